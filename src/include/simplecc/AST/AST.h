@@ -62,11 +62,12 @@ namespace simplecc {
 class AST {
   unsigned SubclassID;
   Location Loc;
+  Location EndLoc;
 
   static const char *getClassName(unsigned Kind);
 protected:
   /// Protected. Use concrete subclass constructor instead.
-  AST(unsigned Kind, Location L) : SubclassID(Kind), Loc(L) {}
+  AST(unsigned Kind, Location L) : SubclassID(Kind), Loc(L), EndLoc(L) {}
   /// Protected. Use deleteAST() instead.
   ~AST() = default;
 public:
@@ -81,6 +82,15 @@ public:
   unsigned getKind() const { return SubclassID; }
   /// Return the source file location where the node is created.
   Location getLocation() const { return Loc; }
+  /// Move the node to another location, as when lines are inserted before it.
+  void setLocation(Location L) { Loc = L; }
+  /// Return the location past the source text of the node, or its location
+  /// if it was not built from source text.
+  Location getEndLocation() const { return EndLoc; }
+  void setEndLocation(Location L) { EndLoc = L; }
+  /// Return the range from getLocation() to getEndLocation(), which errors
+  /// about the node point at.
+  SourceRange getRange() const { return SourceRange(Loc, EndLoc); }
   /// Delete an AST object. Replacement of ``delete``.
   void deleteAST();
   /// Print this AST with proper indentations.
@@ -831,6 +841,7 @@ public:
 
   /// Return the name of the file that produced this AST.
   const std::string &getFilename() const { return Filename; }
+  void setFilename(std::string F) { Filename = std::move(F); }
 
   static bool InstanceCheck(const AST *A) {
     return A->getKind() == ProgramASTKind;
@@ -50,6 +50,8 @@ public:
   ~ASTVerifier() = default;
   /// Check a program.
   bool Check(ProgramAST *P);
+  /// Check a single top-level declaration.
+  bool Check(DeclAST *D);
 private:
   friend ChildrenVisitor;
   friend VisitorBase;
@@ -25,6 +25,7 @@
 #define SIMPLECC_ANALYSIS_ANALYSIS_H
 #include "simplecc/Analysis/SymbolTable.h"
 #include "simplecc/Analysis/Types.h"
+#include <unordered_set>
 
 // TODO: this class sounds very silly.
 
@@ -33,6 +34,7 @@ namespace simplecc {
 /// interface to run all analyses on a program.
 class AnalysisManager {
   SymbolTable TheTable;
+  std::unordered_set<const SubscriptExpr *> ProvenInBounds;
 
 public:
   AnalysisManager() = default;
@@ -47,7 +49,16 @@ public:
 
   SymbolTable &getSymbolTable() { return TheTable; }
 
-  void clear() { TheTable.clear(); }
+  /// Return if the index of a subscript is proven to be always in bound.
+  /// The answer is valid as long as the analyzed AST lives.
+  bool isProvenInBounds(const SubscriptExpr *SB) const {
+    return ProvenInBounds.count(SB);
+  }
+
+  void clear() {
+    TheTable.clear();
+    ProvenInBounds.clear();
+  }
 };
 } // namespace simplecc
 
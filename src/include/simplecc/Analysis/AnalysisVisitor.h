@@ -41,9 +41,29 @@ public:
   explicit AnalysisVisitor(const char *ErrorType = nullptr)
       : ErrorManager(ErrorType) {}
 
-  /// Perform a check on the program.
+  /// Perform a check on the program. Stop early once the error limit of the
+  /// DiagnosticsEngine is reached.
   bool Check(ProgramAST *P, SymbolTable &S) {
-    ContextualVisitor<Derived>::visitProgram(P, S);
+    this->setTable(S);
+    for (DeclAST *D : P->getDecls()) {
+      if (DiagnosticsEngine::get().hasReachedErrorLimit())
+        break;
+      static_cast<Derived *>(this)->visitDecl(D);
+    }
+    return !IsOk();
+  }
+
+  /// Skip the rest of a function once the error limit of the
+  /// DiagnosticsEngine is reached.
+  void visitStmt(StmtAST *S) {
+    if (!DiagnosticsEngine::get().hasReachedErrorLimit())
+      ContextualVisitor<Derived>::visitStmt(S);
+  }
+
+  /// Perform a check on a single function of a program.
+  bool Check(FuncDef *FD, SymbolTable &S) {
+    this->setTable(S);
+    static_cast<Derived *>(this)->visitFuncDef(FD);
     return !IsOk();
   }
 };
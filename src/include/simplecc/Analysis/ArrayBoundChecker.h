@@ -24,31 +24,41 @@
 #define SIMPLECC_ANALYSIS_ARRAYBOUNDCHECKER_H
 #include "simplecc/Analysis/AnalysisVisitor.h"
 #include "simplecc/Analysis/SymbolTable.h"
+#include "simplecc/Analysis/ValueRangeAnalysis.h"
 #include "simplecc/Support/ErrorManager.h"
-#include <utility> // for pair
+#include <memory>
+#include <unordered_set>
 
 namespace simplecc {
-/// @brief ArrayBoundChecker performs static array bound check on a program.
-/// For any SubscriptExpr in a program, if its index is a simple constant expression
-/// then it checks whether the index goes out of bound.
-/// Simple constant expression means it is a:
-/// 1. NumExpr.
-/// 2. UnaryOpExpr wrapping a NumExpr, e.g., -1.
-/// 3. NameExpr that is a ConstType.
-/// Index other than cases above is excluded from this check.
+/// @brief ArrayBoundChecker checks the indices of subscripts against the sizes
+/// of arrays using the ranges computed by ValueRangeAnalysis. An index whose
+/// range lies entirely out of bound is an error. A subscript whose index is
+/// proven to be always in bound is recorded so that code generators may omit
+/// a runtime check for it.
 class ArrayBoundChecker : AnalysisVisitor<ArrayBoundChecker> {
   /// CRTP boilerplate.
   friend AnalysisVisitor;
   friend ChildrenVisitor;
   friend VisitorBase;
-  std::pair<bool, int> getIndex(ExprAST *E) const;
-  void visitSubscript(SubscriptExpr *SB);
+
+  std::unique_ptr<ValueRangeAnalysis> TheAnalysis;
+  std::unordered_set<const SubscriptExpr *> ProvenInBounds;
+
+  void visitFuncDef(FuncDef *FD);
 
 public:
   ArrayBoundChecker() = default;
   /// Perform the check.
   using AnalysisVisitor::Check;
+
+  /// Return the subscripts proven to be in bound.
+  const std::unordered_set<const SubscriptExpr *> &getProvenInBounds() const {
+    return ProvenInBounds;
+  }
+  std::unordered_set<const SubscriptExpr *> &getProvenInBounds() {
+    return ProvenInBounds;
+  }
 };
 } // namespace simplecc
 
-#endif // SIMPLECC_ANALYSIS_ARRAYBOUNDCHECKER_H
\ No newline at end of file
+#endif // SIMPLECC_ANALYSIS_ARRAYBOUNDCHECKER_H
@@ -52,6 +52,9 @@ protected:
     return *TheTable;
   }
 
+  /// Return the local table of the FuncDef being visited.
+  const LocalSymbolTable &getLocalTable() const { return TheLocalTable; }
+
   /// Return the SymbolEntry for an name.
   SymbolEntry getSymbolEntry(const std::string &Name) const {
     return TheLocalTable[Name];
@@ -70,6 +70,8 @@ class ImplicitCallTransformer : ChildrenVisitor<ImplicitCallTransformer> {
 public:
   ImplicitCallTransformer() = default;
   void Transform(ProgramAST *P, const SymbolTable &S);
+  /// Transform a single function of a program.
+  void Transform(FuncDef *FD, const SymbolTable &S);
 
 private:
   friend VisitorBase;
@@ -0,0 +1,102 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef SIMPLECC_ANALYSIS_INTERVAL_H
+#define SIMPLECC_ANALYSIS_INTERVAL_H
+#include "simplecc/Support/Macros.h"
+#include <cstdint>
+#include <iostream>
+
+namespace simplecc {
+/// @brief Interval is an element of the interval domain: a range of int values
+/// [Lower, Upper] whose bounds may be infinite. An Interval with Lower > Upper
+/// is empty.
+///
+/// Arithmetic treats values as mathematical integers and, like C, assumes that
+/// int never overflows: a bound beyond the range of int is clamped to infinity.
+/// A result that lies entirely out of the range of int degrades to the full
+/// range.
+class Interval {
+  int64_t Lower;
+  int64_t Upper;
+
+  Interval(int64_t L, int64_t U) : Lower(L), Upper(U) {}
+
+  /// Create an Interval from bounds that may be out of the range of int.
+  static Interval Normalize(int64_t L, int64_t U);
+
+public:
+  /// The infinite bounds.
+  static constexpr int64_t NegInf = INT64_MIN;
+  static constexpr int64_t PosInf = INT64_MAX;
+
+  /// Construct the full range.
+  Interval() : Lower(NegInf), Upper(PosInf) {}
+
+  /// Return the full range.
+  static Interval getFull() { return Interval(); }
+  /// Return the empty range.
+  static Interval getEmpty() { return Interval(1, 0); }
+  /// Return the range of a single value.
+  static Interval getConstant(int Val) { return Interval(Val, Val); }
+  /// Return [L, U]. Use NegInf or PosInf for an unbounded side.
+  static Interval getRange(int64_t L, int64_t U) { return Normalize(L, U); }
+
+  int64_t getLower() const { return Lower; }
+  int64_t getUpper() const { return Upper; }
+
+  bool isEmpty() const { return Lower > Upper; }
+  bool isFull() const { return Lower == NegInf && Upper == PosInf; }
+  bool isConstant() const { return Lower == Upper; }
+
+  /// Return if a value is in this range.
+  bool contains(int64_t Val) const { return Lower <= Val && Val <= Upper; }
+  /// Return if a range is a subset of this one.
+  bool contains(const Interval &I) const;
+
+  /// Lattice operations.
+  Interval join(const Interval &I) const;
+  Interval meet(const Interval &I) const;
+  /// Widening: push any bound that keeps growing in I to infinity.
+  Interval widen(const Interval &I) const;
+
+  /// Arithmetic.
+  Interval operator-() const;
+  Interval operator+(const Interval &I) const;
+  Interval operator-(const Interval &I) const;
+  Interval operator*(const Interval &I) const;
+  /// Division truncating toward zero. Dividing by a range that contains 0
+  /// gives the full range.
+  Interval operator/(const Interval &I) const;
+
+  bool operator==(const Interval &I) const {
+    return (isEmpty() && I.isEmpty()) ||
+           (Lower == I.Lower && Upper == I.Upper);
+  }
+  bool operator!=(const Interval &I) const { return !(*this == I); }
+
+  void Format(std::ostream &O) const;
+};
+
+DEFINE_INLINE_OUTPUT_OPERATOR(Interval)
+} // namespace simplecc
+#endif // SIMPLECC_ANALYSIS_INTERVAL_H
@@ -24,21 +24,30 @@
 #define SIMPLECC_ANALYSIS_SYMBOLTABLE_H
 #include "simplecc/Analysis/Types.h"
 #include "simplecc/AST/AST.h"
+#include "simplecc/Support/iterator_range.h"
 #include <iostream>
 #include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace simplecc {
+class SymbolTable;
 class SymbolTableBuilder;
-using TableType = std::unordered_map<std::string, SymbolEntry>;
+
+/// The type of an interned identifier.
+using NameID = unsigned;
 
 /// @brief LocalSymbolTable provides a readonly view to a local symbol table.
-/// It overloads the ``operator[]`` to provide readonly access to SymbolEntry
-/// and prevents lookup failure by assertion.
+/// It is a slice of the SymbolTable: the local slots of a function plus the
+/// globals visible to it. It overloads the ``operator[]`` to provide readonly
+/// access to SymbolEntry and prevents lookup failure by assertion.
 class LocalSymbolTable {
   friend class SymbolTable;
-  const TableType *TheTable;
-  explicit LocalSymbolTable(const TableType &T) : TheTable(&T) {}
+  const SymbolTable *TheTable = nullptr;
+  unsigned FuncIndex = 0;
+  LocalSymbolTable(const SymbolTable *T, unsigned Idx)
+      : TheTable(T), FuncIndex(Idx) {}
 
 public:
   /// Define trivial constructor and destructor.
@@ -49,16 +58,27 @@ public:
   LocalSymbolTable(const LocalSymbolTable &) = default;
   LocalSymbolTable &operator=(const LocalSymbolTable &) = default;
 
-  /// Return the SymbolEntry for a name.
+  /// Return the SymbolEntry for a name. Local names shadow global ones.
   SymbolEntry operator[](const std::string &Name) const;
 
-  /// Readonly iterator interface.
-  using const_iterator = TableType::const_iterator;
-  const_iterator begin() const { return TheTable->begin(); }
-  const_iterator end() const { return TheTable->end(); }
+  /// Return the number of local slots, i.e., formal arguments and local
+  /// declarations.
+  unsigned size() const;
+
+  /// Readonly iterator interface over the local slots in slot order.
+  using const_iterator = std::vector<SymbolEntry>::const_iterator;
+  const_iterator begin() const;
+  const_iterator end() const;
+
+  /// Return the globals visible to this function in declaration order.
+  iterator_range<const_iterator> globals() const;
 };
 
 /// @brief SymbolTable holds all the symbols and expression of a program.
+/// Names are interned and every declaration gets a dense integer slot:
+/// globals are numbered in declaration order, and each function owns a
+/// contiguous slice of the local slots (formal arguments first). Lookups go
+/// through an open-addressing hash keyed by scope and interned name.
 class SymbolTable {
 public:
   /// Construct an empty SymbolTable.
@@ -74,19 +94,93 @@ public:
   /// Return a SymbolEntry for a global name.
   SymbolEntry getGlobalEntry(const std::string &Name) const;
 
+  /// Return the number of global slots.
+  unsigned getNumGlobals() const { return GlobalEntries.size(); }
+
+  /// Return the number of local slots left behind by replaceFunction().
+  unsigned getNumRetiredLocals() const { return NumRetiredLocals; }
+
+  /// Return the number of local slots in use.
+  unsigned getNumLocals() const {
+    return LocalEntries.size() - NumRetiredLocals;
+  }
+
   void Format(std::ostream &O) const;
 
 private:
-  TableType GlobalTable;
-  std::unordered_map<const FuncDef *, TableType> LocalTables;
-
+  friend class LocalSymbolTable;
   friend class SymbolTableBuilder;
-  /// Return the global table to be populate.
-  TableType &getGlobal() { return GlobalTable; }
-  /// Create or Return a local table to be populate.
-  TableType &getLocal(FuncDef *FD) { return LocalTables[FD]; }
+
+  /// The range of local slots owned by a function.
+  struct FunctionSlice {
+    const FuncDef *TheFuncDef;
+    unsigned Begin;
+    unsigned End;
+    /// Globals with slots below this are visible to the function.
+    unsigned NumVisibleGlobals;
+  };
+
+  /// A bucket in the slot hash. Scope 0 is the global scope and Scope i + 1
+  /// is the local scope of function i.
+  struct SlotBucket {
+    unsigned Scope;
+    NameID Name;
+    unsigned Slot;
+  };
+  static constexpr unsigned EmptyScope = ~0U;
+
+  /// Interned names, indexed by NameID.
+  std::vector<std::string> Names;
+  /// Open-addressing hash from a name to NameID + 1 (0 for an empty bucket).
+  std::vector<unsigned> NameBuckets;
+  /// Open-addressing hash from (Scope, NameID) to a slot.
+  std::vector<SlotBucket> SlotBuckets;
+  unsigned NumSlotBuckets = 0;
+
+  std::vector<SymbolEntry> GlobalEntries;
+  std::vector<SymbolEntry> LocalEntries;
+  std::vector<FunctionSlice> Functions;
+  std::unordered_map<const FuncDef *, unsigned> FunctionIndices;
+  unsigned NumRetiredLocals = 0;
+
+  /// Return the NameID of a name, or -1 if it was never interned.
+  int findName(const std::string &Name) const;
+  /// Return the NameID of a name, interning it if necessary.
+  NameID intern(const std::string &Name);
+  /// Return the slot of a name in a scope, or -1 if it is not defined there.
+  int findSlot(unsigned Scope, NameID Name) const;
+  void insertSlot(unsigned Scope, NameID Name, unsigned Slot);
+
+  /// Return the local SymbolEntry of a name, or null.
+  const SymbolEntry *lookupLocal(unsigned FuncIndex,
+                                 const std::string &Name) const;
+  /// Return the global SymbolEntry of a name among the first NumVisible
+  /// globals, or null.
+  const SymbolEntry *lookupGlobal(const std::string &Name,
+                                  unsigned NumVisible) const;
+  /// Return the SymbolEntry of a name as seen from a function, or null.
+  const SymbolEntry *lookup(unsigned FuncIndex, const std::string &Name) const;
+
+  /// Interface for SymbolTableBuilder.
+  /// Define a global name. The name must not be defined yet.
+  void defineGlobal(const DeclAST *D);
+  /// Start the local slice of a function. Locals of a function must be defined
+  /// before the next function starts.
+  unsigned beginFunction(const FuncDef *FD);
+  /// Define a local name in the last function. The name must not be defined
+  /// locally yet.
+  void defineLocal(unsigned FuncIndex, const DeclAST *D);
+  /// Return the number of globals visible to a function.
+  unsigned getNumVisibleGlobals(unsigned FuncIndex) const {
+    return Functions[FuncIndex].NumVisibleGlobals;
+  }
+  /// Retire the local slice of Old and start a new one for New, which sees the
+  /// same globals. If Old owns its global name, New takes it over.
+  /// Return the index of New and whether it owns its global name.
+  std::pair<unsigned, bool> replaceFunction(const FuncDef *Old,
+                                            const FuncDef *New);
 };
 
 DEFINE_INLINE_OUTPUT_OPERATOR(SymbolTable)
 } // namespace simplecc
-#endif // SIMPLECC_ANALYSIS_SYMBOLTABLE_H
\ No newline at end of file
+#endif // SIMPLECC_ANALYSIS_SYMBOLTABLE_H
@@ -43,17 +43,16 @@ class SymbolTableBuilder : ChildrenVisitor<SymbolTableBuilder> {
   void visitDecl(DeclAST *D);
 
   /// Overloads to visit AstNodes that have names.
-  void visitName(NameExpr *N) { ResolveName(N->getName(), N->getLocation()); }
+  void visitName(NameExpr *N) { ResolveName(N->getName(), N->getRange()); }
   void visitCall(CallExpr *C);
   void visitSubscript(SubscriptExpr *SB);
-  void ResolveName(const std::string &Name, Location L);
+  void ResolveName(const std::string &Name, SourceRange R);
 
   /// Trivial setters for important states during the construction
   /// of a table.
   void setFuncDef(FuncDef *FD) { TheFuncDef = FD; }
   void setTable(SymbolTable *ST) { TheTable = ST; }
-  void setLocal(TableType *L) { TheLocal = L; }
-  void setGlobal(TableType *G) { TheGlobal = G; }
+  void setFuncIndex(int Idx) { FuncIndex = Idx; }
 
   /// Clear the state of this SymbolTableBuilder
   void clear();
@@ -67,13 +66,25 @@ public:
   /// Note: the table will be cleared first.
   bool Build(ProgramAST *P, SymbolTable &S);
 
+  /// Incremental interface.
+  /// Clear the table and prepare for a sequence of BuildDecl() in program order.
+  void Begin(SymbolTable &S);
+  /// Enter a top-level declaration into the table.
+  /// Return true if errors happened with this declaration.
+  bool BuildDecl(DeclAST *D);
+  /// Enter New in place of Old, a function with the same signature whose body
+  /// changed. Only New is visited, so the rest of the table is untouched.
+  /// Return true if errors happened with New.
+  bool Rebuild(FuncDef *Old, FuncDef *New, SymbolTable &S);
+
 private:
   friend VisitorBase;
   friend ChildrenVisitor;
 
   ErrorManager EM;
-  TableType *TheGlobal;
-  TableType *TheLocal;
+  /// Index of the function being visited in the SymbolTable, or -1 at the
+  /// global scope.
+  int FuncIndex;
   FuncDef *TheFuncDef;
   SymbolTable *TheTable;
 };
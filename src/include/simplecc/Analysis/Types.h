@@ -92,9 +92,10 @@ public:
 class SymbolEntry {
   Scope TheScope;
   const DeclAST *TheDecl = nullptr;
+  unsigned Slot = 0;
 
 public:
-  SymbolEntry(Scope scope, const DeclAST *decl);
+  SymbolEntry(Scope scope, const DeclAST *decl, unsigned slot = 0);
   /// This constructs an invalid SymbolEntry.
   SymbolEntry() = default;
 
@@ -125,6 +126,8 @@ public:
   Location getLocation() const;
   /// Return the value of this name.
   const std::string &getName() const;
+  /// Return the declaration of this name.
+  const DeclAST *getDecl() const { return TheDecl; }
 
   /// Return the Scope of this name.
   Scope getScope() const { return TheScope; }
@@ -133,6 +136,11 @@ public:
   /// Return if this is a local symbol.
   bool IsLocal() const { return Scope::Local == getScope(); }
 
+  /// Return the dense slot of this name within its scope.
+  /// Global slots are numbered in declaration order. Local slots of a function
+  /// start from 0 with the formal arguments.
+  unsigned getSlot() const { return Slot; }
+
   void Format(std::ostream &os) const;
 };
 
@@ -0,0 +1,72 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef SIMPLECC_ANALYSIS_VALUERANGEANALYSIS_H
+#define SIMPLECC_ANALYSIS_VALUERANGEANALYSIS_H
+#include "simplecc/Analysis/Interval.h"
+#include "simplecc/Analysis/SymbolTable.h"
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace simplecc {
+/// @brief ValueRangeAnalysis computes the range of values the index of each
+/// subscript of a function may take by abstract interpretation over the
+/// Interval domain.
+///
+/// Local variables and formal arguments are tracked flow-sensitively and
+/// refined by the conditions of if, while and for. Loops are iterated to a
+/// fixpoint with widening followed by a few rounds of narrowing. Globals and
+/// array elements may hold any value. A call yields the range of values the
+/// callee may return, which is computed on demand and cached.
+class ValueRangeAnalysis {
+public:
+  /// The range of the index of a subscript.
+  struct SubscriptRange {
+    SubscriptExpr *TheSubscript;
+    Interval Range;
+    /// False if the subscript lies in code that never runs. The range of such
+    /// a subscript is computed assuming nothing about local variables.
+    bool Reachable;
+  };
+
+  explicit ValueRangeAnalysis(const SymbolTable &S) : TheTable(S) {}
+
+  /// Analyze a function and return the ranges of its subscripts in program
+  /// order.
+  std::vector<SubscriptRange> Analyze(FuncDef *FD);
+
+  /// Return the range of values a function may return.
+  Interval getReturnRange(FuncDef *FD);
+
+  /// Return the SymbolTable being used.
+  const SymbolTable &getSymbolTable() const { return TheTable; }
+
+private:
+  const SymbolTable &TheTable;
+  std::unordered_map<const FuncDef *, Interval> ReturnRanges;
+  /// Functions whose return range is being computed. Recursive calls to them
+  /// yield the full range.
+  std::unordered_set<const FuncDef *> InProgress;
+};
+} // namespace simplecc
+#endif // SIMPLECC_ANALYSIS_VALUERANGEANALYSIS_H
@@ -54,6 +54,10 @@ private:
   // Lineno in source file.
   unsigned SourceLineno = 0;
 
+  // Name of the function the source line is in, if this was inlined from
+  // another function.
+  const char *SourceFunction = nullptr;
+
   // Offset in the ByteCode stream of a ByteCodeFunction.
   unsigned ByteCodeOffset = 0;
 
@@ -70,6 +74,7 @@ public:
   ~ByteCode() = default;
   ByteCode(const ByteCode &) = default;
   ByteCode(ByteCode &&) = default;
+  ByteCode &operator=(const ByteCode &) = default;
 
   /// Create a ByteCode with no operand.
   static ByteCode Create(Opcode Op) { return ByteCode(Op); }
@@ -102,6 +107,13 @@ public:
   /// Return the source lineno.
   unsigned getSourceLineno() const { return SourceLineno; }
 
+  /// Set the name of the function the source line is in, or nullptr if
+  /// it is the function of this ByteCode. The storage must outlive this.
+  void setSourceFunction(const char *Name) { SourceFunction = Name; }
+
+  /// Return the name of the function the source line is in, or nullptr.
+  const char *getSourceFunction() const { return SourceFunction; }
+
   /// Set the jump target for this ByteCode if this is a jump.
   void setJumpTarget(unsigned Target) {
     assert(IsJump() && "not a jump!");
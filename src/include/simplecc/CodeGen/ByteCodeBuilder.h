@@ -107,6 +107,9 @@ public:
   /// Create a unary operation, such as UNARY_NEGATIVE.
   unsigned CreateUnary(UnaryOpKind Op) { return Create(MakeUnary(Op)); }
 
+  /// Create an operation with a constant operand, such as SHIFT_LEFT.
+  unsigned CreateImmediate(Opcode Op, int Imm) { return Create(Op, Imm); }
+
   /// Create a CALL_FUNCTION.
   unsigned CreateCallFunction(const std::string &Name, unsigned Argc) {
     return Create(ByteCode::CALL_FUNCTION, Name.data(), Argc);
@@ -159,14 +162,22 @@ public:
 
   /// Set the current lineno.
   void setLineno(Location L) { CurrentLineno = L.getLine(); }
+  void setLineno(unsigned Line) { CurrentLineno = Line; }
   /// Return the current lineno.
   unsigned getLineno() const { return CurrentLineno; }
 
+  /// Set the function the current lineno is in, or nullptr for the function
+  /// being built.
+  void setSourceFunction(const char *Name) { CurrentSourceFunction = Name; }
+  /// Return the function the current lineno is in.
+  const char *getSourceFunction() const { return CurrentSourceFunction; }
+
   /// Return the size of the InstList of the insert point.
   unsigned int getSize() const { return getInsertPoint()->size(); }
 private:
   ByteCodeFunction *InsertPoint = nullptr;
   unsigned CurrentLineno = 1;
+  const char *CurrentSourceFunction = nullptr;
 };
 
 template <typename... Args>
@@ -0,0 +1,172 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef SIMPLECC_CODEGEN_BYTECODECFG_H
+#define SIMPLECC_CODEGEN_BYTECODECFG_H
+#include "simplecc/CodeGen/ByteCode.h"
+#include "simplecc/Support/Macros.h"
+#include <iostream>
+#include <vector>
+
+namespace simplecc {
+class ByteCodeFunction;
+
+/// @brief ByteCodeCFG splits a ByteCodeFunction into basic blocks and links
+/// them by the jumps and fall-throughs between them. A block starts at the
+/// entry, at a jump target or right after a jump or return, and blocks are
+/// numbered in the order of the stream, so block 0 is the entry.
+///
+/// On top of the blocks, it computes the immediate dominators of the blocks
+/// reachable from the entry and the natural loops. These are computed when
+/// first asked for after a change.
+///
+/// A pass that edits the stream of a ByteCodeFunction does so through the
+/// ByteCodeCFG that was built for it, which keeps the blocks and their edges
+/// up to date. Editing the stream by other means requires recalculate().
+class ByteCodeCFG {
+public:
+  /// @brief Block is a run of ByteCode's [Begin, End) that is entered only at
+  /// Begin and left only at End - 1.
+  struct Block {
+    unsigned Begin;
+    unsigned End;
+    /// The blocks that jump or fall through to this, each once.
+    std::vector<unsigned> Predecessors;
+    /// The blocks this jumps or falls through to, the jump target first.
+    std::vector<unsigned> Successors;
+
+    unsigned size() const { return End - Begin; }
+  };
+
+  /// @brief Loop is a natural loop: a header that dominates the blocks of the
+  /// loop and the back edges that go to it from the latches. The loops of the
+  /// same header are one Loop.
+  struct Loop {
+    unsigned Header;
+    /// The blocks of the loop in stream order, including those of the loops
+    /// inside it.
+    std::vector<unsigned> Blocks;
+    /// The blocks of the loop that jump back to the header.
+    std::vector<unsigned> Latches;
+    /// The index of the innermost Loop that contains this one, or -1.
+    int Parent;
+    /// 1 for an outermost loop, 2 for one inside it and so on.
+    unsigned Depth;
+  };
+
+  ByteCodeCFG() = default;
+  explicit ByteCodeCFG(const ByteCodeFunction &F) { recalculate(F); }
+  explicit ByteCodeCFG(ByteCodeFunction &F) { recalculate(F); }
+
+  /// Build the blocks of F, which cannot be edited through this.
+  void recalculate(const ByteCodeFunction &F);
+  /// Build the blocks of F, which can be edited through this.
+  void recalculate(ByteCodeFunction &F);
+
+  /// Return the function the blocks are of.
+  const ByteCodeFunction &getFunction() const { return *TheFunction; }
+
+  /// Return the number of blocks.
+  unsigned size() const { return Blocks.size(); }
+  /// Return the block B.
+  const Block &getBlock(unsigned B) const { return Blocks[B]; }
+  /// Return the last ByteCode of the block B.
+  const ByteCode &getTerminator(unsigned B) const;
+
+  /// Return the block that contains the ByteCode at Offset.
+  unsigned getBlockAt(unsigned Offset) const { return BlockOf[Offset]; }
+  /// Return whether a block starts at Offset.
+  bool IsBlockStart(unsigned Offset) const {
+    return Offset < BlockOf.size() && Blocks[BlockOf[Offset]].Begin == Offset;
+  }
+  /// Return whether a jump goes to Offset.
+  bool IsJumpTarget(unsigned Offset) const {
+    return Offset < NumJumpsTo.size() && NumJumpsTo[Offset] != 0;
+  }
+
+  /// Return whether the block B is reachable from the entry.
+  bool isReachable(unsigned B) const;
+  /// Return the immediate dominator of the block B, or -1 for the entry and
+  /// the unreachable blocks.
+  int getIDom(unsigned B) const;
+  /// Return whether the block A dominates the block B. Every block dominates
+  /// itself and every block dominates the unreachable ones.
+  bool dominates(unsigned A, unsigned B) const;
+
+  /// Return the loops, outer ones before the loops inside them.
+  const std::vector<Loop> &getLoops() const;
+  /// Return the index of the innermost Loop that contains the block B, or -1.
+  int getLoopFor(unsigned B) const;
+  /// Return the loop depth of the block B, 0 if it is in no loop.
+  unsigned getLoopDepth(unsigned B) const;
+
+  /// Make the jump at Offset go to Target.
+  void setJumpTarget(unsigned Offset, unsigned Target);
+  /// Replace the ByteCode at Offset by C, which keeps the line of the old one.
+  void replace(unsigned Offset, ByteCode C);
+  /// Remove the ByteCode's at the offsets where Removed is true. A jump to a
+  /// removed ByteCode goes to the first one after it that is kept.
+  void remove(const std::vector<bool> &Removed);
+
+  void Format(std::ostream &O) const;
+
+private:
+  /// Split the stream into blocks and link them.
+  void buildBlocks();
+  /// Return whether a block must start at Offset.
+  bool IsLeader(unsigned Offset) const;
+  /// Compute the successors of the block B again and fix the predecessors.
+  void relink(unsigned B);
+  /// After the ByteCode at Offset has changed, from a jump to Old if it was
+  /// one, update the blocks, relinking them if their bounds still hold.
+  void updateBlocks(unsigned Offset, int Old);
+  /// Compute the dominators and loops if the blocks changed since.
+  void updateAnalyses() const;
+  void computeDominators() const;
+  void computeLoops() const;
+
+  const ByteCodeFunction *TheFunction = nullptr;
+  /// The same function as TheFunction if it can be edited, or nullptr.
+  ByteCodeFunction *MutableFunction = nullptr;
+  std::vector<Block> Blocks;
+  /// The block of each offset.
+  std::vector<unsigned> BlockOf;
+  /// The number of jumps to each offset, and to the end of the stream.
+  std::vector<unsigned> NumJumpsTo;
+
+  /// Whether the analyses below must be computed again.
+  mutable bool Stale = true;
+  /// The reachable blocks in reverse post order.
+  mutable std::vector<unsigned> RPO;
+  /// The index of each block in RPO, or -1 if it is unreachable.
+  mutable std::vector<int> RPONumbers;
+  /// The immediate dominator of each block by block, or -1.
+  mutable std::vector<int> IDoms;
+  mutable std::vector<Loop> Loops;
+  /// The innermost Loop of each block, or -1.
+  mutable std::vector<int> LoopOf;
+};
+
+DEFINE_INLINE_OUTPUT_OPERATOR(ByteCodeCFG)
+} // namespace simplecc
+#endif // SIMPLECC_CODEGEN_BYTECODECFG_H
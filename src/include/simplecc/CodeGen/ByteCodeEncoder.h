@@ -0,0 +1,63 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef SIMPLECC_CODEGEN_BYTECODEENCODER_H
+#define SIMPLECC_CODEGEN_BYTECODEENCODER_H
+#include "simplecc/CodeGen/EncodedModule.h"
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace simplecc {
+class ByteCodeFunction;
+class ByteCodeModule;
+
+/// @brief ByteCodeEncoder lowers a ByteCodeModule into an EncodedModule.
+///
+/// The names of locals, globals and callees are resolved to numbers, and
+/// ByteCode offsets to byte offsets. The sequences that SuperInstructionSelector
+/// selects are fused into one instruction each, unless asked otherwise so
+/// that each ByteCode is one instruction. Since the width of a jump depends on the
+/// offset of its target, which depends on the width of the jumps before it,
+/// the widths of the jumps start at one byte and grow until all the targets
+/// fit.
+class ByteCodeEncoder {
+public:
+  explicit ByteCodeEncoder(bool FuseSuperInstructions = true)
+      : FuseSuperInstructions(FuseSuperInstructions) {}
+  ~ByteCodeEncoder() = default;
+
+  /// Encode M into EM, replacing what it held.
+  void Encode(const ByteCodeModule &M, EncodedModule &EM);
+
+private:
+  void EncodeFunction(const ByteCodeFunction &F, EncodedFunction &EF);
+
+  /// A location and whether it holds an array.
+  using SlotTy = std::pair<unsigned, bool>;
+  std::unordered_map<std::string, SlotTy> Globals;
+  const EncodedModule *TheModule = nullptr;
+  bool FuseSuperInstructions;
+};
+} // namespace simplecc
+#endif // SIMPLECC_CODEGEN_BYTECODEENCODER_H
@@ -0,0 +1,117 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/// @file The .c0bc file, an EncodedModule on disk.
+///
+/// All the integers are 32-bit little-endian words and all the offsets are
+/// from the start of the file. A file has these parts, in order:
+/// 1. The header: the magic "C0BC", the version of the format, the number
+///    of opcodes, the number of words of the globals, the number of string
+///    literals, the number of functions, and the offsets of the string
+///    literals and of the function index.
+/// 2. The string literals by ID, each its size followed by its bytes.
+/// 3. The function index, in the order of the module: for each function,
+///    the offset and size of its name and the offset and size of its body.
+/// 4. The names of the functions.
+/// 5. The bodies: the number of arguments, the number of words of the frame,
+///    the depth of the operand stack, the number of line entries, the size
+///    of the code, then the line entries, each an offset, a line and the
+///    index of the function the line is in, then the code.
+///
+/// When a file is opened, the header, the string literals, the index and the
+/// fields of each body are read, and the code of each function is checked
+/// by EncodedVerifier, so that a corrupt file is rejected before it runs.
+/// The line table and the code of a function are copied out of the file
+/// only when it is first asked for.
+#ifndef SIMPLECC_CODEGEN_BYTECODEFILE_H
+#define SIMPLECC_CODEGEN_BYTECODEFILE_H
+#include "simplecc/Support/ErrorManager.h"
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+
+namespace simplecc {
+class EncodedFunction;
+class EncodedModule;
+
+/// @brief ByteCodeFileImage holds the bytes of a .c0bc file. The file is
+/// mapped into memory where the platform supports it, and read otherwise.
+class ByteCodeFileImage {
+public:
+  ByteCodeFileImage(const ByteCodeFileImage &) = delete;
+  ByteCodeFileImage &operator=(const ByteCodeFileImage &) = delete;
+  ~ByteCodeFileImage();
+
+  /// Open the file named Filename, or return nullptr if it cannot be read.
+  static std::shared_ptr<ByteCodeFileImage> Open(const std::string &Filename);
+
+  const uint8_t *data() const { return Data; }
+  size_t size() const { return Size; }
+
+private:
+  ByteCodeFileImage() = default;
+
+  const uint8_t *Data = nullptr;
+  size_t Size = 0;
+  /// Whether Data is mapped rather than allocated.
+  bool IsMapped = false;
+};
+
+/// @brief ByteCodeFileWriter writes an EncodedModule as a .c0bc file.
+class ByteCodeFileWriter {
+public:
+  ByteCodeFileWriter() = default;
+  ~ByteCodeFileWriter() = default;
+
+  /// Write EM to O, which must be opened in binary mode.
+  void Write(const EncodedModule &EM, std::ostream &O);
+};
+
+/// @brief ByteCodeFileReader reads a .c0bc file into an EncodedModule, which
+/// keeps the file open to decode its functions when they are first asked for.
+class ByteCodeFileReader {
+public:
+  /// The first bytes of every .c0bc file.
+  static constexpr char Magic[] = "C0BC";
+  /// The version of the format. A file of another version is rejected.
+  static constexpr uint32_t Version = 1;
+
+  ByteCodeFileReader() = default;
+  ~ByteCodeFileReader() = default;
+
+  /// Read the file named Filename into M. Return true if it is not a valid
+  /// .c0bc file, which has been reported.
+  bool Read(const std::string &Filename, EncodedModule &M);
+
+  /// Decode the line table and the code of the body of Size bytes at Body
+  /// into F, which were checked when the file was read.
+  static void DecodeFunction(const uint8_t *Body, size_t Size,
+                             EncodedFunction &F);
+
+private:
+  ErrorManager EM{"ByteCodeFileError"};
+};
+} // namespace simplecc
+#endif // SIMPLECC_CODEGEN_BYTECODEFILE_H
@@ -24,6 +24,7 @@
 #define SIMPLECC_CODEGEN_BYTECODEFUNCTION_H
 #include "simplecc/Analysis/SymbolTable.h"
 #include "simplecc/CodeGen/ByteCode.h"
+#include <deque>
 #include <iostream>
 #include <string>
 #include <utility> // move()
@@ -37,10 +38,25 @@ class ByteCodeModule;
 /// 1. a list of formal arguments.
 /// 2. a list of local variables (ArrayType and VarType).
 /// 3. a list of ByteCode's.
+/// Code that no longer comes from the AST, such as the code lowered from the
+/// SSA IR, keeps its values in temporaries, which have no SymbolEntry.
 class ByteCodeFunction {
 public:
   /// The type for a list of local variables.
   using LocalVariableListTy = std::vector<SymbolEntry>;
+
+  /// @brief Temporary is an unnamed local object of a function.
+  struct Temporary {
+    std::string Name;
+    /// Number of elements of an array, or 0 for a variable.
+    unsigned Size;
+
+    bool IsArray() const { return Size != 0; }
+  };
+
+  /// The type for a list of temporaries. A deque keeps the names in place,
+  /// since ByteCode refers to them by pointer.
+  using TemporaryListTy = std::deque<Temporary>;
   /// The type for a list of ByteCode's.
   using ByteCodeListTy = std::vector<ByteCode>;
 
@@ -125,6 +141,18 @@ public:
   /// Return the list of local variables.
   LocalVariableListTy &getLocalVariables() { return LocalVariables; }
 
+  /// Add a temporary and return its name, which lives as long as this.
+  const std::string &addTemporary(std::string Name, unsigned Size = 0) {
+    Temporaries.push_back(Temporary{std::move(Name), Size});
+    return Temporaries.back().Name;
+  }
+
+  /// Return the list of temporaries.
+  const TemporaryListTy &getTemporaries() const { return Temporaries; }
+
+  /// Remove all the temporaries.
+  void clearTemporaries() { Temporaries.clear(); }
+
   /// Return the enclosing ByteCodeModule.
   ByteCodeModule *getParent() const { return Parent; }
 
@@ -137,6 +165,7 @@ private:
   ByteCodeListTy ByteCodeList;
   LocalVariableListTy Arguments;
   LocalVariableListTy LocalVariables;
+  TemporaryListTy Temporaries;
   std::string Name;
 
   /// Private. Use Create() instead.
@@ -0,0 +1,56 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef SIMPLECC_CODEGEN_BYTECODESIMPLIFYCFG_H
+#define SIMPLECC_CODEGEN_BYTECODESIMPLIFYCFG_H
+
+namespace simplecc {
+class ByteCodeCFG;
+class ByteCodeFunction;
+
+/// @brief ByteCodeSimplifyCFG cleans up the jumps of a ByteCodeFunction, such
+/// as those lowered from the SSA IR, through its ByteCodeCFG. It repeats these
+/// until nothing changes:
+/// 1. Delete the blocks unreachable from the entry.
+/// 2. Fold a conditional jump on constants loaded right before it, so that a
+///    jump to its block is threaded to where it goes.
+/// 3. Make a jump to a JUMP_FORWARD go where that goes, and turn a
+///    JUMP_FORWARD to a RETURN_NONE into a RETURN_NONE.
+/// 4. Turn a conditional jump over a JUMP_FORWARD into the opposite jump.
+/// 5. Delete a JUMP_FORWARD to the next ByteCode.
+class ByteCodeSimplifyCFG {
+  bool removeUnreachableBlocks(ByteCodeCFG &CFG);
+  bool foldConstantJumps(ByteCodeCFG &CFG);
+  bool collapseJumpChains(ByteCodeCFG &CFG);
+  bool invertJumpsOverJumps(ByteCodeCFG &CFG);
+  bool removeJumpsToNext(ByteCodeCFG &CFG);
+
+public:
+  ByteCodeSimplifyCFG() = default;
+  ~ByteCodeSimplifyCFG() = default;
+
+  /// Run on F. Return true if F was changed.
+  bool Transform(ByteCodeFunction &F);
+};
+} // namespace simplecc
+#endif // SIMPLECC_CODEGEN_BYTECODESIMPLIFYCFG_H
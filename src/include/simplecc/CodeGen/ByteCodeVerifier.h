@@ -0,0 +1,187 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef SIMPLECC_CODEGEN_BYTECODEVERIFIER_H
+#define SIMPLECC_CODEGEN_BYTECODEVERIFIER_H
+#include "simplecc/AST/Enums.h"
+#include "simplecc/CodeGen/ByteCodeCFG.h"
+#include "simplecc/CodeGen/ByteCodeVisitor.h"
+#include "simplecc/Support/ErrorManager.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace simplecc {
+class ByteCodeFunction;
+class ByteCodeModule;
+class SymbolEntry;
+
+/// @brief ByteCodeVerifier checks that the ByteCode of a function is
+/// well-formed before it is assembled or run.
+///
+/// First, every ByteCode must have the operands its Opcode demands: a jump
+/// lands inside the function, a load or store names a local or global that
+/// exists, a call names a function and passes it as many arguments as it
+/// takes, and a string literal exists. Then the ByteCode's are run on an
+/// abstract operand stack of value kinds over the ByteCodeCFG: the stack
+/// never underflows, it has the same depth wherever control flow merges, and
+/// every ByteCode gets operands of the kinds it expects, such as an array to
+/// subscript and no int where a char is stored or printed.
+///
+/// A module that passes can be encoded. What an interpreter runs is then
+/// checked again by EncodedVerifier, which also finds how deep the operand
+/// stack of each function gets.
+class ByteCodeVerifier : ByteCodeVisitor<ByteCodeVerifier> {
+  friend ByteCodeVisitor;
+
+public:
+  ByteCodeVerifier() = default;
+  ~ByteCodeVerifier() = default;
+
+  /// Check a function. Return true if it is malformed.
+  bool Check(const ByteCodeFunction &F);
+  /// Check all the functions of a module.
+  bool Check(const ByteCodeModule &M);
+
+private:
+  /// The kind of a value on the operand stack.
+  enum ValueKind : unsigned char {
+    Int,
+    Char,
+    /// An int or a char, such as a constant or a temporary.
+    Word,
+    IntArray,
+    CharArray,
+    /// A temporary array, whose elements are words.
+    WordArray,
+    String,
+    /// What a call to a void function pushes.
+    Void,
+  };
+  using StackTy = std::vector<ValueKind>;
+
+  static const char *getKindName(ValueKind K);
+  static ValueKind getKind(BasicTypeKind T);
+  /// Return what a load of the variable or array E pushes.
+  static ValueKind getKind(const SymbolEntry &E);
+  static bool IsScalar(ValueKind K) { return K <= Word; }
+  static bool IsArray(ValueKind K) { return K >= IntArray && K <= WordArray; }
+  /// Return the kind of the elements of an array.
+  static ValueKind getElementKind(ValueKind K) {
+    return static_cast<ValueKind>(K - IntArray);
+  }
+  /// Return whether a value of kind From can be stored where a value of kind
+  /// To is expected.
+  static bool IsAssignable(ValueKind To, ValueKind From);
+  /// Widen A to hold the values of kind B too. Return false if no kind can.
+  static bool Join(ValueKind &A, ValueKind B);
+
+  /// Report an error at the ByteCode being checked.
+  template <typename... Args> void Error(Args &&... args);
+  /// Helper to check a condition.
+  void AssertThat(bool Predicate, const char *ErrMsg);
+
+  /// Collect the names the functions of M can refer to.
+  void setModule(const ByteCodeModule &M);
+  void checkFunction(const ByteCodeFunction &F);
+  void verifyOperands(const ByteCode &C);
+  /// Run the blocks on the abstract stack until nothing changes.
+  void verifyStack();
+  /// Merge the stack into the entry of the block B. Return whether the entry
+  /// changed.
+  bool mergeInto(unsigned B);
+
+  void push(ValueKind K);
+  ValueKind pop();
+  /// Pop a value that must be a scalar, and one of kind To can hold.
+  ValueKind popScalar(const char *What, ValueKind To = Word);
+
+  void visitLoadLocal(const ByteCode &C);
+  void visitLoadGlobal(const ByteCode &C);
+  void visitStoreLocal(const ByteCode &C);
+  void visitStoreGlobal(const ByteCode &C);
+  void visitBinaryAdd(const ByteCode &) { visitBinary(); }
+  void visitBinarySub(const ByteCode &) { visitBinary(); }
+  void visitBinaryMultiply(const ByteCode &) { visitBinary(); }
+  void visitBinaryDivide(const ByteCode &) { visitBinary(); }
+  void visitBinarySubscr(const ByteCode &);
+  void visitStoreSubscr(const ByteCode &);
+  void visitUnaryPositive(const ByteCode &) { visitUnary(); }
+  void visitUnaryNegative(const ByteCode &) { visitUnary(); }
+  void visitShiftLeft(const ByteCode &) { visitUnary(); }
+  void visitShiftRight(const ByteCode &) { visitUnary(); }
+  void visitShiftRightLogical(const ByteCode &) { visitUnary(); }
+  void visitMultiplyHigh(const ByteCode &) { visitUnary(); }
+  void visitReadInteger(const ByteCode &) { push(Int); }
+  void visitReadCharacter(const ByteCode &) { push(Char); }
+  void visitPrintString(const ByteCode &);
+  void visitPrintCharacter(const ByteCode &) {
+    popScalar("printed value", Char);
+  }
+  void visitPrintInteger(const ByteCode &) {
+    popScalar("printed value", Int);
+  }
+  void visitPrintNewline(const ByteCode &) {}
+  void visitJumpForward(const ByteCode &) {}
+  void visitJumpIfTrue(const ByteCode &) { popScalar("condition"); }
+  void visitJumpIfFalse(const ByteCode &) { popScalar("condition"); }
+  void visitJumpIfEqual(const ByteCode &) { visitCompare(); }
+  void visitJumpIfNotEqual(const ByteCode &) { visitCompare(); }
+  void visitJumpIfGreater(const ByteCode &) { visitCompare(); }
+  void visitJumpIfGreaterEqual(const ByteCode &) { visitCompare(); }
+  void visitJumpIfLess(const ByteCode &) { visitCompare(); }
+  void visitJumpIfLessEqual(const ByteCode &) { visitCompare(); }
+  void visitCallFunction(const ByteCode &C);
+  void visitReturnValue(const ByteCode &);
+  void visitReturnNone(const ByteCode &) {}
+  void visitLoadConst(const ByteCode &) { push(Word); }
+  void visitLoadString(const ByteCode &) { push(String); }
+  void visitPopTop(const ByteCode &) { pop(); }
+
+  void visitBinary();
+  void visitUnary();
+  void visitCompare();
+
+  /// What a LOAD_GLOBAL of each global pushes.
+  std::unordered_map<std::string, ValueKind> Globals;
+  /// The functions of the module by name.
+  std::unordered_map<std::string, const ByteCodeFunction *> Functions;
+  /// What a call to each function pushes.
+  std::unordered_map<std::string, ValueKind> ReturnKinds;
+
+  /// What a LOAD_LOCAL of each local pushes.
+  std::unordered_map<std::string, ValueKind> Locals;
+  const ByteCodeFunction *TheFunction = nullptr;
+  ByteCodeCFG CFG;
+  /// The offset of the ByteCode being checked.
+  unsigned Offset = 0;
+  /// The stack at the entry of each block, if it was reached yet.
+  std::vector<StackTy> EntryStacks;
+  std::vector<bool> Reached;
+  StackTy Stack;
+  /// Whether the stack underflowed in the block being run.
+  bool Underflow = false;
+  ErrorManager EM;
+};
+} // namespace simplecc
+#endif // SIMPLECC_CODEGEN_BYTECODEVERIFIER_H
@@ -0,0 +1,114 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef SIMPLECC_CODEGEN_CALLGRAPH_H
+#define SIMPLECC_CODEGEN_CALLGRAPH_H
+#include "simplecc/Support/Macros.h"
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace simplecc {
+class ByteCodeModule;
+class ProgramAST;
+
+/// @brief CallGraph records which functions call which in a program.
+/// Functions are numbered in declaration order, which is also the order of
+/// the FunctionList of a ByteCodeModule and of the FuncDefs of a ProgramAST.
+///
+/// Besides the edges, it computes the strongly connected components (SCCs),
+/// which group mutually recursive functions, the leaf functions, which call
+/// nothing, and the functions reachable from main. The SCCs are ordered
+/// bottom-up: the SCC of a callee always comes before that of its caller.
+class CallGraph {
+public:
+  /// Construct an empty CallGraph.
+  CallGraph() = default;
+
+  /// Build from the CALL_FUNCTION of each ByteCodeFunction.
+  void Build(const ByteCodeModule &M);
+  /// Build from the CallExpr of each FuncDef.
+  void Build(const ProgramAST *P);
+
+  /// The steps of Build() for other forms of a program, such as the IR.
+  /// Start from an empty CallGraph.
+  /// Add a function. All functions must be added before any call.
+  void addFunction(const std::string &Name);
+  /// Add a call from Caller to the function named Callee.
+  void addCall(unsigned Caller, const std::string &Callee);
+  /// Compute SCCs, recursion and reachability once all edges are added.
+  void Finalize();
+
+  /// Return the number of functions.
+  unsigned size() const { return Nodes.size(); }
+
+  /// Return the index of a function, or -1 if there is no such function.
+  int getIndex(const std::string &Name) const;
+  /// Return the name of a function.
+  const std::string &getName(unsigned F) const { return Nodes[F].Name; }
+
+  /// Return the functions that F calls, each once, in order of first call.
+  const std::vector<unsigned> &getCallees(unsigned F) const {
+    return Nodes[F].Callees;
+  }
+  /// Return the functions that call F, each once.
+  const std::vector<unsigned> &getCallers(unsigned F) const {
+    return Nodes[F].Callers;
+  }
+
+  /// Return if F calls no function.
+  bool isLeaf(unsigned F) const { return Nodes[F].Callees.empty(); }
+  /// Return if F may call itself, directly or not.
+  bool isRecursive(unsigned F) const { return Nodes[F].Recursive; }
+  /// Return if F may be called when the program runs.
+  bool isReachable(unsigned F) const { return Nodes[F].Reachable; }
+
+  /// Return the index of the SCC of F in getSCCs().
+  unsigned getSCC(unsigned F) const { return Nodes[F].SCC; }
+  /// Return the SCCs in bottom-up order.
+  const std::vector<std::vector<unsigned>> &getSCCs() const { return SCCs; }
+  /// Return all functions in bottom-up order, i.e., the SCCs flattened.
+  std::vector<unsigned> getBottomUpOrder() const;
+
+  void Format(std::ostream &O) const;
+
+private:
+  struct Node {
+    std::string Name;
+    std::vector<unsigned> Callees;
+    std::vector<unsigned> Callers;
+    unsigned SCC = 0;
+    bool Recursive = false;
+    bool Reachable = false;
+  };
+
+  std::vector<Node> Nodes;
+  std::unordered_map<std::string, unsigned> Indices;
+  std::vector<std::vector<unsigned>> SCCs;
+
+  void clear();
+};
+
+DEFINE_INLINE_OUTPUT_OPERATOR(CallGraph)
+} // namespace simplecc
+#endif // SIMPLECC_CODEGEN_CALLGRAPH_H
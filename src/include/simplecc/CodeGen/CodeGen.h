@@ -24,14 +24,31 @@
 #ifndef SIMPLECC_CODEGEN_CODEGEN_H
 #define SIMPLECC_CODEGEN_CODEGEN_H
 #include <iostream>
+#include <string>
 
 namespace simplecc {
 class ProgramAST;
 class SymbolTable;
 class ByteCodeModule;
+class EncodedModule;
+class RegisterModule;
 
 /// PrintByteCode
 void PrintByteCode(ProgramAST *P, std::ostream &O);
 void CompileToByteCode(ProgramAST *P, const SymbolTable &S, ByteCodeModule &M);
+/// Clean up the jumps of each function of M.
+void SimplifyByteCodeCFG(ByteCodeModule &M);
+/// Check that the byte code of M is well-formed. Return true if it is not.
+bool VerifyByteCode(const ByteCodeModule &M);
+/// Lower M into the dense stream of bytes an interpreter runs. Without
+/// SuperInstructions, each ByteCode is encoded as one instruction.
+void EncodeByteCode(const ByteCodeModule &M, EncodedModule &EM,
+                    bool SuperInstructions = true);
+/// Translate M into the instructions of a register machine.
+void TranslateToRegisterByteCode(const ByteCodeModule &M, RegisterModule &RM);
+/// Write EM to O as a .c0bc file.
+void WriteByteCodeFile(const EncodedModule &EM, std::ostream &O);
+/// Read the .c0bc file named Filename into EM. Return true on errors.
+bool ReadByteCodeFile(const std::string &Filename, EncodedModule &EM);
 } // namespace simplecc
 #endif // SIMPLECC_CODEGEN_CODEGEN_H
\ No newline at end of file
@@ -0,0 +1,243 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef SIMPLECC_CODEGEN_ENCODEDMODULE_H
+#define SIMPLECC_CODEGEN_ENCODEDMODULE_H
+#include "simplecc/CodeGen/SuperInstruction.h"
+#include "simplecc/Support/Macros.h"
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace simplecc {
+class ByteCodeEncoder;
+class ByteCodeFileImage;
+
+/// @brief EncodedFunction is a ByteCodeFunction lowered to a dense stream of
+/// bytes, the form an interpreter or a JIT consumes.
+///
+/// Each instruction is a one-byte Opcode followed by its immediates. An
+/// immediate is a variable-width integer of 7 bits per byte, the high bit of
+/// which tells whether more bytes follow. Names are resolved: a local is the
+/// index of its slot in the frame, a global is its address among the
+/// globals, a callee is its index in the EncodedModule. A jump target is the
+/// offset in bytes of an instruction. The source line of each instruction,
+/// with the function whose source it is in, which differs from this one for
+/// inlined code, is kept apart in a table, which is only searched to report
+/// an error.
+///
+/// Besides the Opcode of ByteCode, an instruction may be a SuperInstruction,
+/// which runs a sequence of ByteCode's at the cost of one dispatch.
+///
+/// The frame of a function is a sequence of words: the arguments come first,
+/// in the order they are passed, then the local variables and temporaries,
+/// one word for a variable and one per element for an array.
+class EncodedFunction {
+public:
+  /// The Opcode of ByteCode, plus one that pushes the address of a local
+  /// array, which ByteCode loads by LOAD_LOCAL, plus the SuperInstruction's.
+  /// The address of a global array is known and pushed by LOAD_CONST.
+  enum Opcode : uint8_t {
+#define HANDLE_OPCODE(opcode, camelName) opcode,
+#include "simplecc/CodeGen/Opcode.def"
+    LOAD_LOCAL_ADDRESS,
+#define HANDLE_SUPER_INSTRUCTION(opcode, camelName) opcode,
+#include "simplecc/CodeGen/SuperInstruction.def"
+    NUM_OPCODES,
+  };
+
+  /// How an immediate is encoded.
+  enum ImmediateKind {
+    /// The end of the immediates.
+    NoImmediate,
+    /// An unsigned integer, such as a slot, an address or an index.
+    UnsignedImmediate,
+    /// A signed integer, zigzag-encoded so that small negatives stay short.
+    SignedImmediate,
+    /// The offset of the instruction a jump goes to, always the last one.
+    TargetImmediate,
+  };
+
+  /// The largest number of immediates of an instruction.
+  static constexpr unsigned MaxImmediates = 3;
+
+  /// Return the kinds of the immediates of Op in order, followed by
+  /// NoImmediate.
+  static const ImmediateKind *getImmediateKinds(Opcode Op);
+  /// Return the name of Op.
+  static const char *getOpcodeName(Opcode Op);
+  /// Return the Opcode that runs SI.
+  static Opcode getOpcode(const SuperInstruction &SI) {
+    return static_cast<Opcode>(LOAD_LOCAL_ADDRESS + 1 + SI.getOpcode());
+  }
+
+  /// Decode an unsigned immediate at PC and advance PC past it.
+  static unsigned DecodeUnsigned(const uint8_t *&PC) {
+    unsigned Val = *PC++;
+#if defined(__GNUC__)
+    if (__builtin_expect(Val < 0x80, 1))
+#else
+    if (Val < 0x80)
+#endif
+      return Val;
+    Val &= 0x7f;
+    unsigned Shift = 7;
+    uint8_t Byte;
+    do {
+      Byte = *PC++;
+      Val |= static_cast<unsigned>(Byte & 0x7f) << Shift;
+      Shift += 7;
+    } while (Byte & 0x80);
+    return Val;
+  }
+
+  /// Decode a signed immediate at PC and advance PC past it.
+  static int DecodeSigned(const uint8_t *&PC) {
+    unsigned Val = DecodeUnsigned(PC);
+    return static_cast<int>((Val >> 1) ^ (0u - (Val & 1)));
+  }
+
+  /// Append Val to Code as an unsigned immediate.
+  static void EncodeUnsigned(std::vector<uint8_t> &Code, unsigned Val);
+  /// Append Val to Code as a signed immediate.
+  static void EncodeSigned(std::vector<uint8_t> &Code, int Val);
+  /// Return the number of bytes Val takes as an unsigned immediate.
+  static unsigned getUnsignedSize(unsigned Val);
+
+  /// Return the name of the function.
+  const std::string &getName() const { return Name; }
+  /// Return the encoded instructions.
+  const std::vector<uint8_t> &getCode() const { return Code; }
+  /// Return the number of arguments.
+  unsigned getArgumentCount() const { return NumArguments; }
+  /// Return the number of words of the frame.
+  unsigned getFrameSize() const { return FrameSize; }
+  /// Return the deepest the operand stack gets, as EncodedVerifier finds it.
+  unsigned getMaxStackDepth() const { return MaxStackDepth; }
+
+  /// Return the source line of the instruction at Offset.
+  unsigned getSourceLineno(unsigned Offset) const;
+  /// Return the index of the function whose source line the instruction at
+  /// Offset is on, or -1 if the line is not known.
+  int getSourceFunction(unsigned Offset) const;
+
+  /// Format the instructions one per line, with their bytes.
+  void Format(std::ostream &O) const;
+
+private:
+  friend class ByteCodeEncoder;
+  friend class ByteCodeFileReader;
+  friend class ByteCodeFileWriter;
+
+  /// The line of the instructions from Offset up to the next entry, and
+  /// the index of the function it is in.
+  struct LineEntry {
+    unsigned Offset;
+    unsigned Lineno;
+    unsigned Function;
+  };
+
+  /// Return the entry of the instruction at Offset, or nullptr.
+  const LineEntry *findLineEntry(unsigned Offset) const;
+
+  std::string Name;
+  std::vector<uint8_t> Code;
+  std::vector<LineEntry> LineTable;
+  unsigned NumArguments = 0;
+  unsigned FrameSize = 0;
+  unsigned MaxStackDepth = 0;
+};
+
+DEFINE_INLINE_OUTPUT_OPERATOR(EncodedFunction)
+
+/// @brief EncodedModule is a ByteCodeModule lowered to EncodedFunction's.
+/// The globals take the first words of memory, in the order of declaration,
+/// and are referred to by address. String literals are referred to by the
+/// IDs the ByteCodeModule gave them.
+///
+/// An EncodedModule read from a .c0bc file decodes each function from the
+/// file when it is first asked for.
+class EncodedModule {
+public:
+  using FunctionListTy = std::vector<EncodedFunction>;
+
+  /// The most words the globals, or a frame with its operand stack, may
+  /// take, so that the offset in bytes of each word fits in an int.
+  static constexpr unsigned MaxWords = 1u << 28;
+
+  EncodedModule() = default;
+  ~EncodedModule() = default;
+
+  /// Return the function at index F.
+  const EncodedFunction &getFunction(unsigned F) const {
+    if (!IsDecoded[F])
+      decodeFunction(F);
+    return Functions[F];
+  }
+  /// Return the index of a function, or -1 if there is no such function.
+  int getFunctionIndex(const std::string &Name) const;
+  /// Return the name of the function at index F without decoding it.
+  const std::string &getFunctionName(unsigned F) const {
+    return Functions[F].getName();
+  }
+  /// Return the number of functions.
+  size_t size() const { return Functions.size(); }
+
+  /// Return the text of each string literal, without the quotes, by ID.
+  const std::vector<std::string> &getStringLiterals() const {
+    return StringLiterals;
+  }
+  /// Return the number of words taken by the globals.
+  unsigned getGlobalsSize() const { return GlobalsSize; }
+
+  void Format(std::ostream &O) const;
+
+private:
+  friend class ByteCodeEncoder;
+  friend class ByteCodeFileReader;
+
+  /// Decode the function at index F from File.
+  void decodeFunction(unsigned F) const;
+
+  mutable FunctionListTy Functions;
+  /// Whether each function is decoded. Only the name of one that is not is
+  /// known.
+  mutable std::vector<bool> IsDecoded;
+  std::unordered_map<std::string, unsigned> FunctionIndices;
+  std::vector<std::string> StringLiterals;
+  unsigned GlobalsSize = 0;
+
+  /// The file the functions are decoded from, if any.
+  std::shared_ptr<const ByteCodeFileImage> File;
+  /// The offset and size of the body of each function in File.
+  std::vector<std::pair<size_t, size_t>> Bodies;
+};
+
+DEFINE_INLINE_OUTPUT_OPERATOR(EncodedModule)
+
+} // namespace simplecc
+#endif // SIMPLECC_CODEGEN_ENCODEDMODULE_H
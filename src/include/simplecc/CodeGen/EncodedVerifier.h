@@ -0,0 +1,120 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef SIMPLECC_CODEGEN_ENCODEDVERIFIER_H
+#define SIMPLECC_CODEGEN_ENCODEDVERIFIER_H
+#include "simplecc/CodeGen/EncodedModule.h"
+#include "simplecc/Support/ErrorManager.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace simplecc {
+
+/// @brief EncodedVerifier checks that the code of an EncodedFunction can be
+/// run as it is, such as the code read from a .c0bc file.
+///
+/// The code must decode into whole instructions of known Opcode's, whose
+/// immediates refer to what exists: a local to a slot of the frame, a
+/// global to an address among the globals, a callee to a function of the
+/// module, a string to a literal and a jump to the start of an instruction.
+/// Then the operand stack is followed along every path: it never
+/// underflows, it has the same depth and holds strings at the same places
+/// wherever control flow merges, only PRINT_STRING takes a string, and
+/// control never falls off the end.
+///
+/// An interpreter of a function that passes need not check its operand
+/// stack at each instruction. It only checks, when the function is called,
+/// that the frame and getMaxStackDepth() words fit in its memory.
+class EncodedVerifier {
+public:
+  /// Verify code that calls the functions of Functions, of which only the
+  /// number of arguments is used, and refers to GlobalsSize words of
+  /// globals and NumStrings string literals.
+  EncodedVerifier(const EncodedModule::FunctionListTy &Functions,
+                  unsigned GlobalsSize, unsigned NumStrings,
+                  const char *ErrorType = "InternalError")
+      : Functions(Functions), GlobalsSize(GlobalsSize),
+        NumStrings(NumStrings), EM(ErrorType) {}
+  ~EncodedVerifier() = default;
+
+  /// Name the file the code is read from in the errors.
+  void setFilename(std::string Name) { Filename = std::move(Name); }
+
+  /// Check the Size bytes of code at Code as the code of the function at
+  /// index F. Return true if it is malformed, which has been reported.
+  bool Check(unsigned F, const uint8_t *Code, size_t Size);
+
+  /// Return the deepest the operand stack of the last function checked gets.
+  unsigned getMaxStackDepth() const { return MaxStackDepth; }
+
+private:
+  using Opcode = EncodedFunction::Opcode;
+
+  /// An instruction and its immediates, as unsigned integers.
+  struct Instruction {
+    Opcode Op;
+    unsigned Offset;
+    unsigned Immediates[EncodedFunction::MaxImmediates];
+  };
+  /// Whether each value on the operand stack is a string.
+  using StackTy = std::vector<bool>;
+
+  /// Report an error at the instruction at Offset.
+  template <typename... Args> void Error(unsigned Offset, Args &&... args);
+  /// Decode the instructions into Insts. Return false on errors.
+  bool decode(const uint8_t *Code, size_t Size);
+  /// Check the immediates of I other than its target.
+  bool checkImmediates(const Instruction &I);
+  /// Return the number of values I pops.
+  unsigned getPopCount(const Instruction &I) const;
+  /// Return whether Op pushes a value.
+  static bool IsPush(Opcode Op);
+  /// Run the instructions on the abstract stack. Return false on errors.
+  bool verifyStack();
+  /// Merge Stack into the entry of the instruction at index To. Queue it if
+  /// it is reached for the first time. Return false on errors.
+  bool mergeInto(unsigned To);
+
+  const EncodedModule::FunctionListTy &Functions;
+  unsigned GlobalsSize;
+  unsigned NumStrings;
+  /// The file of the code, or empty if it was not read from one.
+  std::string Filename;
+
+  const EncodedFunction *TheFunction = nullptr;
+  std::vector<Instruction> Insts;
+  /// The index of the instruction at each offset, or -1 in the middle of one.
+  std::vector<int> IndexAt;
+  /// Whether each instruction is the target of a jump.
+  std::vector<bool> IsTarget;
+  /// The stack at the entry of each instruction that is a jump target.
+  std::vector<StackTy> EntryStacks;
+  std::vector<bool> Reached;
+  std::vector<unsigned> Worklist;
+  StackTy Stack;
+  unsigned MaxStackDepth = 0;
+  ErrorManager EM;
+};
+} // namespace simplecc
+#endif // SIMPLECC_CODEGEN_ENCODEDVERIFIER_H
@@ -0,0 +1,130 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef SIMPLECC_CODEGEN_REGISTERBYTECODE_H
+#define SIMPLECC_CODEGEN_REGISTERBYTECODE_H
+#include "simplecc/Support/Macros.h"
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace simplecc {
+class RegisterByteCodeTranslator;
+
+/// @brief RegisterInstruction is an instruction of a register machine. It
+/// names where its operands are and where its result goes, instead of
+/// popping and pushing them, so that `a = b + c` is a single instruction
+/// rather than four ByteCode's.
+///
+/// The registers of a function are the words of its frame: the arguments,
+/// the local variables and temporaries, then the values the ByteCode's kept
+/// on the operand stack, one register per depth.
+struct RegisterInstruction {
+  enum Opcode : uint8_t {
+#define HANDLE_REGISTER_OPCODE(Opcode, Operands) Opcode,
+#include "simplecc/CodeGen/RegisterOpcode.def"
+    NUM_OPCODES,
+  };
+
+  /// Return the name of Op.
+  static const char *getOpcodeName(Opcode Op);
+  /// Return the kinds of the operands of Op, as in RegisterOpcode.def.
+  static const char *getOperandKinds(Opcode Op);
+
+  Opcode Op;
+  /// The source line.
+  unsigned Lineno;
+  /// The index of the function the source line is in.
+  unsigned Function;
+  /// The operands in order. A jump target is the index of an instruction.
+  int A, B, C;
+};
+
+/// @brief RegisterFunction is a ByteCodeFunction translated to
+/// RegisterInstruction's.
+class RegisterFunction {
+public:
+  using InstructionListTy = std::vector<RegisterInstruction>;
+
+  const std::string &getName() const { return Name; }
+  const InstructionListTy &getInstructions() const { return Instructions; }
+  /// Return the number of arguments, which are the first registers.
+  unsigned getArgumentCount() const { return NumArguments; }
+  /// Return the number of registers, the words of the frame.
+  unsigned getRegisterCount() const { return NumRegisters; }
+
+  /// Format the instructions one per line.
+  void Format(std::ostream &O) const;
+
+private:
+  friend class RegisterByteCodeTranslator;
+
+  std::string Name;
+  InstructionListTy Instructions;
+  unsigned NumArguments = 0;
+  unsigned NumRegisters = 0;
+};
+
+DEFINE_INLINE_OUTPUT_OPERATOR(RegisterFunction)
+
+/// @brief RegisterModule is a ByteCodeModule translated to
+/// RegisterFunction's. Like EncodedModule, the globals take the first words
+/// of memory and a callee is referred to by its index.
+class RegisterModule {
+public:
+  using FunctionListTy = std::vector<RegisterFunction>;
+
+  RegisterModule() = default;
+  ~RegisterModule() = default;
+
+  const RegisterFunction &getFunction(unsigned F) const {
+    return Functions[F];
+  }
+  /// Return the index of a function, or -1 if there is no such function.
+  int getFunctionIndex(const std::string &Name) const;
+  size_t size() const { return Functions.size(); }
+
+  /// Return the text of each string literal, without the quotes, by ID.
+  const std::vector<std::string> &getStringLiterals() const {
+    return StringLiterals;
+  }
+  /// Return the number of words taken by the globals.
+  unsigned getGlobalsSize() const { return GlobalsSize; }
+
+  void Format(std::ostream &O) const;
+
+private:
+  friend class RegisterByteCodeTranslator;
+
+  FunctionListTy Functions;
+  std::unordered_map<std::string, unsigned> FunctionIndices;
+  std::vector<std::string> StringLiterals;
+  unsigned GlobalsSize = 0;
+};
+
+DEFINE_INLINE_OUTPUT_OPERATOR(RegisterModule)
+
+} // namespace simplecc
+#endif // SIMPLECC_CODEGEN_REGISTERBYTECODE_H
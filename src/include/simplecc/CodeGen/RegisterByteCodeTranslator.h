@@ -0,0 +1,116 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef SIMPLECC_CODEGEN_REGISTERBYTECODETRANSLATOR_H
+#define SIMPLECC_CODEGEN_REGISTERBYTECODETRANSLATOR_H
+#include "simplecc/CodeGen/ByteCode.h"
+#include "simplecc/CodeGen/RegisterByteCode.h"
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace simplecc {
+class ByteCodeFunction;
+class ByteCodeModule;
+
+/// @brief RegisterByteCodeTranslator translates a ByteCodeModule into a
+/// RegisterModule.
+///
+/// It runs the ByteCode's of a block on an abstract operand stack. A push of
+/// a local variable or a constant is not an instruction but an entry that
+/// names the local or holds the constant, which the instruction popping it
+/// then uses as its operand. A value that must be in a register, such as an
+/// argument of a call or one live at the end of the block, is moved to the
+/// register of its depth. A result stored to a local right after it is
+/// computed is computed into the local instead.
+class RegisterByteCodeTranslator {
+public:
+  RegisterByteCodeTranslator() = default;
+  ~RegisterByteCodeTranslator() = default;
+
+  /// Translate M into RM, replacing what it held.
+  void Translate(const ByteCodeModule &M, RegisterModule &RM);
+
+private:
+  /// What an entry of the abstract operand stack holds.
+  struct Operand {
+    enum KindTy { Register, Immediate, LocalAddress };
+    KindTy Kind;
+    int Value;
+  };
+
+  void TranslateFunction(const ByteCodeFunction &F, RegisterFunction &RF);
+  /// Compute the depth of the operand stack before each ByteCode of F and
+  /// which ones are jump targets.
+  void computeDepths(const ByteCodeFunction &F);
+  void translate(const ByteCode &C);
+
+  void emit(RegisterInstruction::Opcode Op, int A = 0, int B = 0, int C = 0);
+  /// Emit an instruction that only writes the register of the depth of the
+  /// entry it pushes.
+  void emitPush(RegisterInstruction::Opcode Op, int B = 0, int C = 0);
+  /// Return the register of the stack entry at Depth.
+  unsigned getStackRegister(unsigned Depth) const {
+    return NumSlots + Depth;
+  }
+  /// Return a register holding the stack entry at Depth, moving it to the
+  /// register of its depth if needed.
+  unsigned getRegister(unsigned Depth);
+  /// Move the stack entry at Depth to the register of its depth.
+  void materialize(unsigned Depth);
+  /// Move every stack entry to the register of its depth.
+  void materializeAll();
+  /// Move the stack entries that read the register R to the registers of
+  /// their depths, before R is written.
+  void materializeUsesOf(unsigned R);
+  /// Write the value of the stack entry at Depth to the register R.
+  void storeTo(unsigned R, unsigned Depth);
+  Operand pop() {
+    Operand Top = Stack.back();
+    Stack.pop_back();
+    return Top;
+  }
+
+  /// A location, the size of the array it holds, or 0 for a variable.
+  using SlotTy = std::pair<unsigned, unsigned>;
+  std::unordered_map<std::string, SlotTy> Globals;
+  std::unordered_map<std::string, SlotTy> Locals;
+  const RegisterModule *TheModule = nullptr;
+  unsigned GlobalsSize = 0;
+
+  /// The state of the function being translated.
+  RegisterFunction *TheFunction = nullptr;
+  unsigned NumSlots = 0;
+  /// The size of the array at each slot, or 0.
+  std::vector<unsigned> ArraySizes;
+  std::vector<unsigned> Depths;
+  std::vector<bool> IsJumpTarget;
+  std::vector<Operand> Stack;
+  unsigned Lineno = 0;
+  unsigned SourceFunction = 0;
+  /// The index of the last instruction if it was emitted by emitPush.
+  int LastPush = -1;
+};
+} // namespace simplecc
+#endif // SIMPLECC_CODEGEN_REGISTERBYTECODETRANSLATOR_H
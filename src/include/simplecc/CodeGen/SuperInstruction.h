@@ -0,0 +1,105 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef SIMPLECC_CODEGEN_SUPERINSTRUCTION_H
+#define SIMPLECC_CODEGEN_SUPERINSTRUCTION_H
+#include "simplecc/CodeGen/ByteCode.h"
+#include <vector>
+
+namespace simplecc {
+class ByteCodeFunction;
+
+/// @brief SuperInstruction is a sequence of ByteCode's that a backend runs as
+/// one instruction, which saves the pushes and pops between them.
+/// The sequences are listed in SuperInstruction.def.
+class SuperInstruction {
+public:
+  enum Opcode : unsigned {
+#define HANDLE_SUPER_INSTRUCTION(opcode, camelName) opcode,
+#include "simplecc/CodeGen/SuperInstruction.def"
+  };
+
+  /// Return the name of Op.
+  static const char *getOpcodeName(Opcode Op);
+  /// Return if Op jumps after comparing a local with a constant.
+  static bool IsCompareLocalConst(Opcode Op);
+  /// Return if Op jumps after comparing two locals.
+  static bool IsCompareLocals(Opcode Op);
+  /// Return the JUMP_IF_* that Op ends with, if it compares and jumps.
+  static ByteCode::Opcode getJump(Opcode Op);
+
+  SuperInstruction(Opcode Op, unsigned Length) : Op(Op), Length(Length) {}
+
+  /// Return the Opcode.
+  Opcode getOpcode() const { return Op; }
+  /// Return the name of the Opcode.
+  const char *getOpcodeName() const { return getOpcodeName(Op); }
+  /// Return the number of ByteCode's this runs.
+  unsigned getLength() const { return Length; }
+
+  /// The local that is loaded first or stored.
+  const char *Local = nullptr;
+  /// The local loaded second, or loaded by MOVE_LOCAL.
+  const char *Source = nullptr;
+  /// The constant, negated if it is subtracted.
+  int Constant = 0;
+  /// The ByteCode offset a compare jumps to.
+  unsigned Target = 0;
+
+private:
+  Opcode Op;
+  unsigned Length;
+};
+
+/// @brief SuperInstructionSelector picks the sequences of a ByteCodeFunction
+/// that run as SuperInstruction's.
+///
+/// It scans the ByteCode's once from the start and takes the longest match at
+/// each one. A sequence is taken only if no jump lands inside it, so that a
+/// backend can emit a label before a SuperInstruction as it does before a
+/// ByteCode. The locals in a sequence must be variables, not arrays.
+class SuperInstructionSelector {
+public:
+  SuperInstructionSelector() = default;
+  ~SuperInstructionSelector() = default;
+
+  /// Select the SuperInstruction's of F, dropping those selected before.
+  void Select(const ByteCodeFunction &F);
+
+  /// Return the SuperInstruction starting at the ByteCode at Offset, or
+  /// nullptr if none does.
+  const SuperInstruction *getSuperInstructionAt(unsigned Offset) const {
+    int Idx = Offset < Starts.size() ? Starts[Offset] : -1;
+    return Idx < 0 ? nullptr : &Selected[Idx];
+  }
+
+  /// Return the SuperInstruction's in order.
+  const std::vector<SuperInstruction> &getSelected() const { return Selected; }
+
+private:
+  std::vector<SuperInstruction> Selected;
+  /// The index into Selected of the SuperInstruction at each offset, or -1.
+  std::vector<int> Starts;
+};
+} // namespace simplecc
+#endif // SIMPLECC_CODEGEN_SUPERINSTRUCTION_H
@@ -35,8 +35,14 @@ class Driver : public DriverBase {
   void runDumpSymbolTable();
 #define HANDLE_COMMAND(Name, Arg, Description) void run##Name();
 #include "simplecc/Driver/Driver.def"
+  /// Whether --check-server tells how much it parsed again.
+  bool PrintCheckServerStats = false;
 #if SIMPLE_COMPILER_USE_LLVM
   std::unique_ptr<llvm::raw_ostream> getLLVMRawOstream();
+
+  /// Where --run caches the object code, and whether it tells if it hit.
+  std::string JITCacheDir;
+  bool PrintJITCacheStats = false;
 #endif
 
 public:
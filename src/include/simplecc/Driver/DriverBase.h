@@ -24,6 +24,7 @@
 #define SIMPLECC_DRIVER_DRIVERBASE_H
 #include "simplecc/Analysis/AnalysisManager.h"
 #include "simplecc/CodeGen/ByteCodeModule.h"
+#include "simplecc/IR/IR.h"
 #include "simplecc/Lex/TokenInfo.h"
 #include "simplecc/Support/ErrorManager.h"
 #include "simplecc/Parse/Parse.h"
@@ -38,7 +39,8 @@ namespace simplecc {
 class DriverBase {
 protected:
   /// Return a ptr to the output stream. Nullptr on failure.
-  std::ostream *getStdOstream();
+  /// Pass std::ios::binary in Mode to write bytes other than text.
+  std::ostream *getStdOstream(std::ios::openmode Mode = std::ios::out);
   /// Return a ptr to the input stream. Nullptr on failure.
   std::istream *getStdIstream();
 
@@ -48,6 +50,7 @@ protected:
   bool doAnalyses();
   void doTransform();
   void doCodeGen();
+  bool doOptimize();
   void doAssemble(std::ostream &OS);
 
   /// High level interfaces, each of which run all its dependencies and
@@ -57,6 +60,7 @@ protected:
   bool runAnalyses();
   bool runTransform();
   bool runCodeGen();
+  bool runOptimize();
   bool runAssemble();
 
   const std::vector<TokenInfo> &getTokens() const { return TheTokens; }
@@ -71,6 +75,12 @@ public:
   void setOutputFile(std::string Filename) { OutputFile = std::move(Filename); }
   std::string getInputFile() const { return InputFile; }
   std::string getOutputFile() const { return OutputFile; }
+  void setOptimizationOptions(const OptimizationOptions &Options) {
+    OptOptions = Options;
+  }
+  const OptimizationOptions &getOptimizationOptions() const {
+    return OptOptions;
+  }
 
   void clear();
   int status() const { return !EM.IsOk(); }
@@ -78,6 +88,7 @@ public:
 private:
   std::string InputFile;
   std::string OutputFile;
+  OptimizationOptions OptOptions;
   std::ifstream StdIFStream;
   std::ofstream StdOFStream;
 
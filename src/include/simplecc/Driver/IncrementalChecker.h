@@ -0,0 +1,124 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef SIMPLECC_DRIVER_INCREMENTALCHECKER_H
+#define SIMPLECC_DRIVER_INCREMENTALCHECKER_H
+#include "simplecc/AST/AST.h"
+#include "simplecc/Analysis/SymbolTable.h"
+#include "simplecc/Lex/TokenInfo.h"
+#include "simplecc/Support/Diagnostics.h"
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace simplecc {
+
+/// @brief IncrementalChecker remembers the last version of a file it checked and
+/// re-checks an edited version doing as little work as possible.
+///
+/// The token stream is cut into units, each being a top-level const_decl or
+/// declaration. Diffing the new stream against the old one by common prefix and
+/// suffix tells which units changed. Tokens are compared by kind and text, and
+/// the suffix may have moved by some lines as a whole, so inserting or deleting
+/// lines leaves the units below unchanged; their ASTs and cached diagnostics
+/// are moved along. If only the bodies of some functions changed, these
+/// functions are parsed again alone and only they run through
+/// SymbolTableBuilder, TypeChecker and the other analyses, while the cached
+/// diagnostics of the others are reused. Any other change (to a global
+/// declaration or a function signature, adding or removing a unit) invalidates
+/// everything and the whole file is checked again.
+///
+/// Diagnostics are printed exactly as a full check would print them.
+class IncrementalChecker {
+  /// The analyses that are run unit by unit, in the order of AnalysisManager.
+  enum PhaseKind { NamePhase, TypePhase, ArrayBoundPhase, VerifyPhase,
+                   NumPhases };
+
+  /// The cached result of running a phase on a unit.
+  struct PhaseResult {
+    bool Done = false;
+    bool Failed = false;
+    std::vector<Diagnostic> Diagnostics;
+  };
+
+  /// A top-level const_decl or declaration.
+  struct Unit {
+    /// Token range in TheTokens.
+    unsigned TokenBegin;
+    unsigned TokenEnd;
+    /// Range of the DeclASTs of this unit in the ProgramAST.
+    unsigned DeclBegin;
+    unsigned DeclEnd;
+    PhaseResult Results[NumPhases];
+
+    bool IsFuncDef(const std::vector<TokenInfo> &Tokens) const;
+    /// Return the name of the function of this unit.
+    const std::string &getFuncName(const std::vector<TokenInfo> &Tokens) const;
+    /// Return if any of the names appears in this unit.
+    bool References(const std::vector<TokenInfo> &Tokens,
+                    const std::unordered_set<std::string> &Names) const;
+  };
+
+  /// Parse the changed functions again and enter them into the program,
+  /// reusing everything else from the last check.
+  /// Return false if it is impossible, leaving the last check untouched.
+  bool IncrementalParse(std::vector<TokenInfo> &NewTokens,
+                        std::vector<std::pair<unsigned, unsigned>> &NewUnits);
+  /// Run analyses on all units and print diagnostics of the first failing one.
+  bool RunAnalyses();
+  /// Run a phase on a unit and cache its result.
+  void RunPhase(PhaseKind Phase, Unit &U);
+  /// Move the ASTs and cached diagnostics of a unit by some lines.
+  void ShiftLines(Unit &U, int LineDelta);
+
+public:
+  IncrementalChecker() = default;
+  IncrementalChecker(const IncrementalChecker &) = delete;
+  ~IncrementalChecker() = default;
+
+  /// Check the program read from IS, printing diagnostics to std::cerr.
+  /// It is taken as an edit of the program checked last, whatever its file.
+  /// Return true if errors happened.
+  bool Check(std::istream &IS, const std::string &Filename);
+
+  /// Return the number of functions parsed again by the last Check(),
+  /// or -1 if it checked the whole file.
+  int getNumReparsed() const { return NumReparsed; }
+
+  /// Forget the last check.
+  void clear();
+
+private:
+  std::string Filename;
+  std::vector<TokenInfo> TheTokens;
+  std::vector<Unit> Units;
+  std::unique_ptr<ProgramAST, DeleteAST> TheProgram;
+  SymbolTable TheTable;
+  /// Whether TheTable has been built for all units.
+  bool TableBuilt = false;
+  int NumReparsed = -1;
+};
+} // namespace simplecc
+#endif // SIMPLECC_DRIVER_INCREMENTALCHECKER_H
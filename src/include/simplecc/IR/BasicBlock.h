@@ -0,0 +1,138 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef SIMPLECC_IR_BASICBLOCK_H
+#define SIMPLECC_IR_BASICBLOCK_H
+#include "simplecc/IR/Instruction.h"
+#include "simplecc/Support/Macros.h"
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+namespace simplecc {
+class IRFunction;
+
+/// @brief BasicBlock is a straight-line sequence of Instructions that ends
+/// with exactly one terminator. Phis come first. The Instructions form an
+/// intrusive list so that passes can insert and erase them in constant time.
+/// The predecessors are kept up to date as terminators are inserted into and
+/// removed from blocks.
+class BasicBlock {
+public:
+  /// Forward iterator over the Instructions.
+  template <typename InstTy> class InstIterator {
+    InstTy *Cur;
+
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = InstTy;
+    using difference_type = std::ptrdiff_t;
+    using pointer = InstTy *;
+    using reference = InstTy &;
+
+    explicit InstIterator(InstTy *I = nullptr) : Cur(I) {}
+    reference operator*() const { return *Cur; }
+    pointer operator->() const { return Cur; }
+    InstIterator &operator++() {
+      Cur = Cur->getNext();
+      return *this;
+    }
+    InstIterator operator++(int) {
+      InstIterator Tmp(*this);
+      ++*this;
+      return Tmp;
+    }
+    bool operator==(const InstIterator &RHS) const { return Cur == RHS.Cur; }
+    bool operator!=(const InstIterator &RHS) const { return Cur != RHS.Cur; }
+  };
+
+  using iterator = InstIterator<Instruction>;
+  using const_iterator = InstIterator<const Instruction>;
+  using BlockListTy = std::vector<BasicBlock *>;
+
+  /// Create an empty block. Use IRFunction::createBlock() instead.
+  explicit BasicBlock(IRFunction *F) : Parent(F) {}
+  BasicBlock(const BasicBlock &) = delete;
+  BasicBlock &operator=(const BasicBlock &) = delete;
+  /// Delete all the Instructions, which must not be used outside this block.
+  ~BasicBlock();
+
+  IRFunction *getParent() const { return Parent; }
+
+  iterator begin() { return iterator(First); }
+  iterator end() { return iterator(); }
+  const_iterator begin() const { return const_iterator(First); }
+  const_iterator end() const { return const_iterator(); }
+  bool empty() const { return First == nullptr; }
+  unsigned size() const;
+  Instruction *getFirst() const { return First; }
+  Instruction *getLast() const { return Last; }
+
+  /// Return the terminator, or nullptr if the block is not terminated yet.
+  Instruction *getTerminator() const {
+    return Last && Last->isTerminator() ? Last : nullptr;
+  }
+  /// Return the first Instruction that is not a Phi.
+  Instruction *getFirstNonPhi() const;
+
+  /// Insert I at the end.
+  void push_back(Instruction *I) { insert(nullptr, I); }
+  /// Insert I before Pos, or at the end if Pos is nullptr.
+  void insert(Instruction *Pos, Instruction *I);
+  /// Unlink I without deleting it.
+  Instruction *remove(Instruction *I);
+  /// Unlink I and delete it. It must have no users.
+  void erase(Instruction *I);
+
+  const BlockListTy &getPredecessors() const { return Predecessors; }
+  unsigned getNumPredecessors() const { return Predecessors.size(); }
+  /// Return the only predecessor, or nullptr.
+  BasicBlock *getSinglePredecessor() const {
+    return Predecessors.size() == 1 ? Predecessors[0] : nullptr;
+  }
+  /// Return the successors in the order of the terminator.
+  BlockListTy getSuccessors() const;
+
+  /// Remove the incoming entries for Pred from every Phi in this block. Call
+  /// this before removing an edge from Pred.
+  void removePhiEntriesFor(BasicBlock *Pred);
+  /// Make every Phi in this block take the entries of From as coming from To.
+  void replacePhiUsesWith(BasicBlock *From, BasicBlock *To);
+
+  void Format(std::ostream &O) const;
+
+private:
+  friend class Instruction;
+  /// Maintain the predecessors of the successors of a terminator.
+  void addPredecessor(BasicBlock *B) { Predecessors.push_back(B); }
+  void removePredecessor(BasicBlock *B);
+
+  IRFunction *Parent;
+  Instruction *First = nullptr;
+  Instruction *Last = nullptr;
+  BlockListTy Predecessors;
+};
+
+DEFINE_INLINE_OUTPUT_OPERATOR(BasicBlock)
+
+} // namespace simplecc
+#endif // SIMPLECC_IR_BASICBLOCK_H
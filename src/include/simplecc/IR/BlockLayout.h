@@ -0,0 +1,55 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef SIMPLECC_IR_BLOCKLAYOUT_H
+#define SIMPLECC_IR_BLOCKLAYOUT_H
+#include <cstdint>
+#include <map>
+
+namespace simplecc {
+class BasicBlock;
+class ExecutionProfile;
+class IRFunction;
+
+/// @brief BlockLayout moves the blocks a profiling run never reached after
+/// the others, so that the code that runs is laid out together and its
+/// branches fall through. A block is cold if the profile has the lines of
+/// its instructions and none of them ran. The entry block stays first, and
+/// the blocks keep their order otherwise.
+class BlockLayout {
+  bool isCold(const BasicBlock *BB) const;
+
+public:
+  explicit BlockLayout(const ExecutionProfile &Profile) : Profile(Profile) {}
+  ~BlockLayout() = default;
+
+  /// Run on F. Return true if F was changed.
+  bool Transform(IRFunction &F);
+
+private:
+  const ExecutionProfile &Profile;
+  /// The lines of the function being laid out and their counts.
+  const std::map<unsigned, uint64_t> *Lines = nullptr;
+};
+} // namespace simplecc
+#endif // SIMPLECC_IR_BLOCKLAYOUT_H
@@ -0,0 +1,116 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef SIMPLECC_IR_BYTECODELOWERING_H
+#define SIMPLECC_IR_BYTECODELOWERING_H
+#include "simplecc/CodeGen/ByteCodeBuilder.h"
+#include "simplecc/IR/IRModule.h"
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace simplecc {
+class ByteCodeModule;
+
+/// @brief ByteCodeLowering turns an IRModule back into stack ByteCode, so that
+/// the backends of ByteCode run on the optimized program.
+///
+/// An Instruction whose only use immediately follows it is left on the stack
+/// for its user. Every other value, phis included, lives in a temporary of the
+/// ByteCodeFunction. Phis become copies on the incoming edges: all the sources
+/// are pushed before any destination is stored, so that the copies happen in
+/// parallel. A phi shares its location with the operands that do not
+/// interfere with it, which removes their copies. A conditional branch to a
+/// block that needs copies goes through a stub at the end of the function.
+class ByteCodeLowering {
+  /// An edge that needs its own copies, and the jump that takes it.
+  struct EdgeStub {
+    BasicBlock *From;
+    BasicBlock *To;
+    unsigned Jump;
+  };
+
+  /// Erase the instructions without any uses or side effects.
+  void removeDeadCode(IRFunction &F);
+  /// Decide which instructions of BB stay on the stack.
+  void stackify(BasicBlock *BB);
+  /// Stackify the operands of U and return the first Instruction computed
+  /// for U.
+  Instruction *stackifyOperands(Instruction *U);
+  /// Give every other value a temporary, and each local array a name.
+  void assignTemporaries(IRFunction &F);
+
+  void lowerFunction(IRFunction &F, ByteCodeFunction &BF);
+  void emitBlock(BasicBlock *BB, BasicBlock *Next);
+  void emitTerminator(Instruction *I, BasicBlock *Next);
+  /// Emit I and store its value if any.
+  void emitInstruction(Instruction *I);
+  /// Emit I with its operands, leaving its value on the stack.
+  void emitComputation(Instruction *I);
+  /// Push the value of V, computing it if it is stackified.
+  void emitValue(Value *V);
+  /// Return whether the edge from From to To needs any copies.
+  bool needsCopies(BasicBlock *From, BasicBlock *To) const;
+  /// Emit the copies of the edge from From to To.
+  void emitPhiCopies(BasicBlock *From, BasicBlock *To);
+  /// Jump to Dest unless it is Next.
+  void emitJump(BasicBlock *Dest, BasicBlock *Next);
+  /// Give the ByteCode emitted next the source line of I.
+  void setLineno(const Instruction *I);
+  /// Record that the jump at Offset goes to Dest.
+  void addFixup(unsigned Offset, BasicBlock *Dest) {
+    Fixups.emplace_back(Offset, Dest);
+  }
+
+  const std::string &getName(Value *V) const { return *Names.at(V); }
+  /// Return whether V lives in the temporary of Phi.
+  bool isCoalesced(Value *V, Instruction *Phi) const {
+    auto Iter = Names.find(V);
+    return Iter != Names.end() && Iter->second == Names.at(Phi);
+  }
+
+public:
+  ByteCodeLowering() = default;
+  ~ByteCodeLowering() = default;
+
+  /// Replace the code of each function of BM with its counterpart in M.
+  /// M is consumed by the lowering.
+  void Lower(IRModule &M, ByteCodeModule &BM);
+
+private:
+  ByteCodeBuilder Builder;
+  ByteCodeFunction *TheFunction = nullptr;
+  /// Values computed on the stack right before their only user.
+  std::unordered_set<const Instruction *> Stackified;
+  /// Names of the temporaries, arguments, arrays and globals.
+  std::unordered_map<const Value *, const std::string *> Names;
+  /// Names of the functions in the ByteCodeModule.
+  std::unordered_map<const IRFunction *, const std::string *> FunctionNames;
+  /// Offsets of the blocks and the jumps to patch with them.
+  std::unordered_map<const BasicBlock *, unsigned> BlockOffsets;
+  std::vector<std::pair<unsigned, BasicBlock *>> Fixups;
+  std::vector<EdgeStub> Stubs;
+};
+} // namespace simplecc
+#endif // SIMPLECC_IR_BYTECODELOWERING_H
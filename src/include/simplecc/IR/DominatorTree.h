@@ -0,0 +1,107 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef SIMPLECC_IR_DOMINATORTREE_H
+#define SIMPLECC_IR_DOMINATORTREE_H
+#include "simplecc/Support/Macros.h"
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+namespace simplecc {
+class BasicBlock;
+class Instruction;
+class IRFunction;
+
+/// @brief DominatorTree computes the immediate dominators of the blocks
+/// reachable from the entry with the iterative algorithm of Cooper, Harvey and
+/// Kennedy, and numbers the tree so that dominance is a constant-time query.
+/// It must be recalculated after the CFG changes.
+class DominatorTree {
+public:
+  using BlockListTy = std::vector<BasicBlock *>;
+
+  DominatorTree() = default;
+  explicit DominatorTree(const IRFunction &F) { recalculate(F); }
+
+  /// Compute the tree for F.
+  void recalculate(const IRFunction &F);
+
+  /// Return whether BB is reachable from the entry.
+  bool isReachable(const BasicBlock *BB) const {
+    return RPONumbers.count(BB) != 0;
+  }
+
+  /// Return the immediate dominator of BB, nullptr for the entry and
+  /// unreachable blocks.
+  BasicBlock *getIDom(const BasicBlock *BB) const;
+
+  /// Return the blocks BB immediately dominates.
+  const BlockListTy &getChildren(const BasicBlock *BB) const;
+
+  /// Return whether A dominates B. Every block dominates itself and every
+  /// block dominates the unreachable ones.
+  bool dominates(const BasicBlock *A, const BasicBlock *B) const;
+
+  /// Return whether A dominates B and A is not B.
+  bool properlyDominates(const BasicBlock *A, const BasicBlock *B) const {
+    return A != B && dominates(A, B);
+  }
+
+  /// Return whether the value of Def is available at User, which must not be
+  /// a Phi: the availability for a Phi is at the end of the incoming block.
+  bool dominates(const Instruction *Def, const Instruction *User) const;
+
+  /// Return the reachable blocks in reverse post order.
+  const BlockListTy &getReversePostOrder() const { return RPO; }
+
+  /// Return the index of a reachable block in the reverse post order.
+  unsigned getRPONumber(const BasicBlock *BB) const {
+    return RPONumbers.at(BB);
+  }
+
+  /// Print the tree with the blocks numbered in layout order.
+  void Format(std::ostream &O) const;
+
+private:
+  struct Node {
+    unsigned IDom;
+    BlockListTy Children;
+    /// Pre and post order numbers in the tree.
+    unsigned DFSIn;
+    unsigned DFSOut;
+  };
+
+  void computeRPO(const IRFunction &F);
+  void computeIDoms();
+  void computeDFSNumbers();
+
+  const IRFunction *TheFunction = nullptr;
+  BlockListTy RPO;
+  std::unordered_map<const BasicBlock *, unsigned> RPONumbers;
+  std::vector<Node> Nodes;
+};
+
+DEFINE_INLINE_OUTPUT_OPERATOR(DominatorTree)
+
+} // namespace simplecc
+#endif // SIMPLECC_IR_DOMINATORTREE_H
@@ -0,0 +1,110 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef SIMPLECC_IR_GVN_H
+#define SIMPLECC_IR_GVN_H
+#include "simplecc/IR/Instruction.h"
+#include "simplecc/Support/ScopedHashTable.h"
+#include <functional>
+
+namespace simplecc {
+class BasicBlock;
+class DominatorTree;
+class IRFunction;
+class ModRefInfo;
+
+/// @brief GVN removes the computations whose value is already available, in
+/// the style of the dominator-based value numbering of Briggs, Cooper and
+/// Simpson. The dominator tree is walked in pre-order with a scoped table of
+/// the expressions computed so far, so that a block sees what its dominators
+/// computed and nothing else.
+///
+/// Arithmetic is pure, so a repeated one is always redundant, and it is
+/// folded if its operands are constants. A Load or a
+/// LoadElem is redundant only if nothing may have written the location since
+/// it was read or stored, which is tracked with a version per location:
+///   - Store and StoreElem write only the global or array they name. A stored
+///     value is available to the loads after it.
+///   - Call writes the globals that ModRefInfo says the callee may write.
+///   - A block with more than one predecessor may be entered along a path that
+///     writes anything, so all the memory is new there.
+class GVN {
+  /// An expression and its operands in a canonical order.
+  struct Expression {
+    Instruction::Opcode Op;
+    Value *LHS;
+    Value *RHS;
+
+    bool operator==(const Expression &E) const {
+      return Op == E.Op && LHS == E.LHS && RHS == E.RHS;
+    }
+  };
+
+  struct ExpressionHash {
+    size_t operator()(const Expression &E) const {
+      return (std::hash<unsigned>()(E.Op) * 31 +
+              std::hash<Value *>()(E.LHS)) * 31 +
+             std::hash<Value *>()(E.RHS);
+    }
+  };
+
+  /// The value in a memory location and the version of it.
+  struct MemoryValue {
+    Value *Val;
+    unsigned Version;
+  };
+
+  static Expression getExpression(const Instruction *I);
+  /// Return the Constant that I computes from constant operands, or nullptr.
+  /// They show up as loads are replaced with the values stored.
+  static Value *foldConstant(const Instruction *I);
+
+  /// Return the current version of a global or an array.
+  unsigned getVersion(Value *Location) const;
+  /// Record a write to Location and that it now holds Val.
+  void clobber(Value *Location, const Expression &Key, Value *Val);
+
+  void processBlock(BasicBlock *BB, const DominatorTree &DT);
+  /// Return true if I was found redundant and erased.
+  bool processInstruction(Instruction *I);
+  bool processMemoryRead(Instruction *I, Value *Location);
+
+public:
+  explicit GVN(const ModRefInfo &MRI) : MRI(MRI) {}
+  ~GVN() = default;
+
+  /// Run on F. Return true if F was changed.
+  bool Transform(IRFunction &F);
+
+private:
+  const ModRefInfo &MRI;
+  ScopedHashTable<Expression, Value *, ExpressionHash> AvailableValues;
+  ScopedHashTable<Expression, MemoryValue, ExpressionHash> AvailableMemory;
+  ScopedHashTable<Value *, unsigned> LocationVersions;
+  /// The version of all the memory.
+  unsigned Epoch = 0;
+  /// The last version handed out. Every write takes a new one.
+  unsigned LastVersion = 0;
+  bool Changed = false;
+};
+} // namespace simplecc
+#endif // SIMPLECC_IR_GVN_H
@@ -0,0 +1,42 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/// @file External interface of the IR module.
+#ifndef SIMPLECC_IR_IR_H
+#define SIMPLECC_IR_IR_H
+#include "simplecc/Support/OptimizationOptions.h"
+#include <iostream>
+
+namespace simplecc {
+class ByteCodeModule;
+class IRModule;
+
+/// Build the SSA form of BM into M.
+void BuildIR(const ByteCodeModule &BM, IRModule &M);
+/// Run the optimization passes that Options selects on M.
+void OptimizeIR(IRModule &M, const OptimizationOptions &Options);
+/// Check the invariants of M. Return true if it is malformed.
+bool VerifyIR(const IRModule &M);
+/// Replace the code of BM with that lowered from M, which is consumed.
+void LowerToByteCode(IRModule &M, ByteCodeModule &BM);
+} // namespace simplecc
+#endif // SIMPLECC_IR_IR_H
@@ -0,0 +1,104 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef SIMPLECC_IR_IRFUNCTION_H
+#define SIMPLECC_IR_IRFUNCTION_H
+#include "simplecc/IR/BasicBlock.h"
+#include "simplecc/IR/Value.h"
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace simplecc {
+class IRModule;
+
+/// @brief IRFunction is a function in SSA form: a list of BasicBlocks with the
+/// entry block first, the Arguments and the LocalArrays of its frame.
+class IRFunction {
+public:
+  using BlockListTy = std::vector<BasicBlock *>;
+  using iterator = BlockListTy::iterator;
+  using const_iterator = BlockListTy::const_iterator;
+
+  /// Create an IRFunction and insert it into an IRModule.
+  static IRFunction *Create(IRModule *M, std::string Name,
+                            BasicTypeKind ReturnType);
+
+  IRFunction(const IRFunction &) = delete;
+  IRFunction &operator=(const IRFunction &) = delete;
+  /// Delete all the blocks, arguments and local arrays.
+  ~IRFunction();
+
+  const std::string &getName() const { return Name; }
+  BasicTypeKind getReturnType() const { return ReturnType; }
+  IRModule *getParent() const { return Parent; }
+
+  /// Argument interface.
+  Argument *addArgument(std::string ArgName);
+  unsigned getNumArguments() const { return Arguments.size(); }
+  Argument *getArgument(unsigned I) const { return Arguments[I]; }
+  const std::vector<Argument *> &getArguments() const { return Arguments; }
+
+  /// LocalArray interface.
+  LocalArray *addLocalArray(std::string ArrayName, BasicTypeKind Type,
+                            unsigned Size);
+  const std::vector<LocalArray *> &getLocalArrays() const {
+    return LocalArrays;
+  }
+
+  /// Block interface.
+  iterator begin() { return Blocks.begin(); }
+  iterator end() { return Blocks.end(); }
+  const_iterator begin() const { return Blocks.begin(); }
+  const_iterator end() const { return Blocks.end(); }
+  unsigned size() const { return Blocks.size(); }
+  bool empty() const { return Blocks.empty(); }
+  BasicBlock *getEntryBlock() const { return Blocks.front(); }
+  const BlockListTy &getBlockList() const { return Blocks; }
+
+  /// Create an empty block before InsertBefore, or at the end if it is
+  /// nullptr.
+  BasicBlock *createBlock(BasicBlock *InsertBefore = nullptr);
+  /// Move B so that it comes right after Pos in the layout.
+  void moveBlockAfter(BasicBlock *B, BasicBlock *Pos);
+  /// Delete the blocks. Their Instructions must not be used outside them and
+  /// they must not be successors of the remaining blocks.
+  void eraseBlocks(const BlockListTy &Dead);
+
+  void Format(std::ostream &O) const;
+
+private:
+  IRFunction(IRModule *M, std::string Name, BasicTypeKind ReturnType)
+      : Parent(M), Name(std::move(Name)), ReturnType(ReturnType) {}
+
+  IRModule *Parent;
+  std::string Name;
+  BasicTypeKind ReturnType;
+  std::vector<Argument *> Arguments;
+  std::vector<LocalArray *> LocalArrays;
+  BlockListTy Blocks;
+};
+
+DEFINE_INLINE_OUTPUT_OPERATOR(IRFunction)
+
+} // namespace simplecc
+#endif // SIMPLECC_IR_IRFUNCTION_H
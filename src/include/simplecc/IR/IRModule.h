@@ -0,0 +1,92 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef SIMPLECC_IR_IRMODULE_H
+#define SIMPLECC_IR_IRMODULE_H
+#include "simplecc/IR/IRFunction.h"
+#include "simplecc/IR/Value.h"
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace simplecc {
+
+/// @brief IRModule owns the IRFunctions, the GlobalVariables, the uniqued
+/// Constants and the string literals of a program.
+class IRModule {
+public:
+  using FunctionListTy = std::vector<IRFunction *>;
+  using GlobalListTy = std::vector<GlobalVariable *>;
+  /// The string literal unique pool, the same as the ByteCodeModule's.
+  using StringLiteralTable = std::unordered_map<std::string, unsigned>;
+  using iterator = FunctionListTy::iterator;
+  using const_iterator = FunctionListTy::const_iterator;
+
+  IRModule() = default;
+  IRModule(const IRModule &) = delete;
+  IRModule &operator=(const IRModule &) = delete;
+  ~IRModule() { clear(); }
+
+  /// Function interface.
+  iterator begin() { return Functions.begin(); }
+  iterator end() { return Functions.end(); }
+  const_iterator begin() const { return Functions.begin(); }
+  const_iterator end() const { return Functions.end(); }
+  FunctionListTy &getFunctionList() { return Functions; }
+  /// Return the function of a name, or nullptr.
+  IRFunction *getFunction(const std::string &Name) const;
+
+  /// Global interface.
+  GlobalVariable *addGlobal(std::string Name, BasicTypeKind Type,
+                            unsigned Size);
+  const GlobalListTy &getGlobals() const { return Globals; }
+  /// Return the global of a name, or nullptr.
+  GlobalVariable *getGlobal(const std::string &Name) const;
+
+  /// Return the uniqued Constant for Val.
+  Constant *getConstant(int Val);
+  /// Return the only UndefValue.
+  UndefValue *getUndef() { return &Undef; }
+
+  StringLiteralTable &getStringLiteralTable() { return StringLiterals; }
+  const StringLiteralTable &getStringLiteralTable() const {
+    return StringLiterals;
+  }
+
+  /// Delete everything.
+  void clear();
+
+  void Format(std::ostream &O) const;
+
+private:
+  FunctionListTy Functions;
+  GlobalListTy Globals;
+  std::unordered_map<int, Constant *> Constants;
+  UndefValue Undef;
+  StringLiteralTable StringLiterals;
+};
+
+DEFINE_INLINE_OUTPUT_OPERATOR(IRModule)
+
+} // namespace simplecc
+#endif // SIMPLECC_IR_IRMODULE_H
@@ -0,0 +1,61 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef SIMPLECC_IR_IRVERIFIER_H
+#define SIMPLECC_IR_IRVERIFIER_H
+#include "simplecc/IR/DominatorTree.h"
+#include "simplecc/Support/ErrorManager.h"
+
+namespace simplecc {
+class BasicBlock;
+class Instruction;
+class IRFunction;
+class IRModule;
+
+/// @brief IRVerifier checks the invariants of the SSA IR that the rest of the
+/// compiler relies on: every block ends with exactly one terminator, phis
+/// come first and agree with the predecessors, the def-use chains are
+/// consistent and every definition dominates its uses.
+class IRVerifier {
+  /// Helper to check a condition.
+  void AssertThat(bool Predicate, const BasicBlock *BB, const char *ErrMsg);
+
+  void verifyBlock(const BasicBlock &BB);
+  void verifyPhi(const Instruction &I);
+  void verifyOperands(const Instruction &I);
+  void verifyOpcode(const Instruction &I);
+
+public:
+  IRVerifier() = default;
+  ~IRVerifier() = default;
+  /// Check a function. Return true if it is malformed.
+  bool Check(const IRFunction &F);
+  /// Check all the functions of a module.
+  bool Check(const IRModule &M);
+
+private:
+  const IRFunction *TheFunction = nullptr;
+  DominatorTree DT;
+  ErrorManager EM;
+};
+} // namespace simplecc
+#endif // SIMPLECC_IR_IRVERIFIER_H
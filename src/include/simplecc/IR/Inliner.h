@@ -0,0 +1,81 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef SIMPLECC_IR_INLINER_H
+#define SIMPLECC_IR_INLINER_H
+#include <cstdint>
+#include <unordered_map>
+
+namespace simplecc {
+class ExecutionProfile;
+class Instruction;
+class IRFunction;
+class IRModule;
+
+/// @brief Inliner replaces a call with a copy of the body of the callee. The
+/// functions are visited bottom-up in the call graph, so a callee has got the
+/// calls in it inlined before it is copied. A function that may call itself is
+/// never inlined.
+///
+/// A call is inlined if its cost is at most the threshold. The cost is the
+/// number of instructions of the callee, less what the call itself takes and
+/// what a constant argument may fold away. The threshold is doubled for a
+/// call in a loop.
+///
+/// Given a profile, the threshold follows how often the call ran instead: it
+/// is raised for a hot call and dropped to zero for one that never ran, so
+/// that only a callee smaller than the call is inlined there.
+///
+/// The SSA values of the copy are new values, so there is nothing to rename
+/// except the local arrays, which become those of the caller. Each return of
+/// the copy branches to the code after the call and the returned values meet
+/// in a phi there.
+class Inliner {
+  static unsigned getFunctionSize(const IRFunction &F);
+  /// Return the cost of inlining Call. The lower the more profitable.
+  int getInlineCost(const Instruction *Call) const;
+  /// Replace Call with the body of its callee.
+  void inlineCall(Instruction *Call);
+  /// Return the threshold of Call in F given the profile, which is Limit
+  /// unless the profile tells the call is hot or cold.
+  int getProfileLimit(const IRFunction &F, const Instruction *Call,
+                      int Limit) const;
+
+public:
+  explicit Inliner(unsigned Threshold,
+                   const ExecutionProfile *Profile = nullptr)
+      : Threshold(Threshold), Profile(Profile) {}
+  ~Inliner() = default;
+
+  /// Run on M. Return true if M was changed.
+  bool Transform(IRModule &M);
+
+private:
+  unsigned Threshold;
+  const ExecutionProfile *Profile;
+  /// The count of the hottest call of the profile.
+  uint64_t MaxCallCount = 0;
+  /// The current number of instructions of each function.
+  std::unordered_map<const IRFunction *, unsigned> Sizes;
+};
+} // namespace simplecc
+#endif // SIMPLECC_IR_INLINER_H
@@ -0,0 +1,223 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef SIMPLECC_IR_INSTRUCTION_H
+#define SIMPLECC_IR_INSTRUCTION_H
+#include "simplecc/IR/Value.h"
+#include <cassert>
+#include <vector>
+
+namespace simplecc {
+class BasicBlock;
+class IRFunction;
+
+/// @brief Instruction is an operation in a BasicBlock and the SSA value it
+/// defines, if any. Like ByteCode, it is a single class: the opcode decides
+/// which of the operands, the block list, the callee and the predicate are
+/// meaningful.
+///
+/// Operands are laid out in the order a stack machine evaluates them:
+///   - Store:     value, global.
+///   - StoreElem: value, base, index.
+///   - LoadElem:  base, index.
+///   - CondBr:    lhs, rhs, with the true and false successors as blocks.
+///   - Phi:       one incoming value per incoming block.
+class Instruction : public Value {
+public:
+  enum Opcode {
+#define HANDLE_INSTRUCTION(Opc, Name) Opc,
+#include "simplecc/IR/Instruction.def"
+  };
+
+  /// The comparison a CondBr makes between its two operands.
+  enum Predicate { EQ, NE, LT, LE, GT, GE };
+
+  using OperandListTy = std::vector<Value *>;
+  using BlockListTy = std::vector<BasicBlock *>;
+
+  ~Instruction() override;
+
+  /// Factories. The result is not inserted into any BasicBlock.
+  static Instruction *CreateBinary(Opcode Op, Value *LHS, Value *RHS);
+  static Instruction *CreateNeg(Value *V);
+  static Instruction *CreateLoad(GlobalVariable *GV);
+  static Instruction *CreateStore(Value *V, GlobalVariable *GV);
+  static Instruction *CreateLoadElem(Value *Base, Value *Index);
+  static Instruction *CreateStoreElem(Value *V, Value *Base, Value *Index);
+  static Instruction *CreateCall(IRFunction *Callee, const OperandListTy &Args);
+  static Instruction *CreateRead(Opcode Op);
+  static Instruction *CreatePrintString(unsigned StringID);
+  static Instruction *CreatePrint(Opcode Op, Value *V);
+  static Instruction *CreatePrintNewline();
+  static Instruction *CreatePhi();
+  static Instruction *CreateBr(BasicBlock *Dest);
+  static Instruction *CreateCondBr(Predicate P, Value *LHS, Value *RHS,
+                                   BasicBlock *TrueDest, BasicBlock *FalseDest);
+  static Instruction *CreateRet(Value *V = nullptr);
+
+  /// Return a new Instruction with the same opcode and extra fields as this
+  /// one and the same operands and blocks. It is not inserted anywhere.
+  Instruction *clone() const;
+
+  Opcode getOpcode() const { return Op; }
+  const char *getOpcodeName() const { return getOpcodeName(Op); }
+  static const char *getOpcodeName(Opcode Op);
+
+  /// Opcode classes.
+  static bool isTerminator(Opcode Op) {
+    return Op == Br || Op == CondBr || Op == Ret;
+  }
+  static bool isBinaryOp(Opcode Op) {
+    return Op == Add || Op == Sub || Op == Mul || Op == Div ||
+           hasImmediateOperand(Op);
+  }
+  static bool isCommutative(Opcode Op) { return Op == Add || Op == Mul; }
+  /// Return whether the RHS must be a Constant, which the target encodes in
+  /// the instruction. These come from strength reduction.
+  static bool hasImmediateOperand(Opcode Op) {
+    return Op == Shl || Op == AShr || Op == LShr || Op == MulHi;
+  }
+  bool isTerminator() const { return isTerminator(Op); }
+  bool isBinaryOp() const { return isBinaryOp(Op); }
+  bool isPhi() const { return Op == Phi; }
+
+  /// Return whether this defines a value that can be used as an operand.
+  bool hasValue() const;
+  /// Return whether this reads memory that Store, StoreElem or a callee may
+  /// write.
+  bool mayReadMemory() const;
+  /// Return whether this writes a global, an array or anything a callee may.
+  bool mayWriteMemory() const;
+  /// Return whether this does anything besides defining its value, i.e.,
+  /// writes memory, does I/O or transfers control.
+  bool hasSideEffects() const;
+  /// Return whether this can stop the program with a runtime error, i.e.,
+  /// a Div whose divisor is not a known non-zero Constant or a LoadElem.
+  /// Such an instruction must run even when its value is unused.
+  bool mayTrap() const;
+
+  /// The enclosing BasicBlock, or nullptr when not inserted.
+  BasicBlock *getParent() const { return Parent; }
+  IRFunction *getFunction() const;
+  /// Neighbours in the enclosing BasicBlock.
+  Instruction *getPrev() const { return Prev; }
+  Instruction *getNext() const { return Next; }
+
+  /// Unlink this from its BasicBlock and delete it. It must have no users.
+  void eraseFromParent();
+  /// Unlink this from its BasicBlock and move it before Pos.
+  void moveBefore(Instruction *Pos);
+
+  /// Operand interface.
+  unsigned getNumOperands() const { return Operands.size(); }
+  Value *getOperand(unsigned I) const { return Operands[I]; }
+  void setOperand(unsigned I, Value *V);
+  const OperandListTy &getOperands() const { return Operands; }
+  /// Replace every operand that is From with To.
+  void replaceUsesOfWith(Value *From, Value *To);
+  /// Drop all the operands so that this is no longer a user of them.
+  void dropAllReferences();
+
+  /// Successors of a terminator.
+  unsigned getNumSuccessors() const;
+  BasicBlock *getSuccessor(unsigned I) const {
+    assert(isTerminator() && "Not a terminator");
+    return Blocks[I];
+  }
+  void setSuccessor(unsigned I, BasicBlock *B);
+
+  /// Phi interface. The incoming values are the operands.
+  unsigned getNumIncoming() const { return Operands.size(); }
+  Value *getIncomingValue(unsigned I) const { return Operands[I]; }
+  BasicBlock *getIncomingBlock(unsigned I) const { return Blocks[I]; }
+  void setIncomingBlock(unsigned I, BasicBlock *B) { Blocks[I] = B; }
+  void addIncoming(Value *V, BasicBlock *B);
+  void removeIncoming(unsigned I);
+  /// Return the value coming from B, which must be an incoming block.
+  Value *getIncomingValueForBlock(const BasicBlock *B) const;
+  /// Return the value every incoming edge agrees on other than this phi
+  /// itself, or nullptr if there is none.
+  Value *getUniqueIncomingValue() const;
+
+  /// CondBr interface.
+  Predicate getPredicate() const { return Pred; }
+  void setPredicate(Predicate P) { Pred = P; }
+  static Predicate getInversePredicate(Predicate P);
+  static Predicate getSwappedPredicate(Predicate P);
+  static const char *getPredicateName(Predicate P);
+  static bool EvaluatePredicate(Predicate P, int LHS, int RHS);
+
+  /// Compute a binary operator on constants as the target does. Return false
+  /// if the result is undefined, i.e., a division by zero or an overflowing
+  /// division. A shift takes the amount modulo 32 and MulHi is the high word
+  /// of the signed 64-bit product.
+  static bool EvaluateBinary(Opcode Op, int LHS, int RHS, int &Result);
+
+  /// Call interface. The arguments are the operands.
+  IRFunction *getCallee() const { return Callee; }
+
+  /// PrintString interface.
+  unsigned getStringID() const { return StringID; }
+
+  /// The source line this came from.
+  unsigned getLineno() const { return Lineno; }
+  void setLineno(unsigned L) { Lineno = L; }
+  /// The function whose source the line is in, if this was inlined from
+  /// another function, or nullptr.
+  IRFunction *getSourceFunction() const { return SourceFunction; }
+  void setSourceFunction(IRFunction *F) { SourceFunction = F; }
+  /// Take the source line of I and the function it is in.
+  void copyLineno(const Instruction *I) {
+    Lineno = I->Lineno;
+    SourceFunction = I->SourceFunction;
+  }
+
+  void Format(std::ostream &O) const;
+
+  static bool InstanceCheck(const Value *V) {
+    return V->getKind() == InstructionKind;
+  }
+
+private:
+  friend class BasicBlock;
+  explicit Instruction(Opcode Op) : Value(InstructionKind), Op(Op) {}
+  void addOperand(Value *V);
+
+  Opcode Op;
+  OperandListTy Operands;
+  /// Successors of a terminator or incoming blocks of a Phi.
+  BlockListTy Blocks;
+  IRFunction *Callee = nullptr;
+  Predicate Pred = EQ;
+  unsigned StringID = 0;
+  unsigned Lineno = 0;
+  IRFunction *SourceFunction = nullptr;
+
+  BasicBlock *Parent = nullptr;
+  Instruction *Prev = nullptr;
+  Instruction *Next = nullptr;
+};
+
+DEFINE_INLINE_OUTPUT_OPERATOR(Instruction)
+
+} // namespace simplecc
+#endif // SIMPLECC_IR_INSTRUCTION_H
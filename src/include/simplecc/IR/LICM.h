@@ -0,0 +1,75 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef SIMPLECC_IR_LICM_H
+#define SIMPLECC_IR_LICM_H
+#include "simplecc/IR/LoopInfo.h"
+#include <unordered_set>
+
+namespace simplecc {
+class BasicBlock;
+class DominatorTree;
+class Instruction;
+class IRFunction;
+class ModRefInfo;
+class Value;
+
+/// @brief LICM hoists the computations whose value does not change in a loop
+/// out of it, into a preheader: a block that branches only to the header and
+/// is its only predecessor from outside. The loops are visited inner ones
+/// first, so that a value can move out of several loops.
+///
+/// An instruction is invariant if its operands are defined out of the loop.
+/// Arithmetic is always hoisted, and so are the reads of a memory location
+/// that nothing in the loop may write:
+///   - Store and StoreElem write only the global or array they name.
+///   - Call writes the globals that ModRefInfo says the callee may write.
+/// As the loop may run zero times, an instruction that can fail is hoisted
+/// only if it runs whenever the loop does, i.e., it dominates every exit.
+/// These are a Div with a divisor that may be 0 and a LoadElem with an index
+/// that may be out of bounds.
+class LICM {
+  /// Give each loop that lacks it a preheader. Return true if any was made.
+  bool insertPreheaders(IRFunction &F, const LoopInfo &LI);
+  void insertPreheader(IRFunction &F, Loop *L);
+
+  bool hoistLoop(Loop *L, const DominatorTree &DT);
+  bool isLoopInvariant(const Loop *L, const Value *V) const;
+  /// Return whether I computes the same value wherever it is in L.
+  bool canHoist(const Instruction *I, const Loop *L) const;
+  /// Return whether I can run even when it would not have.
+  static bool isSafeToSpeculate(const Instruction *I);
+
+public:
+  explicit LICM(const ModRefInfo &MRI) : MRI(MRI) {}
+  ~LICM() = default;
+
+  /// Run on F. Return true if F was changed.
+  bool Transform(IRFunction &F);
+
+private:
+  const ModRefInfo &MRI;
+  /// The globals and arrays the loop being visited may write.
+  std::unordered_set<const Value *> ModifiedLocations;
+};
+} // namespace simplecc
+#endif // SIMPLECC_IR_LICM_H
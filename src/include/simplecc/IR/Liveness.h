@@ -0,0 +1,70 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef SIMPLECC_IR_LIVENESS_H
+#define SIMPLECC_IR_LIVENESS_H
+#include <unordered_map>
+#include <unordered_set>
+
+namespace simplecc {
+class BasicBlock;
+class DominatorTree;
+class Instruction;
+class IRFunction;
+class Value;
+
+/// @brief Liveness computes the Instructions and Arguments live into and out
+/// of each block. A phi uses its operands at the end of the incoming blocks
+/// and defines its value at the start of its own block.
+class Liveness {
+public:
+  using ValueSetTy = std::unordered_set<const Value *>;
+
+  Liveness() = default;
+  explicit Liveness(const IRFunction &F) { recalculate(F); }
+
+  /// Compute the live sets for F.
+  void recalculate(const IRFunction &F);
+
+  const ValueSetTy &getLiveIn(const BasicBlock *BB) const {
+    return LiveIn.at(BB);
+  }
+  const ValueSetTy &getLiveOut(const BasicBlock *BB) const {
+    return LiveOut.at(BB);
+  }
+
+  /// Return whether V is live right after I, or after all the phis if I is
+  /// one.
+  bool isLiveAfter(const Value *V, const Instruction *I) const;
+
+  /// Return whether A and B are live at the same time, so that they cannot
+  /// share a location. In SSA form, two values interfere only if one of them
+  /// is live at the definition of the other, which it dominates.
+  bool interfere(const Value *A, const Value *B,
+                 const DominatorTree &DT) const;
+
+private:
+  std::unordered_map<const BasicBlock *, ValueSetTy> LiveIn;
+  std::unordered_map<const BasicBlock *, ValueSetTy> LiveOut;
+};
+} // namespace simplecc
+#endif // SIMPLECC_IR_LIVENESS_H
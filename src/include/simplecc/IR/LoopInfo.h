@@ -0,0 +1,124 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef SIMPLECC_IR_LOOPINFO_H
+#define SIMPLECC_IR_LOOPINFO_H
+#include "simplecc/Support/Macros.h"
+#include <iostream>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace simplecc {
+class BasicBlock;
+class DominatorTree;
+class Instruction;
+
+/// @brief Loop is a natural loop: a header that dominates the blocks of the
+/// loop and the back edges that go to it from the latches. The loops of the
+/// same header are one Loop.
+class Loop {
+public:
+  using BlockListTy = std::vector<BasicBlock *>;
+
+  BasicBlock *getHeader() const { return Header; }
+  /// Return the innermost Loop that contains this one, or nullptr.
+  Loop *getParentLoop() const { return ParentLoop; }
+  /// Return the outermost loops inside this one.
+  const std::vector<Loop *> &getSubLoops() const { return SubLoops; }
+  /// Return 1 for an outermost loop, 2 for one inside it and so on.
+  unsigned getLoopDepth() const;
+
+  /// Return the blocks in reverse post order, the header first. The blocks
+  /// of the sub-loops are included.
+  const BlockListTy &getBlocks() const { return Blocks; }
+  bool contains(const BasicBlock *BB) const { return BlockSet.count(BB); }
+  bool contains(const Loop *L) const;
+
+  /// Return the blocks in the loop that branch back to the header.
+  BlockListTy getLatches() const;
+  /// Return the blocks in the loop that branch out of it.
+  BlockListTy getExitingBlocks() const;
+  /// Return the blocks out of the loop that it branches to.
+  BlockListTy getExitBlocks() const;
+  /// Return the only predecessor of the header out of the loop, if it
+  /// branches only to the header, or nullptr.
+  BasicBlock *getLoopPreheader() const;
+
+  void Format(std::ostream &O) const;
+
+private:
+  friend class LoopInfo;
+  explicit Loop(BasicBlock *Header) : Header(Header) {}
+
+  BasicBlock *Header;
+  Loop *ParentLoop = nullptr;
+  std::vector<Loop *> SubLoops;
+  BlockListTy Blocks;
+  std::unordered_set<const BasicBlock *> BlockSet;
+};
+
+DEFINE_INLINE_OUTPUT_OPERATOR(Loop)
+
+/// @brief LoopInfo finds the natural loops of an IRFunction and how they nest.
+/// A back edge is an edge to a block that dominates its source. As a C0
+/// program has only structured control flow, every cycle has such an edge.
+/// It must be recalculated after the CFG changes.
+class LoopInfo {
+public:
+  using LoopListTy = std::vector<Loop *>;
+
+  LoopInfo() = default;
+  explicit LoopInfo(const DominatorTree &DT) { recalculate(DT); }
+  LoopInfo(const LoopInfo &) = delete;
+  LoopInfo &operator=(const LoopInfo &) = delete;
+  ~LoopInfo() { clear(); }
+
+  /// Find the loops of the function DT was computed for.
+  void recalculate(const DominatorTree &DT);
+
+  /// Return the innermost Loop that contains BB, or nullptr.
+  Loop *getLoopFor(const BasicBlock *BB) const;
+  /// Return the loop depth of BB, 0 if it is in no loop.
+  unsigned getLoopDepth(const BasicBlock *BB) const;
+
+  /// Return the loops that are in no other loop.
+  const LoopListTy &getTopLevelLoops() const { return TopLevelLoops; }
+  /// Return all the loops, each after the loops inside it.
+  LoopListTy getLoopsInPostorder() const;
+  bool empty() const { return Loops.empty(); }
+
+  void Format(std::ostream &O) const;
+
+private:
+  void clear();
+
+  /// All the loops, outer ones before the loops inside them.
+  LoopListTy Loops;
+  LoopListTy TopLevelLoops;
+  std::unordered_map<const BasicBlock *, Loop *> BlockMap;
+};
+
+DEFINE_INLINE_OUTPUT_OPERATOR(LoopInfo)
+
+} // namespace simplecc
+#endif // SIMPLECC_IR_LOOPINFO_H
@@ -0,0 +1,97 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef SIMPLECC_IR_LOOPUNROLL_H
+#define SIMPLECC_IR_LOOPUNROLL_H
+#include "simplecc/IR/Instruction.h"
+#include <unordered_map>
+
+namespace simplecc {
+class BasicBlock;
+class IRFunction;
+class Loop;
+
+/// @brief LoopUnroll copies the body of an innermost loop several times, so
+/// that fewer branches and conditions run per iteration.
+///
+/// A loop is unrolled if it is tested at the bottom and counted, i.e., its
+/// latch is the only block that leaves it and does so by comparing an
+/// induction variable, a header phi stepped by a constant, or its next value
+/// against a loop invariant bound. A C0 for loop has this shape.
+///   - If the trip count is a constant and small enough, the loop is fully
+///     unrolled and no branch is left.
+///   - Otherwise, a copy of the loop that runs Factor iterations at a time
+///     without testing in between is put before the loop, which runs the
+///     remaining iterations. The copy runs while Factor more iterations are
+///     certain to run.
+class LoopUnroll {
+  /// What makes a loop countable.
+  struct Candidate {
+    BasicBlock *Preheader;
+    BasicBlock *Header;
+    BasicBlock *Latch;
+    BasicBlock *Exit;
+    /// The induction variable and its step.
+    Instruction *IndVar;
+    int Step;
+    /// The loop goes on while Tested Pred Bound holds, where Tested is
+    /// IndVar, or its next value if TestsNext.
+    Instruction::Predicate Pred;
+    bool TestsNext;
+    Value *Bound;
+    /// The number of instructions in the loop.
+    unsigned Size;
+  };
+  using ValueMapTy = std::unordered_map<const Value *, Value *>;
+  using BlockMapTy = std::unordered_map<const BasicBlock *, BasicBlock *>;
+
+  static bool analyzeLoop(Loop *L, Candidate &C);
+  /// Return the trip count of a loop with a constant one, or 0 if it is
+  /// unknown or too large to unroll fully.
+  static unsigned getTripCount(const Candidate &C);
+  /// Copy the blocks of L before InsertBefore. VM must map the header phis to
+  /// their values in the copy, and maps the rest of L on return. The latch of
+  /// the copy still branches to the header of the copy.
+  static void cloneLoop(IRFunction &F, Loop *L, BasicBlock *InsertBefore,
+                        ValueMapTy &VM, BlockMapTy &BM);
+  /// Branch to TrueDest if Factor iterations starting with the induction
+  /// variable at Start all run, and to FalseDest otherwise.
+  void insertChunkTest(const Candidate &C, Value *Start, BasicBlock *BB,
+                       BasicBlock *TrueDest, BasicBlock *FalseDest);
+
+  void unrollFully(IRFunction &F, Loop *L, const Candidate &C,
+                   unsigned TripCount);
+  bool unrollPartially(IRFunction &F, Loop *L, const Candidate &C);
+
+public:
+  explicit LoopUnroll(unsigned Factor) : Factor(Factor) {}
+  ~LoopUnroll() = default;
+
+  /// Run on F. Return true if F was changed.
+  bool Transform(IRFunction &F);
+
+private:
+  unsigned Factor;
+};
+} // namespace simplecc
+#endif // SIMPLECC_IR_LOOPUNROLL_H
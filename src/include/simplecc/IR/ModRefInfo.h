@@ -0,0 +1,62 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef SIMPLECC_IR_MODREFINFO_H
+#define SIMPLECC_IR_MODREFINFO_H
+#include <unordered_map>
+#include <unordered_set>
+
+namespace simplecc {
+class IRFunction;
+class IRModule;
+class Value;
+
+/// @brief ModRefInfo finds the globals and global arrays that each function
+/// may write, directly or through the functions it calls. A callee cannot
+/// write a local array of its caller since arrays are never passed.
+///
+/// The result stays correct as passes delete stores and calls, only less
+/// precise, so it can be computed once before optimizing a module.
+class ModRefInfo {
+public:
+  using LocationSetTy = std::unordered_set<Value *>;
+
+  ModRefInfo() = default;
+  explicit ModRefInfo(const IRModule &M) { recalculate(M); }
+
+  void recalculate(const IRModule &M);
+
+  /// Return the globals that a call to F may write.
+  const LocationSetTy &getModifiedGlobals(const IRFunction *F) const {
+    return ModifiedGlobals.at(F);
+  }
+
+  /// Return whether a call to F may write Location.
+  bool mayModify(const IRFunction *F, const Value *Location) const {
+    return getModifiedGlobals(F).count(const_cast<Value *>(Location));
+  }
+
+private:
+  std::unordered_map<const IRFunction *, LocationSetTy> ModifiedGlobals;
+};
+} // namespace simplecc
+#endif // SIMPLECC_IR_MODREFINFO_H
@@ -0,0 +1,101 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef SIMPLECC_IR_SCCP_H
+#define SIMPLECC_IR_SCCP_H
+#include "simplecc/IR/IRFunction.h"
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace simplecc {
+class Instruction;
+class Value;
+
+/// @brief SCCP implements the sparse conditional constant propagation of
+/// Wegman and Zadeck. Each value starts unknown and is lowered to a constant
+/// or to overdefined as the blocks and edges proven executable are visited.
+/// Afterwards the constant values are replaced, the branches on constants are
+/// folded and the blocks never executed are deleted.
+///
+/// An undefined local is taken as 0, which is what the lowering loads for it.
+/// Only the arithmetic on SSA values is folded: loads, calls and reads are
+/// overdefined.
+class SCCP {
+  /// The lattice of a value.
+  struct LatticeValue {
+    enum KindTy { Unknown, Const, Overdefined } Kind = Unknown;
+    int Val = 0;
+
+    bool isUnknown() const { return Kind == Unknown; }
+    bool isConstant() const { return Kind == Const; }
+    bool isOverdefined() const { return Kind == Overdefined; }
+  };
+
+  LatticeValue getValue(Value *V) const;
+  /// Lower the lattice of I to LV, or to overdefined if they disagree.
+  void mergeInValue(Instruction *I, LatticeValue LV);
+  void markOverdefined(Instruction *I);
+
+  void markBlockExecutable(BasicBlock *BB);
+  void markEdgeExecutable(BasicBlock *From, BasicBlock *To);
+  bool isEdgeExecutable(BasicBlock *From, BasicBlock *To) const {
+    return ExecutableEdges.count(std::make_pair(From, To));
+  }
+
+  void visitInstruction(Instruction *I);
+  void visitPhi(Instruction *I);
+  void visitBinary(Instruction *I);
+  void visitNeg(Instruction *I);
+  void visitCondBr(Instruction *I);
+
+  /// Propagate until both worklists are empty.
+  void solve();
+  /// Rewrite F with the solution. Return true if anything changed.
+  bool rewrite(IRFunction &F);
+
+public:
+  SCCP() = default;
+  ~SCCP() = default;
+
+  /// Run on F. Return true if F was changed.
+  bool Transform(IRFunction &F);
+
+private:
+  struct EdgeHash {
+    size_t operator()(const std::pair<BasicBlock *, BasicBlock *> &E) const {
+      return std::hash<BasicBlock *>()(E.first) * 31 +
+             std::hash<BasicBlock *>()(E.second);
+    }
+  };
+
+  IRModule *TheModule = nullptr;
+  std::unordered_map<const Instruction *, LatticeValue> Values;
+  std::unordered_set<const BasicBlock *> ExecutableBlocks;
+  std::unordered_set<std::pair<BasicBlock *, BasicBlock *>, EdgeHash>
+      ExecutableEdges;
+  std::vector<BasicBlock *> BlockWorklist;
+  std::vector<Instruction *> InstWorklist;
+};
+} // namespace simplecc
+#endif // SIMPLECC_IR_SCCP_H
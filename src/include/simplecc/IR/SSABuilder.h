@@ -0,0 +1,188 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef SIMPLECC_IR_SSABUILDER_H
+#define SIMPLECC_IR_SSABUILDER_H
+#include "simplecc/Analysis/SymbolTable.h"
+#include "simplecc/CodeGen/ByteCodeVisitor.h"
+#include "simplecc/IR/IRModule.h"
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace simplecc {
+class ByteCodeFunction;
+class ByteCodeModule;
+
+/// @brief SSABuilder lowers a ByteCodeModule into the SSA IR.
+///
+/// The stack of each basic block is simulated to turn ByteCode into
+/// Instructions; the stack is always empty across blocks. Local scalars
+/// become SSA values with the algorithm of Braun et al., "Simple and Efficient
+/// Construction of Static Single Assignment Form": a block is sealed once all
+/// its predecessors have been filled, and trivial phis are removed as soon as
+/// they are complete. Globals and arrays stay in memory.
+class SSABuilder : ByteCodeVisitor<SSABuilder> {
+  friend ByteCodeVisitor;
+
+  void visitLoadLocal(const ByteCode &C);
+  void visitLoadGlobal(const ByteCode &C);
+  void visitStoreLocal(const ByteCode &C);
+  void visitStoreGlobal(const ByteCode &C);
+  void visitBinaryAdd(const ByteCode &) { visitBinary(Instruction::Add); }
+  void visitBinarySub(const ByteCode &) { visitBinary(Instruction::Sub); }
+  void visitBinaryMultiply(const ByteCode &) {
+    visitBinary(Instruction::Mul);
+  }
+  void visitBinaryDivide(const ByteCode &) { visitBinary(Instruction::Div); }
+  void visitBinarySubscr(const ByteCode &C);
+  void visitStoreSubscr(const ByteCode &C);
+  void visitUnaryPositive(const ByteCode &) {}
+  void visitUnaryNegative(const ByteCode &C);
+  void visitShiftLeft(const ByteCode &C) {
+    visitImmediate(Instruction::Shl, C);
+  }
+  void visitShiftRight(const ByteCode &C) {
+    visitImmediate(Instruction::AShr, C);
+  }
+  void visitShiftRightLogical(const ByteCode &C) {
+    visitImmediate(Instruction::LShr, C);
+  }
+  void visitMultiplyHigh(const ByteCode &C) {
+    visitImmediate(Instruction::MulHi, C);
+  }
+  void visitReadInteger(const ByteCode &) { visitRead(Instruction::ReadInt); }
+  void visitReadCharacter(const ByteCode &) {
+    visitRead(Instruction::ReadChar);
+  }
+  void visitPrintString(const ByteCode &C);
+  void visitPrintCharacter(const ByteCode &) {
+    visitPrint(Instruction::PrintChar);
+  }
+  void visitPrintInteger(const ByteCode &) {
+    visitPrint(Instruction::PrintInt);
+  }
+  void visitPrintNewline(const ByteCode &C);
+  void visitJumpForward(const ByteCode &C);
+  void visitJumpIfTrue(const ByteCode &C) {
+    visitUnaryJumpIf(C, Instruction::NE);
+  }
+  void visitJumpIfFalse(const ByteCode &C) {
+    visitUnaryJumpIf(C, Instruction::EQ);
+  }
+  void visitJumpIfEqual(const ByteCode &C) { visitJumpIf(C, Instruction::EQ); }
+  void visitJumpIfNotEqual(const ByteCode &C) {
+    visitJumpIf(C, Instruction::NE);
+  }
+  void visitJumpIfGreater(const ByteCode &C) {
+    visitJumpIf(C, Instruction::GT);
+  }
+  void visitJumpIfGreaterEqual(const ByteCode &C) {
+    visitJumpIf(C, Instruction::GE);
+  }
+  void visitJumpIfLess(const ByteCode &C) { visitJumpIf(C, Instruction::LT); }
+  void visitJumpIfLessEqual(const ByteCode &C) {
+    visitJumpIf(C, Instruction::LE);
+  }
+  void visitCallFunction(const ByteCode &C);
+  void visitReturnValue(const ByteCode &C);
+  void visitReturnNone(const ByteCode &C);
+  void visitLoadConst(const ByteCode &C);
+  void visitLoadString(const ByteCode &C);
+  void visitPopTop(const ByteCode &C);
+
+  void visitBinary(Instruction::Opcode Op);
+  void visitImmediate(Instruction::Opcode Op, const ByteCode &C);
+  void visitRead(Instruction::Opcode Op);
+  void visitPrint(Instruction::Opcode Op);
+  void visitUnaryJumpIf(const ByteCode &C, Instruction::Predicate P);
+  void visitJumpIf(const ByteCode &C, Instruction::Predicate P);
+
+  /// Stack helpers.
+  void push(Value *V) { Stack.push_back(V); }
+  Value *pop() {
+    assert(!Stack.empty() && "Pop an empty stack");
+    Value *V = Stack.back();
+    Stack.pop_back();
+    return resolve(V);
+  }
+  /// Append I to the current block and return it.
+  Instruction *insert(Instruction *I);
+  /// Terminate the current block with a branch on P to the jump target of C,
+  /// falling through to the next block.
+  void insertCondBr(const ByteCode &C, Instruction::Predicate P, Value *LHS,
+                    Value *RHS);
+
+  /// Return the block starting at a ByteCode offset.
+  BasicBlock *getBlockAt(unsigned Offset) const { return Blocks.at(Offset); }
+
+  /// Braun et al.'s SSA construction.
+  void writeVariable(unsigned Slot, BasicBlock *BB, Value *V);
+  Value *readVariable(unsigned Slot, BasicBlock *BB);
+  Value *readVariableRecursive(unsigned Slot, BasicBlock *BB);
+  Value *addPhiOperands(unsigned Slot, Instruction *Phi);
+  Value *tryRemoveTrivialPhi(Instruction *Phi);
+  /// Follow the replacements of removed phis.
+  Value *resolve(Value *V) const;
+  void sealBlock(BasicBlock *BB);
+  bool isSealed(BasicBlock *BB) const { return Sealed.count(BB); }
+
+  /// Split F into blocks and create the reachable ones.
+  void createBlocks(const ByteCodeFunction &F);
+  void buildFunction(const ByteCodeFunction &F, IRFunction *IRF);
+
+public:
+  SSABuilder() = default;
+  ~SSABuilder() = default;
+
+  /// Lower all the functions of BM into M.
+  void Build(const ByteCodeModule &BM, IRModule &M);
+
+private:
+  IRModule *TheModule = nullptr;
+  IRFunction *TheFunction = nullptr;
+  LocalSymbolTable TheLocalTable;
+  BasicBlock *CurrentBlock = nullptr;
+  unsigned CurrentLineno = 0;
+  unsigned NextOffset = 0;
+  std::vector<Value *> Stack;
+
+  /// Blocks by their starting offset.
+  std::unordered_map<unsigned, BasicBlock *> Blocks;
+  /// Number of predecessors each block has in the ByteCode.
+  std::unordered_map<BasicBlock *, unsigned> NumPredecessors;
+  std::unordered_map<BasicBlock *, unsigned> NumFilledPredecessors;
+  /// Local arrays by slot.
+  std::unordered_map<unsigned, LocalArray *> Arrays;
+
+  /// The current definition of each local scalar in each block.
+  std::unordered_map<BasicBlock *, std::vector<Value *>> CurrentDef;
+  std::unordered_set<BasicBlock *> Sealed;
+  /// Phis waiting for their blocks to be sealed, with their slots.
+  using IncompletePhiListTy = std::vector<std::pair<unsigned, Instruction *>>;
+  std::unordered_map<BasicBlock *, IncompletePhiListTy> IncompletePhis;
+  /// Trivial phis removed from their blocks, mapped to what replaced them.
+  std::unordered_map<Value *, Value *> RemovedPhis;
+};
+} // namespace simplecc
+#endif // SIMPLECC_IR_SSABUILDER_H
@@ -0,0 +1,53 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef SIMPLECC_IR_SIMPLIFYCFG_H
+#define SIMPLECC_IR_SIMPLIFYCFG_H
+
+namespace simplecc {
+class BasicBlock;
+class IRFunction;
+
+/// @brief SimplifyCFG cleans up the CFG after other passes have folded
+/// branches. It repeats these until nothing changes:
+/// 1. Delete the blocks unreachable from the entry.
+/// 2. Replace the phis whose incoming values are all the same.
+/// 3. Turn a conditional branch with the same successors into a branch.
+/// 4. Merge a block into its only predecessor if that branches only to it.
+/// 5. Make the predecessors of an empty block branch past it, when the
+///    target has no phis.
+class SimplifyCFG {
+  bool removeUnreachableBlocks(IRFunction &F);
+  bool foldTrivialPhis(BasicBlock *BB);
+  bool foldRedundantCondBr(BasicBlock *BB);
+  bool mergeIntoPredecessor(BasicBlock *BB);
+  bool forwardEmptyBlock(BasicBlock *BB);
+
+public:
+  SimplifyCFG() = default;
+  ~SimplifyCFG() = default;
+
+  /// Run on F. Return true if F was changed.
+  bool Transform(IRFunction &F);
+};
+} // namespace simplecc
+#endif // SIMPLECC_IR_SIMPLIFYCFG_H
@@ -0,0 +1,63 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef SIMPLECC_IR_STRENGTHREDUCTION_H
+#define SIMPLECC_IR_STRENGTHREDUCTION_H
+#include "simplecc/IR/Instruction.h"
+
+namespace simplecc {
+class IRFunction;
+class Loop;
+
+/// @brief StrengthReduction replaces multiplications and divisions by a
+/// constant with cheaper operations. A mult takes about a dozen cycles on the
+/// MIPS and a div about three dozen, while a shift or an add takes one.
+///
+/// Two rewrites are made, in this order:
+///   - In a loop, a product of an induction variable P and a constant C
+///     becomes an induction variable of its own: it starts at Init * C and
+///     steps by Step * C whenever P steps by Step.
+///   - A product by a constant becomes shifts and an add or a sub when the
+///     constant is a power of two or one away from it. A quotient by a
+///     constant becomes shifts when the divisor is a power of two, and a
+///     MulHi by a magic number and shifts otherwise, as in chapter 10 of
+///     Hacker's Delight. The quotient is rounded toward zero, as div does.
+class StrengthReduction {
+  bool reduceInductionVariables(Loop *L);
+  bool reduceInstruction(Instruction *I);
+  Value *reduceMul(Instruction *I, Value *X, int C);
+  Value *reduceDiv(Instruction *I, Value *X, int D);
+  /// Create an instruction before Pos, at the line of Pos.
+  Instruction *insertBinary(Instruction::Opcode Op, Value *LHS, Value *RHS,
+                            Instruction *Pos);
+  Instruction *insertNeg(Value *V, Instruction *Pos);
+
+public:
+  StrengthReduction() = default;
+  ~StrengthReduction() = default;
+
+  /// Run on F. Return true if F was changed.
+  bool Transform(IRFunction &F);
+};
+} // namespace simplecc
+#endif // SIMPLECC_IR_STRENGTHREDUCTION_H
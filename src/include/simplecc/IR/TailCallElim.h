@@ -0,0 +1,67 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef SIMPLECC_IR_TAILCALLELIM_H
+#define SIMPLECC_IR_TAILCALLELIM_H
+
+namespace simplecc {
+class BasicBlock;
+class Instruction;
+class IRFunction;
+class Value;
+
+/// @brief TailCallElim turns the calls a function makes to itself right
+/// before it returns into a branch back to its entry, so that the recursion
+/// runs as a loop in a single frame. The arguments become phis at the old
+/// entry, which takes the arguments of each such call from its block.
+///
+/// A call whose result is added to or multiplied by a value computed before
+/// it, like `return (n * f(n - 1))`, is turned too. Since the operation is
+/// associative and commutative, the values are accumulated in a phi, which
+/// starts as 0 or 1 and is combined with the value of every other return.
+/// All such calls in a function must use the same operation.
+///
+/// The recursive call may not read the local arrays of its caller, since
+/// arrays are never passed, so the loop can reuse them.
+class TailCallElim {
+  /// A call to be turned into a branch and the Add or Mul that combines its
+  /// result, if any.
+  struct TailCall {
+    Instruction *Call;
+    Instruction *Accumulate;
+  };
+
+  /// Return the tail call in BB, if any.
+  static bool findTailCall(BasicBlock *BB, TailCall &TC);
+  /// Return the operand of TC.Accumulate that is not TC.Call.
+  static Value *getAccumulatedValue(const TailCall &TC);
+
+public:
+  TailCallElim() = default;
+  ~TailCallElim() = default;
+
+  /// Run on F. Return true if F was changed.
+  bool Transform(IRFunction &F);
+};
+} // namespace simplecc
+#endif // SIMPLECC_IR_TAILCALLELIM_H
@@ -0,0 +1,162 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef SIMPLECC_IR_VALUE_H
+#define SIMPLECC_IR_VALUE_H
+#include "simplecc/AST/Enums.h"
+#include "simplecc/Support/Macros.h"
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace simplecc {
+class Instruction;
+
+/// @brief Value is anything that can be an operand of an Instruction.
+/// Every Value keeps the Instructions that use it, one entry per operand,
+/// which forms the def-use chains of the IR. All values are 32-bit integers
+/// or addresses of arrays, so the IR has no type system.
+class Value {
+public:
+  enum ValueKind {
+    ConstantKind,
+    UndefValueKind,
+    ArgumentKind,
+    GlobalVariableKind,
+    LocalArrayKind,
+    InstructionKind,
+  };
+
+  /// The users of a Value, with one entry per operand that refers to it.
+  using UserListTy = std::vector<Instruction *>;
+
+  Value(const Value &) = delete;
+  Value &operator=(const Value &) = delete;
+  virtual ~Value();
+
+  ValueKind getKind() const { return Kind; }
+
+  const UserListTy &getUsers() const { return Users; }
+  bool hasUses() const { return !Users.empty(); }
+  bool hasOneUse() const { return Users.size() == 1; }
+  unsigned getNumUses() const { return Users.size(); }
+
+  /// Make every user of this Value use V instead.
+  void replaceAllUsesWith(Value *V);
+
+  /// Format this Value as an operand.
+  void Format(std::ostream &O) const;
+
+protected:
+  explicit Value(ValueKind K) : Kind(K) {}
+
+private:
+  friend class Instruction;
+  void addUser(Instruction *I) { Users.push_back(I); }
+  void removeUser(Instruction *I);
+
+  ValueKind Kind;
+  UserListTy Users;
+};
+
+DEFINE_INLINE_OUTPUT_OPERATOR(Value)
+
+/// @brief Constant is an integer constant. It is uniqued by the IRModule.
+class Constant : public Value {
+  int Val;
+
+public:
+  explicit Constant(int V) : Value(ConstantKind), Val(V) {}
+  int getValue() const { return Val; }
+  static bool InstanceCheck(const Value *V) {
+    return V->getKind() == ConstantKind;
+  }
+};
+
+/// @brief UndefValue is the value of a local variable read before any
+/// assignment. It may be assumed to be any constant.
+class UndefValue : public Value {
+public:
+  UndefValue() : Value(UndefValueKind) {}
+  static bool InstanceCheck(const Value *V) {
+    return V->getKind() == UndefValueKind;
+  }
+};
+
+/// @brief Argument is the value a formal argument holds on entry.
+class Argument : public Value {
+  std::string Name;
+  unsigned ArgNo;
+
+public:
+  Argument(std::string Name, unsigned ArgNo)
+      : Value(ArgumentKind), Name(std::move(Name)), ArgNo(ArgNo) {}
+  const std::string &getName() const { return Name; }
+  unsigned getArgNo() const { return ArgNo; }
+  static bool InstanceCheck(const Value *V) {
+    return V->getKind() == ArgumentKind;
+  }
+};
+
+/// @brief GlobalVariable is a global object. A scalar is read and written
+/// with Load and Store, an array is the base operand of LoadElem and
+/// StoreElem.
+class GlobalVariable : public Value {
+  std::string Name;
+  BasicTypeKind Type;
+  /// Number of elements for an array, 0 for a scalar.
+  unsigned Size;
+
+public:
+  GlobalVariable(std::string Name, BasicTypeKind Type, unsigned Size)
+      : Value(GlobalVariableKind), Name(std::move(Name)), Type(Type),
+        Size(Size) {}
+  const std::string &getName() const { return Name; }
+  BasicTypeKind getType() const { return Type; }
+  bool isArray() const { return Size != 0; }
+  unsigned getSize() const { return Size; }
+  static bool InstanceCheck(const Value *V) {
+    return V->getKind() == GlobalVariableKind;
+  }
+};
+
+/// @brief LocalArray is an array in the frame of a function. Local scalars
+/// are not objects in the IR: they become SSA values.
+class LocalArray : public Value {
+  std::string Name;
+  BasicTypeKind Type;
+  unsigned Size;
+
+public:
+  LocalArray(std::string Name, BasicTypeKind Type, unsigned Size)
+      : Value(LocalArrayKind), Name(std::move(Name)), Type(Type), Size(Size) {}
+  const std::string &getName() const { return Name; }
+  BasicTypeKind getType() const { return Type; }
+  unsigned getSize() const { return Size; }
+  static bool InstanceCheck(const Value *V) {
+    return V->getKind() == LocalArrayKind;
+  }
+};
+
+} // namespace simplecc
+#endif // SIMPLECC_IR_VALUE_H
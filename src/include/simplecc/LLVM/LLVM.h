@@ -22,6 +22,7 @@
 
 #ifndef SIMPLECC_LLVM_LLVM_H
 #define SIMPLECC_LLVM_LLVM_H
+#include "simplecc/Support/OptimizationOptions.h"
 #include <llvm/Support/raw_ostream.h>
 #include <string>
 
@@ -29,8 +30,21 @@ namespace simplecc {
 class ProgramAST;
 class SymbolTable;
 
-/// @brief Compile a program to LLVM IR, dump result to \param OS.
+/// @brief Compile a program to LLVM IR, optimize it with the passes that
+/// \param Options selects and dump result to \param OS.
 /// @return true if error happened.
-bool CompileToLLVMIR(ProgramAST *P, const SymbolTable &S, llvm::raw_ostream &OS);
+bool CompileToLLVMIR(ProgramAST *P, const SymbolTable &S, llvm::raw_ostream &OS,
+                     const OptimizationOptions &Options);
+
+/// @brief Compile a program to machine code with the JIT of LLVM and run
+/// its main function in process. The program reads stdin and writes stdout
+/// with the printf() and scanf() of the compiler. \param Options selects the
+/// passes and the level of code generation. The object code is cached in
+/// \param CacheDir, unless it is empty, by the hash of the optimized Module.
+/// If \param PrintCacheStats, whether the cache had it is told on stderr.
+/// @return true if error happened.
+bool RunWithLLVMJIT(ProgramAST *P, const SymbolTable &S,
+                    const OptimizationOptions &Options,
+                    const std::string &CacheDir, bool PrintCacheStats);
 } // namespace simplecc
 #endif // SIMPLECC_LLVM_LLVM_H
\ No newline at end of file
@@ -0,0 +1,71 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef SIMPLECC_LLVM_LLVMOBJECTCACHE_H
+#define SIMPLECC_LLVM_LLVMOBJECTCACHE_H
+#include <llvm/ExecutionEngine/ObjectCache.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <memory>
+#include <string>
+
+namespace simplecc {
+
+/// @brief LLVMObjectCache keeps the object files compiled by the JIT on disk,
+/// so that running the same program again skips the code generation.
+///
+/// An object is found by the identifier of its Module, which must be set to
+/// getModuleKey() before the Module is compiled.
+class LLVMObjectCache : public llvm::ObjectCache {
+public:
+  /// Keep the objects in the directory Dir. An empty Dir caches nothing.
+  explicit LLVMObjectCache(std::string Dir) : CacheDir(std::move(Dir)) {}
+
+  /// Return the default directory of the cache, or an empty string if the
+  /// user has none.
+  static std::string getDefaultDirectory();
+
+  /// @brief Return a key of M and the level of code generation, which is
+  /// the hash of the text of M. The data layout and the target triple of
+  /// M are part of its text.
+  static std::string getModuleKey(const llvm::Module &M, unsigned OptLevel);
+
+  /// Save the object compiled from M.
+  void notifyObjectCompiled(const llvm::Module *M,
+                            llvm::MemoryBufferRef Obj) override;
+
+  /// Return the object of M compiled before, or nullptr if there is none.
+  std::unique_ptr<llvm::MemoryBuffer> getObject(const llvm::Module *M) override;
+
+  /// Return the number of objects found in the cache.
+  unsigned getNumHits() const { return NumHits; }
+
+private:
+  /// Return the file of the object of M.
+  std::string getObjectPath(const llvm::Module *M) const;
+
+  std::string CacheDir;
+  unsigned NumHits = 0;
+};
+} // namespace simplecc
+#endif // SIMPLECC_LLVM_LLVMOBJECTCACHE_H
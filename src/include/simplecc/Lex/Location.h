@@ -49,6 +49,25 @@ public:
 };
 
 DEFINE_INLINE_OUTPUT_OPERATOR(Location)
+
+/// This class represents a range [Begin, End) in the source file.
+class SourceRange {
+  Location Begin;
+  Location End;
+
+public:
+  /// Construct an empty range at the beginning of the file.
+  SourceRange() = default;
+  /// Construct an empty range at a location.
+  SourceRange(Location L) : Begin(L), End(L) {}
+  SourceRange(Location B, Location E) : Begin(B), End(E) {}
+
+  /// Return the first location in the range.
+  Location getBegin() const { return Begin; }
+
+  /// Return the location past the end of the range.
+  Location getEnd() const { return End; }
+};
 } // namespace simplecc
 
 #endif // SIMPLECC_LEX_LOCATION_H
\ No newline at end of file
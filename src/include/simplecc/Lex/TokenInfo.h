@@ -43,6 +43,12 @@ public:
   /// Return the location this token was found.
   Location getLocation() const { return Loc; }
 
+  /// Return the range of source text this token spans.
+  SourceRange getRange() const {
+    return SourceRange(Loc,
+                       Location(Loc.getLine(), Loc.getColumn() + Str.size()));
+  }
+
   /// Return the string value of this token.
   /// Virtual tokens like ENDMARKER have an empty one.
   const std::string &getString() const { return Str; }
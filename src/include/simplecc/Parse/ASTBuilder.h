@@ -121,7 +121,7 @@ class ASTBuilder {
   ExprAST *visit_atom(Node *N, ExprContextKind Context);
 
   /// atom_trailer: '[' expr ']' | arglist
-  ExprAST *visit_atom_trailer(Node *N, const std::string &Name,
+  ExprAST *visit_atom_trailer(Node *N, Node *Name,
                               ExprContextKind Context);
 
   /// arglist: '(' expr (',' expr)* ')'
@@ -132,13 +132,18 @@ class ASTBuilder {
 
   /// Handle conversion from string to integer.
   /// If the resultant integer exceeds the range of int,
-  /// report error through EM.
-  int evaluate_integer(const std::string &Str, Location L);
+  /// report error at N through EM.
+  int evaluate_integer(const std::string &Str, const Node *N);
 public:
   /// Create an AST from the parse tree and the filename.
   /// On error, return nullptr and print an error.
   std::unique_ptr<ProgramAST, DeleteAST>
       Build(const std::string &Filename, const Node *N);
+
+  /// Create the DeclASTs of a single const_decl or declaration node and
+  /// append them to Decls.
+  /// On error, return true, leave Decls untouched and print an error.
+  bool BuildTopLevelDecl(const Node *N, std::vector<DeclAST *> &Decls);
 private:
   ErrorManager EM;
 };
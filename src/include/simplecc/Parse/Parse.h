@@ -40,5 +40,11 @@ BuildCST(const std::vector<TokenInfo> &TheTokens);
 std::unique_ptr<ProgramAST, DeleteAST>
 BuildAST(const std::string &Filename, const std::vector<TokenInfo> &TheTokens);
 
+/// Parse the tokens of a single top-level const_decl or declaration, which
+/// do not end with an ENDMARKER, and append the DeclASTs to Decls.
+/// Return true on error.
+bool BuildTopLevelDecl(const std::vector<TokenInfo> &TheTokens,
+                       std::vector<DeclAST *> &Decls);
+
 } // namespace simplecc
 #endif // SIMPLECC_PARSE_PARSE_H
\ No newline at end of file
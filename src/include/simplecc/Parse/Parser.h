@@ -89,6 +89,10 @@ class Parser {
 public:
   /// @brief Construct a Parser from a Grammar object.
   explicit Parser(const Grammar *G);
+
+  /// @brief Construct a Parser that parses a non-terminal other than the start
+  /// symbol of the Grammar.
+  Parser(const Grammar *G, Symbol Start);
   // TODO: cleanup the stack.
   ~Parser() = default;
 
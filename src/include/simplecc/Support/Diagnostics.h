@@ -0,0 +1,127 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef SIMPLECC_SUPPORT_DIAGNOSTICS_H
+#define SIMPLECC_SUPPORT_DIAGNOSTICS_H
+#include "simplecc/Lex/Location.h"
+#include <atomic>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace simplecc {
+/// @brief Diagnostic is a single error reported by some component.
+class Diagnostic {
+  std::string Type;
+  bool HasRange;
+  SourceRange Range;
+  std::string Message;
+
+public:
+  /// Construct a Diagnostic that refers to some source text.
+  Diagnostic(std::string Ty, SourceRange R, std::string Msg)
+      : Type(std::move(Ty)), HasRange(true), Range(R),
+        Message(std::move(Msg)) {}
+  /// Construct a Diagnostic about the input as a whole.
+  Diagnostic(std::string Ty, std::string Msg)
+      : Type(std::move(Ty)), HasRange(false), Message(std::move(Msg)) {}
+
+  /// Return the kind of error, such as "TypeError".
+  const std::string &getType() const { return Type; }
+  bool hasRange() const { return HasRange; }
+  SourceRange getRange() const { return Range; }
+  const std::string &getMessage() const { return Message; }
+
+  /// Format as "Type at Line:Column: Message".
+  void Format(std::ostream &O) const;
+  /// Format as a JSON object.
+  void FormatJSON(std::ostream &O) const;
+};
+
+DEFINE_INLINE_OUTPUT_OPERATOR(Diagnostic)
+
+/// @brief DiagnosticsEngine collects the diagnostics of all ErrorManagers of
+/// the process into a buffer and writes them to std::cerr in batches.
+///
+/// Once as many diagnostics as the error limit have been reported, the next
+/// one is dropped with a note saying so, and so are all later ones. From then
+/// on, components can ask hasReachedErrorLimit() to stop early. Diagnostics can be
+/// written as text or as a JSON array. All methods are thread-safe.
+class DiagnosticsEngine {
+public:
+  enum FormatKind { TextFormat, JSONFormat };
+
+  /// Return the engine of the process.
+  static DiagnosticsEngine &get();
+
+  /// Set the maximum number of diagnostics to report. 0 means no limit.
+  void setErrorLimit(unsigned N);
+  unsigned getErrorLimit() const { return ErrorLimit; }
+
+  void setFormat(FormatKind F);
+  FormatKind getFormat() const { return Format; }
+
+  /// Return if a diagnostic was dropped for the error limit, so that later
+  /// ones would be dropped as well.
+  bool hasReachedErrorLimit() const { return LimitReached && !Capturing; }
+
+  /// Buffer a diagnostic unless the error limit is reached.
+  void Report(Diagnostic D);
+
+  /// Write buffered text diagnostics to std::cerr. JSON diagnostics are kept
+  /// until finish().
+  void flush();
+
+  /// Write all buffered diagnostics and start counting anew. In JSON format,
+  /// this writes one array of all the diagnostics since the last finish().
+  void finish();
+
+  /// Divert later diagnostics into a separate buffer, where they are neither
+  /// counted nor limited, until endCapture(). Captures do not nest.
+  void beginCapture();
+  /// Stop diverting and return the diverted diagnostics.
+  std::vector<Diagnostic> endCapture();
+
+  /// Write buffered text diagnostics.
+  ~DiagnosticsEngine();
+
+private:
+  DiagnosticsEngine() = default;
+
+  /// Write buffered text diagnostics. Mutex must be held.
+  void flushText();
+
+  /// Text diagnostics are written once this many are buffered.
+  static constexpr unsigned MaxBuffered = 256;
+
+  mutable std::mutex Mutex;
+  std::vector<Diagnostic> Buffer;
+  std::vector<Diagnostic> Captured;
+  std::atomic<bool> Capturing{false};
+  unsigned NumReported = 0;
+  unsigned ErrorLimit = 0;
+  std::atomic<bool> LimitReached{false};
+  FormatKind Format = TextFormat;
+};
+} // namespace simplecc
+#endif // SIMPLECC_SUPPORT_DIAGNOSTICS_H
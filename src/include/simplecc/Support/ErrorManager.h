@@ -23,23 +23,42 @@
 #ifndef SIMPLECC_SUPPORT_ERRORMANAGER_H
 #define SIMPLECC_SUPPORT_ERRORMANAGER_H
 #include "simplecc/Lex/Location.h"
+#include "simplecc/Support/Diagnostics.h"
 #include "simplecc/Support/Print.h"
+#include <cassert>
 #include <iostream>
+#include <sstream>
+#include <string>
 #include <utility>
-#include <cassert>
 
 namespace simplecc {
 inline std::string Quote(const std::string &string) {
   return '\'' + string + '\'';
 }
 
-class ErrorManager : private Printer {
+/// @brief ErrorManager formats errors of a component and reports them to the
+/// DiagnosticsEngine. It counts the errors reported through itself so that the
+/// component can tell whether it failed.
+class ErrorManager {
   int ErrorCount = 0;
   const char *ErrorType;
 
+  /// Format the arguments separated by spaces.
+  template <typename... Args> static std::string FormatMessage(Args &&... args) {
+    std::ostringstream O;
+    Print(O, std::forward<Args>(args)...);
+    std::string Message = O.str();
+    Message.pop_back(); // the newline.
+    return Message;
+  }
+
 public:
-  ErrorManager(const char *ET = nullptr) : Printer(std::cerr) {
-    setErrorType(ET);
+  ErrorManager(const char *ET = nullptr) { setErrorType(ET); }
+
+  /// Write out what this reported.
+  ~ErrorManager() {
+    if (ErrorCount)
+      DiagnosticsEngine::get().flush();
   }
 
   void setErrorType(const char *ET) {
@@ -51,19 +70,28 @@ public:
     return ErrorType;
   }
 
-  /// TODO: these 2 overloads are too easy to be ambiguous.
-  template <typename... Args> void Error(Location loc, Args &&... args) {
-    getOuts() << getErrorType() << " at ";
-    loc.FormatCompact(getOuts());
-    getOuts() << " ";
-    WriteLine(std::forward<Args>(args)...);
+  /// TODO: these 3 overloads are too easy to be ambiguous.
+  template <typename... Args> void Error(SourceRange R, Args &&... args) {
     increaseErrorCount();
+    DiagnosticsEngine &Diags = DiagnosticsEngine::get();
+    /// Don't bother formatting what will be dropped.
+    if (Diags.hasReachedErrorLimit())
+      return;
+    Diags.Report(Diagnostic(getErrorType(), R,
+                            FormatMessage(std::forward<Args>(args)...)));
+  }
+
+  template <typename... Args> void Error(Location loc, Args &&... args) {
+    Error(SourceRange(loc), std::forward<Args>(args)...);
   }
 
   template <typename... Args> void Error(Args &&... args) {
-    getOuts() << getErrorType() << ": ";
-    WriteLine(std::forward<Args>(args)...);
     increaseErrorCount();
+    DiagnosticsEngine &Diags = DiagnosticsEngine::get();
+    if (Diags.hasReachedErrorLimit())
+      return;
+    Diags.Report(
+        Diagnostic(getErrorType(), FormatMessage(std::forward<Args>(args)...)));
   }
 
   void clear() { ErrorCount = 0; }
@@ -0,0 +1,157 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/// @file The counts of a profiling run and the file they are kept in.
+///
+/// A profile is a text file, a record per line:
+///
+///     simplecc-profile 1
+///     function <name> <entry count>
+///     bc <offset> <line> <count>
+///     block <begin> <end> <count>
+///     call <offset> <line> <callee> <count>
+///     end
+///
+/// The first line names the format and its version. Each function has a
+/// function record, then a bc record for each ByteCode, a block record for
+/// each basic block and a call record for each call, then an end record.
+/// Offsets are those of the optimized ByteCode that ran, and lines are the
+/// source lines of ByteCode::getSourceLineno(). The optimizations look the
+/// counts up by function and line, so that a profile still applies to code
+/// optimized differently.
+#ifndef SIMPLECC_SUPPORT_EXECUTIONPROFILE_H
+#define SIMPLECC_SUPPORT_EXECUTIONPROFILE_H
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace simplecc {
+
+/// @brief ExecutionProfile holds how many times each instruction, basic
+/// block and call of each function ran.
+class ExecutionProfile {
+public:
+  /// The count of the ByteCode at Offset.
+  struct InstructionCount {
+    unsigned Offset;
+    unsigned Lineno;
+    uint64_t Count;
+  };
+  /// The count of the basic block of the ByteCode's in [Begin, End).
+  struct BlockCount {
+    unsigned Begin;
+    unsigned End;
+    uint64_t Count;
+  };
+  /// The count of the call at Offset.
+  struct CallCount {
+    unsigned Offset;
+    unsigned Lineno;
+    std::string Callee;
+    uint64_t Count;
+  };
+
+  /// @brief FunctionProfile holds the counts of a function.
+  class FunctionProfile {
+  public:
+    explicit FunctionProfile(std::string Name, uint64_t EntryCount = 0)
+        : Name(std::move(Name)), EntryCount(EntryCount) {}
+
+    const std::string &getName() const { return Name; }
+    /// Return the number of times the function was called.
+    uint64_t getEntryCount() const { return EntryCount; }
+    /// Return the number of ByteCode's that ran in the function.
+    uint64_t getTotalCount() const;
+
+    const std::vector<InstructionCount> &getInstructions() const {
+      return Instructions;
+    }
+    const std::vector<BlockCount> &getBlocks() const { return Blocks; }
+    const std::vector<CallCount> &getCalls() const { return Calls; }
+
+    /// Return whether some ByteCode of Lineno ran or could have run.
+    bool hasLine(unsigned Lineno) const { return Lines.count(Lineno); }
+    /// Return the number of times the line Lineno was reached, the largest
+    /// count of its ByteCode's, or 0 if it has none.
+    uint64_t getLineCount(unsigned Lineno) const;
+    /// Return the lines and their counts in order.
+    const std::map<unsigned, uint64_t> &getLineCounts() const { return Lines; }
+
+    /// Find the count of the calls to Callee on the line Lineno. Return
+    /// false if there is no such call.
+    bool findCallCount(unsigned Lineno, const std::string &Callee,
+                       uint64_t &Count) const;
+
+    void addInstruction(unsigned Offset, unsigned Lineno, uint64_t Count);
+    void addBlock(unsigned Begin, unsigned End, uint64_t Count) {
+      Blocks.push_back(BlockCount{Begin, End, Count});
+    }
+    void addCall(unsigned Offset, unsigned Lineno, std::string Callee,
+                 uint64_t Count) {
+      Calls.push_back(CallCount{Offset, Lineno, std::move(Callee), Count});
+    }
+
+  private:
+    std::string Name;
+    uint64_t EntryCount;
+    std::vector<InstructionCount> Instructions;
+    std::vector<BlockCount> Blocks;
+    std::vector<CallCount> Calls;
+    /// The count of each line.
+    std::map<unsigned, uint64_t> Lines;
+  };
+
+  ExecutionProfile() = default;
+  ~ExecutionProfile() = default;
+
+  /// Add a function and return its profile.
+  FunctionProfile &addFunction(std::string Name, uint64_t EntryCount);
+  /// Return the profile of the function Name, or nullptr if it has none.
+  const FunctionProfile *getFunction(const std::string &Name) const;
+  const std::vector<FunctionProfile> &getFunctions() const { return Functions; }
+
+  /// Return the largest count of a call.
+  uint64_t getMaxCallCount() const;
+
+  /// The name and version of the format.
+  static constexpr const char *Magic = "simplecc-profile";
+  static constexpr unsigned Version = 1;
+
+  /// Write the profile to O in the format above.
+  void Write(std::ostream &O) const;
+  /// Read the profile in the file Filename, replacing what this held.
+  /// Return true on errors.
+  bool Read(const std::string &Filename);
+  /// Print a report of where the program spent its time.
+  void Print(std::ostream &O) const;
+
+private:
+  std::vector<FunctionProfile> Functions;
+  /// The index of each function in Functions.
+  std::map<std::string, unsigned> FunctionIndices;
+};
+} // namespace simplecc
+#endif // SIMPLECC_SUPPORT_EXECUTIONPROFILE_H
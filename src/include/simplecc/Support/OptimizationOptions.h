@@ -0,0 +1,62 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/// @file The options that select the optimization passes to run.
+#ifndef SIMPLECC_SUPPORT_OPTIMIZATIONOPTIONS_H
+#define SIMPLECC_SUPPORT_OPTIMIZATIONOPTIONS_H
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace simplecc {
+class ExecutionProfile;
+
+/// The options of TransformProgram(), OptimizeIR() and CompileToLLVMIR().
+struct OptimizationOptions {
+  /// The optimization level, from 0 (no passes) to 3.
+  unsigned OptLevel = 2;
+  /// Inline a call if its cost is at most this.
+  unsigned InlineThreshold = 25;
+  /// Unroll the loops by this factor. Less than 2 disables unrolling.
+  unsigned UnrollFactor = 4;
+  /// If not empty, run these passes in order instead of those of OptLevel.
+  /// See Passes.def for their names.
+  std::vector<std::string> Passes;
+  /// The counts of a profiling run, if any, which guide the inlining and the
+  /// layout of the blocks.
+  std::shared_ptr<const ExecutionProfile> Profile;
+
+  /// Return whether Passes, rather than OptLevel, selects the passes.
+  bool hasCustomPipeline() const { return !Passes.empty(); }
+
+  /// Return the default options of OptLevel.
+  static OptimizationOptions getDefault(unsigned OptLevel);
+};
+
+/// Return whether Name names a pass in Passes.def.
+bool IsKnownPass(const std::string &Name);
+
+/// Split a comma-separated list of pass names.
+std::vector<std::string> ParsePassList(const std::string &List);
+} // namespace simplecc
+#endif // SIMPLECC_SUPPORT_OPTIMIZATIONOPTIONS_H
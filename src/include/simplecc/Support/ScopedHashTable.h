@@ -0,0 +1,89 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef SIMPLECC_SUPPORT_SCOPEDHASHTABLE_H
+#define SIMPLECC_SUPPORT_SCOPEDHASHTABLE_H
+#include <cassert>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace simplecc {
+/// @brief ScopedHashTable is a hash map whose insertions are undone when the
+/// scope they were made in is popped. An insertion in an inner scope shadows
+/// the entry of an outer one until then. It suits walks over a tree, such as
+/// the dominator tree, where what is known in a node holds in its subtree.
+template <typename K, typename V, typename Hash = std::hash<K>>
+class ScopedHashTable {
+public:
+  ScopedHashTable() = default;
+  ~ScopedHashTable() = default;
+
+  void pushScope() { ScopeMarks.push_back(UndoLog.size()); }
+
+  void popScope() {
+    assert(!ScopeMarks.empty() && "No scope to pop");
+    for (auto Mark = ScopeMarks.back(); UndoLog.size() > Mark;) {
+      UndoEntry &E = UndoLog.back();
+      if (E.HadOld)
+        Map[E.Key] = std::move(E.Old);
+      else
+        Map.erase(E.Key);
+      UndoLog.pop_back();
+    }
+    ScopeMarks.pop_back();
+  }
+
+  /// Map Key to Val in the current scope.
+  void insert(const K &Key, V Val) {
+    assert(!ScopeMarks.empty() && "Insertion outside any scope");
+    auto Iter = Map.find(Key);
+    if (Iter == Map.end()) {
+      UndoLog.push_back(UndoEntry{Key, V(), false});
+      Map.emplace(Key, std::move(Val));
+      return;
+    }
+    UndoLog.push_back(UndoEntry{Key, std::move(Iter->second), true});
+    Iter->second = std::move(Val);
+  }
+
+  /// Return the innermost value of Key, or nullptr if there is none.
+  const V *lookup(const K &Key) const {
+    auto Iter = Map.find(Key);
+    return Iter == Map.end() ? nullptr : &Iter->second;
+  }
+
+private:
+  struct UndoEntry {
+    K Key;
+    V Old;
+    bool HadOld;
+  };
+
+  std::unordered_map<K, V, Hash> Map;
+  std::vector<UndoEntry> UndoLog;
+  /// The size of UndoLog when each scope was pushed.
+  std::vector<size_t> ScopeMarks;
+};
+} // namespace simplecc
+#endif // SIMPLECC_SUPPORT_SCOPEDHASHTABLE_H
@@ -23,6 +23,7 @@
 #ifndef SIMPLECC_TARGET_BYTECODETOMIPSTRANSLATOR_H
 #define SIMPLECC_TARGET_BYTECODETOMIPSTRANSLATOR_H
 #include "simplecc/CodeGen/ByteCodeVisitor.h"
+#include "simplecc/CodeGen/SuperInstruction.h"
 #include "simplecc/Support/Print.h"
 #include "simplecc/Target/MipsSupport.h"
 #include <iostream>
@@ -61,6 +62,13 @@ class ByteCodeToMipsTranslator : ByteCodeVisitor<ByteCodeToMipsTranslator> {
   void visitUnaryPositive(const ByteCode &C) {}
   void visitUnaryNegative(const ByteCode &C);
 
+  /// Operators with a constant operand, which work on TOS in place.
+  void visitShift(const char *Op, const ByteCode &C);
+  void visitShiftLeft(const ByteCode &C) { visitShift("sll", C); }
+  void visitShiftRight(const ByteCode &C) { visitShift("sra", C); }
+  void visitShiftRightLogical(const ByteCode &C) { visitShift("srl", C); }
+  void visitMultiplyHigh(const ByteCode &C);
+
   /// Call and Return.
   void visitCallFunction(const ByteCode &C);
   void visitReturn();
@@ -98,6 +106,20 @@ class ByteCodeToMipsTranslator : ByteCodeVisitor<ByteCodeToMipsTranslator> {
 
   void visitPopTop(const ByteCode &C) { POP(); }
 
+  /// SuperInstruction's, which keep their operands in registers.
+  void visitIncLocal(const SuperInstruction &SI);
+  void visitLoadLocalAddConst(const SuperInstruction &SI);
+  void visitMoveLocal(const SuperInstruction &SI);
+  void visitStoreLocalConst(const SuperInstruction &SI);
+  void visitAddConst(const SuperInstruction &SI);
+  void visitAddLocal(const SuperInstruction &SI);
+  void visitSubLocal(const SuperInstruction &SI);
+  void visitCompareLocalConst(const SuperInstruction &SI);
+  void visitCompareLocals(const SuperInstruction &SI);
+
+  /// Add K to $t0.
+  void WriteAddImmediate(int K);
+
   /// Forward WriteLine() to ThePrinter.
   template <typename... Args> void WriteLine(Args &&... Arguments) {
     ThePrinter.WriteLine(std::forward<Args>(Arguments)...);
@@ -112,6 +134,9 @@ public:
   /// generation.
   void Write(const ByteCode &C);
 
+  /// Write a SuperInstruction, the first ByteCode of which is C.
+  void Write(const ByteCode &C, const SuperInstruction &SI);
+
 private:
   friend ByteCodeVisitor;
   Printer ThePrinter;
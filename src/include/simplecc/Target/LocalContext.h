@@ -22,9 +22,11 @@
 
 #ifndef SIMPLECC_TARGET_LOCALCONTEXT_H
 #define SIMPLECC_TARGET_LOCALCONTEXT_H
-#include <unordered_map>
-#include <unordered_set>
+#include "simplecc/CodeGen/ByteCodeCFG.h"
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace simplecc {
 class ByteCodeFunction;
@@ -32,25 +34,20 @@ class ByteCodeFunction;
 /// This class provides local information for ByteCodeToMipsTranslator
 class LocalContext {
 
-  /// Initialize the **local offset** dictionary for a function.
-  /// The LocalOffsets is where local variables live on the stack.
+  /// Initialize the **local offset** table for a function.
+  /// The LocalOffsets is where local variables live on the stack,
+  /// indexed by local slot. Temporaries are laid out after them.
   void InitializeLocalOffsets();
 
-  /// Initialize the **jump targets** set, which tells us whether an offset
-  /// in the ByteCode stream is a target of some jump command.
-  void InitializeJumpTargets();
-
 public:
   LocalContext() = default;
   ~LocalContext() = default;
 
-  /// Initialize both LocalOffsets and JumpTargets.
+  /// Initialize both LocalOffsets and the CFG.
   void Initialize(const ByteCodeFunction &F);
 
   /// Return if an offset is a jump target.
-  bool IsJumpTarget(unsigned Off) const {
-    return JumpTargets.find(Off) != JumpTargets.end();
-  }
+  bool IsJumpTarget(unsigned Off) const { return CFG.IsJumpTarget(Off); }
 
   /// Return the offset of local name related to frame pointer.
   signed int getLocalOffset(const char *Name) const;
@@ -61,12 +58,19 @@ public:
   /// Return whether a name is an array.
   bool IsArray(const char *Name) const;
 
+  /// Return the number of bytes taken by formal arguments and local objects.
+  unsigned getLocalObjectsInBytes() const { return LocalObjectsInBytes; }
+
   /// Return the name of the function being translated.
   const std::string &getFuncName() const;
 
 private:
-  std::unordered_map<std::string, signed> LocalOffsets;
-  std::unordered_set<unsigned> JumpTargets;
+  std::vector<signed> LocalOffsets;
+  /// Offsets of temporaries and whether they are arrays, by name.
+  std::unordered_map<std::string, std::pair<signed, bool>> TemporaryOffsets;
+  unsigned LocalObjectsInBytes = 0;
+  /// The blocks of the function, which tell the jump targets.
+  ByteCodeCFG CFG;
   const ByteCodeFunction *TheFunction = nullptr;
 };
 
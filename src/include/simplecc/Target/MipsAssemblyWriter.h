@@ -22,6 +22,7 @@
 
 #ifndef SIMPLECC_TARGET_MIPSASSEMBLYWRITER_H
 #define SIMPLECC_TARGET_MIPSASSEMBLYWRITER_H
+#include "simplecc/CodeGen/CallGraph.h"
 #include "simplecc/Support/Print.h"
 #include "simplecc/Target/LocalContext.h"
 #include <iostream>
@@ -37,7 +38,10 @@ class MipsAssemblyWriter {
 
   /// Write data segment -- strings, arrays and variables.
   void WriteData(Printer &W, const ByteCodeModule &Module);
-  /// Write text segment -- the bundle of functions.
+  /// Return if TheFunction calls no function, so $ra needs no saving.
+  bool isLeaf(const ByteCodeFunction &TheFunction) const;
+
+  /// Write text segment -- the bundle of functions reachable from main.
   void WriteText(Printer &W, const ByteCodeModule &Module);
   /// Write prologue for TheFunction.
   void WritePrologue(Printer &W, const ByteCodeFunction &TheFunction);
@@ -55,6 +59,7 @@ public:
 
 private:
   LocalContext TheContext;
+  CallGraph TheCallGraph;
 };
 
 } // namespace simplecc
@@ -0,0 +1,75 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef SIMPLECC_TRANSFORM_DEADSTOREELIMINATOR_H
+#define SIMPLECC_TRANSFORM_DEADSTOREELIMINATOR_H
+#include "simplecc/AST/AST.h"
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace simplecc {
+/// This class deletes the assignments to local variables whose value is never
+/// read, and then the declarations of the local variables that are no longer
+/// used, so that they take no stack slot. It performs these operations:
+/// 1. Compute the live local variables backward over each stmt list. A
+/// variable that is assigned is live only if its value may be read later, and
+/// an assignment to a variable that is not live reads nothing, so a chain of
+/// useless assignments goes at once. Loops are iterated to a fixed point.
+/// 2. Delete an assignment to a variable that is not live, unless its value
+/// calls a function or may stop with a runtime error, i.e., divides by
+/// anything but a non-zero constant or subscripts an array. The initial and
+/// step of a for-stmt are kept.
+/// 3. Delete the VarDecl of a scalar that no stmt names any more.
+/// Globals and arrays are left alone, as a call or an index may reach them.
+class DeadStoreEliminator {
+  using StmtListType = std::vector<StmtAST *>;
+  using LiveSetType = std::unordered_set<std::string>;
+
+  /// Return the live variables before StmtList given those after it. If
+  /// Delete is true, delete the dead assignments on the way.
+  LiveSetType visitStmtList(StmtListType &StmtList, LiveSetType Live,
+                            bool Delete);
+  LiveSetType visitStmt(StmtAST *S, LiveSetType Live, bool Delete);
+  LiveSetType visitFor(ForStmt *F, const LiveSetType &Live, bool Delete);
+  LiveSetType visitWhile(WhileStmt *W, const LiveSetType &Live, bool Delete);
+  /// Update Live for the initial or step of a for-stmt, which is kept.
+  void visitKeptAssign(StmtAST *S, LiveSetType &Live);
+  /// Return if S assigns a value that has no side effect and cannot fail to a
+  /// dead variable.
+  bool isDeadStore(StmtAST *S, const LiveSetType &Live) const;
+  /// Add the local variables that E reads to Live.
+  void addUses(ExprAST *E, LiveSetType &Live) const;
+  void removeUnusedVarDecls(FuncDef *FD);
+  void visitFuncDef(FuncDef *FD);
+
+public:
+  DeadStoreEliminator() = default;
+  void Transform(ProgramAST *P);
+
+private:
+  /// The scalar arguments and variables of the current function.
+  std::unordered_set<std::string> Locals;
+};
+} // namespace simplecc
+#endif // SIMPLECC_TRANSFORM_DEADSTOREELIMINATOR_H
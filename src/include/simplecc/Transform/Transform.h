@@ -26,12 +26,14 @@
 /// rather than Analysis.
 #ifndef SIMPLECC_TRANSFORM_TRANSFORM_H
 #define SIMPLECC_TRANSFORM_TRANSFORM_H
+#include "simplecc/Support/OptimizationOptions.h"
 
 namespace simplecc {
 class ProgramAST;
 class SymbolTable;
 
-/// This function performs all the transformations on the AST.
-void TransformProgram(ProgramAST *P, SymbolTable &S);
+/// This function performs the transformations on the AST that Options selects.
+void TransformProgram(ProgramAST *P, SymbolTable &S,
+                      const OptimizationOptions &Options);
 } // namespace simplecc
 #endif // SIMPLECC_TRANSFORM_TRANSFORM_H
\ No newline at end of file
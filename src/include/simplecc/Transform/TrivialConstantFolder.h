@@ -34,6 +34,10 @@ class TrivialConstantFolder : ExpressionTransformer<TrivialConstantFolder> {
 #define HANDLE_CONST_FOLD(Class) ExprAST *Fold##Class(Class *E);
 #include "simplecc/Transform/TrivialConstantFolder.def"
   ExprAST *FoldExprAST(ExprAST *E);
+  /// Return E to replace an int expression at Loc. Since a char is an int
+  /// only in parentheses, a char constant becomes a NumExpr and any other
+  /// char is put in a ParenExpr.
+  ExprAST *KeepInt(ExprAST *E, Location Loc);
   ExprAST *TransformExpr(ExprAST *E, AST *Parent);
 
 public:
@@ -0,0 +1,93 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef SIMPLECC_VM_INTERPRETER_H
+#define SIMPLECC_VM_INTERPRETER_H
+#include "simplecc/CodeGen/EncodedModule.h"
+#include "simplecc/Support/ErrorManager.h"
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace simplecc {
+class ByteCodeModule;
+class ExecutionProfile;
+
+/// @brief Interpreter executes a ByteCodeModule without leaving the process.
+///
+/// It runs the EncodedModule lowered from the ByteCodeModule, whose operands
+/// are already numbers: the slot of a local, the address of a global, the
+/// index of a callee. Globals, frames and the operand stack share one array
+/// of words, and an address is an index into it. The arguments a caller
+/// pushes become the first slots of the frame of its callee, so a call moves
+/// no data. The locals follow the arguments and the operand stack follows
+/// the locals.
+///
+/// When the compiler supports labels as values, the instructions are
+/// dispatched by jumping from one handler right to the next one, which
+/// predicts much better than a single switch.
+///
+/// When profiling, each instruction counts how many times it ran. Super
+/// instructions are not fused then, so that each count is that of one
+/// ByteCode.
+class Interpreter {
+public:
+  Interpreter() = default;
+  ~Interpreter() = default;
+
+  /// Run the main function of M. Return true if a runtime error happened.
+  bool Run(const ByteCodeModule &M, std::istream &IS, std::ostream &OS);
+  /// Run the main function of EM. Return true if a runtime error happened.
+  bool Run(const EncodedModule &EM, std::istream &IS, std::ostream &OS);
+  /// Run the main function of M and fill P with the counts of the run.
+  /// Return true if a runtime error happened, after which P holds the counts
+  /// up to the error.
+  bool Profile(const ByteCodeModule &M, std::istream &IS, std::ostream &OS,
+               ExecutionProfile &P);
+
+  /// Number of words of the memory, which holds the globals and the stack.
+  static constexpr unsigned MemorySize = 1u << 21;
+  /// Maximal depth of calls.
+  static constexpr unsigned MaxCallDepth = 1u << 16;
+
+  /// Read an integer, or 0 if there is none, leaving the input in a state to
+  /// read what follows.
+  static int ReadInteger(std::istream &IS);
+  /// Read a character after the blanks as scanf(" %c") does, or 0 at the end.
+  static int ReadCharacter(std::istream &IS);
+
+private:
+  /// Run the code from the function at index Main, counting each
+  /// instruction in Counts if Profiling.
+  template <bool Profiling>
+  bool Execute(unsigned Main, std::istream &IS, std::ostream &OS);
+  /// Report a runtime error at the instruction at Offset in F.
+  void Error(const EncodedFunction &F, unsigned Offset, const char *Msg);
+
+  const EncodedModule *TheModule = nullptr;
+  /// The count of the instruction at each offset of each function.
+  std::vector<std::vector<uint64_t>> Counts;
+  ErrorManager EM{"RuntimeError"};
+};
+} // namespace simplecc
+#endif // SIMPLECC_VM_INTERPRETER_H
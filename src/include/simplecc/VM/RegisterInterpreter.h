@@ -0,0 +1,60 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef SIMPLECC_VM_REGISTERINTERPRETER_H
+#define SIMPLECC_VM_REGISTERINTERPRETER_H
+#include "simplecc/CodeGen/RegisterByteCode.h"
+#include "simplecc/Support/ErrorManager.h"
+#include <iostream>
+
+namespace simplecc {
+class ByteCodeModule;
+
+/// @brief RegisterInterpreter executes a RegisterModule without leaving the
+/// process. Its memory is that of Interpreter: the globals, then the frames,
+/// each of which is the registers of its function. The arguments of a call
+/// are the registers of the caller the callee's frame starts from, so a call
+/// moves no data, and the value returned is written to the first of them.
+/// A program behaves as it does under Interpreter, runtime errors included.
+class RegisterInterpreter {
+public:
+  RegisterInterpreter() = default;
+  ~RegisterInterpreter() = default;
+
+  /// Run the main function of M. Return true if a runtime error happened.
+  bool Run(const ByteCodeModule &M, std::istream &IS, std::ostream &OS);
+  /// Run the main function of RM. Return true if a runtime error happened.
+  bool Run(const RegisterModule &RM, std::istream &IS, std::ostream &OS);
+
+private:
+  /// Run the code from the function at index Main.
+  bool Execute(unsigned Main, std::istream &IS, std::ostream &OS);
+  /// Report a runtime error at the instruction I, naming the function its
+  /// source line is in.
+  void Error(const RegisterInstruction &I, const char *Msg);
+
+  const RegisterModule *TheModule = nullptr;
+  ErrorManager EM{"RuntimeError"};
+};
+} // namespace simplecc
+#endif // SIMPLECC_VM_REGISTERINTERPRETER_H
@@ -0,0 +1,102 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef SIMPLECC_VM_TEMPLATEJIT_H
+#define SIMPLECC_VM_TEMPLATEJIT_H
+#include "simplecc/CodeGen/EncodedModule.h"
+#include "simplecc/Support/ErrorManager.h"
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+namespace simplecc {
+class ByteCodeModule;
+
+/// @brief TemplateJIT compiles an EncodedModule to x86-64 machine code and
+/// runs it in process.
+///
+/// Each instruction is translated on its own by a fixed template, so the
+/// code is only as good as the byte code, but no instruction is dispatched
+/// any more. The memory is laid out as the Interpreter lays it out: globals,
+/// frames and the operand stack share one array of words, and an address is
+/// an index into it. The top of the operand stack is cached in a register,
+/// which saves a store and a load for most instructions. A compiled function
+/// is called by a native call, and READ and PRINT call back into C++.
+///
+/// The JIT needs an x86-64 host with the System V calling convention. On any
+/// other host, or if no executable memory can be had, the Interpreter runs
+/// the module instead.
+class TemplateJIT {
+public:
+  TemplateJIT() = default;
+  ~TemplateJIT();
+  TemplateJIT(const TemplateJIT &) = delete;
+  TemplateJIT &operator=(const TemplateJIT &) = delete;
+
+  /// Return true if the JIT can run on this host.
+  static bool isSupported();
+
+  /// Compile and run the main function of M. Return true if a runtime error
+  /// happened.
+  bool Run(const ByteCodeModule &M, std::istream &IS, std::ostream &OS);
+  /// Compile and run the main function of EM. Return true if a runtime error
+  /// happened.
+  bool Run(const EncodedModule &EM, std::istream &IS, std::ostream &OS);
+
+  /// The state of a run the compiled code reaches through a register.
+  struct Context;
+
+private:
+  /// Compile every function of TheModule into executable memory. Return
+  /// false if there is no executable memory.
+  bool Compile();
+  /// Emit the code that enters and leaves the compiled code.
+  void compileEntry(std::vector<uint8_t> &Buffer);
+  /// Emit the code of the function at index F.
+  void compileFunction(unsigned F, std::vector<uint8_t> &Buffer);
+  /// Release the executable memory.
+  void releaseCode();
+
+  /// Report a runtime error at the instruction at Offset in F.
+  void Error(const EncodedFunction &F, unsigned Offset, const char *Msg);
+  /// Report a runtime error of the run of C, called by the compiled code.
+  static void ErrorHelper(Context *C, const EncodedFunction *F,
+                          unsigned Offset, const char *Msg);
+
+  const EncodedModule *TheModule = nullptr;
+  /// The executable memory and its size.
+  uint8_t *Code = nullptr;
+  size_t CodeSize = 0;
+  /// The offset in Code of the entry of each function.
+  std::vector<size_t> FunctionEntries;
+  /// The calls to patch once every function has its entry, and the index of
+  /// the callee.
+  std::vector<std::pair<size_t, unsigned>> Calls;
+  /// The offset in Code of the code that leaves on a runtime error.
+  size_t ErrorExit = 0;
+  ErrorManager EM{"RuntimeError"};
+};
+} // namespace simplecc
+#endif // SIMPLECC_VM_TEMPLATEJIT_H
@@ -0,0 +1,61 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/// @file External interface of the VM module.
+#ifndef SIMPLECC_VM_VM_H
+#define SIMPLECC_VM_VM_H
+#include <iostream>
+
+namespace simplecc {
+class ByteCodeModule;
+class EncodedModule;
+class ExecutionProfile;
+
+/// This function runs the main function of a ByteCodeModule in process,
+/// reading the input of the program from IS and writing its output to OS.
+/// Return true if a runtime error happened.
+bool RunByteCode(const ByteCodeModule &M, std::istream &IS, std::ostream &OS);
+
+/// Likewise, but run an EncodedModule, such as one read from a .c0bc file.
+bool RunEncodedModule(const EncodedModule &M, std::istream &IS,
+                      std::ostream &OS);
+
+/// This function compiles a ByteCodeModule to machine code and runs its main
+/// function in process, like RunByteCode. Where the host is not x86-64, the
+/// byte code is interpreted instead. Return true if a runtime error happened.
+bool RunByteCodeJIT(const ByteCodeModule &M, std::istream &IS,
+                    std::ostream &OS);
+
+/// This function translates a ByteCodeModule to the instructions of a
+/// register machine and runs its main function, like RunByteCode. Return true
+/// if a runtime error happened.
+bool RunRegisterByteCode(const ByteCodeModule &M, std::istream &IS,
+                         std::ostream &OS);
+
+/// This function interprets a ByteCodeModule like RunByteCode and fills P
+/// with how many times each of its ByteCode's, blocks and calls ran.
+/// Return true if a runtime error happened.
+bool ProfileByteCode(const ByteCodeModule &M, std::istream &IS,
+                     std::ostream &OS, ExecutionProfile &P);
+} // namespace simplecc
+#endif // SIMPLECC_VM_VM_H
@@ -98,6 +98,14 @@ bool ASTVerifier::Check(ProgramAST *P) {
   return !EM.IsOk();
 }
 
+bool ASTVerifier::Check(DeclAST *D) {
+  EM.setErrorType("InternalError");
+  AssertThat(!IsInstance<ArgDecl>(D),
+             "ArgDecl cannot appear in Decls of ProgramAST");
+  visitDecl(D);
+  return !EM.IsOk();
+}
+
 void ASTVerifier::AssertThat(bool Predicate, const char *ErrMsg) {
   if (Predicate)
     return;
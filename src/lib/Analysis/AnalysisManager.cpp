@@ -47,9 +47,11 @@ bool AnalysisManager::runAllAnalyses(ProgramAST *P) {
     return true;
   }
 
-  if (ArrayBoundChecker().Check(P, TheTable)) {
+  ArrayBoundChecker ABC;
+  if (ABC.Check(P, TheTable)) {
     return true;
   }
+  ProvenInBounds = std::move(ABC.getProvenInBounds());
 
   if (ASTVerifier().Check(P)) {
     PrintErrs("ProgramAST should be well-formed after all analyses run!");
@@ -100,7 +100,9 @@ ExprAST *ImplicitCallTransformer::TransformExpr(ExprAST *E) {
   if (!TheLocalTable[N->getName()].IsFunction()) {
     return E;
   }
-  return new CallExpr(N->getName(), {}, E->getLocation());
+  auto C = new CallExpr(N->getName(), {}, E->getLocation());
+  C->setEndLocation(E->getEndLocation());
+  return C;
 }
 
 /// Perform implicit call transform on the program using a SymbolTable.
@@ -110,6 +112,12 @@ void ImplicitCallTransformer::Transform(ProgramAST *P, const SymbolTable &S) {
   visitProgram(P);
 }
 
+void ImplicitCallTransformer::Transform(FuncDef *FD, const SymbolTable &S) {
+  assert(FD);
+  setTable(&S);
+  visitFuncDef(FD);
+}
+
 void ImplicitCallTransformer::visitBoolOp(BoolOpExpr *B) {
   B->setValue(TransformExpr(B->getValue()));
 }
@@ -0,0 +1,173 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "simplecc/Analysis/Interval.h"
+#include <algorithm> // min(), max()
+#include <climits>
+
+using namespace simplecc;
+
+constexpr int64_t Interval::NegInf;
+constexpr int64_t Interval::PosInf;
+
+namespace {
+/// Return if a bound is infinite.
+inline bool IsInf(int64_t B) {
+  return B == Interval::NegInf || B == Interval::PosInf;
+}
+
+/// Add two bounds on the same side.
+inline int64_t AddBound(int64_t A, int64_t B) {
+  if (IsInf(A))
+    return A;
+  if (IsInf(B))
+    return B;
+  return A + B;
+}
+
+/// Negate a bound.
+inline int64_t NegateBound(int64_t B) {
+  if (B == Interval::NegInf)
+    return Interval::PosInf;
+  if (B == Interval::PosInf)
+    return Interval::NegInf;
+  return -B;
+}
+
+/// Multiply two bounds. Zero times infinity is zero since the infinity
+/// stands for a finite value.
+inline int64_t MultiplyBound(int64_t A, int64_t B) {
+  if (A == 0 || B == 0)
+    return 0;
+  if (IsInf(A) || IsInf(B))
+    return (A < 0) == (B < 0) ? Interval::PosInf : Interval::NegInf;
+  return A * B;
+}
+
+/// Divide two bounds, B being nonzero.
+inline int64_t DivideBound(int64_t A, int64_t B) {
+  if (IsInf(B))
+    return IsInf(A) ? ((A < 0) == (B < 0) ? 1 : -1) : 0;
+  if (IsInf(A))
+    return (A < 0) == (B < 0) ? Interval::PosInf : Interval::NegInf;
+  return A / B;
+}
+} // namespace
+
+Interval Interval::Normalize(int64_t L, int64_t U) {
+  if (L > U)
+    return getEmpty();
+  /// The whole range wraps around.
+  if ((!IsInf(L) && L > INT_MAX) || (!IsInf(U) && U < INT_MIN))
+    return getFull();
+  if (L < INT_MIN)
+    L = NegInf;
+  if (U > INT_MAX)
+    U = PosInf;
+  return Interval(L, U);
+}
+
+bool Interval::contains(const Interval &I) const {
+  return I.isEmpty() || (Lower <= I.Lower && I.Upper <= Upper);
+}
+
+Interval Interval::join(const Interval &I) const {
+  if (isEmpty())
+    return I;
+  if (I.isEmpty())
+    return *this;
+  return Interval(std::min(Lower, I.Lower), std::max(Upper, I.Upper));
+}
+
+Interval Interval::meet(const Interval &I) const {
+  if (isEmpty() || I.isEmpty())
+    return getEmpty();
+  Interval Result(std::max(Lower, I.Lower), std::min(Upper, I.Upper));
+  return Result.isEmpty() ? getEmpty() : Result;
+}
+
+Interval Interval::widen(const Interval &I) const {
+  if (isEmpty())
+    return I;
+  if (I.isEmpty())
+    return *this;
+  return Interval(I.Lower < Lower ? NegInf : Lower,
+                  I.Upper > Upper ? PosInf : Upper);
+}
+
+Interval Interval::operator-() const {
+  if (isEmpty())
+    return *this;
+  return Normalize(NegateBound(Upper), NegateBound(Lower));
+}
+
+Interval Interval::operator+(const Interval &I) const {
+  if (isEmpty() || I.isEmpty())
+    return getEmpty();
+  return Normalize(AddBound(Lower, I.Lower), AddBound(Upper, I.Upper));
+}
+
+Interval Interval::operator-(const Interval &I) const { return *this + -I; }
+
+Interval Interval::operator*(const Interval &I) const {
+  if (isEmpty() || I.isEmpty())
+    return getEmpty();
+  int64_t Corners[] = {
+      MultiplyBound(Lower, I.Lower), MultiplyBound(Lower, I.Upper),
+      MultiplyBound(Upper, I.Lower), MultiplyBound(Upper, I.Upper)};
+  return Normalize(*std::min_element(std::begin(Corners), std::end(Corners)),
+                   *std::max_element(std::begin(Corners), std::end(Corners)));
+}
+
+Interval Interval::operator/(const Interval &I) const {
+  if (isEmpty() || I.isEmpty())
+    return getEmpty();
+  if (I.contains(0))
+    return getFull();
+  int64_t Corners[] = {
+      DivideBound(Lower, I.Lower), DivideBound(Lower, I.Upper),
+      DivideBound(Upper, I.Lower), DivideBound(Upper, I.Upper)};
+  return Normalize(*std::min_element(std::begin(Corners), std::end(Corners)),
+                   *std::max_element(std::begin(Corners), std::end(Corners)));
+}
+
+void Interval::Format(std::ostream &O) const {
+  if (isEmpty()) {
+    O << "[]";
+    return;
+  }
+  if (isConstant()) {
+    O << Lower;
+    return;
+  }
+  O << "[";
+  if (Lower == NegInf)
+    O << "-inf";
+  else
+    O << Lower;
+  O << ", ";
+  if (Upper == PosInf)
+    O << "+inf";
+  else
+    O << Upper;
+  O << "]";
+}
@@ -21,40 +21,249 @@
 // SOFTWARE.
 
 #include "simplecc/Analysis/SymbolTable.h"
+#include <functional> // hash
 
 using namespace simplecc;
 
+namespace {
+/// Initial number of buckets of both hashes. Must be a power of 2.
+constexpr unsigned InitialBuckets = 64;
+
+/// Mix a (Scope, NameID) pair into a hash value.
+inline unsigned hashSlotKey(unsigned Scope, NameID Name) {
+  unsigned H = Scope * 0x9E3779B1U ^ Name;
+  H ^= H >> 16;
+  H *= 0x85EBCA6BU;
+  H ^= H >> 13;
+  return H;
+}
+} // namespace
+
 void SymbolTable::Format(std::ostream &O) const {
   O << "Global:\n";
-  for (const auto &Pair : GlobalTable) {
-    O << "  " << Pair.first << ": " << Pair.second << "\n";
+  for (const SymbolEntry &E : GlobalEntries) {
+    O << "  " << E.getName() << ": " << E << "\n";
   }
   O << "\n";
-  for (const auto &Pair : LocalTables) {
-    O << "Local(" << Pair.first->getName() << "):\n";
-    for (const auto &Item : Pair.second) {
-      O << "  " << Item.first << ": " << Item.second << "\n";
+  for (const FunctionSlice &F : Functions) {
+    O << "Local(" << F.TheFuncDef->getName() << "):\n";
+    for (unsigned I = F.Begin; I < F.End; ++I) {
+      const SymbolEntry &E = LocalEntries[I];
+      O << "  " << E.getName() << ": " << E << "\n";
     }
     O << "\n";
   }
 }
 
 void SymbolTable::clear() {
-  GlobalTable.clear();
-  LocalTables.clear();
+  Names.clear();
+  NameBuckets.clear();
+  SlotBuckets.clear();
+  NumSlotBuckets = 0;
+  GlobalEntries.clear();
+  LocalEntries.clear();
+  Functions.clear();
+  FunctionIndices.clear();
+  NumRetiredLocals = 0;
+}
+
+int SymbolTable::findName(const std::string &Name) const {
+  if (NameBuckets.empty())
+    return -1;
+  unsigned Mask = NameBuckets.size() - 1;
+  for (unsigned I = std::hash<std::string>()(Name) & Mask;; I = (I + 1) & Mask) {
+    unsigned ID = NameBuckets[I];
+    if (ID == 0)
+      return -1;
+    if (Names[ID - 1] == Name)
+      return ID - 1;
+  }
+}
+
+NameID SymbolTable::intern(const std::string &Name) {
+  int Found = findName(Name);
+  if (Found >= 0)
+    return Found;
+
+  /// Keep the load factor under 1/2.
+  if (2 * (Names.size() + 1) > NameBuckets.size()) {
+    std::vector<unsigned> Old(std::move(NameBuckets));
+    NameBuckets.assign(Old.empty() ? InitialBuckets : 2 * Old.size(), 0);
+    unsigned Mask = NameBuckets.size() - 1;
+    for (unsigned ID : Old) {
+      if (ID == 0)
+        continue;
+      unsigned I = std::hash<std::string>()(Names[ID - 1]) & Mask;
+      while (NameBuckets[I])
+        I = (I + 1) & Mask;
+      NameBuckets[I] = ID;
+    }
+  }
+
+  Names.push_back(Name);
+  unsigned Mask = NameBuckets.size() - 1;
+  unsigned I = std::hash<std::string>()(Name) & Mask;
+  while (NameBuckets[I])
+    I = (I + 1) & Mask;
+  NameBuckets[I] = Names.size();
+  return Names.size() - 1;
+}
+
+int SymbolTable::findSlot(unsigned Scope, NameID Name) const {
+  if (SlotBuckets.empty())
+    return -1;
+  unsigned Mask = SlotBuckets.size() - 1;
+  for (unsigned I = hashSlotKey(Scope, Name) & Mask;; I = (I + 1) & Mask) {
+    const SlotBucket &B = SlotBuckets[I];
+    if (B.Scope == EmptyScope)
+      return -1;
+    if (B.Scope == Scope && B.Name == Name)
+      return B.Slot;
+  }
+}
+
+void SymbolTable::insertSlot(unsigned Scope, NameID Name, unsigned Slot) {
+  assert(findSlot(Scope, Name) < 0 && "Slot already defined");
+  /// Keep the load factor under 1/2.
+  if (2 * (NumSlotBuckets + 1) > SlotBuckets.size()) {
+    std::vector<SlotBucket> Old(std::move(SlotBuckets));
+    SlotBuckets.assign(Old.empty() ? InitialBuckets : 2 * Old.size(),
+                       SlotBucket{EmptyScope, 0, 0});
+    NumSlotBuckets = 0;
+    for (const SlotBucket &B : Old) {
+      if (B.Scope != EmptyScope)
+        insertSlot(B.Scope, B.Name, B.Slot);
+    }
+  }
+
+  unsigned Mask = SlotBuckets.size() - 1;
+  unsigned I = hashSlotKey(Scope, Name) & Mask;
+  while (SlotBuckets[I].Scope != EmptyScope)
+    I = (I + 1) & Mask;
+  SlotBuckets[I] = SlotBucket{Scope, Name, Slot};
+  ++NumSlotBuckets;
+}
+
+const SymbolEntry *SymbolTable::lookupLocal(unsigned FuncIndex,
+                                            const std::string &Name) const {
+  int ID = findName(Name);
+  if (ID < 0)
+    return nullptr;
+  int Slot = findSlot(FuncIndex + 1, ID);
+  if (Slot < 0)
+    return nullptr;
+  return &LocalEntries[Functions[FuncIndex].Begin + Slot];
+}
+
+const SymbolEntry *SymbolTable::lookupGlobal(const std::string &Name,
+                                             unsigned NumVisible) const {
+  int ID = findName(Name);
+  if (ID < 0)
+    return nullptr;
+  int Slot = findSlot(0, ID);
+  if (Slot < 0 || unsigned(Slot) >= NumVisible)
+    return nullptr;
+  return &GlobalEntries[Slot];
+}
+
+const SymbolEntry *SymbolTable::lookup(unsigned FuncIndex,
+                                       const std::string &Name) const {
+  int ID = findName(Name);
+  if (ID < 0)
+    return nullptr;
+  const FunctionSlice &F = Functions[FuncIndex];
+  int Slot = findSlot(FuncIndex + 1, ID);
+  if (Slot >= 0)
+    return &LocalEntries[F.Begin + Slot];
+  /// Fall back to globally.
+  Slot = findSlot(0, ID);
+  if (Slot >= 0 && unsigned(Slot) < F.NumVisibleGlobals)
+    return &GlobalEntries[Slot];
+  return nullptr;
+}
+
+void SymbolTable::defineGlobal(const DeclAST *D) {
+  unsigned Slot = GlobalEntries.size();
+  insertSlot(0, intern(D->getName()), Slot);
+  GlobalEntries.emplace_back(Scope::Global, D, Slot);
+}
+
+unsigned SymbolTable::beginFunction(const FuncDef *FD) {
+  assert(!FunctionIndices.count(FD) && "Function already begun");
+  unsigned Idx = Functions.size();
+  unsigned Begin = LocalEntries.size();
+  Functions.push_back(FunctionSlice{FD, Begin, Begin, getNumGlobals()});
+  FunctionIndices.emplace(FD, Idx);
+  return Idx;
+}
+
+void SymbolTable::defineLocal(unsigned FuncIndex, const DeclAST *D) {
+  assert(FuncIndex + 1 == Functions.size() &&
+         "Locals must be defined in the last function");
+  FunctionSlice &F = Functions[FuncIndex];
+  unsigned Slot = F.End - F.Begin;
+  insertSlot(FuncIndex + 1, intern(D->getName()), Slot);
+  LocalEntries.emplace_back(Scope::Local, D, Slot);
+  ++F.End;
+}
+
+std::pair<unsigned, bool> SymbolTable::replaceFunction(const FuncDef *Old,
+                                                      const FuncDef *New) {
+  auto Iter = FunctionIndices.find(Old);
+  assert(Iter != FunctionIndices.end() && "Old function not in the table");
+  const FunctionSlice OldSlice = Functions[Iter->second];
+  FunctionIndices.erase(Iter);
+  NumRetiredLocals += OldSlice.End - OldSlice.Begin;
+
+  /// The global entry may belong to another function of the same name.
+  bool OwnsName = false;
+  int ID = findName(New->getName());
+  int Slot = ID < 0 ? -1 : findSlot(0, ID);
+  if (Slot >= 0 && GlobalEntries[Slot].getDecl() == Old) {
+    GlobalEntries[Slot] = SymbolEntry(Scope::Global, New, Slot);
+    OwnsName = true;
+  }
+
+  unsigned Idx = Functions.size();
+  unsigned Begin = LocalEntries.size();
+  Functions.push_back(
+      FunctionSlice{New, Begin, Begin, OldSlice.NumVisibleGlobals});
+  FunctionIndices.emplace(New, Idx);
+  return std::make_pair(Idx, OwnsName);
 }
 
 LocalSymbolTable SymbolTable::getLocalTable(const FuncDef *FD) const {
-  assert(LocalTables.count(FD));
-  return LocalSymbolTable(LocalTables.find(FD)->second);
+  assert(FunctionIndices.count(FD));
+  return LocalSymbolTable(this, FunctionIndices.find(FD)->second);
 }
 
 SymbolEntry SymbolTable::getGlobalEntry(const std::string &Name) const {
-  assert(GlobalTable.count(Name));
-  return GlobalTable.find(Name)->second;
+  auto E = lookupGlobal(Name, getNumGlobals());
+  assert(E && "Undefined Name");
+  return *E;
 }
 
 SymbolEntry LocalSymbolTable::operator[](const std::string &Name) const {
-  assert(TheTable->count(Name) && "Undefined Name");
-  return TheTable->find(Name)->second;
-}
\ No newline at end of file
+  auto E = TheTable->lookup(FuncIndex, Name);
+  assert(E && "Undefined Name");
+  return *E;
+}
+
+unsigned LocalSymbolTable::size() const {
+  const auto &F = TheTable->Functions[FuncIndex];
+  return F.End - F.Begin;
+}
+
+LocalSymbolTable::const_iterator LocalSymbolTable::begin() const {
+  return TheTable->LocalEntries.begin() + TheTable->Functions[FuncIndex].Begin;
+}
+
+LocalSymbolTable::const_iterator LocalSymbolTable::end() const {
+  return TheTable->LocalEntries.begin() + TheTable->Functions[FuncIndex].End;
+}
+
+iterator_range<LocalSymbolTable::const_iterator>
+LocalSymbolTable::globals() const {
+  auto B = TheTable->GlobalEntries.begin();
+  return make_range(B, B + TheTable->Functions[FuncIndex].NumVisibleGlobals);
+}
@@ -25,53 +25,51 @@
 using namespace simplecc;
 
 void SymbolTableBuilder::DefineLocalDecl(DeclAST *D) {
-  assert(TheLocal && "TheLocal must be set!");
-  if (TheLocal->count(D->getName())) {
-    EM.Error(D->getLocation(), "redefinition of identifier", D->getName(), "in",
+  assert(FuncIndex >= 0 && "FuncIndex must be set!");
+  if (TheTable->lookupLocal(FuncIndex, D->getName())) {
+    EM.Error(D->getRange(), "redefinition of identifier", D->getName(), "in",
              TheFuncDef->getName());
     return;
   }
-  if (TheGlobal->count(D->getName()) &&
-      (*TheGlobal)[D->getName()].IsFunction()) {
-    EM.Error(D->getLocation(), "local identifier", D->getName(), "in",
+  auto G = TheTable->lookupGlobal(D->getName(),
+                                  TheTable->getNumVisibleGlobals(FuncIndex));
+  if (G && G->IsFunction()) {
+    EM.Error(D->getRange(), "local identifier", D->getName(), "in",
              TheFuncDef->getName(), "shallows a global function");
     return;
   }
   /// Now we successfully define the name
-  TheLocal->emplace(D->getName(), SymbolEntry(Scope::Local, D));
+  TheTable->defineLocal(FuncIndex, D);
 }
 
 void SymbolTableBuilder::DefineGlobalDecl(DeclAST *D) {
-  assert(TheGlobal && "TheGlobal must be set!");
-  if (TheGlobal->count(D->getName())) {
-    EM.Error(D->getLocation(), "redefinition of identifier", D->getName(),
+  assert(TheTable && "TheTable must be set!");
+  if (TheTable->lookupGlobal(D->getName(), TheTable->getNumGlobals())) {
+    EM.Error(D->getRange(), "redefinition of identifier", D->getName(),
              "in <module>");
     return;
   }
-  TheGlobal->emplace(D->getName(), SymbolEntry(Scope::Global, D));
+  TheTable->defineGlobal(D);
 }
 
-void SymbolTableBuilder::ResolveName(const std::string &Name, Location L) {
-  assert(TheLocal && TheGlobal && TheFuncDef);
-  if (TheLocal->count(Name))
+void SymbolTableBuilder::ResolveName(const std::string &Name, SourceRange R) {
+  assert(FuncIndex >= 0 && TheFuncDef);
+  /// Globals visible to the function are found through its LocalSymbolTable,
+  /// so there is nothing to copy.
+  if (TheTable->lookup(FuncIndex, Name))
     return;
-  if (TheGlobal->count(Name)) {
-    /// Fall back to globally.
-    TheLocal->emplace(Name, (*TheGlobal)[Name]);
-    return;
-  }
   /// Undefined
-  EM.Error(L, "undefined identifier", Name, "in", TheFuncDef->getName());
+  EM.Error(R, "undefined identifier", Name, "in", TheFuncDef->getName());
 }
 
 void SymbolTableBuilder::visitCall(CallExpr *C) {
-  ResolveName(C->getCallee(), C->getLocation());
+  ResolveName(C->getCallee(), C->getRange());
   /// Recurse into children.
   ChildrenVisitor::visitCall(C);
 }
 
 void SymbolTableBuilder::visitSubscript(SubscriptExpr *SB) {
-  ResolveName(SB->getArrayName(), SB->getLocation());
+  ResolveName(SB->getArrayName(), SB->getRange());
   /// Recurse into children.
   ChildrenVisitor::visitSubscript(SB);
 }
@@ -80,35 +78,64 @@ void SymbolTableBuilder::visitDecl(DeclAST *D) {
   switch (D->getKind()) {
   case DeclAST::FuncDefKind:
     setFuncDef(static_cast<FuncDef *>(D));
-    setLocal(&TheTable->getLocal(TheFuncDef));
-    /// Define this function globally.
+    /// Define this function globally before its body so that it can recurse.
     DefineGlobalDecl(D);
+    setFuncIndex(TheTable->beginFunction(TheFuncDef));
     return visitFuncDef(TheFuncDef);
 
   case DeclAST::ConstDeclKind:
   case DeclAST::VarDeclKind:
   case DeclAST::ArgDeclKind:
     /* Fall through */
-    return TheLocal ? DefineLocalDecl(D) : DefineGlobalDecl(D);
+    return FuncIndex >= 0 ? DefineLocalDecl(D) : DefineGlobalDecl(D);
   default:
     assert(false && "Unhandled DeclAST subclass!");
   }
 }
 
 bool SymbolTableBuilder::Build(ProgramAST *P, SymbolTable &S) {
+  Begin(S);
+  for (DeclAST *D : P->getDecls()) {
+    if (DiagnosticsEngine::get().hasReachedErrorLimit())
+      break;
+    visitDecl(D);
+  }
+  return !EM.IsOk();
+}
+
+void SymbolTableBuilder::Begin(SymbolTable &S) {
   clear();
   S.clear();
   setTable(&S);
-  setGlobal(&S.getGlobal());
   EM.setErrorType("NameError");
-  visitProgram(P);
+}
+
+bool SymbolTableBuilder::BuildDecl(DeclAST *D) {
+  assert(TheTable && "Begin() must be called first!");
+  auto Prev = EM.getErrorCount();
+  visitDecl(D);
+  return !EM.IsOk(Prev);
+}
+
+bool SymbolTableBuilder::Rebuild(FuncDef *Old, FuncDef *New, SymbolTable &S) {
+  clear();
+  setTable(&S);
+  EM.setErrorType("NameError");
+  setFuncDef(New);
+  auto Result = S.replaceFunction(Old, New);
+  if (!Result.second) {
+    /// Old was a redefinition so New is, too.
+    EM.Error(New->getRange(), "redefinition of identifier", New->getName(),
+             "in <module>");
+  }
+  setFuncIndex(Result.first);
+  visitFuncDef(New);
   return !EM.IsOk();
 }
 
 void SymbolTableBuilder::clear() {
   setTable(nullptr);
-  setLocal(nullptr);
-  setGlobal(nullptr);
+  setFuncIndex(-1);
   setFuncDef(nullptr);
   EM.clear();
 }
\ No newline at end of file
@@ -33,17 +33,19 @@ void SyntaxChecker::visitProgram(ProgramAST *P) {
   // Check the order of declarations.
   int PrevDecl = DeclAST::ConstDeclKind;
   for (auto D : P->getDecls()) {
+    if (DiagnosticsEngine::get().hasReachedErrorLimit())
+      return;
     switch (D->getKind()) {
     case DeclAST::ConstDeclKind:
       if (PrevDecl != DeclAST::ConstDeclKind) {
         // ConstDecl can only be preceded by ConstDecl.
-        EM.Error(D->getLocation(), "unexpected const declaration");
+        EM.Error(D->getRange(), "unexpected const declaration");
       }
       break;
     case DeclAST::VarDeclKind:
       if (PrevDecl == DeclAST::FuncDefKind) {
         // VarDecl cannot be preceded by FuncDef.
-        EM.Error(D->getLocation(), "unexpected variable declaration");
+        EM.Error(D->getRange(), "unexpected variable declaration");
       }
       break;
     case DeclAST::FuncDefKind:
@@ -59,28 +61,28 @@ void SyntaxChecker::visitProgram(ProgramAST *P) {
   DeclAST *LastDecl = P->getDecls().back();
   if (isMainFunction(LastDecl))
     return;
-  EM.Error(LastDecl->getLocation(), "the last declaration must be void main()");
+  EM.Error(LastDecl->getRange(), "the last declaration must be void main()");
 }
 
 void SyntaxChecker::visitConstDecl(ConstDecl *CD) {
   if (CD->getType() == BasicTypeKind::Int &&
       !IsInstance<NumExpr>(CD->getValue())) {
-    EM.Error(CD->getLocation(), "expected int initializer");
+    EM.Error(CD->getRange(), "expected int initializer");
   }
 
   if (CD->getType() == BasicTypeKind::Character &&
       !IsInstance<CharExpr>(CD->getValue())) {
-    EM.Error(CD->getLocation(), "expected char initializer");
+    EM.Error(CD->getRange(), "expected char initializer");
   }
 }
 
 void SyntaxChecker::visitVarDecl(VarDecl *VD) {
   if (VD->getType() == BasicTypeKind::Void) {
-    EM.Error(VD->getLocation(), "cannot declare void variable");
+    EM.Error(VD->getRange(), "cannot declare void variable");
   }
 
   if (VD->isArray() && VD->getSize() == 0) {
-    EM.Error(VD->getLocation(), "array size cannot be 0");
+    EM.Error(VD->getRange(), "array size cannot be 0");
   }
 }
 
@@ -95,7 +97,7 @@ void SyntaxChecker::visitFuncDef(FuncDef *FD) {
 
 void SyntaxChecker::visitArgDecl(ArgDecl *AD) {
   if (AD->getType() == BasicTypeKind::Void) {
-    EM.Error(AD->getLocation(), "cannot declare void argument");
+    EM.Error(AD->getRange(), "cannot declare void argument");
   }
 }
 
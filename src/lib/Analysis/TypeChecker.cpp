@@ -28,7 +28,7 @@ void TypeChecker::visitRead(ReadStmt *RD) {
   for (auto N : RD->getNames()) {
     const auto &Entry = getSymbolEntry(N->getName());
     if (!Entry.IsVariable()) {
-      Error(N->getLocation(), "scanf() only applies to variables.");
+      Error(N->getRange(), "scanf() only applies to variables.");
       continue;
     }
   }
@@ -47,7 +47,7 @@ void TypeChecker::visitReturn(ReturnStmt *R) {
 
   // order a strict match
   if (ShouldReturn != ActuallyReturn) {
-    Error(R->getLocation(), TheFuncDef->getName(), "must return",
+    Error(R->getRange(), TheFuncDef->getName(), "must return",
           CStringFromBasicTypeKind(ShouldReturn));
   }
 }
@@ -58,7 +58,7 @@ void TypeChecker::visitAssign(AssignStmt *A) {
   auto LHS = visitExpr(A->getTarget());
 
   if (IsOk(Errs) && LHS != RHS) {
-    Error(A->getLocation(), "cannot assign", CStringFromBasicTypeKind(RHS),
+    Error(A->getRange(), "cannot assign", CStringFromBasicTypeKind(RHS),
           "to", CStringFromBasicTypeKind(LHS));
   }
 }
@@ -69,7 +69,7 @@ void TypeChecker::CheckBoolOpOperand(ExprAST *E) {
   auto Errs = getErrorCount();
   auto T = visitExpr(E);
   if (IsOk(Errs) && T != BasicTypeKind::Int) {
-    Error(E->getLocation(), Msg);
+    Error(E->getRange(), Msg);
   }
 }
 
@@ -90,7 +90,7 @@ BasicTypeKind TypeChecker::CheckExprOperand(ExprAST *E) {
   auto Errs = getErrorCount();
   auto T = visitExpr(E);
   if (IsOk(Errs) && T == BasicTypeKind::Void) {
-    Error(E->getLocation(), Msg);
+    Error(E->getRange(), Msg);
   }
   return T;
 }
@@ -114,7 +114,7 @@ BasicTypeKind TypeChecker::visitParenExpr(ParenExpr *PE) {
 BasicTypeKind TypeChecker::visitCall(CallExpr *C) {
   const auto &Entry = getSymbolEntry(C->getCallee());
   if (!Entry.IsFunction()) {
-    Error(C->getLocation(), Entry.getName(), "is not a function");
+    Error(C->getRange(), Entry.getName(), "is not a function");
     return BasicTypeKind::Void;
   }
 
@@ -122,7 +122,7 @@ BasicTypeKind TypeChecker::visitCall(CallExpr *C) {
   auto NumFormal = Ty.getNumArgs();
   auto NumActual = C->getArgs().size();
   if (NumFormal != NumActual) {
-    Error(C->getLocation(), C->getCallee(), "expects", NumFormal,
+    Error(C->getRange(), C->getCallee(), "expects", NumFormal,
           "arguments, got", NumActual);
   }
 
@@ -132,7 +132,7 @@ BasicTypeKind TypeChecker::visitCall(CallExpr *C) {
     auto ActualTy = visitExpr(C->getArgs()[I]);
     auto FormalTy = Ty.getArgTypeAt(I);
     if (ActualTy != FormalTy) {
-      Error(C->getArgs()[I]->getLocation(), "argument", I + 1, "of",
+      Error(C->getArgs()[I]->getRange(), "argument", I + 1, "of",
             C->getCallee(), "must be", CStringFromBasicTypeKind(FormalTy));
     }
   }
@@ -142,14 +142,14 @@ BasicTypeKind TypeChecker::visitCall(CallExpr *C) {
 BasicTypeKind TypeChecker::visitSubscript(SubscriptExpr *SB) {
   const auto &Entry = getSymbolEntry(SB->getArrayName());
   if (!Entry.IsArray()) {
-    Error(SB->getLocation(), Entry.getName(), "is not an array");
+    Error(SB->getRange(), Entry.getName(), "is not an array");
     return BasicTypeKind::Void;
   }
 
   int Errs = getErrorCount();
   auto Idx = visitExpr(SB->getIndex());
   if (IsOk(Errs) && Idx != BasicTypeKind::Int) {
-    Error(SB->getLocation(), "array index must be int");
+    Error(SB->getRange(), "array index must be int");
   }
 
   return Entry.AsArray().getElementType();
@@ -166,11 +166,11 @@ BasicTypeKind TypeChecker::visitName(NameExpr *N) {
   CheckNoLoadFunction(Entry, N);
 
   if (N->getContext() == ExprContextKind::Load && Entry.IsArray()) {
-    Error(N->getLocation(), "using an array in an expression");
+    Error(N->getRange(), "using an array in an expression");
     return BasicTypeKind::Void;
   }
   if (N->getContext() == ExprContextKind::Store && !Entry.IsVariable()) {
-    Error(N->getLocation(), "only variables can be assigned to");
+    Error(N->getRange(), "only variables can be assigned to");
     return BasicTypeKind::Void;
   }
   if (Entry.IsConstant())
@@ -125,8 +125,8 @@ void SymbolEntry::Format(std::ostream &O) const {
     << getScope() << ", " << getLocation() << ")";
 }
 
-SymbolEntry::SymbolEntry(Scope scope, const DeclAST *decl)
-    : TheScope(scope), TheDecl(decl) {}
+SymbolEntry::SymbolEntry(Scope scope, const DeclAST *decl, unsigned slot)
+    : TheScope(scope), TheDecl(decl), Slot(slot) {}
 
 namespace simplecc {
 std::ostream &operator<<(std::ostream &O, Scope S) {
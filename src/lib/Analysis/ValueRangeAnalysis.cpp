@@ -0,0 +1,464 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "simplecc/Analysis/ValueRangeAnalysis.h"
+#include "simplecc/AST/VisitorBase.h"
+
+using namespace simplecc;
+
+namespace {
+/// The abstract state at a program point: the range of each local slot.
+class RangeState {
+  std::vector<Interval> Ranges;
+  /// If false, no execution reaches this point and Ranges are meaningless.
+  bool Reachable = true;
+
+public:
+  RangeState() = default;
+  explicit RangeState(unsigned NumSlots) : Ranges(NumSlots) {}
+
+  bool isReachable() const { return Reachable; }
+  void setUnreachable() { Reachable = false; }
+
+  /// Return the range of a slot. In unreachable code, it is the full range.
+  Interval get(unsigned Slot) const {
+    return Reachable ? Ranges[Slot] : Interval::getFull();
+  }
+
+  void set(unsigned Slot, const Interval &I) {
+    if (!Reachable)
+      return;
+    if (I.isEmpty())
+      Reachable = false;
+    else
+      Ranges[Slot] = I;
+  }
+
+  RangeState join(const RangeState &S) const {
+    if (!Reachable)
+      return S;
+    if (!S.Reachable)
+      return *this;
+    RangeState Result(*this);
+    for (unsigned I = 0, E = Ranges.size(); I < E; ++I)
+      Result.Ranges[I] = Ranges[I].join(S.Ranges[I]);
+    return Result;
+  }
+
+  RangeState widen(const RangeState &S) const {
+    if (!Reachable)
+      return S;
+    if (!S.Reachable)
+      return *this;
+    RangeState Result(*this);
+    for (unsigned I = 0, E = Ranges.size(); I < E; ++I)
+      Result.Ranges[I] = Ranges[I].widen(S.Ranges[I]);
+    return Result;
+  }
+
+  /// Return if S describes a subset of the executions this describes.
+  bool contains(const RangeState &S) const {
+    if (!S.Reachable)
+      return true;
+    if (!Reachable)
+      return false;
+    for (unsigned I = 0, E = Ranges.size(); I < E; ++I)
+      if (!Ranges[I].contains(S.Ranges[I]))
+        return false;
+    return true;
+  }
+};
+
+/// Return the values of X for which "X Op Y" can hold.
+Interval RefineCompare(const Interval &X, BinaryOpKind Op, const Interval &Y) {
+  if (X.isEmpty() || Y.isEmpty())
+    return Interval::getEmpty();
+  auto Below = [](int64_t B) {
+    return B == Interval::PosInf ? B : B - 1;
+  };
+  auto Above = [](int64_t B) {
+    return B == Interval::NegInf ? B : B + 1;
+  };
+  switch (Op) {
+  case BinaryOpKind::Lt:
+    return X.meet(Interval::getRange(Interval::NegInf, Below(Y.getUpper())));
+  case BinaryOpKind::LtE:
+    return X.meet(Interval::getRange(Interval::NegInf, Y.getUpper()));
+  case BinaryOpKind::Gt:
+    return X.meet(Interval::getRange(Above(Y.getLower()), Interval::PosInf));
+  case BinaryOpKind::GtE:
+    return X.meet(Interval::getRange(Y.getLower(), Interval::PosInf));
+  case BinaryOpKind::Eq:
+    return X.meet(Y);
+  case BinaryOpKind::NotEq:
+    if (!Y.isConstant())
+      return X;
+    if (X.getLower() == Y.getLower())
+      return Interval::getRange(Above(X.getLower()), X.getUpper());
+    if (X.getUpper() == Y.getLower())
+      return Interval::getRange(X.getLower(), Below(X.getUpper()));
+    return X;
+  default:
+    assert(false && "Not a compare operator");
+    return X;
+  }
+}
+
+/// Return Op' such that "Y Op' X" iff "X Op Y".
+BinaryOpKind SwapCompare(BinaryOpKind Op) {
+  switch (Op) {
+  case BinaryOpKind::Lt:
+    return BinaryOpKind::Gt;
+  case BinaryOpKind::LtE:
+    return BinaryOpKind::GtE;
+  case BinaryOpKind::Gt:
+    return BinaryOpKind::Lt;
+  case BinaryOpKind::GtE:
+    return BinaryOpKind::LtE;
+  default:
+    return Op;
+  }
+}
+
+/// Return Op' such that "X Op' Y" iff not "X Op Y".
+BinaryOpKind NegateCompare(BinaryOpKind Op) {
+  switch (Op) {
+  case BinaryOpKind::Lt:
+    return BinaryOpKind::GtE;
+  case BinaryOpKind::LtE:
+    return BinaryOpKind::Gt;
+  case BinaryOpKind::Gt:
+    return BinaryOpKind::LtE;
+  case BinaryOpKind::GtE:
+    return BinaryOpKind::Lt;
+  case BinaryOpKind::Eq:
+    return BinaryOpKind::NotEq;
+  case BinaryOpKind::NotEq:
+    return BinaryOpKind::Eq;
+  default:
+    assert(false && "Not a compare operator");
+    return Op;
+  }
+}
+
+/// @brief RangeEvaluator interprets a function over RangeState.
+class RangeEvaluator : VisitorBase<RangeEvaluator> {
+  friend VisitorBase;
+  using SubscriptRange = ValueRangeAnalysis::SubscriptRange;
+
+  /// Number of iterations of a loop that join before widening starts.
+  static constexpr unsigned WideningDelay = 3;
+  /// Number of narrowing iterations after a loop stabilizes.
+  static constexpr unsigned NumNarrowing = 2;
+
+  ValueRangeAnalysis &TheAnalysis;
+  LocalSymbolTable TheLocal;
+  RangeState Current;
+  /// If true, this is the final pass over the current statement. Subscripts
+  /// and return values are only recorded in the final pass.
+  bool Final = true;
+  std::vector<SubscriptRange> *Records;
+  Interval ReturnRange = Interval::getEmpty();
+
+public:
+  RangeEvaluator(ValueRangeAnalysis &A, FuncDef *FD,
+                 std::vector<SubscriptRange> *R)
+      : TheAnalysis(A), TheLocal(A.getSymbolTable().getLocalTable(FD)),
+        Current(TheLocal.size()), Records(R) {}
+
+  /// Interpret the function and return the range of its return values.
+  Interval Evaluate(FuncDef *FD) {
+    visitStmtList(FD->getStmts());
+    return ReturnRange;
+  }
+
+private:
+  /// Return the slot of a NameExpr if it names a tracked local, or -1.
+  int getTrackedSlot(ExprAST *E) const {
+    while (auto PE = subclass_cast<ParenExpr>(E))
+      E = PE->getValue();
+    auto N = subclass_cast<NameExpr>(E);
+    if (!N)
+      return -1;
+    SymbolEntry Entry = TheLocal[N->getName()];
+    if (!Entry.IsLocal() || !(Entry.IsFormalArgument() || Entry.IsVariable()))
+      return -1;
+    return Entry.getSlot();
+  }
+
+  Interval evaluate(ExprAST *E) { return visitExpr<Interval>(E); }
+
+  /// Evaluate E without recording anything.
+  Interval peek(ExprAST *E) {
+    bool SavedFinal = Final;
+    Final = false;
+    Interval Result = evaluate(E);
+    Final = SavedFinal;
+    return Result;
+  }
+
+  /// Refine Current assuming a condition is Truth.
+  void refine(ExprAST *Cond, bool Truth);
+
+  void visitStmtList(const std::vector<StmtAST *> &Stmts) {
+    for (auto S : Stmts)
+      visitStmt(S);
+  }
+
+  /// Run Step on Current until it stabilizes starting from Entry. Step must
+  /// leave in Current the state that flows back to the loop head. Return the
+  /// state of the loop head.
+  template <typename StepFn>
+  RangeState computeLoopHead(const RangeState &Entry, StepFn Step);
+
+  // Statements.
+  void visitRead(ReadStmt *R);
+  void visitWrite(WriteStmt *W);
+  void visitAssign(AssignStmt *A);
+  void visitFor(ForStmt *F);
+  void visitWhile(WhileStmt *W);
+  void visitReturn(ReturnStmt *R);
+  void visitIf(IfStmt *I);
+  void visitExprStmt(ExprStmt *ES) { evaluate(ES->getValue()); }
+
+  // Expressions.
+  Interval visitBinOp(BinOpExpr *B);
+  Interval visitParenExpr(ParenExpr *PE) { return evaluate(PE->getValue()); }
+  Interval visitBoolOp(BoolOpExpr *B);
+  Interval visitUnaryOp(UnaryOpExpr *U);
+  Interval visitSubscript(SubscriptExpr *SB);
+  Interval visitCall(CallExpr *C);
+  Interval visitNum(NumExpr *N) { return Interval::getConstant(N->getNum()); }
+  Interval visitStr(StrExpr *) { return Interval::getFull(); }
+  Interval visitChar(CharExpr *C) {
+    return Interval::getConstant(C->getChar());
+  }
+  Interval visitName(NameExpr *N);
+};
+
+constexpr unsigned RangeEvaluator::WideningDelay;
+constexpr unsigned RangeEvaluator::NumNarrowing;
+} // namespace
+
+void RangeEvaluator::refine(ExprAST *Cond, bool Truth) {
+  auto B = subclass_cast<BoolOpExpr>(Cond);
+  ExprAST *Left = B ? B->getValue() : Cond;
+  ExprAST *Right = nullptr;
+  BinaryOpKind Op = BinaryOpKind::NotEq;
+  if (B && B->hasCompareOp()) {
+    auto Compare = static_cast<BinOpExpr *>(Left);
+    Left = Compare->getLeft();
+    Right = Compare->getRight();
+    Op = Compare->getOp();
+  }
+  if (!Truth)
+    Op = NegateCompare(Op);
+
+  Interval LeftRange = peek(Left);
+  Interval RightRange = Right ? peek(Right) : Interval::getConstant(0);
+  Interval NewLeft = RefineCompare(LeftRange, Op, RightRange);
+  Interval NewRight = RefineCompare(RightRange, SwapCompare(Op), LeftRange);
+  if (NewLeft.isEmpty() || NewRight.isEmpty()) {
+    Current.setUnreachable();
+    return;
+  }
+  int Slot = getTrackedSlot(Left);
+  if (Slot >= 0)
+    Current.set(Slot, NewLeft);
+  Slot = Right ? getTrackedSlot(Right) : -1;
+  if (Slot >= 0)
+    Current.set(Slot, NewRight);
+}
+
+template <typename StepFn>
+RangeState RangeEvaluator::computeLoopHead(const RangeState &Entry,
+                                           StepFn Step) {
+  bool SavedFinal = Final;
+  Final = false;
+  RangeState Head = Entry;
+  for (unsigned Iter = 0;; ++Iter) {
+    Current = Head;
+    Step();
+    RangeState Next = Entry.join(Current);
+    if (Head.contains(Next))
+      break;
+    Head = Iter < WideningDelay ? Next : Head.widen(Next);
+  }
+  for (unsigned Iter = 0; Iter < NumNarrowing; ++Iter) {
+    Current = Head;
+    Step();
+    Head = Entry.join(Current);
+  }
+  Final = SavedFinal;
+  return Head;
+}
+
+void RangeEvaluator::visitRead(ReadStmt *R) {
+  for (auto N : R->getNames()) {
+    int Slot = getTrackedSlot(N);
+    if (Slot >= 0)
+      Current.set(Slot, Interval::getFull());
+  }
+}
+
+void RangeEvaluator::visitWrite(WriteStmt *W) {
+  if (auto E = W->getValue())
+    evaluate(E);
+}
+
+void RangeEvaluator::visitAssign(AssignStmt *A) {
+  Interval Value = evaluate(A->getValue());
+  int Slot = getTrackedSlot(A->getTarget());
+  if (Slot >= 0)
+    Current.set(Slot, Value);
+  else
+    evaluate(A->getTarget());
+}
+
+void RangeEvaluator::visitFor(ForStmt *F) {
+  /// The body runs before the condition is first tested:
+  /// initial; body; step; condition; body; ...
+  visitStmt(F->getInitial());
+  auto Step = [this, F]() {
+    visitStmtList(F->getBody());
+    visitStmt(F->getStep());
+    evaluate(F->getCondition());
+    refine(F->getCondition(), true);
+  };
+  Current = computeLoopHead(Current, Step);
+  visitStmtList(F->getBody());
+  visitStmt(F->getStep());
+  evaluate(F->getCondition());
+  refine(F->getCondition(), false);
+}
+
+void RangeEvaluator::visitWhile(WhileStmt *W) {
+  auto Step = [this, W]() {
+    evaluate(W->getCondition());
+    refine(W->getCondition(), true);
+    visitStmtList(W->getBody());
+  };
+  Current = computeLoopHead(Current, Step);
+  evaluate(W->getCondition());
+  RangeState Head = Current;
+  refine(W->getCondition(), true);
+  visitStmtList(W->getBody());
+  Current = Head;
+  refine(W->getCondition(), false);
+}
+
+void RangeEvaluator::visitReturn(ReturnStmt *R) {
+  if (R->hasValue()) {
+    Interval Value = evaluate(R->getValue());
+    if (Final && Current.isReachable())
+      ReturnRange = ReturnRange.join(Value);
+  }
+  Current.setUnreachable();
+}
+
+void RangeEvaluator::visitIf(IfStmt *I) {
+  evaluate(I->getCondition());
+  RangeState Saved = Current;
+  refine(I->getCondition(), true);
+  visitStmtList(I->getThen());
+  RangeState Then = Current;
+  Current = Saved;
+  refine(I->getCondition(), false);
+  visitStmtList(I->getElse());
+  Current = Then.join(Current);
+}
+
+Interval RangeEvaluator::visitBinOp(BinOpExpr *B) {
+  Interval Left = evaluate(B->getLeft());
+  Interval Right = evaluate(B->getRight());
+  switch (B->getOp()) {
+  case BinaryOpKind::Add:
+    return Left + Right;
+  case BinaryOpKind::Sub:
+    return Left - Right;
+  case BinaryOpKind::Mult:
+    return Left * Right;
+  case BinaryOpKind::Div:
+    return Left / Right;
+  default:
+    return Interval::getRange(0, 1);
+  }
+}
+
+Interval RangeEvaluator::visitBoolOp(BoolOpExpr *B) {
+  Interval Value = evaluate(B->getValue());
+  return B->hasCompareOp() ? Interval::getRange(0, 1) : Value;
+}
+
+Interval RangeEvaluator::visitUnaryOp(UnaryOpExpr *U) {
+  Interval Operand = evaluate(U->getOperand());
+  return U->getOp() == UnaryOpKind::USub ? -Operand : Operand;
+}
+
+Interval RangeEvaluator::visitSubscript(SubscriptExpr *SB) {
+  Interval Index = evaluate(SB->getIndex());
+  if (Final && Records)
+    Records->push_back({SB, Index, Current.isReachable()});
+  return Interval::getFull();
+}
+
+Interval RangeEvaluator::visitCall(CallExpr *C) {
+  for (auto Arg : C->getArgs())
+    evaluate(Arg);
+  SymbolEntry Entry = TheLocal[C->getCallee()];
+  /// The visit does not mutate the callee.
+  auto Callee = const_cast<FuncDef *>(
+      static_cast<const FuncDef *>(Entry.getDecl()));
+  return TheAnalysis.getReturnRange(Callee);
+}
+
+Interval RangeEvaluator::visitName(NameExpr *N) {
+  SymbolEntry Entry = TheLocal[N->getName()];
+  if (Entry.IsConstant())
+    return Interval::getConstant(Entry.AsConstant().getValue());
+  int Slot = getTrackedSlot(N);
+  if (Slot >= 0)
+    return Current.get(Slot);
+  return Interval::getFull();
+}
+
+std::vector<ValueRangeAnalysis::SubscriptRange>
+ValueRangeAnalysis::Analyze(FuncDef *FD) {
+  std::vector<SubscriptRange> Records;
+  Interval Return = RangeEvaluator(*this, FD, &Records).Evaluate(FD);
+  if (!InProgress.count(FD))
+    ReturnRanges.emplace(FD, Return);
+  return Records;
+}
+
+Interval ValueRangeAnalysis::getReturnRange(FuncDef *FD) {
+  auto Iter = ReturnRanges.find(FD);
+  if (Iter != ReturnRanges.end())
+    return Iter->second;
+  if (InProgress.count(FD))
+    return Interval::getFull();
+  InProgress.insert(FD);
+  Interval Return = RangeEvaluator(*this, FD, nullptr).Evaluate(FD);
+  InProgress.erase(FD);
+  ReturnRanges.emplace(FD, Return);
+  return Return;
+}
@@ -142,6 +142,7 @@ unsigned ByteCodeBuilder::Insert(ByteCode Code) {
   /// Fill in other members of Code.
   auto Off = TheFunction.size();
   Code.setSourceLineno(getLineno());
+  Code.setSourceFunction(getSourceFunction());
   Code.setByteCodeOffset(Off);
 
   /// Insert Code at the back of the function.
@@ -0,0 +1,387 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "simplecc/CodeGen/ByteCodeCFG.h"
+#include "simplecc/CodeGen/ByteCodeFunction.h"
+#include <algorithm>
+#include <utility>
+
+using namespace simplecc;
+
+void ByteCodeCFG::recalculate(const ByteCodeFunction &F) {
+  TheFunction = &F;
+  MutableFunction = nullptr;
+  buildBlocks();
+}
+
+void ByteCodeCFG::recalculate(ByteCodeFunction &F) {
+  TheFunction = &F;
+  MutableFunction = &F;
+  buildBlocks();
+}
+
+const ByteCode &ByteCodeCFG::getTerminator(unsigned B) const {
+  return TheFunction->getByteCodeAt(Blocks[B].End - 1);
+}
+
+/// A block starts at the entry, at a jump target and right after a jump or
+/// return.
+bool ByteCodeCFG::IsLeader(unsigned Offset) const {
+  if (Offset == 0 || NumJumpsTo[Offset])
+    return true;
+  const ByteCode &Prev = TheFunction->getByteCodeAt(Offset - 1);
+  return Prev.IsJump() || Prev.getOpcode() == ByteCode::RETURN_VALUE ||
+         Prev.getOpcode() == ByteCode::RETURN_NONE;
+}
+
+void ByteCodeCFG::buildBlocks() {
+  unsigned Size = TheFunction->size();
+  NumJumpsTo.assign(Size + 1, 0);
+  for (const ByteCode &C : *TheFunction) {
+    if (C.IsJump())
+      ++NumJumpsTo[C.getJumpTarget()];
+  }
+
+  Blocks.clear();
+  BlockOf.assign(Size, 0);
+  for (unsigned Off = 0; Off < Size; ++Off) {
+    if (IsLeader(Off))
+      Blocks.push_back(Block{Off, Off, {}, {}});
+    Blocks.back().End = Off + 1;
+    BlockOf[Off] = Blocks.size() - 1;
+  }
+  for (unsigned B = 0, E = Blocks.size(); B < E; ++B) {
+    relink(B);
+  }
+  Stale = true;
+}
+
+void ByteCodeCFG::relink(unsigned B) {
+  Block &BB = Blocks[B];
+  for (unsigned Succ : BB.Successors) {
+    auto &Preds = Blocks[Succ].Predecessors;
+    Preds.erase(std::remove(Preds.begin(), Preds.end(), B), Preds.end());
+  }
+  BB.Successors.clear();
+
+  auto AddSuccessor = [&](unsigned Succ) {
+    if (std::find(BB.Successors.begin(), BB.Successors.end(), Succ) !=
+        BB.Successors.end())
+      return;
+    BB.Successors.push_back(Succ);
+    Blocks[Succ].Predecessors.push_back(B);
+  };
+
+  const ByteCode &Last = getTerminator(B);
+  switch (Last.getOpcode()) {
+  case ByteCode::RETURN_VALUE:
+  case ByteCode::RETURN_NONE:
+    break;
+  default:
+    if (Last.IsJump()) {
+      assert(Last.getJumpTarget() < BlockOf.size() &&
+             "Jump out of the function");
+      AddSuccessor(BlockOf[Last.getJumpTarget()]);
+    }
+    if (Last.getOpcode() != ByteCode::JUMP_FORWARD) {
+      assert(BB.End < BlockOf.size() && "Falling off the end of function");
+      AddSuccessor(B + 1);
+    }
+    break;
+  }
+  Stale = true;
+}
+
+void ByteCodeCFG::updateBlocks(unsigned Offset, int Old) {
+  /// The bounds of the blocks hold if a block starts exactly where a leader
+  /// is. Only the leaders around the changed ByteCode can have moved.
+  auto Holds = [this](unsigned Off) {
+    return Off >= BlockOf.size() || IsBlockStart(Off) == IsLeader(Off);
+  };
+  const ByteCode &C = TheFunction->getByteCodeAt(Offset);
+  if (Holds(Offset + 1) && (Old < 0 || Holds(Old)) &&
+      (!C.IsJump() || Holds(C.getJumpTarget()))) {
+    relink(BlockOf[Offset]);
+    return;
+  }
+  buildBlocks();
+}
+
+void ByteCodeCFG::setJumpTarget(unsigned Offset, unsigned Target) {
+  assert(MutableFunction && "Editing a const ByteCodeFunction");
+  ByteCode &C = MutableFunction->getByteCodeAt(Offset);
+  unsigned Old = C.getJumpTarget();
+  --NumJumpsTo[Old];
+  ++NumJumpsTo[Target];
+  C.setJumpTarget(Target);
+  updateBlocks(Offset, Old);
+}
+
+void ByteCodeCFG::replace(unsigned Offset, ByteCode C) {
+  assert(MutableFunction && "Editing a const ByteCodeFunction");
+  ByteCode &Old = MutableFunction->getByteCodeAt(Offset);
+  int OldTarget = -1;
+  if (Old.IsJump()) {
+    OldTarget = Old.getJumpTarget();
+    --NumJumpsTo[OldTarget];
+  }
+  if (C.IsJump())
+    ++NumJumpsTo[C.getJumpTarget()];
+  C.setSourceLineno(Old.getSourceLineno());
+  C.setSourceFunction(Old.getSourceFunction());
+  C.setByteCodeOffset(Offset);
+  Old = C;
+  updateBlocks(Offset, OldTarget);
+}
+
+void ByteCodeCFG::remove(const std::vector<bool> &Removed) {
+  assert(MutableFunction && "Editing a const ByteCodeFunction");
+  auto &List = MutableFunction->getByteCodeList();
+  unsigned Size = List.size();
+  assert(Removed.size() >= Size && "Removed must cover every ByteCode");
+
+  /// The new offset of each ByteCode, or of the first one kept after it.
+  std::vector<unsigned> NewOffsets(Size + 1);
+  unsigned Kept = 0;
+  for (unsigned Off = 0; Off < Size; ++Off) {
+    NewOffsets[Off] = Kept;
+    if (!Removed[Off])
+      ++Kept;
+  }
+  NewOffsets[Size] = Kept;
+
+  ByteCodeFunction::ByteCodeListTy NewList;
+  NewList.reserve(Kept);
+  for (unsigned Off = 0; Off < Size; ++Off) {
+    if (Removed[Off])
+      continue;
+    ByteCode C = List[Off];
+    if (C.IsJump())
+      C.setJumpTarget(NewOffsets[C.getJumpTarget()]);
+    C.setByteCodeOffset(NewList.size());
+    NewList.push_back(C);
+  }
+  List.swap(NewList);
+  buildBlocks();
+}
+
+void ByteCodeCFG::updateAnalyses() const {
+  if (!Stale)
+    return;
+  Stale = false;
+  computeDominators();
+  computeLoops();
+}
+
+void ByteCodeCFG::computeDominators() const {
+  unsigned N = Blocks.size();
+  RPO.clear();
+  RPONumbers.assign(N, -1);
+  IDoms.assign(N, -1);
+  if (N == 0)
+    return;
+
+  /// Iterative DFS that records the post order.
+  std::vector<bool> Visited(N, false);
+  std::vector<std::pair<unsigned, unsigned>> Stack;
+  std::vector<unsigned> PostOrder;
+  Stack.emplace_back(0, 0);
+  Visited[0] = true;
+  while (!Stack.empty()) {
+    unsigned B = Stack.back().first;
+    unsigned &Next = Stack.back().second;
+    if (Next == Blocks[B].Successors.size()) {
+      PostOrder.push_back(B);
+      Stack.pop_back();
+      continue;
+    }
+    unsigned Succ = Blocks[B].Successors[Next++];
+    if (!Visited[Succ]) {
+      Visited[Succ] = true;
+      Stack.emplace_back(Succ, 0);
+    }
+  }
+  RPO.assign(PostOrder.rbegin(), PostOrder.rend());
+  for (unsigned I = 0, E = RPO.size(); I < E; ++I) {
+    RPONumbers[RPO[I]] = I;
+  }
+
+  /// The algorithm of Cooper, Harvey and Kennedy on the RPO numbers.
+  std::vector<int> Doms(RPO.size(), -1);
+  Doms[0] = 0;
+  auto Intersect = [&Doms](int A, int B) {
+    while (A != B) {
+      while (A > B)
+        A = Doms[A];
+      while (B > A)
+        B = Doms[B];
+    }
+    return A;
+  };
+  for (bool Changed = true; Changed;) {
+    Changed = false;
+    for (unsigned I = 1, E = RPO.size(); I < E; ++I) {
+      int NewIDom = -1;
+      for (unsigned Pred : Blocks[RPO[I]].Predecessors) {
+        int P = RPONumbers[Pred];
+        if (P < 0 || Doms[P] < 0)
+          continue;
+        NewIDom = NewIDom < 0 ? P : Intersect(P, NewIDom);
+      }
+      if (NewIDom != Doms[I]) {
+        Doms[I] = NewIDom;
+        Changed = true;
+      }
+    }
+  }
+  for (unsigned I = 1, E = RPO.size(); I < E; ++I) {
+    IDoms[RPO[I]] = RPO[Doms[I]];
+  }
+}
+
+void ByteCodeCFG::computeLoops() const {
+  unsigned N = Blocks.size();
+  Loops.clear();
+  LoopOf.assign(N, -1);
+
+  /// Visit the headers in reverse post order, so that a loop comes after
+  /// those that contain it.
+  for (unsigned Header : RPO) {
+    Loop L{Header, {}, {}, -1, 1};
+    for (unsigned Pred : Blocks[Header].Predecessors) {
+      if (RPONumbers[Pred] >= 0 && dominates(Header, Pred))
+        L.Latches.push_back(Pred);
+    }
+    if (L.Latches.empty())
+      continue;
+
+    /// The body is what reaches a latch backward without passing the header.
+    std::vector<bool> InLoop(N, false);
+    InLoop[Header] = true;
+    std::vector<unsigned> Worklist(L.Latches);
+    while (!Worklist.empty()) {
+      unsigned B = Worklist.back();
+      Worklist.pop_back();
+      if (InLoop[B])
+        continue;
+      InLoop[B] = true;
+      for (unsigned Pred : Blocks[B].Predecessors) {
+        if (RPONumbers[Pred] >= 0 && !InLoop[Pred])
+          Worklist.push_back(Pred);
+      }
+    }
+    for (unsigned B = 0; B < N; ++B) {
+      if (InLoop[B])
+        L.Blocks.push_back(B);
+    }
+
+    /// The innermost loop that contains this one has the latest header.
+    for (int J = Loops.size() - 1; J >= 0; --J) {
+      if (std::binary_search(Loops[J].Blocks.begin(), Loops[J].Blocks.end(),
+                             Header)) {
+        L.Parent = J;
+        L.Depth = Loops[J].Depth + 1;
+        break;
+      }
+    }
+    Loops.push_back(std::move(L));
+  }
+
+  for (unsigned I = 0, E = Loops.size(); I < E; ++I) {
+    for (unsigned B : Loops[I].Blocks)
+      LoopOf[B] = I;
+  }
+}
+
+bool ByteCodeCFG::isReachable(unsigned B) const {
+  updateAnalyses();
+  return RPONumbers[B] >= 0;
+}
+
+int ByteCodeCFG::getIDom(unsigned B) const {
+  updateAnalyses();
+  return IDoms[B];
+}
+
+bool ByteCodeCFG::dominates(unsigned A, unsigned B) const {
+  updateAnalyses();
+  if (RPONumbers[B] < 0)
+    return true;
+  if (RPONumbers[A] < 0)
+    return false;
+  int Walk = B;
+  while (Walk != static_cast<int>(A)) {
+    Walk = IDoms[Walk];
+    if (Walk < 0)
+      return false;
+  }
+  return true;
+}
+
+const std::vector<ByteCodeCFG::Loop> &ByteCodeCFG::getLoops() const {
+  updateAnalyses();
+  return Loops;
+}
+
+int ByteCodeCFG::getLoopFor(unsigned B) const {
+  updateAnalyses();
+  return LoopOf[B];
+}
+
+unsigned ByteCodeCFG::getLoopDepth(unsigned B) const {
+  int L = getLoopFor(B);
+  return L < 0 ? 0 : Loops[L].Depth;
+}
+
+void ByteCodeCFG::Format(std::ostream &O) const {
+  auto FormatList = [&O](const char *Label, const std::vector<unsigned> &List) {
+    if (List.empty())
+      return;
+    O << ", " << Label << ":";
+    for (unsigned B : List)
+      O << " bb" << B;
+  };
+
+  O << TheFunction->getName() << ":\n";
+  for (unsigned B = 0, E = size(); B < E; ++B) {
+    const Block &BB = Blocks[B];
+    O << "bb" << B << " [" << BB.Begin << ", " << BB.End << ")";
+    if (!isReachable(B)) {
+      O << ", unreachable\n";
+      continue;
+    }
+    FormatList("preds", BB.Predecessors);
+    FormatList("succs", BB.Successors);
+    if (getIDom(B) >= 0)
+      O << ", idom: bb" << getIDom(B);
+    if (getLoopDepth(B))
+      O << ", loop depth: " << getLoopDepth(B);
+    O << "\n";
+  }
+  for (const Loop &L : getLoops()) {
+    O << "loop bb" << L.Header;
+    FormatList("blocks", L.Blocks);
+    FormatList("latches", L.Latches);
+    O << "\n";
+  }
+}
@@ -0,0 +1,276 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "simplecc/CodeGen/ByteCodeEncoder.h"
+#include "simplecc/CodeGen/ByteCodeFunction.h"
+#include "simplecc/CodeGen/ByteCodeModule.h"
+#include "simplecc/CodeGen/EncodedVerifier.h"
+#include "simplecc/CodeGen/SuperInstruction.h"
+#include <cassert>
+
+using namespace simplecc;
+
+/// Append Val as an unsigned immediate of exactly Size bytes, padding it
+/// with continuation bytes.
+static void EncodeUnsignedPadded(std::vector<uint8_t> &Code, unsigned Val,
+                                 unsigned Size) {
+  for (unsigned I = 1; I < Size; I++) {
+    Code.push_back(static_cast<uint8_t>((Val & 0x7f) | 0x80));
+    Val >>= 7;
+  }
+  assert(Val < 0x80 && "Immediate does not fit");
+  Code.push_back(static_cast<uint8_t>(Val));
+}
+
+void ByteCodeEncoder::EncodeFunction(const ByteCodeFunction &F,
+                                     EncodedFunction &EF) {
+  using Opcode = EncodedFunction::Opcode;
+  using ImmediateKind = EncodedFunction::ImmediateKind;
+
+  /// Lay out the arguments, then the local variables and the temporaries.
+  std::unordered_map<std::string, SlotTy> Locals;
+  unsigned Slot = 0;
+  auto Layout = [&](const std::string &Name, unsigned Size) {
+    Locals.emplace(Name, SlotTy(Slot, Size != 0));
+    Slot += Size ? Size : 1;
+  };
+  for (const SymbolEntry &E : F.getFormalArguments())
+    Layout(E.getName(), 0);
+  for (const SymbolEntry &E : F.getLocalVariables())
+    Layout(E.getName(), E.IsArray() ? E.AsArray().getSize() : 0);
+  for (const auto &T : F.getTemporaries())
+    Layout(T.Name, T.Size);
+  auto LocalAt = [&](const char *Name) -> const SlotTy & {
+    auto Iter = Locals.find(Name);
+    assert(Iter != Locals.end() && "Undefined local");
+    return Iter->second;
+  };
+
+  EF.Name = F.getName();
+  EF.NumArguments = F.getFormalArgumentCount();
+  EF.FrameSize = Slot;
+  EF.MaxStackDepth = 0;
+
+  /// An instruction to encode, which runs Length ByteCode's from Start.
+  /// The immediate of a target is a ByteCode offset until it is emitted.
+  struct Item {
+    Opcode Op;
+    unsigned Start;
+    unsigned Length;
+    int Immediates[EncodedFunction::MaxImmediates];
+  };
+  std::vector<Item> Items;
+  Items.reserve(F.size());
+
+  /// Resolve the operands and fuse the SuperInstruction's.
+  SuperInstructionSelector Selector;
+  if (FuseSuperInstructions)
+    Selector.Select(F);
+  for (unsigned I = 0; I < F.size();) {
+    if (const SuperInstruction *SI = Selector.getSuperInstructionAt(I)) {
+      Item It{EncodedFunction::getOpcode(*SI), I, SI->getLength(), {0, 0, 0}};
+      int *Imm = It.Immediates;
+      if (SI->Local)
+        *Imm++ = LocalAt(SI->Local).first;
+      if (SI->Source)
+        *Imm++ = LocalAt(SI->Source).first;
+      if (SuperInstruction::IsCompareLocals(SI->getOpcode())) {
+        *Imm++ = SI->Target;
+      } else if (SuperInstruction::IsCompareLocalConst(SI->getOpcode())) {
+        *Imm++ = SI->Constant;
+        *Imm++ = SI->Target;
+      } else if (SI->getOpcode() != SuperInstruction::MOVE_LOCAL &&
+                 SI->getOpcode() != SuperInstruction::ADD_LOCAL &&
+                 SI->getOpcode() != SuperInstruction::SUB_LOCAL) {
+        *Imm++ = SI->Constant;
+      }
+      Items.push_back(It);
+    } else {
+      const ByteCode &C = F.getByteCodeAt(I);
+      Item It{static_cast<Opcode>(C.getOpcode()), I, 1,
+              {C.HasIntOperand() ? C.getIntOperand() : 0, 0, 0}};
+      switch (C.getOpcode()) {
+      case ByteCode::LOAD_LOCAL:
+      case ByteCode::STORE_LOCAL: {
+        const SlotTy &Local = LocalAt(C.getStrOperand());
+        It.Immediates[0] = Local.first;
+        if (Local.second)
+          It.Op = EncodedFunction::LOAD_LOCAL_ADDRESS;
+        break;
+      }
+      case ByteCode::LOAD_GLOBAL:
+      case ByteCode::STORE_GLOBAL: {
+        auto Iter = Globals.find(C.getStrOperand());
+        assert(Iter != Globals.end() && "Undefined global");
+        It.Immediates[0] = Iter->second.first;
+        if (Iter->second.second)
+          It.Op = EncodedFunction::LOAD_CONST;
+        break;
+      }
+      case ByteCode::CALL_FUNCTION:
+        It.Immediates[0] = TheModule->getFunctionIndex(C.getStrOperand());
+        assert(It.Immediates[0] >= 0 && "Undefined function");
+        break;
+      default:
+        break;
+      }
+      Items.push_back(It);
+    }
+    I += Items.back().Length;
+  }
+
+  /// Return the size of It, given the sizes of its targets.
+  auto SizeOf = [](const Item &It, const std::vector<unsigned> &TargetSizes,
+                   unsigned Idx) {
+    unsigned Size = 1;
+    const ImmediateKind *K = EncodedFunction::getImmediateKinds(It.Op);
+    for (unsigned J = 0; K[J] != EncodedFunction::NoImmediate; J++) {
+      switch (K[J]) {
+      case EncodedFunction::UnsignedImmediate:
+        Size += EncodedFunction::getUnsignedSize(It.Immediates[J]);
+        break;
+      case EncodedFunction::SignedImmediate: {
+        std::vector<uint8_t> Bytes;
+        EncodedFunction::EncodeSigned(Bytes, It.Immediates[J]);
+        Size += Bytes.size();
+        break;
+      }
+      default:
+        Size += TargetSizes[Idx];
+        break;
+      }
+    }
+    return Size;
+  };
+
+  /// Size the instructions, growing the targets until they fit.
+  std::vector<unsigned> TargetSizes(Items.size(), 1);
+  std::vector<unsigned> Sizes(Items.size());
+  /// The offset of each ByteCode, and of the end of the code.
+  std::vector<unsigned> Offsets(F.size() + 1);
+  for (bool Changed = true; Changed;) {
+    Changed = false;
+    unsigned Offset = 0;
+    for (unsigned I = 0; I < Items.size(); I++) {
+      Sizes[I] = SizeOf(Items[I], TargetSizes, I);
+      for (unsigned J = 0; J < Items[I].Length; J++)
+        Offsets[Items[I].Start + J] = Offset;
+      Offset += Sizes[I];
+    }
+    Offsets.back() = Offset;
+    for (unsigned I = 0; I < Items.size(); I++) {
+      const ImmediateKind *K = EncodedFunction::getImmediateKinds(Items[I].Op);
+      for (unsigned J = 0; K[J] != EncodedFunction::NoImmediate; J++) {
+        if (K[J] != EncodedFunction::TargetImmediate)
+          continue;
+        int Target = Items[I].Immediates[J];
+        assert(Target >= 0 && static_cast<size_t>(Target) <= F.size() &&
+               "Jump target out of range");
+        unsigned Size = EncodedFunction::getUnsignedSize(Offsets[Target]);
+        if (Size > TargetSizes[I]) {
+          TargetSizes[I] = Size;
+          Changed = true;
+        }
+      }
+    }
+  }
+
+  /// Emit the instructions and their lines.
+  EF.Code.clear();
+  EF.Code.reserve(Offsets.back());
+  EF.LineTable.clear();
+  auto Self = static_cast<unsigned>(TheModule->getFunctionIndex(F.getName()));
+  for (unsigned I = 0; I < Items.size(); I++) {
+    const Item &It = Items[I];
+    const ByteCode &Start = F.getByteCodeAt(It.Start);
+    unsigned Lineno = Start.getSourceLineno();
+    unsigned Source = Start.getSourceFunction()
+                          ? TheModule->getFunctionIndex(Start.getSourceFunction())
+                          : Self;
+    if (EF.LineTable.empty() || EF.LineTable.back().Lineno != Lineno ||
+        EF.LineTable.back().Function != Source)
+      EF.LineTable.push_back(
+          EncodedFunction::LineEntry{Offsets[It.Start], Lineno, Source});
+    EF.Code.push_back(It.Op);
+    const ImmediateKind *K = EncodedFunction::getImmediateKinds(It.Op);
+    for (unsigned J = 0; K[J] != EncodedFunction::NoImmediate; J++) {
+      switch (K[J]) {
+      case EncodedFunction::UnsignedImmediate:
+        EncodedFunction::EncodeUnsigned(EF.Code, It.Immediates[J]);
+        break;
+      case EncodedFunction::SignedImmediate:
+        EncodedFunction::EncodeSigned(EF.Code, It.Immediates[J]);
+        break;
+      default:
+        EncodeUnsignedPadded(EF.Code, Offsets[It.Immediates[J]],
+                             TargetSizes[I]);
+        break;
+      }
+    }
+    assert(EF.Code.size() == Offsets[It.Start] + Sizes[I] &&
+           "Wrong size of instruction");
+  }
+}
+
+void ByteCodeEncoder::Encode(const ByteCodeModule &M, EncodedModule &EM) {
+  TheModule = &EM;
+
+  Globals.clear();
+  unsigned Address = 0;
+  for (const SymbolEntry &E : M.getGlobalVariables()) {
+    bool IsArray = E.IsArray();
+    Globals.emplace(E.getName(), SlotTy(Address, IsArray));
+    Address += IsArray ? E.AsArray().getSize() : 1;
+  }
+  EM.GlobalsSize = Address;
+
+  EM.StringLiterals.assign(M.getStringLiteralTable().size(), std::string());
+  for (const auto &Item : M.getStringLiteralTable()) {
+    const std::string &Quoted = Item.first;
+    EM.StringLiterals[Item.second] = Quoted.substr(1, Quoted.size() - 2);
+  }
+
+  EM.FunctionIndices.clear();
+  for (const ByteCodeFunction *F : M) {
+    EM.FunctionIndices.emplace(F->getName(), EM.FunctionIndices.size());
+  }
+  EM.Functions.assign(M.size(), EncodedFunction());
+  EM.IsDecoded.assign(M.size(), true);
+  EM.File.reset();
+  EM.Bodies.clear();
+  for (unsigned I = 0; I < M.size(); I++) {
+    EncodeFunction(*M.getFunctionList()[I], EM.Functions[I]);
+  }
+  /// The depth of the stack is the one the verifier finds, once the
+  /// callees are encoded.
+  EncodedVerifier Verifier(EM.Functions, EM.GlobalsSize,
+                           EM.StringLiterals.size());
+  for (unsigned I = 0; I < M.size(); I++) {
+    EncodedFunction &EF = EM.Functions[I];
+    bool Failed = Verifier.Check(I, EF.Code.data(), EF.Code.size());
+    assert(!Failed && "Encoded a malformed function");
+    (void)Failed;
+    EF.MaxStackDepth = Verifier.getMaxStackDepth();
+  }
+  TheModule = nullptr;
+}
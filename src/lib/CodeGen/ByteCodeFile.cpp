@@ -0,0 +1,310 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "simplecc/CodeGen/ByteCodeFile.h"
+#include "simplecc/CodeGen/EncodedModule.h"
+#include "simplecc/CodeGen/EncodedVerifier.h"
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SIMPLECC_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define SIMPLECC_HAS_MMAP 0
+#endif
+
+using namespace simplecc;
+
+constexpr char ByteCodeFileReader::Magic[];
+constexpr uint32_t ByteCodeFileReader::Version;
+
+/// The number of words of the header, of an index entry, of the fields
+/// before the line table of a body and of a line entry.
+static constexpr size_t HeaderWords = 8;
+static constexpr size_t IndexEntryWords = 4;
+static constexpr size_t BodyHeaderWords = 5;
+static constexpr size_t LineEntryWords = 3;
+
+/// Append a little-endian word to Bytes.
+static void PutWord(std::vector<uint8_t> &Bytes, uint32_t Word) {
+  for (unsigned I = 0; I < 4; I++)
+    Bytes.push_back(static_cast<uint8_t>(Word >> (8 * I)));
+}
+
+/// Overwrite the word at Offset in Bytes.
+static void SetWord(std::vector<uint8_t> &Bytes, size_t Offset, uint32_t Word) {
+  for (unsigned I = 0; I < 4; I++)
+    Bytes[Offset + I] = static_cast<uint8_t>(Word >> (8 * I));
+}
+
+/// Return the little-endian word at P.
+static uint32_t GetWord(const uint8_t *P) {
+  return static_cast<uint32_t>(P[0]) | static_cast<uint32_t>(P[1]) << 8 |
+         static_cast<uint32_t>(P[2]) << 16 | static_cast<uint32_t>(P[3]) << 24;
+}
+
+ByteCodeFileImage::~ByteCodeFileImage() {
+#if SIMPLECC_HAS_MMAP
+  if (IsMapped) {
+    munmap(const_cast<uint8_t *>(Data), Size);
+    return;
+  }
+#endif
+  delete[] Data;
+}
+
+std::shared_ptr<ByteCodeFileImage>
+ByteCodeFileImage::Open(const std::string &Filename) {
+  std::shared_ptr<ByteCodeFileImage> Image(new ByteCodeFileImage());
+#if SIMPLECC_HAS_MMAP
+  int FD = open(Filename.c_str(), O_RDONLY);
+  if (FD < 0)
+    return nullptr;
+  struct stat Stat;
+  if (fstat(FD, &Stat) == 0 && Stat.st_size > 0) {
+    void *Addr = mmap(nullptr, Stat.st_size, PROT_READ, MAP_PRIVATE, FD, 0);
+    if (Addr != MAP_FAILED) {
+      Image->Data = static_cast<const uint8_t *>(Addr);
+      Image->Size = Stat.st_size;
+      Image->IsMapped = true;
+      close(FD);
+      return Image;
+    }
+  }
+  close(FD);
+#endif
+  /// Read the whole file, such as one that cannot be mapped.
+  std::ifstream IFS(Filename, std::ios::binary);
+  if (IFS.fail())
+    return nullptr;
+  std::vector<char> Bytes((std::istreambuf_iterator<char>(IFS)),
+                          std::istreambuf_iterator<char>());
+  uint8_t *Data = new uint8_t[Bytes.size()];
+  std::memcpy(Data, Bytes.data(), Bytes.size());
+  Image->Data = Data;
+  Image->Size = Bytes.size();
+  return Image;
+}
+
+void ByteCodeFileWriter::Write(const EncodedModule &M, std::ostream &O) {
+  const char *Magic = ByteCodeFileReader::Magic;
+  std::vector<uint8_t> Bytes(Magic, Magic + 4);
+  PutWord(Bytes, ByteCodeFileReader::Version);
+  PutWord(Bytes, EncodedFunction::NUM_OPCODES);
+  PutWord(Bytes, M.getGlobalsSize());
+  PutWord(Bytes, M.getStringLiterals().size());
+  PutWord(Bytes, M.size());
+  /// The offsets of the string literals and of the index.
+  PutWord(Bytes, 0);
+  PutWord(Bytes, 0);
+
+  SetWord(Bytes, 24, Bytes.size());
+  for (const std::string &Str : M.getStringLiterals()) {
+    PutWord(Bytes, Str.size());
+    Bytes.insert(Bytes.end(), Str.begin(), Str.end());
+  }
+
+  /// The index is filled in once the names and bodies are laid out.
+  size_t Index = Bytes.size();
+  SetWord(Bytes, 28, Index);
+  Bytes.resize(Index + 4 * IndexEntryWords * M.size());
+  for (unsigned F = 0; F < M.size(); F++) {
+    const std::string &Name = M.getFunction(F).getName();
+    SetWord(Bytes, Index + 4 * (IndexEntryWords * F), Bytes.size());
+    SetWord(Bytes, Index + 4 * (IndexEntryWords * F + 1), Name.size());
+    Bytes.insert(Bytes.end(), Name.begin(), Name.end());
+  }
+  for (unsigned F = 0; F < M.size(); F++) {
+    const EncodedFunction &EF = M.getFunction(F);
+    size_t Body = Bytes.size();
+    PutWord(Bytes, EF.getArgumentCount());
+    PutWord(Bytes, EF.getFrameSize());
+    PutWord(Bytes, EF.getMaxStackDepth());
+    PutWord(Bytes, EF.LineTable.size());
+    PutWord(Bytes, EF.getCode().size());
+    for (const auto &Entry : EF.LineTable) {
+      PutWord(Bytes, Entry.Offset);
+      PutWord(Bytes, Entry.Lineno);
+      PutWord(Bytes, Entry.Function);
+    }
+    Bytes.insert(Bytes.end(), EF.getCode().begin(), EF.getCode().end());
+    SetWord(Bytes, Index + 4 * (IndexEntryWords * F + 2), Body);
+    SetWord(Bytes, Index + 4 * (IndexEntryWords * F + 3), Bytes.size() - Body);
+  }
+  O.write(reinterpret_cast<const char *>(Bytes.data()), Bytes.size());
+}
+
+bool ByteCodeFileReader::Read(const std::string &Filename, EncodedModule &M) {
+  EM.clear();
+  std::shared_ptr<ByteCodeFileImage> Image = ByteCodeFileImage::Open(Filename);
+  if (!Image) {
+    EM.setErrorType("FileReadError");
+    EM.Error(Quote(Filename));
+    EM.setErrorType("ByteCodeFileError");
+    return true;
+  }
+  const uint8_t *Data = Image->data();
+  size_t Size = Image->size();
+  /// Return whether Count items of ItemSize bytes from Offset are in the file.
+  auto InFile = [Size](size_t Offset, size_t Count, size_t ItemSize) {
+    return Offset <= Size && Count <= (Size - Offset) / ItemSize;
+  };
+
+  if (!InFile(0, HeaderWords, 4) || std::memcmp(Data, Magic, 4) != 0) {
+    EM.Error(Quote(Filename), "is not a byte code file");
+    return true;
+  }
+  uint32_t FileVersion = GetWord(Data + 4);
+  if (FileVersion != Version) {
+    EM.Error(Quote(Filename), "has version", FileVersion, "but version",
+             Version, "is supported");
+    return true;
+  }
+  if (GetWord(Data + 8) != EncodedFunction::NUM_OPCODES) {
+    EM.Error(Quote(Filename), "was written with another set of opcodes");
+    return true;
+  }
+  auto Corrupt = [&](const char *What) {
+    EM.Error(Quote(Filename), "has a corrupt", What);
+    return true;
+  };
+
+  uint32_t NumStrings = GetWord(Data + 16);
+  uint32_t NumFunctions = GetWord(Data + 20);
+  size_t Offset = GetWord(Data + 24);
+  /// Each string literal takes at least a word.
+  if (!InFile(Offset, NumStrings, 4))
+    return Corrupt("string literal");
+  std::vector<std::string> StringLiterals(NumStrings);
+  for (std::string &Str : StringLiterals) {
+    if (!InFile(Offset, 1, 4))
+      return Corrupt("string literal");
+    size_t Length = GetWord(Data + Offset);
+    Offset += 4;
+    if (!InFile(Offset, Length, 1))
+      return Corrupt("string literal");
+    Str.assign(reinterpret_cast<const char *>(Data + Offset), Length);
+    Offset += Length;
+  }
+
+  size_t Index = GetWord(Data + 28);
+  if (!InFile(Index, NumFunctions, 4 * IndexEntryWords))
+    return Corrupt("function index");
+  EncodedModule::FunctionListTy Functions(NumFunctions);
+  std::unordered_map<std::string, unsigned> FunctionIndices;
+  std::vector<std::pair<size_t, size_t>> Bodies(NumFunctions);
+  for (unsigned F = 0; F < NumFunctions; F++) {
+    const uint8_t *Entry = Data + Index + 4 * IndexEntryWords * F;
+    size_t NameOffset = GetWord(Entry), NameSize = GetWord(Entry + 4);
+    size_t Body = GetWord(Entry + 8), BodySize = GetWord(Entry + 12);
+    if (!InFile(NameOffset, NameSize, 1))
+      return Corrupt("function name");
+    Functions[F].Name.assign(reinterpret_cast<const char *>(Data + NameOffset),
+                             NameSize);
+    if (!FunctionIndices.emplace(Functions[F].Name, F).second)
+      return Corrupt("function index");
+
+    /// Check the sizes of the parts of the body, which is decoded later.
+    if (!InFile(Body, BodySize, 1) || BodySize < 4 * BodyHeaderWords)
+      return Corrupt("function body");
+    size_t NumLines = GetWord(Data + Body + 12);
+    size_t CodeSize = GetWord(Data + Body + 16);
+    size_t Rest = BodySize - 4 * BodyHeaderWords;
+    if (NumLines > Rest / (4 * LineEntryWords) ||
+        CodeSize != Rest - 4 * LineEntryWords * NumLines)
+      return Corrupt("function body");
+    /// The frame holds the arguments, and it fits in memory with the stack.
+    EncodedFunction &EF = Functions[F];
+    EF.NumArguments = GetWord(Data + Body);
+    EF.FrameSize = GetWord(Data + Body + 4);
+    EF.MaxStackDepth = GetWord(Data + Body + 8);
+    if (EF.NumArguments > EF.FrameSize ||
+        EF.FrameSize > EncodedModule::MaxWords ||
+        EF.MaxStackDepth > EncodedModule::MaxWords - EF.FrameSize)
+      return Corrupt("function body");
+    /// The lines are sorted by offset within the code, and each is in one
+    /// of the functions.
+    const uint8_t *Line = Data + Body + 4 * BodyHeaderWords;
+    for (size_t I = 0; I < NumLines; I++, Line += 4 * LineEntryWords) {
+      if (GetWord(Line) >= CodeSize ||
+          (I && GetWord(Line) <= GetWord(Line - 4 * LineEntryWords)) ||
+          GetWord(Line + 8) >= NumFunctions)
+        return Corrupt("line table");
+    }
+    Bodies[F] = std::make_pair(Body, BodySize);
+  }
+
+  uint32_t GlobalsSize = GetWord(Data + 12);
+  if (GlobalsSize > EncodedModule::MaxWords)
+    return Corrupt("size of globals");
+  /// Check the code of every function, each of which may call any other.
+  /// The code is still decoded only when the function is first asked for.
+  EncodedVerifier Verifier(Functions, GlobalsSize, NumStrings,
+                           EM.getErrorType());
+  Verifier.setFilename(Filename);
+  for (unsigned F = 0; F < NumFunctions; F++) {
+    size_t Body = Bodies[F].first;
+    size_t NumLines = GetWord(Data + Body + 12);
+    size_t CodeSize = GetWord(Data + Body + 16);
+    if (Verifier.Check(F,
+                       Data + Body + 4 * (BodyHeaderWords +
+                                          LineEntryWords * NumLines),
+                       CodeSize)) {
+      EM.increaseErrorCount();
+      return true;
+    }
+    if (Functions[F].MaxStackDepth < Verifier.getMaxStackDepth())
+      return Corrupt("stack depth");
+  }
+
+  M.Functions.swap(Functions);
+  M.IsDecoded.assign(NumFunctions, false);
+  M.FunctionIndices.swap(FunctionIndices);
+  M.StringLiterals.swap(StringLiterals);
+  M.GlobalsSize = GlobalsSize;
+  M.File = Image;
+  M.Bodies.swap(Bodies);
+  return false;
+}
+
+void ByteCodeFileReader::DecodeFunction(const uint8_t *Body, size_t Size,
+                                        EncodedFunction &F) {
+  size_t NumLines = GetWord(Body + 12);
+  size_t CodeSize = GetWord(Body + 16);
+  const uint8_t *P = Body + 4 * BodyHeaderWords;
+  F.LineTable.resize(NumLines);
+  for (auto &Entry : F.LineTable) {
+    Entry.Offset = GetWord(P);
+    Entry.Lineno = GetWord(P + 4);
+    Entry.Function = GetWord(P + 8);
+    P += 4 * LineEntryWords;
+  }
+  F.Code.assign(P, P + CodeSize);
+  assert(P + CodeSize == Body + Size && "Body checked when read");
+  (void)Size;
+}
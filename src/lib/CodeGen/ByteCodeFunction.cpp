@@ -44,6 +44,13 @@ void ByteCodeFunction::Format(std::ostream &O) const {
     O << LocalVar << "\n";
   }
 
+  for (const Temporary &T : getTemporaries()) {
+    O << "Temporary(" << T.Name;
+    if (T.IsArray())
+      O << ", " << T.Size;
+    O << ")\n";
+  }
+
   for (const ByteCode &Code : *this) {
     O << Code << "\n";
   }
@@ -0,0 +1,235 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "simplecc/CodeGen/ByteCodeSimplifyCFG.h"
+#include "simplecc/CodeGen/ByteCodeCFG.h"
+#include "simplecc/CodeGen/ByteCodeFunction.h"
+
+using namespace simplecc;
+
+/// Return the number of operands a conditional jump pops.
+static unsigned getNumOperands(ByteCode::Opcode Op) {
+  switch (Op) {
+  case ByteCode::JUMP_IF_TRUE:
+  case ByteCode::JUMP_IF_FALSE:
+    return 1;
+  default:
+    return 2;
+  }
+}
+
+/// Return whether the conditional jump Op is taken on L and R, where R is
+/// unused by a jump of one operand.
+static bool IsTaken(ByteCode::Opcode Op, int L, int R) {
+  switch (Op) {
+  case ByteCode::JUMP_IF_TRUE:
+    return L != 0;
+  case ByteCode::JUMP_IF_FALSE:
+    return L == 0;
+  case ByteCode::JUMP_IF_EQUAL:
+    return L == R;
+  case ByteCode::JUMP_IF_NOT_EQUAL:
+    return L != R;
+  case ByteCode::JUMP_IF_GREATER:
+    return L > R;
+  case ByteCode::JUMP_IF_GREATER_EQUAL:
+    return L >= R;
+  case ByteCode::JUMP_IF_LESS:
+    return L < R;
+  case ByteCode::JUMP_IF_LESS_EQUAL:
+    return L <= R;
+  default:
+    assert(false && "Not a conditional jump");
+    return false;
+  }
+}
+
+/// Return the conditional jump taken exactly when Op is not.
+static ByteCode::Opcode getOppositeJump(ByteCode::Opcode Op) {
+  switch (Op) {
+  case ByteCode::JUMP_IF_TRUE:
+    return ByteCode::JUMP_IF_FALSE;
+  case ByteCode::JUMP_IF_FALSE:
+    return ByteCode::JUMP_IF_TRUE;
+  case ByteCode::JUMP_IF_EQUAL:
+    return ByteCode::JUMP_IF_NOT_EQUAL;
+  case ByteCode::JUMP_IF_NOT_EQUAL:
+    return ByteCode::JUMP_IF_EQUAL;
+  case ByteCode::JUMP_IF_GREATER:
+    return ByteCode::JUMP_IF_LESS_EQUAL;
+  case ByteCode::JUMP_IF_GREATER_EQUAL:
+    return ByteCode::JUMP_IF_LESS;
+  case ByteCode::JUMP_IF_LESS:
+    return ByteCode::JUMP_IF_GREATER_EQUAL;
+  case ByteCode::JUMP_IF_LESS_EQUAL:
+    return ByteCode::JUMP_IF_GREATER;
+  default:
+    assert(false && "Not a conditional jump");
+    return Op;
+  }
+}
+
+/// Return whether C is a jump that may fall through.
+static bool IsCondJump(const ByteCode &C) {
+  return C.IsJump() && C.getOpcode() != ByteCode::JUMP_FORWARD;
+}
+
+bool ByteCodeSimplifyCFG::removeUnreachableBlocks(ByteCodeCFG &CFG) {
+  std::vector<bool> Removed(CFG.getFunction().size(), false);
+  bool Changed = false;
+  for (unsigned B = 0, E = CFG.size(); B < E; ++B) {
+    if (CFG.isReachable(B))
+      continue;
+    const ByteCodeCFG::Block &BB = CFG.getBlock(B);
+    for (unsigned Off = BB.Begin; Off < BB.End; ++Off)
+      Removed[Off] = true;
+    Changed = true;
+  }
+  if (Changed)
+    CFG.remove(Removed);
+  return Changed;
+}
+
+bool ByteCodeSimplifyCFG::foldConstantJumps(ByteCodeCFG &CFG) {
+  const ByteCodeFunction &F = CFG.getFunction();
+  std::vector<bool> Removed(F.size(), false);
+  bool Changed = false;
+  for (unsigned B = 0, E = CFG.size(); B < E; ++B) {
+    const ByteCodeCFG::Block &BB = CFG.getBlock(B);
+    const ByteCode &Last = CFG.getTerminator(B);
+    if (!IsCondJump(Last))
+      continue;
+    /// The operands must be constants loaded in this block.
+    unsigned NumOperands = getNumOperands(Last.getOpcode());
+    unsigned Jump = BB.End - 1;
+    if (Jump < BB.Begin + NumOperands)
+      continue;
+    int Operands[2] = {0, 0};
+    bool AllConstant = true;
+    for (unsigned I = 0; I < NumOperands; ++I) {
+      const ByteCode &C = F.getByteCodeAt(Jump - NumOperands + I);
+      AllConstant &= C.getOpcode() == ByteCode::LOAD_CONST;
+      if (AllConstant)
+        Operands[I] = C.getIntOperand();
+    }
+    if (!AllConstant)
+      continue;
+
+    for (unsigned I = 0; I < NumOperands; ++I)
+      Removed[Jump - NumOperands + I] = true;
+    if (IsTaken(Last.getOpcode(), Operands[0], Operands[1]))
+      CFG.replace(Jump, ByteCode::Create(ByteCode::JUMP_FORWARD,
+                                         Last.getJumpTarget()));
+    else
+      Removed[Jump] = true;
+    Changed = true;
+  }
+  if (Changed)
+    CFG.remove(Removed);
+  return Changed;
+}
+
+bool ByteCodeSimplifyCFG::collapseJumpChains(ByteCodeCFG &CFG) {
+  const ByteCodeFunction &F = CFG.getFunction();
+  bool Changed = false;
+  for (unsigned Off = 0, E = F.size(); Off < E; ++Off) {
+    const ByteCode &C = F.getByteCodeAt(Off);
+    if (!C.IsJump())
+      continue;
+    /// Follow the JUMP_FORWARD's, at most E of them in case they loop.
+    unsigned Target = C.getJumpTarget();
+    for (unsigned Steps = 0; Steps < E; ++Steps) {
+      const ByteCode &Next = F.getByteCodeAt(Target);
+      if (Next.getOpcode() != ByteCode::JUMP_FORWARD ||
+          Next.getJumpTarget() == Target)
+        break;
+      Target = Next.getJumpTarget();
+    }
+    if (C.getOpcode() == ByteCode::JUMP_FORWARD &&
+        F.getByteCodeAt(Target).getOpcode() == ByteCode::RETURN_NONE) {
+      CFG.replace(Off, ByteCode::Create(ByteCode::RETURN_NONE));
+      Changed = true;
+      continue;
+    }
+    if (Target != C.getJumpTarget()) {
+      CFG.setJumpTarget(Off, Target);
+      Changed = true;
+    }
+  }
+  return Changed;
+}
+
+bool ByteCodeSimplifyCFG::invertJumpsOverJumps(ByteCodeCFG &CFG) {
+  const ByteCodeFunction &F = CFG.getFunction();
+  std::vector<bool> Removed(F.size(), false);
+  bool Changed = false;
+  /// Turn "Jc L; JUMP_FORWARD M; L:" into "J!c M; L:", if nothing else
+  /// jumps to the JUMP_FORWARD.
+  for (unsigned Off = 0, E = F.size(); Off + 2 < E; ++Off) {
+    const ByteCode &C = F.getByteCodeAt(Off);
+    const ByteCode &Next = F.getByteCodeAt(Off + 1);
+    if (!IsCondJump(C) || C.getJumpTarget() != Off + 2 ||
+        Next.getOpcode() != ByteCode::JUMP_FORWARD ||
+        Next.getJumpTarget() == Off + 1 || CFG.IsJumpTarget(Off + 1) ||
+        Removed[Off])
+      continue;
+    CFG.replace(Off, ByteCode::Create(getOppositeJump(C.getOpcode()),
+                                      Next.getJumpTarget()));
+    Removed[Off + 1] = true;
+    Changed = true;
+  }
+  if (Changed)
+    CFG.remove(Removed);
+  return Changed;
+}
+
+bool ByteCodeSimplifyCFG::removeJumpsToNext(ByteCodeCFG &CFG) {
+  const ByteCodeFunction &F = CFG.getFunction();
+  std::vector<bool> Removed(F.size(), false);
+  bool Changed = false;
+  for (unsigned Off = 0, E = F.size(); Off < E; ++Off) {
+    const ByteCode &C = F.getByteCodeAt(Off);
+    if (C.getOpcode() == ByteCode::JUMP_FORWARD &&
+        C.getJumpTarget() == Off + 1) {
+      Removed[Off] = true;
+      Changed = true;
+    }
+  }
+  if (Changed)
+    CFG.remove(Removed);
+  return Changed;
+}
+
+bool ByteCodeSimplifyCFG::Transform(ByteCodeFunction &F) {
+  ByteCodeCFG CFG(F);
+  bool Changed = false;
+  for (bool LocalChanged = true; LocalChanged;) {
+    LocalChanged = removeUnreachableBlocks(CFG);
+    LocalChanged |= foldConstantJumps(CFG);
+    LocalChanged |= collapseJumpChains(CFG);
+    LocalChanged |= invertJumpsOverJumps(CFG);
+    LocalChanged |= removeJumpsToNext(CFG);
+    Changed |= LocalChanged;
+  }
+  return Changed;
+}
@@ -0,0 +1,369 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "simplecc/CodeGen/ByteCodeVerifier.h"
+#include "simplecc/CodeGen/ByteCodeFunction.h"
+#include "simplecc/CodeGen/ByteCodeModule.h"
+#include <utility>
+
+using namespace simplecc;
+
+const char *ByteCodeVerifier::getKindName(ValueKind K) {
+  switch (K) {
+  case Int:
+    return "int";
+  case Char:
+    return "char";
+  case Word:
+    return "word";
+  case IntArray:
+    return "int array";
+  case CharArray:
+    return "char array";
+  case WordArray:
+    return "array";
+  case String:
+    return "string";
+  case Void:
+    return "void";
+  }
+  return "";
+}
+
+ByteCodeVerifier::ValueKind ByteCodeVerifier::getKind(BasicTypeKind T) {
+  switch (T) {
+  case BasicTypeKind::Int:
+    return Int;
+  case BasicTypeKind::Character:
+    return Char;
+  default:
+    return Void;
+  }
+}
+
+ByteCodeVerifier::ValueKind ByteCodeVerifier::getKind(const SymbolEntry &E) {
+  if (E.IsArray()) {
+    ValueKind Elem = getKind(E.AsArray().getElementType());
+    return static_cast<ValueKind>(IntArray + Elem);
+  }
+  return getKind(E.AsVariable().getType());
+}
+
+bool ByteCodeVerifier::IsAssignable(ValueKind To, ValueKind From) {
+  /// A char in parentheses is an int, but no int is ever a char.
+  return IsScalar(From) && !(To == Char && From == Int);
+}
+
+bool ByteCodeVerifier::Join(ValueKind &A, ValueKind B) {
+  if (A == B)
+    return true;
+  if (IsScalar(A) && IsScalar(B)) {
+    A = Word;
+    return true;
+  }
+  if (IsArray(A) && IsArray(B)) {
+    A = WordArray;
+    return true;
+  }
+  return false;
+}
+
+template <typename... Args> void ByteCodeVerifier::Error(Args &&... args) {
+  EM.Error("in function", Quote(TheFunction->getName()) + ",",
+           "offset " + std::to_string(Offset) + ":",
+           std::forward<Args>(args)...);
+}
+
+void ByteCodeVerifier::AssertThat(bool Predicate, const char *ErrMsg) {
+  if (!Predicate)
+    Error(ErrMsg);
+}
+
+void ByteCodeVerifier::push(ValueKind K) { Stack.push_back(K); }
+
+ByteCodeVerifier::ValueKind ByteCodeVerifier::pop() {
+  if (Stack.empty()) {
+    /// Report only the first pop of an empty stack.
+    if (!Underflow)
+      Error("stack underflow");
+    Underflow = true;
+    return Word;
+  }
+  ValueKind K = Stack.back();
+  Stack.pop_back();
+  return K;
+}
+
+ByteCodeVerifier::ValueKind ByteCodeVerifier::popScalar(const char *What,
+                                                        ValueKind To) {
+  ValueKind K = pop();
+  if (!IsScalar(K))
+    Error(What, "must be a scalar, not", getKindName(K));
+  else if (!IsAssignable(To, K))
+    Error(What, "must be", std::string(getKindName(To)) + ",", "not",
+          getKindName(K));
+  return K;
+}
+
+void ByteCodeVerifier::visitLoadLocal(const ByteCode &C) {
+  push(Locals.at(C.getStrOperand()));
+}
+
+void ByteCodeVerifier::visitLoadGlobal(const ByteCode &C) {
+  push(Globals.at(C.getStrOperand()));
+}
+
+void ByteCodeVerifier::visitStoreLocal(const ByteCode &C) {
+  popScalar("stored value", Locals.at(C.getStrOperand()));
+}
+
+void ByteCodeVerifier::visitStoreGlobal(const ByteCode &C) {
+  popScalar("stored value", Globals.at(C.getStrOperand()));
+}
+
+void ByteCodeVerifier::visitBinary() {
+  popScalar("operand");
+  popScalar("operand");
+  push(Int);
+}
+
+void ByteCodeVerifier::visitUnary() {
+  popScalar("operand");
+  push(Int);
+}
+
+void ByteCodeVerifier::visitCompare() {
+  popScalar("operand");
+  popScalar("operand");
+}
+
+void ByteCodeVerifier::visitBinarySubscr(const ByteCode &) {
+  popScalar("array index", Int);
+  ValueKind Base = pop();
+  AssertThat(Underflow || IsArray(Base), "subscript of a non-array");
+  push(IsArray(Base) ? getElementKind(Base) : Word);
+}
+
+void ByteCodeVerifier::visitStoreSubscr(const ByteCode &) {
+  popScalar("array index", Int);
+  ValueKind Base = pop();
+  AssertThat(Underflow || IsArray(Base), "subscript of a non-array");
+  popScalar("stored value", IsArray(Base) ? getElementKind(Base) : Word);
+}
+
+void ByteCodeVerifier::visitPrintString(const ByteCode &) {
+  ValueKind K = pop();
+  AssertThat(Underflow || K == String, "printed value must be a string");
+}
+
+void ByteCodeVerifier::visitCallFunction(const ByteCode &C) {
+  const ByteCodeFunction *Callee = Functions.at(C.getStrOperand());
+  /// The last argument is on the top.
+  const auto &Arguments = Callee->getFormalArguments();
+  for (auto Iter = Arguments.rbegin(); Iter != Arguments.rend(); ++Iter)
+    popScalar("argument", getKind(*Iter));
+  push(ReturnKinds.at(C.getStrOperand()));
+}
+
+void ByteCodeVerifier::visitReturnValue(const ByteCode &) {
+  ValueKind Ret = ReturnKinds.at(TheFunction->getName());
+  AssertThat(Ret != Void, "void function returns a value");
+  popScalar("returned value", Ret == Void ? Word : Ret);
+}
+
+void ByteCodeVerifier::verifyOperands(const ByteCode &C) {
+  AssertThat(C.getByteCodeOffset() == Offset, "wrong offset");
+  if (C.HasStrOperand() && !C.getStrOperand()) {
+    Error("missing name");
+    return;
+  }
+  switch (C.getOpcode()) {
+  case ByteCode::LOAD_LOCAL:
+  case ByteCode::STORE_LOCAL: {
+    auto Iter = Locals.find(C.getStrOperand());
+    if (Iter == Locals.end()) {
+      Error("undefined local", Quote(C.getStrOperand()));
+      break;
+    }
+    AssertThat(C.getOpcode() == ByteCode::LOAD_LOCAL || IsScalar(Iter->second),
+               "store to an array");
+    break;
+  }
+  case ByteCode::LOAD_GLOBAL:
+  case ByteCode::STORE_GLOBAL: {
+    auto Iter = Globals.find(C.getStrOperand());
+    if (Iter == Globals.end()) {
+      Error("undefined global", Quote(C.getStrOperand()));
+      break;
+    }
+    AssertThat(C.getOpcode() == ByteCode::LOAD_GLOBAL ||
+                   IsScalar(Iter->second),
+               "store to an array");
+    break;
+  }
+  case ByteCode::CALL_FUNCTION: {
+    auto Iter = Functions.find(C.getStrOperand());
+    if (Iter == Functions.end()) {
+      Error("undefined function", Quote(C.getStrOperand()));
+      break;
+    }
+    AssertThat(C.getIntOperand() >= 0 &&
+                   unsigned(C.getIntOperand()) ==
+                       Iter->second->getFormalArgumentCount(),
+               "wrong number of arguments");
+    break;
+  }
+  case ByteCode::LOAD_STRING:
+    AssertThat(C.getIntOperand() >= 0 &&
+                   unsigned(C.getIntOperand()) < TheFunction->getParent()
+                                                     ->getStringLiteralTable()
+                                                     .size(),
+               "undefined string literal");
+    break;
+  default:
+    if (C.IsJump()) {
+      AssertThat(C.getIntOperand() >= 0 &&
+                     unsigned(C.getIntOperand()) < TheFunction->size(),
+                 "jump target out of range");
+    }
+    break;
+  }
+}
+
+bool ByteCodeVerifier::mergeInto(unsigned B) {
+  if (!Reached[B]) {
+    Reached[B] = true;
+    EntryStacks[B] = Stack;
+    return true;
+  }
+  StackTy &Entry = EntryStacks[B];
+  Offset = CFG.getBlock(B).Begin;
+  if (Entry.size() != Stack.size()) {
+    Error("stack depth is", Entry.size(), "or", Stack.size(),
+          "where control flow merges");
+    return false;
+  }
+  StackTy Old = Entry;
+  for (unsigned I = 0, E = Entry.size(); I < E; ++I) {
+    if (!Join(Entry[I], Stack[I])) {
+      Error("stack holds", getKindName(Entry[I]), "or",
+            getKindName(Stack[I]), "where control flow merges");
+      return false;
+    }
+  }
+  return Entry != Old;
+}
+
+void ByteCodeVerifier::verifyStack() {
+  CFG.recalculate(*TheFunction);
+  EntryStacks.assign(CFG.size(), StackTy());
+  Reached.assign(CFG.size(), false);
+  Reached[0] = true;
+  std::vector<unsigned> Worklist{0};
+  std::vector<bool> Queued(CFG.size(), false);
+  Queued[0] = true;
+  int Prev = EM.getErrorCount();
+
+  while (!Worklist.empty()) {
+    unsigned B = Worklist.back();
+    Worklist.pop_back();
+    Queued[B] = false;
+    const ByteCodeCFG::Block &Block = CFG.getBlock(B);
+    Stack = EntryStacks[B];
+    Underflow = false;
+    for (Offset = Block.Begin; Offset < Block.End && !Underflow; ++Offset)
+      visit(TheFunction->getByteCodeAt(Offset));
+    /// Running the block again would report the same errors.
+    if (!EM.IsOk(Prev))
+      return;
+    for (unsigned Succ : Block.Successors) {
+      if (mergeInto(Succ) && !Queued[Succ]) {
+        Queued[Succ] = true;
+        Worklist.push_back(Succ);
+      }
+    }
+    if (!EM.IsOk(Prev))
+      return;
+  }
+}
+
+void ByteCodeVerifier::checkFunction(const ByteCodeFunction &F) {
+  TheFunction = &F;
+  Offset = 0;
+  if (F.empty()) {
+    Error("function has no ByteCode");
+    return;
+  }
+
+  Locals.clear();
+  for (const SymbolEntry &E : F.getFormalArguments())
+    Locals.emplace(E.getName(), getKind(E));
+  for (const SymbolEntry &E : F.getLocalVariables())
+    Locals.emplace(E.getName(), getKind(E));
+  for (const auto &T : F.getTemporaries())
+    Locals.emplace(T.Name, T.IsArray() ? WordArray : Word);
+
+  int Prev = EM.getErrorCount();
+  for (Offset = 0; Offset < F.size(); ++Offset)
+    verifyOperands(F.getByteCodeAt(Offset));
+  Offset = F.size() - 1;
+  ByteCode::Opcode Last = F.getByteCodeAt(Offset).getOpcode();
+  AssertThat(Last == ByteCode::JUMP_FORWARD ||
+                 Last == ByteCode::RETURN_VALUE ||
+                 Last == ByteCode::RETURN_NONE,
+             "control falls off the end");
+  /// The blocks cannot be built on broken jumps.
+  if (EM.IsOk(Prev))
+    verifyStack();
+}
+
+void ByteCodeVerifier::setModule(const ByteCodeModule &M) {
+  Globals.clear();
+  for (const SymbolEntry &E : M.getGlobalVariables())
+    Globals.emplace(E.getName(), getKind(E));
+  Functions.clear();
+  ReturnKinds.clear();
+  for (const ByteCodeFunction *F : M) {
+    Functions.emplace(F->getName(), F);
+    SymbolEntry E = F->getLocalTable()[F->getName()];
+    ReturnKinds.emplace(F->getName(),
+                        getKind(E.AsFunction().getReturnType()));
+  }
+}
+
+bool ByteCodeVerifier::Check(const ByteCodeFunction &F) {
+  EM.setErrorType("InternalError");
+  int Prev = EM.getErrorCount();
+  setModule(*F.getParent());
+  checkFunction(F);
+  return !EM.IsOk(Prev);
+}
+
+bool ByteCodeVerifier::Check(const ByteCodeModule &M) {
+  EM.setErrorType("InternalError");
+  int Prev = EM.getErrorCount();
+  setModule(M);
+  for (const ByteCodeFunction *F : M)
+    checkFunction(*F);
+  return !EM.IsOk(Prev);
+}
@@ -0,0 +1,224 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "simplecc/CodeGen/CallGraph.h"
+#include "simplecc/AST/ChildrenVisitor.h"
+#include "simplecc/CodeGen/ByteCodeFunction.h"
+#include "simplecc/CodeGen/ByteCodeModule.h"
+#include <algorithm> // find(), min(), reverse()
+
+using namespace simplecc;
+
+namespace {
+/// Collect the callee of each CallExpr in a FuncDef.
+class CallCollector : ChildrenVisitor<CallCollector> {
+  friend ChildrenVisitor;
+  friend VisitorBase;
+  std::vector<std::string> &Callees;
+
+  void visitCall(CallExpr *C) {
+    Callees.push_back(C->getCallee());
+    ChildrenVisitor::visitCall(C);
+  }
+
+public:
+  explicit CallCollector(std::vector<std::string> &C) : Callees(C) {}
+  void Collect(FuncDef *FD) { visitFuncDef(FD); }
+};
+
+/// Tarjan's algorithm over the callees of each node.
+class SCCFinder {
+  const std::vector<std::vector<unsigned>> &Edges;
+  std::vector<std::vector<unsigned>> &SCCs;
+  std::vector<unsigned> Stack;
+  std::vector<int> DFSNumbers;
+  std::vector<unsigned> LowLinks;
+  std::vector<bool> OnStack;
+  int NextDFSNumber = 0;
+
+  void Visit(unsigned N) {
+    DFSNumbers[N] = LowLinks[N] = NextDFSNumber++;
+    Stack.push_back(N);
+    OnStack[N] = true;
+    for (unsigned M : Edges[N]) {
+      if (DFSNumbers[M] < 0) {
+        Visit(M);
+        LowLinks[N] = std::min(LowLinks[N], LowLinks[M]);
+      } else if (OnStack[M]) {
+        LowLinks[N] = std::min(LowLinks[N], unsigned(DFSNumbers[M]));
+      }
+    }
+    if (LowLinks[N] != unsigned(DFSNumbers[N]))
+      return;
+    /// N is the root of an SCC. Since the callees of N are finished first,
+    /// SCCs come out bottom-up.
+    SCCs.emplace_back();
+    unsigned M;
+    do {
+      M = Stack.back();
+      Stack.pop_back();
+      OnStack[M] = false;
+      SCCs.back().push_back(M);
+    } while (M != N);
+    std::reverse(SCCs.back().begin(), SCCs.back().end());
+  }
+
+public:
+  SCCFinder(const std::vector<std::vector<unsigned>> &E,
+            std::vector<std::vector<unsigned>> &S)
+      : Edges(E), SCCs(S), DFSNumbers(E.size(), -1), LowLinks(E.size()),
+        OnStack(E.size()) {}
+
+  void Run() {
+    for (unsigned N = 0, E = Edges.size(); N < E; ++N)
+      if (DFSNumbers[N] < 0)
+        Visit(N);
+  }
+};
+} // namespace
+
+void CallGraph::clear() {
+  Nodes.clear();
+  Indices.clear();
+  SCCs.clear();
+}
+
+int CallGraph::getIndex(const std::string &Name) const {
+  auto Iter = Indices.find(Name);
+  return Iter == Indices.end() ? -1 : int(Iter->second);
+}
+
+void CallGraph::addFunction(const std::string &Name) {
+  Indices.emplace(Name, Nodes.size());
+  Nodes.emplace_back();
+  Nodes.back().Name = Name;
+}
+
+void CallGraph::addCall(unsigned Caller, const std::string &Callee) {
+  int Idx = getIndex(Callee);
+  assert(Idx >= 0 && "Call to an undefined function");
+  std::vector<unsigned> &Callees = Nodes[Caller].Callees;
+  if (std::find(Callees.begin(), Callees.end(), Idx) != Callees.end())
+    return;
+  Callees.push_back(Idx);
+  Nodes[Idx].Callers.push_back(Caller);
+}
+
+void CallGraph::Build(const ByteCodeModule &M) {
+  clear();
+  for (const ByteCodeFunction *Fn : M)
+    addFunction(Fn->getName());
+  unsigned Caller = 0;
+  for (const ByteCodeFunction *Fn : M) {
+    for (const ByteCode &C : *Fn)
+      if (C.getOpcode() == ByteCode::CALL_FUNCTION)
+        addCall(Caller, C.getStrOperand());
+    ++Caller;
+  }
+  Finalize();
+}
+
+void CallGraph::Build(const ProgramAST *P) {
+  clear();
+  std::vector<FuncDef *> FuncDefs;
+  for (DeclAST *D : P->getDecls())
+    if (auto FD = subclass_cast<FuncDef>(D)) {
+      addFunction(FD->getName());
+      FuncDefs.push_back(FD);
+    }
+  for (unsigned Caller = 0, E = FuncDefs.size(); Caller < E; ++Caller) {
+    std::vector<std::string> Callees;
+    CallCollector(Callees).Collect(FuncDefs[Caller]);
+    for (const std::string &Callee : Callees)
+      addCall(Caller, Callee);
+  }
+  Finalize();
+}
+
+void CallGraph::Finalize() {
+  std::vector<std::vector<unsigned>> Edges;
+  Edges.reserve(size());
+  for (const Node &N : Nodes)
+    Edges.push_back(N.Callees);
+  SCCFinder(Edges, SCCs).Run();
+
+  for (unsigned I = 0, E = SCCs.size(); I < E; ++I) {
+    for (unsigned F : SCCs[I]) {
+      Nodes[F].SCC = I;
+      /// A function in an SCC with others calls itself through them.
+      Nodes[F].Recursive = SCCs[I].size() > 1;
+    }
+  }
+  for (unsigned F = 0, E = size(); F < E; ++F) {
+    const std::vector<unsigned> &Callees = Nodes[F].Callees;
+    if (std::find(Callees.begin(), Callees.end(), F) != Callees.end())
+      Nodes[F].Recursive = true;
+  }
+
+  /// Everything that runs is called from main, directly or not.
+  int Main = getIndex("main");
+  if (Main < 0)
+    return;
+  std::vector<unsigned> WorkList{unsigned(Main)};
+  Nodes[Main].Reachable = true;
+  while (!WorkList.empty()) {
+    unsigned F = WorkList.back();
+    WorkList.pop_back();
+    for (unsigned Callee : Nodes[F].Callees) {
+      if (Nodes[Callee].Reachable)
+        continue;
+      Nodes[Callee].Reachable = true;
+      WorkList.push_back(Callee);
+    }
+  }
+}
+
+std::vector<unsigned> CallGraph::getBottomUpOrder() const {
+  std::vector<unsigned> Order;
+  Order.reserve(size());
+  for (const auto &SCC : SCCs)
+    Order.insert(Order.end(), SCC.begin(), SCC.end());
+  return Order;
+}
+
+void CallGraph::Format(std::ostream &O) const {
+  for (unsigned F = 0, E = size(); F < E; ++F) {
+    O << getName(F) << ":";
+    for (unsigned Callee : getCallees(F))
+      O << " " << getName(Callee);
+    if (isLeaf(F))
+      O << " (leaf)";
+    if (isRecursive(F))
+      O << " (recursive)";
+    if (!isReachable(F))
+      O << " (unreachable)";
+    O << "\n";
+  }
+
+  O << "\nSCCs in bottom-up order:\n";
+  for (const auto &SCC : SCCs) {
+    O << "{";
+    for (unsigned I = 0, E = SCC.size(); I < E; ++I)
+      O << (I ? ", " : "") << getName(SCC[I]);
+    O << "}\n";
+  }
+}
@@ -22,7 +22,13 @@
 
 #include "simplecc/CodeGen/CodeGen.h"
 #include "simplecc/CodeGen/ByteCodeCompiler.h"
+#include "simplecc/CodeGen/ByteCodeEncoder.h"
+#include "simplecc/CodeGen/ByteCodeFile.h"
+#include "simplecc/CodeGen/ByteCodeModule.h"
 #include "simplecc/CodeGen/ByteCodePrinter.h"
+#include "simplecc/CodeGen/ByteCodeSimplifyCFG.h"
+#include "simplecc/CodeGen/ByteCodeVerifier.h"
+#include "simplecc/CodeGen/RegisterByteCodeTranslator.h"
 
 namespace simplecc {
 void PrintByteCode(ProgramAST *P, std::ostream &O) {
@@ -32,4 +38,31 @@ void PrintByteCode(ProgramAST *P, std::ostream &O) {
 void CompileToByteCode(ProgramAST *P, const SymbolTable &S, ByteCodeModule &M) {
   ByteCodeCompiler().Compile(P, S, M);
 }
+
+void SimplifyByteCodeCFG(ByteCodeModule &M) {
+  for (ByteCodeFunction *F : M) {
+    ByteCodeSimplifyCFG().Transform(*F);
+  }
+}
+
+bool VerifyByteCode(const ByteCodeModule &M) {
+  return ByteCodeVerifier().Check(M);
+}
+
+void EncodeByteCode(const ByteCodeModule &M, EncodedModule &EM,
+                    bool SuperInstructions) {
+  ByteCodeEncoder(SuperInstructions).Encode(M, EM);
+}
+
+void TranslateToRegisterByteCode(const ByteCodeModule &M, RegisterModule &RM) {
+  RegisterByteCodeTranslator().Translate(M, RM);
+}
+
+void WriteByteCodeFile(const EncodedModule &EM, std::ostream &O) {
+  ByteCodeFileWriter().Write(EM, O);
+}
+
+bool ReadByteCodeFile(const std::string &Filename, EncodedModule &EM) {
+  return ByteCodeFileReader().Read(Filename, EM);
+}
 } // namespace simplecc
\ No newline at end of file
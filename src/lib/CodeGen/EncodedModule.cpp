@@ -0,0 +1,207 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "simplecc/CodeGen/EncodedModule.h"
+#include "simplecc/CodeGen/ByteCodeFile.h"
+#include <algorithm>
+#include <cassert>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+
+using namespace simplecc;
+
+constexpr unsigned EncodedFunction::MaxImmediates;
+constexpr unsigned EncodedModule::MaxWords;
+
+const EncodedFunction::ImmediateKind *
+EncodedFunction::getImmediateKinds(Opcode Op) {
+  static const ImmediateKind None[] = {NoImmediate};
+  static const ImmediateKind U[] = {UnsignedImmediate, NoImmediate};
+  static const ImmediateKind S[] = {SignedImmediate, NoImmediate};
+  static const ImmediateKind T[] = {TargetImmediate, NoImmediate};
+  static const ImmediateKind US[] = {UnsignedImmediate, SignedImmediate,
+                                     NoImmediate};
+  static const ImmediateKind UU[] = {UnsignedImmediate, UnsignedImmediate,
+                                     NoImmediate};
+  static const ImmediateKind UST[] = {UnsignedImmediate, SignedImmediate,
+                                      TargetImmediate, NoImmediate};
+  static const ImmediateKind UUT[] = {UnsignedImmediate, UnsignedImmediate,
+                                      TargetImmediate, NoImmediate};
+  switch (Op) {
+  case LOAD_LOCAL:
+  case LOAD_LOCAL_ADDRESS:
+  case LOAD_GLOBAL:
+  case STORE_LOCAL:
+  case STORE_GLOBAL:
+  case SHIFT_LEFT:
+  case SHIFT_RIGHT:
+  case SHIFT_RIGHT_LOGICAL:
+  case LOAD_STRING:
+  case CALL_FUNCTION:
+  case ADD_LOCAL:
+  case SUB_LOCAL:
+    return U;
+  case LOAD_CONST:
+  case MULTIPLY_HIGH:
+  case ADD_CONST:
+    return S;
+#define HANDLE_JUMP(opcode, camelName) case opcode:
+#include "simplecc/CodeGen/Opcode.def"
+    return T;
+  case INC_LOCAL:
+  case LOAD_LOCAL_ADD_CONST:
+  case STORE_LOCAL_CONST:
+    return US;
+  case MOVE_LOCAL:
+    return UU;
+#define HANDLE_COMPARE_LOCAL_CONST(opcode, camelName, Jump) case opcode:
+#include "simplecc/CodeGen/SuperInstruction.def"
+    return UST;
+#define HANDLE_COMPARE_LOCALS(opcode, camelName, Jump) case opcode:
+#include "simplecc/CodeGen/SuperInstruction.def"
+    return UUT;
+  default:
+    return None;
+  }
+}
+
+const char *EncodedFunction::getOpcodeName(Opcode Op) {
+  switch (Op) {
+#define HANDLE_OPCODE(opcode, camelName)                                       \
+  case opcode:                                                                 \
+    return #opcode;
+#include "simplecc/CodeGen/Opcode.def"
+  case LOAD_LOCAL_ADDRESS:
+    return "LOAD_LOCAL_ADDRESS";
+#define HANDLE_SUPER_INSTRUCTION(opcode, camelName)                            \
+  case opcode:                                                                 \
+    return #opcode;
+#include "simplecc/CodeGen/SuperInstruction.def"
+  default:
+    assert(false && "Invalid Opcode");
+    return nullptr;
+  }
+}
+
+void EncodedFunction::EncodeUnsigned(std::vector<uint8_t> &Code,
+                                     unsigned Val) {
+  while (Val >= 0x80) {
+    Code.push_back(static_cast<uint8_t>(Val | 0x80));
+    Val >>= 7;
+  }
+  Code.push_back(static_cast<uint8_t>(Val));
+}
+
+void EncodedFunction::EncodeSigned(std::vector<uint8_t> &Code, int Val) {
+  auto Bits = static_cast<unsigned>(Val);
+  EncodeUnsigned(Code, (Bits << 1) ^ (0u - (Bits >> 31)));
+}
+
+unsigned EncodedFunction::getUnsignedSize(unsigned Val) {
+  unsigned Size = 1;
+  while (Val >= 0x80) {
+    Val >>= 7;
+    ++Size;
+  }
+  return Size;
+}
+
+const EncodedFunction::LineEntry *
+EncodedFunction::findLineEntry(unsigned Offset) const {
+  auto Iter = std::upper_bound(
+      LineTable.begin(), LineTable.end(), Offset,
+      [](unsigned Offset, const LineEntry &E) { return Offset < E.Offset; });
+  return Iter == LineTable.begin() ? nullptr : &*std::prev(Iter);
+}
+
+unsigned EncodedFunction::getSourceLineno(unsigned Offset) const {
+  const LineEntry *E = findLineEntry(Offset);
+  return E ? E->Lineno : 0;
+}
+
+int EncodedFunction::getSourceFunction(unsigned Offset) const {
+  const LineEntry *E = findLineEntry(Offset);
+  return E ? static_cast<int>(E->Function) : -1;
+}
+
+void EncodedFunction::Format(std::ostream &O) const {
+  O << getName() << ": " << getArgumentCount() << " arguments, "
+    << getFrameSize() << " words of frame, " << Code.size() << " bytes\n";
+
+  const uint8_t *Begin = Code.data();
+  const uint8_t *PC = Begin;
+  const uint8_t *End = Begin + Code.size();
+  auto Line = LineTable.begin();
+  while (PC != End) {
+    auto Offset = static_cast<unsigned>(PC - Begin);
+    if (Line != LineTable.end() && Line->Offset == Offset) {
+      O << "Line " << Line->Lineno << "\n";
+      ++Line;
+    }
+    auto Op = static_cast<Opcode>(*PC++);
+    std::string Immediates;
+    for (const ImmediateKind *K = getImmediateKinds(Op); *K != NoImmediate;
+         ++K) {
+      if (!Immediates.empty())
+        Immediates += ", ";
+      if (*K == SignedImmediate)
+        Immediates += std::to_string(DecodeSigned(PC));
+      else
+        Immediates += std::to_string(DecodeUnsigned(PC));
+    }
+    O << std::left << std::setw(6) << Offset;
+    std::ostringstream Bytes;
+    for (const uint8_t *B = Begin + Offset; B != PC; ++B) {
+      Bytes << std::hex << std::setw(2) << std::setfill('0')
+            << static_cast<unsigned>(*B) << " ";
+    }
+    O << std::setw(19) << Bytes.str();
+    if (Immediates.empty())
+      O << getOpcodeName(Op) << "\n";
+    else
+      O << std::setw(35) << getOpcodeName(Op) << Immediates << "\n";
+  }
+}
+
+int EncodedModule::getFunctionIndex(const std::string &Name) const {
+  auto Iter = FunctionIndices.find(Name);
+  return Iter == FunctionIndices.end() ? -1 : static_cast<int>(Iter->second);
+}
+
+void EncodedModule::decodeFunction(unsigned F) const {
+  assert(File && "Function neither encoded nor read");
+  ByteCodeFileReader::DecodeFunction(File->data() + Bodies[F].first,
+                                     Bodies[F].second, Functions[F]);
+  IsDecoded[F] = true;
+}
+
+void EncodedModule::Format(std::ostream &O) const {
+  O << "Globals: " << getGlobalsSize() << " words\n";
+  for (unsigned I = 0; I < StringLiterals.size(); I++) {
+    O << "String " << I << ": \"" << StringLiterals[I] << "\"\n";
+  }
+  for (unsigned F = 0; F < size(); F++) {
+    O << "\n" << getFunction(F);
+  }
+}
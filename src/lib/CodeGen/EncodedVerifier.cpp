@@ -0,0 +1,318 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "simplecc/CodeGen/EncodedVerifier.h"
+#include <algorithm>
+#include <string>
+#include <utility>
+
+using namespace simplecc;
+
+/// Decode an unsigned immediate at PC, which ends before End, into Val and
+/// advance PC past it. Return false if it runs past End or does not fit in
+/// 32 bits.
+static bool DecodeUnsigned(const uint8_t *&PC, const uint8_t *End,
+                           unsigned &Val) {
+  Val = 0;
+  for (unsigned Shift = 0; Shift < 32; Shift += 7) {
+    if (PC == End)
+      return false;
+    uint8_t Byte = *PC++;
+    /// The fifth byte holds the last four bits.
+    if (Shift == 28 && Byte > 0x0f)
+      return false;
+    Val |= static_cast<unsigned>(Byte & 0x7f) << Shift;
+    if (!(Byte & 0x80))
+      return true;
+  }
+  return false;
+}
+
+template <typename... Args>
+void EncodedVerifier::Error(unsigned Offset, Args &&... args) {
+  std::string Where = "in function " + Quote(TheFunction->getName());
+  if (!Filename.empty())
+    Where += " of " + Quote(Filename);
+  EM.Error(Where + ",", "offset " + std::to_string(Offset) + ":",
+           std::forward<Args>(args)...);
+}
+
+bool EncodedVerifier::decode(const uint8_t *Code, size_t Size) {
+  Insts.clear();
+  IndexAt.assign(Size, -1);
+  const uint8_t *PC = Code;
+  const uint8_t *End = Code + Size;
+  while (PC != End) {
+    auto Offset = static_cast<unsigned>(PC - Code);
+    if (*PC >= EncodedFunction::NUM_OPCODES) {
+      Error(Offset, "invalid opcode", static_cast<unsigned>(*PC));
+      return false;
+    }
+    Instruction I{static_cast<Opcode>(*PC++), Offset, {0, 0, 0}};
+    const EncodedFunction::ImmediateKind *K =
+        EncodedFunction::getImmediateKinds(I.Op);
+    for (unsigned J = 0; K[J] != EncodedFunction::NoImmediate; J++) {
+      if (!DecodeUnsigned(PC, End, I.Immediates[J])) {
+        Error(Offset, "malformed immediate");
+        return false;
+      }
+    }
+    if (!checkImmediates(I))
+      return false;
+    IndexAt[Offset] = static_cast<int>(Insts.size());
+    Insts.push_back(I);
+  }
+
+  /// Resolve the targets now that the instructions are known.
+  IsTarget.assign(Insts.size(), false);
+  for (const Instruction &I : Insts) {
+    const EncodedFunction::ImmediateKind *K =
+        EncodedFunction::getImmediateKinds(I.Op);
+    for (unsigned J = 0; K[J] != EncodedFunction::NoImmediate; J++) {
+      if (K[J] != EncodedFunction::TargetImmediate)
+        continue;
+      unsigned Target = I.Immediates[J];
+      if (Target >= Size || IndexAt[Target] < 0) {
+        Error(I.Offset, "jump target out of range");
+        return false;
+      }
+      IsTarget[IndexAt[Target]] = true;
+    }
+  }
+  return true;
+}
+
+bool EncodedVerifier::checkImmediates(const Instruction &I) {
+  unsigned Imm = I.Immediates[0];
+  switch (I.Op) {
+  case EncodedFunction::LOAD_GLOBAL:
+  case EncodedFunction::STORE_GLOBAL:
+    if (Imm >= GlobalsSize) {
+      Error(I.Offset, "global out of range");
+      return false;
+    }
+    return true;
+  case EncodedFunction::CALL_FUNCTION:
+    if (Imm >= Functions.size()) {
+      Error(I.Offset, "undefined function");
+      return false;
+    }
+    return true;
+  case EncodedFunction::LOAD_STRING:
+    if (Imm >= NumStrings) {
+      Error(I.Offset, "undefined string literal");
+      return false;
+    }
+    return true;
+  case EncodedFunction::SHIFT_LEFT:
+  case EncodedFunction::SHIFT_RIGHT:
+  case EncodedFunction::SHIFT_RIGHT_LOGICAL:
+    if (Imm >= 32) {
+      Error(I.Offset, "shift out of range");
+      return false;
+    }
+    return true;
+  default:
+    break;
+  }
+  /// Any other unsigned immediate is a local.
+  const EncodedFunction::ImmediateKind *K =
+      EncodedFunction::getImmediateKinds(I.Op);
+  for (unsigned J = 0; K[J] != EncodedFunction::NoImmediate; J++) {
+    if (K[J] == EncodedFunction::UnsignedImmediate &&
+        I.Immediates[J] >= TheFunction->getFrameSize()) {
+      Error(I.Offset, "local out of range");
+      return false;
+    }
+  }
+  return true;
+}
+
+unsigned EncodedVerifier::getPopCount(const Instruction &I) const {
+  switch (I.Op) {
+  case EncodedFunction::STORE_SUBSCR:
+    return 3;
+  case EncodedFunction::BINARY_ADD:
+  case EncodedFunction::BINARY_SUB:
+  case EncodedFunction::BINARY_MULTIPLY:
+  case EncodedFunction::BINARY_DIVIDE:
+  case EncodedFunction::BINARY_SUBSCR:
+  case EncodedFunction::JUMP_IF_EQUAL:
+  case EncodedFunction::JUMP_IF_NOT_EQUAL:
+  case EncodedFunction::JUMP_IF_GREATER:
+  case EncodedFunction::JUMP_IF_GREATER_EQUAL:
+  case EncodedFunction::JUMP_IF_LESS:
+  case EncodedFunction::JUMP_IF_LESS_EQUAL:
+    return 2;
+  case EncodedFunction::STORE_LOCAL:
+  case EncodedFunction::STORE_GLOBAL:
+  case EncodedFunction::POP_TOP:
+  case EncodedFunction::UNARY_POSITIVE:
+  case EncodedFunction::UNARY_NEGATIVE:
+  case EncodedFunction::SHIFT_LEFT:
+  case EncodedFunction::SHIFT_RIGHT:
+  case EncodedFunction::SHIFT_RIGHT_LOGICAL:
+  case EncodedFunction::MULTIPLY_HIGH:
+  case EncodedFunction::PRINT_STRING:
+  case EncodedFunction::PRINT_CHARACTER:
+  case EncodedFunction::PRINT_INTEGER:
+  case EncodedFunction::JUMP_IF_TRUE:
+  case EncodedFunction::JUMP_IF_FALSE:
+  case EncodedFunction::RETURN_VALUE:
+  case EncodedFunction::ADD_CONST:
+  case EncodedFunction::ADD_LOCAL:
+  case EncodedFunction::SUB_LOCAL:
+    return 1;
+  case EncodedFunction::CALL_FUNCTION:
+    return Functions[I.Immediates[0]].getArgumentCount();
+  default:
+    return 0;
+  }
+}
+
+bool EncodedVerifier::IsPush(Opcode Op) {
+  switch (Op) {
+  case EncodedFunction::LOAD_LOCAL:
+  case EncodedFunction::LOAD_LOCAL_ADDRESS:
+  case EncodedFunction::LOAD_GLOBAL:
+  case EncodedFunction::LOAD_CONST:
+  case EncodedFunction::LOAD_STRING:
+  case EncodedFunction::BINARY_ADD:
+  case EncodedFunction::BINARY_SUB:
+  case EncodedFunction::BINARY_MULTIPLY:
+  case EncodedFunction::BINARY_DIVIDE:
+  case EncodedFunction::BINARY_SUBSCR:
+  case EncodedFunction::UNARY_POSITIVE:
+  case EncodedFunction::UNARY_NEGATIVE:
+  case EncodedFunction::SHIFT_LEFT:
+  case EncodedFunction::SHIFT_RIGHT:
+  case EncodedFunction::SHIFT_RIGHT_LOGICAL:
+  case EncodedFunction::MULTIPLY_HIGH:
+  case EncodedFunction::READ_INTEGER:
+  case EncodedFunction::READ_CHARACTER:
+  case EncodedFunction::CALL_FUNCTION:
+  case EncodedFunction::LOAD_LOCAL_ADD_CONST:
+  case EncodedFunction::ADD_CONST:
+  case EncodedFunction::ADD_LOCAL:
+  case EncodedFunction::SUB_LOCAL:
+    return true;
+  default:
+    return false;
+  }
+}
+
+bool EncodedVerifier::mergeInto(unsigned To) {
+  if (!Reached[To]) {
+    Reached[To] = true;
+    EntryStacks[To] = Stack;
+    Worklist.push_back(To);
+    return true;
+  }
+  const StackTy &Entry = EntryStacks[To];
+  if (Entry.size() != Stack.size()) {
+    Error(Insts[To].Offset, "stack depth is", Entry.size(), "or",
+          Stack.size(), "where control flow merges");
+    return false;
+  }
+  if (Entry != Stack) {
+    Error(Insts[To].Offset,
+          "stack holds a string or a word where control flow merges");
+    return false;
+  }
+  return true;
+}
+
+bool EncodedVerifier::verifyStack() {
+  EntryStacks.assign(Insts.size(), StackTy());
+  Reached.assign(Insts.size(), false);
+  Worklist.clear();
+  Stack.clear();
+  mergeInto(0);
+
+  while (!Worklist.empty()) {
+    unsigned Idx = Worklist.back();
+    Worklist.pop_back();
+    Stack = EntryStacks[Idx];
+    /// Run the instructions up to the next jump target.
+    for (;;) {
+      const Instruction &I = Insts[Idx];
+      unsigned Pops = getPopCount(I);
+      if (Stack.size() < Pops) {
+        Error(I.Offset, "stack underflow");
+        return false;
+      }
+      for (unsigned J = 0; J < Pops; J++) {
+        bool IsString = Stack.back();
+        Stack.pop_back();
+        if (I.Op == EncodedFunction::POP_TOP)
+          continue;
+        if (I.Op == EncodedFunction::PRINT_STRING && !IsString) {
+          Error(I.Offset, "printed value must be a string");
+          return false;
+        }
+        if (I.Op != EncodedFunction::PRINT_STRING && IsString) {
+          Error(I.Offset, "operand must be a word, not a string");
+          return false;
+        }
+      }
+      if (IsPush(I.Op)) {
+        Stack.push_back(I.Op == EncodedFunction::LOAD_STRING);
+        MaxStackDepth =
+            std::max(MaxStackDepth, static_cast<unsigned>(Stack.size()));
+      }
+
+      /// The target is always the last immediate.
+      const EncodedFunction::ImmediateKind *K =
+          EncodedFunction::getImmediateKinds(I.Op);
+      for (unsigned J = 0; K[J] != EncodedFunction::NoImmediate; J++) {
+        if (K[J] == EncodedFunction::TargetImmediate &&
+            !mergeInto(IndexAt[I.Immediates[J]]))
+          return false;
+      }
+      if (I.Op == EncodedFunction::JUMP_FORWARD ||
+          I.Op == EncodedFunction::RETURN_VALUE ||
+          I.Op == EncodedFunction::RETURN_NONE)
+        break;
+      if (++Idx == Insts.size()) {
+        Error(I.Offset, "control falls off the end");
+        return false;
+      }
+      if (IsTarget[Idx]) {
+        if (!mergeInto(Idx))
+          return false;
+        break;
+      }
+    }
+  }
+  return true;
+}
+
+bool EncodedVerifier::Check(unsigned F, const uint8_t *Code, size_t Size) {
+  TheFunction = &Functions[F];
+  MaxStackDepth = 0;
+  int Prev = EM.getErrorCount();
+  if (!Size)
+    Error(0, "function has no code");
+  else if (decode(Code, Size))
+    verifyStack();
+  return !EM.IsOk(Prev);
+}
@@ -0,0 +1,116 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "simplecc/CodeGen/RegisterByteCode.h"
+#include <cassert>
+#include <iomanip>
+#include <sstream>
+
+using namespace simplecc;
+
+const char *RegisterInstruction::getOpcodeName(Opcode Op) {
+  switch (Op) {
+#define HANDLE_REGISTER_OPCODE(Opcode, Operands)                               \
+  case Opcode:                                                                 \
+    return #Opcode;
+#include "simplecc/CodeGen/RegisterOpcode.def"
+  default:
+    assert(false && "Unhandled Opcode");
+    return nullptr;
+  }
+}
+
+const char *RegisterInstruction::getOperandKinds(Opcode Op) {
+  switch (Op) {
+#define HANDLE_REGISTER_OPCODE(Opcode, Operands)                               \
+  case Opcode:                                                                 \
+    return Operands;
+#include "simplecc/CodeGen/RegisterOpcode.def"
+  default:
+    assert(false && "Unhandled Opcode");
+    return "";
+  }
+}
+
+void RegisterFunction::Format(std::ostream &O) const {
+  O << getName() << ": " << getArgumentCount() << " arguments, "
+    << getRegisterCount() << " registers, " << Instructions.size()
+    << " instructions\n";
+
+  unsigned Lineno = 0;
+  for (unsigned I = 0; I < Instructions.size(); I++) {
+    const RegisterInstruction &RI = Instructions[I];
+    if (I == 0 || RI.Lineno != Lineno) {
+      Lineno = RI.Lineno;
+      O << "Line " << Lineno << "\n";
+    }
+    const int Operands[] = {RI.A, RI.B, RI.C};
+    const char *Kinds = RegisterInstruction::getOperandKinds(RI.Op);
+    std::ostringstream OS;
+    for (unsigned J = 0; Kinds[J]; J++) {
+      if (J)
+        OS << ", ";
+      switch (Kinds[J]) {
+      case 'R':
+        OS << "r" << Operands[J];
+        break;
+      case 'L':
+        OS << "&r" << Operands[J];
+        break;
+      case 'A':
+        OS << "@" << Operands[J];
+        break;
+      case 'S':
+        OS << "string " << Operands[J];
+        break;
+      case 'F':
+        OS << "function " << Operands[J];
+        break;
+      default:
+        OS << Operands[J];
+        break;
+      }
+    }
+    O << std::left << std::setw(6) << I;
+    if (OS.str().empty())
+      O << RegisterInstruction::getOpcodeName(RI.Op) << "\n";
+    else
+      O << std::setw(28) << RegisterInstruction::getOpcodeName(RI.Op)
+        << OS.str() << "\n";
+  }
+}
+
+int RegisterModule::getFunctionIndex(const std::string &Name) const {
+  auto Iter = FunctionIndices.find(Name);
+  return Iter == FunctionIndices.end() ? -1 : static_cast<int>(Iter->second);
+}
+
+void RegisterModule::Format(std::ostream &O) const {
+  O << "Globals: " << getGlobalsSize() << " words\n";
+  for (unsigned I = 0; I < StringLiterals.size(); I++) {
+    O << "String " << I << ": \"" << StringLiterals[I] << "\"\n";
+  }
+  for (unsigned F = 0; F < size(); F++) {
+    O << "\nFunction " << F << ", " << getFunction(F);
+  }
+}
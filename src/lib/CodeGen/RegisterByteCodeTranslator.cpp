@@ -0,0 +1,563 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "simplecc/CodeGen/RegisterByteCodeTranslator.h"
+#include "simplecc/CodeGen/ByteCodeFunction.h"
+#include "simplecc/CodeGen/ByteCodeModule.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+using namespace simplecc;
+
+using RI = RegisterInstruction;
+
+/// Return the change of the depth of the operand stack by C.
+static int getStackEffect(const ByteCode &C) {
+  switch (C.getOpcode()) {
+  case ByteCode::LOAD_LOCAL:
+  case ByteCode::LOAD_GLOBAL:
+  case ByteCode::LOAD_CONST:
+  case ByteCode::LOAD_STRING:
+  case ByteCode::READ_INTEGER:
+  case ByteCode::READ_CHARACTER:
+    return 1;
+  case ByteCode::STORE_LOCAL:
+  case ByteCode::STORE_GLOBAL:
+  case ByteCode::BINARY_ADD:
+  case ByteCode::BINARY_SUB:
+  case ByteCode::BINARY_MULTIPLY:
+  case ByteCode::BINARY_DIVIDE:
+  case ByteCode::BINARY_SUBSCR:
+  case ByteCode::PRINT_STRING:
+  case ByteCode::PRINT_CHARACTER:
+  case ByteCode::PRINT_INTEGER:
+  case ByteCode::JUMP_IF_TRUE:
+  case ByteCode::JUMP_IF_FALSE:
+  case ByteCode::RETURN_VALUE:
+  case ByteCode::POP_TOP:
+    return -1;
+  case ByteCode::JUMP_IF_EQUAL:
+  case ByteCode::JUMP_IF_NOT_EQUAL:
+  case ByteCode::JUMP_IF_GREATER:
+  case ByteCode::JUMP_IF_GREATER_EQUAL:
+  case ByteCode::JUMP_IF_LESS:
+  case ByteCode::JUMP_IF_LESS_EQUAL:
+    return -2;
+  case ByteCode::STORE_SUBSCR:
+    return -3;
+  case ByteCode::CALL_FUNCTION:
+    return 1 - C.getIntOperand();
+  default:
+    return 0;
+  }
+}
+
+/// Return whether control never goes from C to the ByteCode after it.
+static bool IsTerminator(const ByteCode &C) {
+  switch (C.getOpcode()) {
+  case ByteCode::JUMP_FORWARD:
+  case ByteCode::RETURN_VALUE:
+  case ByteCode::RETURN_NONE:
+    return true;
+  default:
+    return false;
+  }
+}
+
+/// Return the jump that compares as Op does, with a register or, if Imm, an
+/// immediate on the right.
+static RI::Opcode getCompareJump(ByteCode::Opcode Op, bool Imm) {
+  switch (Op) {
+  case ByteCode::JUMP_IF_EQUAL:
+    return Imm ? RI::JUMP_IF_EQUAL_IMM : RI::JUMP_IF_EQUAL;
+  case ByteCode::JUMP_IF_NOT_EQUAL:
+    return Imm ? RI::JUMP_IF_NOT_EQUAL_IMM : RI::JUMP_IF_NOT_EQUAL;
+  case ByteCode::JUMP_IF_GREATER:
+    return Imm ? RI::JUMP_IF_GREATER_IMM : RI::JUMP_IF_GREATER;
+  case ByteCode::JUMP_IF_GREATER_EQUAL:
+    return Imm ? RI::JUMP_IF_GREATER_EQUAL_IMM : RI::JUMP_IF_GREATER_EQUAL;
+  case ByteCode::JUMP_IF_LESS:
+    return Imm ? RI::JUMP_IF_LESS_IMM : RI::JUMP_IF_LESS;
+  case ByteCode::JUMP_IF_LESS_EQUAL:
+    return Imm ? RI::JUMP_IF_LESS_EQUAL_IMM : RI::JUMP_IF_LESS_EQUAL;
+  default:
+    assert(false && "Not a comparison");
+    return RI::JUMP;
+  }
+}
+
+/// Return the comparison that holds for R and L when Op holds for L and R.
+static ByteCode::Opcode getSwappedCompare(ByteCode::Opcode Op) {
+  switch (Op) {
+  case ByteCode::JUMP_IF_GREATER:
+    return ByteCode::JUMP_IF_LESS;
+  case ByteCode::JUMP_IF_GREATER_EQUAL:
+    return ByteCode::JUMP_IF_LESS_EQUAL;
+  case ByteCode::JUMP_IF_LESS:
+    return ByteCode::JUMP_IF_GREATER;
+  case ByteCode::JUMP_IF_LESS_EQUAL:
+    return ByteCode::JUMP_IF_GREATER_EQUAL;
+  default:
+    return Op;
+  }
+}
+
+void RegisterByteCodeTranslator::emit(RI::Opcode Op, int A, int B, int C) {
+  TheFunction->Instructions.push_back(RI{Op, Lineno, SourceFunction, A, B, C});
+  LastPush = -1;
+}
+
+void RegisterByteCodeTranslator::emitPush(RI::Opcode Op, int B, int C) {
+  auto R = static_cast<int>(getStackRegister(Stack.size()));
+  emit(Op, R, B, C);
+  LastPush = TheFunction->Instructions.size() - 1;
+  Stack.push_back(Operand{Operand::Register, R});
+}
+
+void RegisterByteCodeTranslator::storeTo(unsigned R, unsigned Depth) {
+  const Operand &E = Stack[Depth];
+  switch (E.Kind) {
+  case Operand::Register:
+    if (E.Value != static_cast<int>(R))
+      emit(RI::MOVE, R, E.Value);
+    break;
+  case Operand::Immediate:
+    emit(RI::LOAD_IMM, R, E.Value);
+    break;
+  case Operand::LocalAddress:
+    emit(RI::LOAD_ADDRESS, R, E.Value);
+    break;
+  }
+}
+
+void RegisterByteCodeTranslator::materialize(unsigned Depth) {
+  unsigned R = getStackRegister(Depth);
+  storeTo(R, Depth);
+  Stack[Depth] = Operand{Operand::Register, static_cast<int>(R)};
+}
+
+unsigned RegisterByteCodeTranslator::getRegister(unsigned Depth) {
+  if (Stack[Depth].Kind != Operand::Register)
+    materialize(Depth);
+  return Stack[Depth].Value;
+}
+
+void RegisterByteCodeTranslator::materializeAll() {
+  for (unsigned Depth = 0; Depth < Stack.size(); Depth++)
+    materialize(Depth);
+}
+
+void RegisterByteCodeTranslator::materializeUsesOf(unsigned R) {
+  for (unsigned Depth = 0; Depth < Stack.size(); Depth++) {
+    const Operand &E = Stack[Depth];
+    if (E.Kind == Operand::Register && E.Value == static_cast<int>(R))
+      materialize(Depth);
+  }
+}
+
+void RegisterByteCodeTranslator::computeDepths(const ByteCodeFunction &F) {
+  Depths.assign(F.size() + 1, 0);
+  IsJumpTarget.assign(F.size() + 1, false);
+  /// The depth at a jump target is that of the jumps to it. Code reached
+  /// only by a later jump starts with an empty stack, as blocks do.
+  std::vector<bool> Known(F.size() + 1, false);
+  Known[0] = true;
+  for (unsigned I = 0; I < F.size(); I++) {
+    const ByteCode &C = F.getByteCodeAt(I);
+    int After = static_cast<int>(Depths[I]) + getStackEffect(C);
+    assert(After >= 0 && "Operand stack underflow");
+    if (C.IsJump()) {
+      unsigned Target = C.getJumpTarget();
+      IsJumpTarget[Target] = true;
+      if (!Known[Target])
+        Depths[Target] = After;
+      Known[Target] = true;
+    }
+    if (!IsTerminator(C) && !Known[I + 1]) {
+      Depths[I + 1] = After;
+      Known[I + 1] = true;
+    }
+  }
+}
+
+void RegisterByteCodeTranslator::translate(const ByteCode &C) {
+  unsigned Depth = Stack.size();
+  switch (C.getOpcode()) {
+  case ByteCode::LOAD_LOCAL: {
+    const SlotTy &Local = Locals.at(C.getStrOperand());
+    Stack.push_back(Operand{Local.second ? Operand::LocalAddress
+                                         : Operand::Register,
+                            static_cast<int>(Local.first)});
+    break;
+  }
+  case ByteCode::LOAD_GLOBAL: {
+    const SlotTy &Global = Globals.at(C.getStrOperand());
+    /// The address of an array is known.
+    if (Global.second)
+      Stack.push_back(
+          Operand{Operand::Immediate, static_cast<int>(Global.first)});
+    else
+      emitPush(RI::LOAD_GLOBAL, Global.first);
+    break;
+  }
+  case ByteCode::LOAD_CONST:
+  case ByteCode::LOAD_STRING:
+    Stack.push_back(Operand{Operand::Immediate, C.getIntOperand()});
+    break;
+
+  case ByteCode::STORE_LOCAL: {
+    unsigned R = Locals.at(C.getStrOperand()).first;
+    const Operand &Value = Stack.back();
+    bool IsRead = std::any_of(
+        Stack.begin(), Stack.end() - 1, [R](const Operand &E) {
+          return E.Kind == Operand::Register && E.Value == static_cast<int>(R);
+        });
+    /// Compute the value right into the local, if nothing still reads the
+    /// old value of it.
+    if (!IsRead && LastPush >= 0 && Value.Kind == Operand::Register &&
+        Value.Value == static_cast<int>(getStackRegister(Depth - 1)) &&
+        TheFunction->Instructions[LastPush].A == Value.Value) {
+      TheFunction->Instructions[LastPush].A = R;
+      LastPush = -1;
+    } else {
+      materializeUsesOf(R);
+      storeTo(R, Depth - 1);
+    }
+    Stack.pop_back();
+    break;
+  }
+  case ByteCode::STORE_GLOBAL:
+    emit(RI::STORE_GLOBAL, Globals.at(C.getStrOperand()).first,
+         getRegister(Depth - 1));
+    Stack.pop_back();
+    break;
+
+  case ByteCode::BINARY_ADD:
+  case ByteCode::BINARY_SUB:
+  case ByteCode::BINARY_MULTIPLY:
+  case ByteCode::BINARY_DIVIDE: {
+    static const RI::Opcode Ops[][2] = {{RI::ADD, RI::ADD_IMM},
+                                        {RI::SUB, RI::SUB_IMM},
+                                        {RI::MUL, RI::MUL_IMM},
+                                        {RI::DIV, RI::DIV_IMM}};
+    unsigned Kind = C.getOpcode() == ByteCode::BINARY_ADD        ? 0
+                    : C.getOpcode() == ByteCode::BINARY_SUB      ? 1
+                    : C.getOpcode() == ByteCode::BINARY_MULTIPLY ? 2
+                                                                 : 3;
+    bool IsCommutative = Kind == 0 || Kind == 2;
+    const Operand L = Stack[Depth - 2], R = Stack[Depth - 1];
+    int A, B;
+    RI::Opcode Op;
+    if (R.Kind == Operand::Immediate) {
+      A = getRegister(Depth - 2), B = R.Value, Op = Ops[Kind][1];
+    } else if (IsCommutative && L.Kind == Operand::Immediate) {
+      A = getRegister(Depth - 1), B = L.Value, Op = Ops[Kind][1];
+    } else {
+      A = getRegister(Depth - 2), B = getRegister(Depth - 1), Op = Ops[Kind][0];
+    }
+    Stack.resize(Depth - 2);
+    emitPush(Op, A, B);
+    break;
+  }
+
+  case ByteCode::BINARY_SUBSCR: {
+    const Operand Base = Stack[Depth - 2], Index = Stack[Depth - 1];
+    if (Base.Kind == Operand::LocalAddress) {
+      unsigned Size = ArraySizes[Base.Value];
+      Stack.resize(Depth - 2);
+      /// An element at a constant index is a register of its own.
+      if (Index.Kind == Operand::Immediate && Index.Value >= 0 &&
+          static_cast<unsigned>(Index.Value) < Size) {
+        emitPush(RI::MOVE, Base.Value + Index.Value);
+        break;
+      }
+      Stack.push_back(Index);
+      unsigned IndexRegister = getRegister(Depth - 2);
+      Stack.pop_back();
+      emitPush(RI::LOAD_ELEM_LOCAL, Base.Value, IndexRegister);
+      break;
+    }
+    if (Base.Kind == Operand::Immediate) {
+      Stack.resize(Depth - 2);
+      /// So is a global element at a constant index.
+      if (Index.Kind == Operand::Immediate && Index.Value >= 0 &&
+          Base.Value >= 0 &&
+          static_cast<unsigned>(Base.Value + Index.Value) < GlobalsSize) {
+        emitPush(RI::LOAD_GLOBAL, Base.Value + Index.Value);
+        break;
+      }
+      Stack.push_back(Index);
+      unsigned IndexRegister = getRegister(Depth - 2);
+      Stack.pop_back();
+      emitPush(RI::LOAD_ELEM_GLOBAL, Base.Value, IndexRegister);
+      break;
+    }
+    unsigned BaseRegister = getRegister(Depth - 2);
+    unsigned IndexRegister = getRegister(Depth - 1);
+    Stack.resize(Depth - 2);
+    emitPush(RI::LOAD_ELEM, BaseRegister, IndexRegister);
+    break;
+  }
+  case ByteCode::STORE_SUBSCR: {
+    /// The value, the base and the index.
+    const Operand Base = Stack[Depth - 2], Index = Stack[Depth - 1];
+    if (Base.Kind == Operand::LocalAddress && Index.Kind == Operand::Immediate &&
+        Index.Value >= 0 &&
+        static_cast<unsigned>(Index.Value) < ArraySizes[Base.Value]) {
+      /// No stack entry reads an element of an array.
+      storeTo(Base.Value + Index.Value, Depth - 3);
+    } else if (Base.Kind == Operand::LocalAddress) {
+      emit(RI::STORE_ELEM_LOCAL, Base.Value, getRegister(Depth - 1),
+           getRegister(Depth - 3));
+    } else if (Base.Kind == Operand::Immediate &&
+               Index.Kind == Operand::Immediate && Index.Value >= 0 &&
+               Base.Value >= 0 &&
+               static_cast<unsigned>(Base.Value + Index.Value) < GlobalsSize) {
+      emit(RI::STORE_GLOBAL, Base.Value + Index.Value, getRegister(Depth - 3));
+    } else if (Base.Kind == Operand::Immediate) {
+      emit(RI::STORE_ELEM_GLOBAL, Base.Value, getRegister(Depth - 1),
+           getRegister(Depth - 3));
+    } else {
+      emit(RI::STORE_ELEM, getRegister(Depth - 2), getRegister(Depth - 1),
+           getRegister(Depth - 3));
+    }
+    Stack.resize(Depth - 3);
+    break;
+  }
+
+  case ByteCode::UNARY_POSITIVE:
+    break;
+  case ByteCode::UNARY_NEGATIVE: {
+    Operand &Top = Stack.back();
+    if (Top.Kind == Operand::Immediate) {
+      Top.Value =
+          static_cast<int>(0u - static_cast<unsigned>(Top.Value));
+      break;
+    }
+    unsigned R = getRegister(Depth - 1);
+    Stack.pop_back();
+    emitPush(RI::NEG, R);
+    break;
+  }
+  case ByteCode::SHIFT_LEFT:
+  case ByteCode::SHIFT_RIGHT:
+  case ByteCode::SHIFT_RIGHT_LOGICAL:
+  case ByteCode::MULTIPLY_HIGH: {
+    RI::Opcode Op = C.getOpcode() == ByteCode::SHIFT_LEFT    ? RI::SHIFT_LEFT
+                    : C.getOpcode() == ByteCode::SHIFT_RIGHT ? RI::SHIFT_RIGHT
+                    : C.getOpcode() == ByteCode::SHIFT_RIGHT_LOGICAL
+                        ? RI::SHIFT_RIGHT_LOGICAL
+                        : RI::MULTIPLY_HIGH;
+    unsigned R = getRegister(Depth - 1);
+    Stack.pop_back();
+    emitPush(Op, R, C.getIntOperand());
+    break;
+  }
+
+  case ByteCode::READ_INTEGER:
+    emitPush(RI::READ_INTEGER);
+    break;
+  case ByteCode::READ_CHARACTER:
+    emitPush(RI::READ_CHARACTER);
+    break;
+  case ByteCode::PRINT_STRING:
+    assert(Stack.back().Kind == Operand::Immediate &&
+           "A string must be loaded right before it is printed");
+    emit(RI::PRINT_STRING, Stack.back().Value);
+    Stack.pop_back();
+    break;
+  case ByteCode::PRINT_CHARACTER:
+  case ByteCode::PRINT_INTEGER:
+    emit(C.getOpcode() == ByteCode::PRINT_CHARACTER ? RI::PRINT_CHARACTER
+                                                    : RI::PRINT_INTEGER,
+         getRegister(Depth - 1));
+    Stack.pop_back();
+    break;
+  case ByteCode::PRINT_NEWLINE:
+    emit(RI::PRINT_NEWLINE);
+    break;
+
+  /// The values left on the stack must be in their registers at the target.
+  case ByteCode::JUMP_FORWARD:
+    materializeAll();
+    emit(RI::JUMP, C.getJumpTarget());
+    break;
+  case ByteCode::JUMP_IF_TRUE:
+  case ByteCode::JUMP_IF_FALSE: {
+    unsigned R = getRegister(Depth - 1);
+    Stack.pop_back();
+    materializeAll();
+    emit(C.getOpcode() == ByteCode::JUMP_IF_TRUE ? RI::JUMP_IF_TRUE
+                                                 : RI::JUMP_IF_FALSE,
+         R, C.getJumpTarget());
+    break;
+  }
+  case ByteCode::JUMP_IF_EQUAL:
+  case ByteCode::JUMP_IF_NOT_EQUAL:
+  case ByteCode::JUMP_IF_GREATER:
+  case ByteCode::JUMP_IF_GREATER_EQUAL:
+  case ByteCode::JUMP_IF_LESS:
+  case ByteCode::JUMP_IF_LESS_EQUAL: {
+    const Operand L = Stack[Depth - 2], R = Stack[Depth - 1];
+    ByteCode::Opcode Compare = C.getOpcode();
+    int A, B;
+    bool IsImm = true;
+    if (R.Kind == Operand::Immediate) {
+      A = getRegister(Depth - 2), B = R.Value;
+    } else if (L.Kind == Operand::Immediate) {
+      A = getRegister(Depth - 1), B = L.Value;
+      Compare = getSwappedCompare(Compare);
+    } else {
+      A = getRegister(Depth - 2), B = getRegister(Depth - 1), IsImm = false;
+    }
+    Stack.resize(Depth - 2);
+    materializeAll();
+    emit(getCompareJump(Compare, IsImm), A, B, C.getJumpTarget());
+    break;
+  }
+
+  case ByteCode::CALL_FUNCTION: {
+    unsigned Argc = C.getIntOperand();
+    for (unsigned I = Depth - Argc; I < Depth; I++)
+      materialize(I);
+    Stack.resize(Depth - Argc);
+    int Callee = TheModule->getFunctionIndex(C.getStrOperand());
+    assert(Callee >= 0 && "Undefined function");
+    emit(RI::CALL, getStackRegister(Depth - Argc), Callee);
+    Stack.push_back(Operand{Operand::Register,
+                            static_cast<int>(getStackRegister(Depth - Argc))});
+    break;
+  }
+  case ByteCode::RETURN_VALUE:
+    emit(RI::RETURN_VALUE, getRegister(Depth - 1));
+    Stack.pop_back();
+    break;
+  case ByteCode::RETURN_NONE:
+    emit(RI::RETURN_NONE);
+    break;
+  case ByteCode::POP_TOP:
+    Stack.pop_back();
+    break;
+  }
+}
+
+void RegisterByteCodeTranslator::TranslateFunction(const ByteCodeFunction &F,
+                                                   RegisterFunction &RF) {
+  /// Lay out the arguments, then the local variables and the temporaries,
+  /// as ByteCodeEncoder does.
+  Locals.clear();
+  ArraySizes.clear();
+  auto Layout = [&](const std::string &Name, unsigned Size) {
+    unsigned Slot = ArraySizes.size();
+    Locals.emplace(Name, SlotTy(Slot, Size));
+    ArraySizes.resize(Slot + (Size ? Size : 1));
+    ArraySizes[Slot] = Size;
+  };
+  for (const SymbolEntry &E : F.getFormalArguments())
+    Layout(E.getName(), 0);
+  for (const SymbolEntry &E : F.getLocalVariables())
+    Layout(E.getName(), E.IsArray() ? E.AsArray().getSize() : 0);
+  for (const auto &T : F.getTemporaries())
+    Layout(T.Name, T.Size);
+  NumSlots = ArraySizes.size();
+
+  computeDepths(F);
+  RF.Name = F.getName();
+  RF.NumArguments = F.getFormalArgumentCount();
+  RF.NumRegisters = NumSlots + *std::max_element(Depths.begin(), Depths.end());
+  RF.Instructions.clear();
+  TheFunction = &RF;
+  Stack.clear();
+  LastPush = -1;
+
+  auto Self = static_cast<unsigned>(TheModule->getFunctionIndex(F.getName()));
+  /// The first instruction of each ByteCode.
+  std::vector<unsigned> Starts(F.size() + 1);
+  bool IsReachable = true;
+  for (unsigned I = 0; I < F.size(); I++) {
+    const ByteCode &C = F.getByteCodeAt(I);
+    Lineno = C.getSourceLineno();
+    SourceFunction = C.getSourceFunction()
+                         ? TheModule->getFunctionIndex(C.getSourceFunction())
+                         : Self;
+    if (IsJumpTarget[I] || !IsReachable) {
+      if (IsReachable)
+        materializeAll();
+      /// Every value on the stack is in its register here.
+      Stack.clear();
+      for (unsigned D = 0; D < Depths[I]; D++)
+        Stack.push_back(
+            Operand{Operand::Register, static_cast<int>(getStackRegister(D))});
+      LastPush = -1;
+    }
+    Starts[I] = RF.Instructions.size();
+    translate(C);
+    /// The result of an instruction takes the register of its depth.
+    RF.NumRegisters = std::max<unsigned>(
+        RF.NumRegisters, NumSlots + static_cast<unsigned>(Stack.size()));
+    IsReachable = !IsTerminator(C);
+  }
+  Starts.back() = RF.Instructions.size();
+
+  /// Resolve the targets from ByteCode offsets to instruction indices.
+  for (RegisterInstruction &I : RF.Instructions) {
+    const char *Kinds = RegisterInstruction::getOperandKinds(I.Op);
+    size_t N = std::strlen(Kinds);
+    if (N == 0 || Kinds[N - 1] != 'T')
+      continue;
+    int *Target = N == 1 ? &I.A : N == 2 ? &I.B : &I.C;
+    *Target = Starts[*Target];
+  }
+  TheFunction = nullptr;
+}
+
+void RegisterByteCodeTranslator::Translate(const ByteCodeModule &M,
+                                           RegisterModule &RM) {
+  TheModule = &RM;
+
+  Globals.clear();
+  unsigned Address = 0;
+  for (const SymbolEntry &E : M.getGlobalVariables()) {
+    unsigned Size = E.IsArray() ? E.AsArray().getSize() : 0;
+    Globals.emplace(E.getName(), SlotTy(Address, Size));
+    Address += Size ? Size : 1;
+  }
+  RM.GlobalsSize = GlobalsSize = Address;
+
+  RM.StringLiterals.assign(M.getStringLiteralTable().size(), std::string());
+  for (const auto &Item : M.getStringLiteralTable()) {
+    const std::string &Quoted = Item.first;
+    RM.StringLiterals[Item.second] = Quoted.substr(1, Quoted.size() - 2);
+  }
+
+  RM.FunctionIndices.clear();
+  for (const ByteCodeFunction *F : M) {
+    RM.FunctionIndices.emplace(F->getName(), RM.FunctionIndices.size());
+  }
+  RM.Functions.assign(M.size(), RegisterFunction());
+  for (unsigned I = 0; I < M.size(); I++) {
+    TranslateFunction(*M.getFunctionList()[I], RM.Functions[I]);
+  }
+  TheModule = nullptr;
+}
@@ -0,0 +1,236 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "simplecc/CodeGen/SuperInstruction.h"
+#include "simplecc/CodeGen/ByteCodeCFG.h"
+#include "simplecc/CodeGen/ByteCodeFunction.h"
+#include <cassert>
+#include <cstring>
+#include <unordered_set>
+
+using namespace simplecc;
+
+const char *SuperInstruction::getOpcodeName(Opcode Op) {
+  switch (Op) {
+#define HANDLE_SUPER_INSTRUCTION(opcode, camelName)                            \
+  case opcode:                                                                 \
+    return #opcode;
+#include "simplecc/CodeGen/SuperInstruction.def"
+  default:
+    assert(false && "Invalid Opcode");
+    return nullptr;
+  }
+}
+
+bool SuperInstruction::IsCompareLocalConst(Opcode Op) {
+  switch (Op) {
+  default:
+    return false;
+#define HANDLE_COMPARE_LOCAL_CONST(opcode, camelName, Jump) case opcode:
+#include "simplecc/CodeGen/SuperInstruction.def"
+    return true;
+  }
+}
+
+bool SuperInstruction::IsCompareLocals(Opcode Op) {
+  switch (Op) {
+  default:
+    return false;
+#define HANDLE_COMPARE_LOCALS(opcode, camelName, Jump) case opcode:
+#include "simplecc/CodeGen/SuperInstruction.def"
+    return true;
+  }
+}
+
+ByteCode::Opcode SuperInstruction::getJump(Opcode Op) {
+  switch (Op) {
+#define HANDLE_COMPARE_LOCAL_CONST(opcode, camelName, Jump)                    \
+  case opcode:                                                                 \
+    return ByteCode::Jump;
+#define HANDLE_COMPARE_LOCALS(opcode, camelName, Jump)                         \
+  case opcode:                                                                 \
+    return ByteCode::Jump;
+#include "simplecc/CodeGen/SuperInstruction.def"
+  default:
+    assert(false && "Not a compare");
+    return ByteCode::JUMP_FORWARD;
+  }
+}
+
+/// Return the SuperInstruction that compares a local with a constant and
+/// jumps by Jump.
+static SuperInstruction::Opcode getCompareLocalConst(ByteCode::Opcode Jump) {
+  switch (Jump) {
+#define HANDLE_COMPARE_LOCAL_CONST(opcode, camelName, Jump)                    \
+  case ByteCode::Jump:                                                         \
+    return SuperInstruction::opcode;
+#include "simplecc/CodeGen/SuperInstruction.def"
+  default:
+    assert(false && "Not a compare");
+    return SuperInstruction::INC_LOCAL;
+  }
+}
+
+/// Return the SuperInstruction that compares two locals and jumps by Jump.
+static SuperInstruction::Opcode getCompareLocals(ByteCode::Opcode Jump) {
+  switch (Jump) {
+#define HANDLE_COMPARE_LOCALS(opcode, camelName, Jump)                         \
+  case ByteCode::Jump:                                                         \
+    return SuperInstruction::opcode;
+#include "simplecc/CodeGen/SuperInstruction.def"
+  default:
+    assert(false && "Not a compare");
+    return SuperInstruction::INC_LOCAL;
+  }
+}
+
+/// Return if Op jumps after comparing TOS1 with TOS.
+static bool IsBinaryJump(ByteCode::Opcode Op) {
+  switch (Op) {
+  case ByteCode::JUMP_IF_EQUAL:
+  case ByteCode::JUMP_IF_NOT_EQUAL:
+  case ByteCode::JUMP_IF_GREATER:
+  case ByteCode::JUMP_IF_GREATER_EQUAL:
+  case ByteCode::JUMP_IF_LESS:
+  case ByteCode::JUMP_IF_LESS_EQUAL:
+    return true;
+  default:
+    return false;
+  }
+}
+
+/// Return if Op adds or subtracts.
+static bool IsAddOrSub(ByteCode::Opcode Op) {
+  return Op == ByteCode::BINARY_ADD || Op == ByteCode::BINARY_SUB;
+}
+
+/// Return K, negated if Op subtracts. The negation wraps around.
+static int getAddend(int K, ByteCode::Opcode Op) {
+  if (Op == ByteCode::BINARY_ADD)
+    return K;
+  return static_cast<int>(0u - static_cast<unsigned>(K));
+}
+
+void SuperInstructionSelector::Select(const ByteCodeFunction &F) {
+  Selected.clear();
+  Starts.assign(F.size(), -1);
+
+  ByteCodeCFG CFG(F);
+  std::unordered_set<std::string> Arrays;
+  for (const SymbolEntry &E : F.getLocalVariables()) {
+    if (E.IsArray())
+      Arrays.insert(E.getName());
+  }
+  for (const auto &T : F.getTemporaries()) {
+    if (T.IsArray())
+      Arrays.insert(T.Name);
+  }
+
+  /// Return the Opcode at I if it may follow the start of a sequence, or
+  /// POP_TOP, which starts or continues none.
+  auto OpcodeAt = [&](unsigned I) {
+    if (I >= F.size() || CFG.IsJumpTarget(I))
+      return ByteCode::POP_TOP;
+    return F.getByteCodeAt(I).getOpcode();
+  };
+  auto IsVariable = [&](unsigned I) {
+    return Arrays.count(F.getByteCodeAt(I).getStrOperand()) == 0;
+  };
+  auto Name = [&](unsigned I) { return F.getByteCodeAt(I).getStrOperand(); };
+  auto Int = [&](unsigned I) { return F.getByteCodeAt(I).getIntOperand(); };
+
+  /// Return the longest match at I, or one of Length 0 if nothing matches.
+  auto Match = [&](unsigned I) -> SuperInstruction {
+    const ByteCode &C = F.getByteCodeAt(I);
+    ByteCode::Opcode Op1 = OpcodeAt(I + 1);
+    ByteCode::Opcode Op2 = OpcodeAt(I + 2);
+
+    if (C.getOpcode() == ByteCode::LOAD_CONST) {
+      if (Op1 == ByteCode::STORE_LOCAL) {
+        SuperInstruction SI(SuperInstruction::STORE_LOCAL_CONST, 2);
+        SI.Local = Name(I + 1);
+        SI.Constant = Int(I);
+        return SI;
+      }
+      if (IsAddOrSub(Op1)) {
+        SuperInstruction SI(SuperInstruction::ADD_CONST, 2);
+        SI.Constant = getAddend(Int(I), Op1);
+        return SI;
+      }
+    }
+
+    if (C.getOpcode() != ByteCode::LOAD_LOCAL || !IsVariable(I))
+      return SuperInstruction(SuperInstruction::INC_LOCAL, 0);
+
+    if (Op1 == ByteCode::LOAD_CONST && IsAddOrSub(Op2)) {
+      bool IsInc = OpcodeAt(I + 3) == ByteCode::STORE_LOCAL &&
+                   std::strcmp(Name(I + 3), Name(I)) == 0;
+      SuperInstruction SI(IsInc ? SuperInstruction::INC_LOCAL
+                                : SuperInstruction::LOAD_LOCAL_ADD_CONST,
+                          IsInc ? 4 : 3);
+      SI.Local = Name(I);
+      SI.Constant = getAddend(Int(I + 1), Op2);
+      return SI;
+    }
+    if (Op1 == ByteCode::LOAD_CONST && IsBinaryJump(Op2)) {
+      SuperInstruction SI(getCompareLocalConst(Op2), 3);
+      SI.Local = Name(I);
+      SI.Constant = Int(I + 1);
+      SI.Target = F.getByteCodeAt(I + 2).getJumpTarget();
+      return SI;
+    }
+    if (Op1 == ByteCode::LOAD_LOCAL && IsVariable(I + 1) && IsBinaryJump(Op2)) {
+      SuperInstruction SI(getCompareLocals(Op2), 3);
+      SI.Local = Name(I);
+      SI.Source = Name(I + 1);
+      SI.Target = F.getByteCodeAt(I + 2).getJumpTarget();
+      return SI;
+    }
+    if (Op1 == ByteCode::STORE_LOCAL) {
+      SuperInstruction SI(SuperInstruction::MOVE_LOCAL, 2);
+      SI.Local = Name(I + 1);
+      SI.Source = Name(I);
+      return SI;
+    }
+    if (IsAddOrSub(Op1)) {
+      SuperInstruction SI(Op1 == ByteCode::BINARY_ADD
+                              ? SuperInstruction::ADD_LOCAL
+                              : SuperInstruction::SUB_LOCAL,
+                          2);
+      SI.Local = Name(I);
+      return SI;
+    }
+    return SuperInstruction(SuperInstruction::INC_LOCAL, 0);
+  };
+
+  for (unsigned I = 0; I < F.size();) {
+    SuperInstruction SI = Match(I);
+    if (SI.getLength() == 0) {
+      ++I;
+      continue;
+    }
+    Starts[I] = static_cast<int>(Selected.size());
+    Selected.push_back(SI);
+    I += SI.getLength();
+  }
+}
@@ -21,14 +21,25 @@
 // SOFTWARE.
 
 #include "simplecc/Driver/Driver.h"
+#include "simplecc/CodeGen/ByteCodeCFG.h"
+#include "simplecc/CodeGen/CallGraph.h"
 #include "simplecc/CodeGen/CodeGen.h"
+#include "simplecc/CodeGen/EncodedModule.h"
+#include "simplecc/CodeGen/RegisterByteCode.h"
+#include "simplecc/Driver/IncrementalChecker.h"
+#include "simplecc/IR/IR.h"
+#include "simplecc/IR/IRModule.h"
 #include "simplecc/Lex/Tokenize.h"
+#include "simplecc/Support/Diagnostics.h"
+#include "simplecc/Support/ExecutionProfile.h"
 #include "simplecc/Target/Target.h"
 #include "simplecc/Transform/Transform.h"
+#include "simplecc/VM/VM.h"
 #include <tclap/CmdLine.h>
 
 #if SIMPLE_COMPILER_USE_LLVM
 #include "simplecc/LLVM/LLVM.h"
+#include "simplecc/LLVM/LLVMObjectCache.h"
 #include "simplecc/Visualize/Visualize.h"
 #endif
 
@@ -36,12 +47,22 @@ using namespace simplecc;
 
 #if SIMPLE_COMPILER_USE_LLVM
 void Driver::runEmitLLVMIR() {
-  if (runAnalyses())
+  if (DriverBase::runTransform())
     return;
   auto OS = getLLVMRawOstream();
   if (!OS)
     return;
-  if (CompileToLLVMIR(getProgram(), getSymbolTable(), *OS)) {
+  if (CompileToLLVMIR(getProgram(), getSymbolTable(), *OS,
+                      getOptimizationOptions())) {
+    getEM().increaseErrorCount();
+  }
+}
+
+void Driver::runRunLLVMJIT() {
+  if (DriverBase::runTransform())
+    return;
+  if (RunWithLLVMJIT(getProgram(), getSymbolTable(), getOptimizationOptions(),
+                     JITCacheDir, PrintJITCacheStats)) {
     getEM().increaseErrorCount();
   }
 }
@@ -67,7 +88,7 @@ void Driver::runWriteCSTGraph() {
 
 std::unique_ptr<llvm::raw_ostream> Driver::getLLVMRawOstream() {
   std::error_code EC;
-  auto OS = llvm::make_unique<llvm::raw_fd_ostream>(getOutputFile(), EC);
+  auto OS = std::make_unique<llvm::raw_fd_ostream>(getOutputFile(), EC);
   if (EC) {
     // Destroy the raw_fd_ostream as told by their doc.
     OS.release();
@@ -101,6 +122,98 @@ void Driver::runPrintTokens() {
 
 void Driver::runAssembleMips() { runAssemble(); }
 
+void Driver::runInterpret() {
+  if (runOptimize())
+    return;
+  auto OS = getStdOstream();
+  if (!OS)
+    return;
+  if (RunByteCode(getByteCodeModule(), std::cin, *OS))
+    getEM().increaseErrorCount();
+}
+
+void Driver::runInterpretRegisterByteCode() {
+  if (runOptimize())
+    return;
+  auto OS = getStdOstream();
+  if (!OS)
+    return;
+  if (RunRegisterByteCode(getByteCodeModule(), std::cin, *OS))
+    getEM().increaseErrorCount();
+}
+
+void Driver::runRunJIT() {
+  if (runOptimize())
+    return;
+  auto OS = getStdOstream();
+  if (!OS)
+    return;
+  if (RunByteCodeJIT(getByteCodeModule(), std::cin, *OS))
+    getEM().increaseErrorCount();
+}
+
+/// Run the program like --interpret, but write its profile to the output
+/// file, since the program writes to stdout.
+void Driver::runProfile() {
+  if (runOptimize())
+    return;
+  ExecutionProfile Profile;
+  if (ProfileByteCode(getByteCodeModule(), std::cin, std::cout, Profile))
+    getEM().increaseErrorCount();
+  std::string Filename =
+      getOutputFile() == "-" ? "default.profile" : getOutputFile();
+  std::ofstream OFS(Filename);
+  if (OFS.fail()) {
+    getEM().setErrorType("FileWriteError");
+    getEM().Error(Quote(Filename));
+    return;
+  }
+  Profile.Write(OFS);
+}
+
+void Driver::runPrintProfile() {
+  ExecutionProfile Profile;
+  if (Profile.Read(getInputFile())) {
+    getEM().increaseErrorCount();
+    return;
+  }
+  auto OS = getStdOstream();
+  if (!OS)
+    return;
+  Profile.Print(*OS);
+}
+
+void Driver::runEmitByteCodeFile() {
+  if (runOptimize())
+    return;
+  auto OS = getStdOstream(std::ios::binary);
+  if (!OS)
+    return;
+  EncodedModule M;
+  EncodeByteCode(getByteCodeModule(), M);
+  WriteByteCodeFile(M, *OS);
+}
+
+/// Run a .c0bc file, which skips the front end entirely.
+void Driver::runInterpretByteCodeFile() {
+  EncodedModule M;
+  if (ReadByteCodeFile(getInputFile(), M)) {
+    getEM().increaseErrorCount();
+    return;
+  }
+  int Main = M.getFunctionIndex("main");
+  if (Main < 0 || M.getFunction(Main).getArgumentCount()) {
+    getEM().setErrorType("ByteCodeFileError");
+    getEM().Error(Quote(getInputFile()), "has no main function");
+    return;
+  }
+  auto OS = getStdOstream();
+  if (!OS)
+    return;
+  if (RunEncodedModule(M, std::cin, *OS))
+    getEM().increaseErrorCount();
+}
+
 void Driver::runPrintByteCode() {
   if (runAnalyses())
     return;
@@ -121,6 +234,36 @@ void Driver::runPrintAST() {
 
 void Driver::runCheckOnly() { runAnalyses(); }
 
+/// Serve an editor: each line read from stdin asks to check the input file, or
+/// the file it names, again. Diagnostics go to stderr as usual and a line of
+/// "ok" or "error" to stdout marks the end of each check.
+void Driver::runCheckServer() {
+  IncrementalChecker Checker;
+  std::string Line;
+  while (std::getline(std::cin, Line)) {
+    std::string Filename = Line.empty() ? getInputFile() : Line;
+    std::ifstream IFS(Filename);
+    bool Failed = true;
+    bool Checked = false;
+    if (IFS.fail()) {
+      getEM().setErrorType("FileReadError");
+      getEM().Error(Quote(Filename));
+    } else {
+      Failed = Checker.Check(IFS, Filename);
+      Checked = true;
+    }
+    DiagnosticsEngine::get().finish();
+    if (Checked && PrintCheckServerStats) {
+      int NumReparsed = Checker.getNumReparsed();
+      if (NumReparsed < 0)
+        std::cerr << "Check server: full\n";
+      else
+        std::cerr << "Check server: reparsed " << NumReparsed << "\n";
+    }
+    std::cout << (Failed ? "error" : "ok") << std::endl;
+  }
+}
+
 void Driver::runPrintCST() {
   auto ParseTree = runBuildCST();
   if (!ParseTree) {
@@ -141,6 +284,66 @@ void Driver::runPrintByteCodeModule() {
   Print(*OS, getByteCodeModule());
 }
 
+void Driver::runPrintSSAIR() {
+  if (runCodeGen())
+    return;
+  auto OS = getStdOstream();
+  if (!OS)
+    return;
+  IRModule M;
+  BuildIR(getByteCodeModule(), M);
+  OptimizeIR(M, getOptimizationOptions());
+  if (VerifyIR(M)) {
+    getEM().increaseErrorCount();
+    return;
+  }
+  Print(*OS, M);
+}
+
+void Driver::runPrintEncodedModule() {
+  if (runOptimize())
+    return;
+  auto OS = getStdOstream();
+  if (!OS)
+    return;
+  EncodedModule M;
+  EncodeByteCode(getByteCodeModule(), M);
+  Print(*OS, M);
+}
+
+void Driver::runPrintRegisterByteCode() {
+  if (runOptimize())
+    return;
+  auto OS = getStdOstream();
+  if (!OS)
+    return;
+  RegisterModule M;
+  TranslateToRegisterByteCode(getByteCodeModule(), M);
+  Print(*OS, M);
+}
+
+void Driver::runDumpCallGraph() {
+  if (runCodeGen())
+    return;
+  auto OS = getStdOstream();
+  if (!OS)
+    return;
+  CallGraph TheCallGraph;
+  TheCallGraph.Build(getByteCodeModule());
+  Print(*OS, TheCallGraph);
+}
+
+void Driver::runDumpByteCodeCFG() {
+  if (runCodeGen())
+    return;
+  auto OS = getStdOstream();
+  if (!OS)
+    return;
+  for (const ByteCodeFunction *F : getByteCodeModule()) {
+    *OS << ByteCodeCFG(*F) << "\n";
+  }
+}
+
 void Driver::runDumpSymbolTable() {
   if (runAnalyses())
     return;
@@ -160,15 +363,110 @@ void Driver::runTransform() {
   PrettyPrintAST(*getProgram(), *OS);
 }
 
+namespace {
+/// A ValueArg that also takes its value joined to its name as GCC does, in
+/// "-name=value" or "--name=value", and to its one-letter flag, in "-O2".
+/// "--name value" works as it does for any ValueArg.
+template <typename T> class JoinedValueArg : public TCLAP::ValueArg<T> {
+  using Base = TCLAP::ValueArg<T>;
+
+  /// Return if Arg names this with a value joined to it, which goes to Value.
+  bool matchJoined(const std::string &Arg, std::string &Value) const {
+    if (Arg.size() < 2 || Arg[0] != '-')
+      return false;
+    std::string Name = this->getName() + '=';
+    auto NameBegin = Arg[1] == '-' ? 2 : 1;
+    if (Arg.compare(NameBegin, Name.size(), Name) == 0) {
+      Value = Arg.substr(NameBegin + Name.size());
+      return true;
+    }
+    const std::string &Flag = this->getFlag();
+    if (!Flag.empty() && NameBegin == 1 && Arg.size() > 1 + Flag.size() &&
+        Arg.compare(1, Flag.size(), Flag) == 0 &&
+        Arg.find('=') == std::string::npos) {
+      Value = Arg.substr(1 + Flag.size());
+      return true;
+    }
+    return false;
+  }
+
+public:
+  using Base::Base;
+
+  bool processArg(int *I, std::vector<std::string> &Args) override {
+    std::string Value;
+    if (!matchJoined(Args[*I], Value))
+      return Base::processArg(I, Args);
+    if (this->_alreadySet)
+      throw TCLAP::CmdLineParseException(
+          this->_xorSet ? "Mutually exclusive argument already set!"
+                        : "Argument already set!",
+          this->toString());
+    this->_extractValue(Value);
+    this->_alreadySet = true;
+    this->_checkWithVisitor();
+    return true;
+  }
+};
+} // namespace
+
 int Driver::run(int argc, char **argv) {
   namespace tclap = TCLAP;
   tclap::CmdLine Parser("A simple yet modular C-like compiler", ' ', "3.0");
   std::vector<tclap::Arg *> Switches;
   tclap::UnlabeledValueArg<std::string> InputArg(
       "input", "input file (default to stdin)", false, "", "input-file", Parser);
-  tclap::ValueArg<std::string> OutputArg("o", "output",
-                                         "output file (default to stdout)",
-                                         false, "", "output-file", Parser);
+  JoinedValueArg<std::string> OutputArg("o", "output",
+                                        "output file (default to stdout)",
+                                        false, "", "output-file", Parser);
+  JoinedValueArg<unsigned> ErrorLimitArg(
+      "", "ferror-limit", "stop after N errors (default to 0, no limit)", false,
+      0, "N", Parser);
+  std::vector<std::string> Formats{"text", "json"};
+  tclap::ValuesConstraint<std::string> FormatConstraint(Formats);
+  JoinedValueArg<std::string> FormatArg(
+      "", "fdiagnostics-format", "print diagnostics as text or JSON", false,
+      "text", &FormatConstraint, Parser);
+  std::vector<unsigned> OptLevels{0, 1, 2, 3};
+  tclap::ValuesConstraint<unsigned> OptLevelConstraint(OptLevels);
+  JoinedValueArg<unsigned> OptLevelArg(
+      "O", "opt-level", "optimization level (default to 2)", false,
+      OptimizationOptions().OptLevel, &OptLevelConstraint, Parser);
+  JoinedValueArg<std::string> PassesArg(
+      "", "passes",
+      "run this comma-separated list of passes instead of those of -O", false,
+      "", "pass-list", Parser);
+  JoinedValueArg<unsigned> InlineThresholdArg(
+      "", "inline-threshold",
+      "inline the calls whose cost is at most N (default to 25, or 100 at "
+      "-O3)",
+      false, OptimizationOptions().InlineThreshold, "N", Parser);
+  JoinedValueArg<unsigned> UnrollArg(
+      "", "unroll",
+      "unroll the loops by a factor of N, or not at all if N < 2 (default "
+      "to 4, or 8 at -O3)",
+      false, OptimizationOptions().UnrollFactor, "N", Parser);
+  JoinedValueArg<std::string> ProfileUseArg(
+      "", "profile-use",
+      "guide the inlining and the layout of the blocks by a profile written "
+      "by --profile",
+      false, "", "profile-file", Parser);
+  tclap::SwitchArg CheckServerStatsArg(
+      "", "check-server-stats",
+      "tell on stderr how many functions --check-server parsed again, or if "
+      "it checked the whole file",
+      Parser, false);
+#if SIMPLE_COMPILER_USE_LLVM
+  JoinedValueArg<std::string> JITCacheArg(
+      "", "jit-cache",
+      "keep the object code of --run in this directory, or nowhere if it is "
+      "empty (default to $XDG_CACHE_HOME/simplecc)",
+      false, "", "directory", Parser);
+  tclap::SwitchArg JITCacheStatsArg(
+      "", "jit-cache-stats",
+      "tell on stderr whether --run found the object code in the cache",
+      Parser, false);
+#endif
 
 #define HANDLE_COMMAND(Name, Arg, Description)                                 \
   tclap::SwitchArg Name##Switch("", Arg, Description, false);                  \
@@ -184,10 +482,46 @@ int Driver::run(int argc, char **argv) {
   }
   setInputFile(InputArg.isSet() ? InputArg.getValue() : "-");
   setOutputFile(OutputArg.isSet() ? OutputArg.getValue() : "-");
+  auto OptOptions = OptimizationOptions::getDefault(OptLevelArg.getValue());
+  if (InlineThresholdArg.isSet())
+    OptOptions.InlineThreshold = InlineThresholdArg.getValue();
+  if (UnrollArg.isSet())
+    OptOptions.UnrollFactor = UnrollArg.getValue();
+  OptOptions.Passes = ParsePassList(PassesArg.getValue());
+  if (ProfileUseArg.isSet()) {
+    auto Profile = std::make_shared<ExecutionProfile>();
+    if (Profile->Read(ProfileUseArg.getValue()))
+      return 1;
+    OptOptions.Profile = std::move(Profile);
+  }
+  for (const std::string &Pass : OptOptions.Passes) {
+#if SIMPLE_COMPILER_USE_LLVM
+    /// LLVM checks the names of its own passes.
+    if (EmitLLVMIRSwitch.isSet() || RunLLVMJITSwitch.isSet())
+      break;
+#endif
+    if (!IsKnownPass(Pass)) {
+      PrintErrs("Unknown pass", Quote(Pass), "in -passes");
+      return 1;
+    }
+  }
+  setOptimizationOptions(OptOptions);
+  PrintCheckServerStats = CheckServerStatsArg.getValue();
+#if SIMPLE_COMPILER_USE_LLVM
+  JITCacheDir = JITCacheArg.isSet() ? JITCacheArg.getValue()
+                                    : LLVMObjectCache::getDefaultDirectory();
+  PrintJITCacheStats = JITCacheStatsArg.getValue();
+#endif
+  DiagnosticsEngine &Diags = DiagnosticsEngine::get();
+  Diags.setErrorLimit(ErrorLimitArg.getValue());
+  Diags.setFormat(FormatArg.getValue() == "json"
+                      ? DiagnosticsEngine::JSONFormat
+                      : DiagnosticsEngine::TextFormat);
 
 #define HANDLE_COMMAND(Name, Arg, Description)                                 \
   if (Name##Switch.isSet()) {                                                  \
     run##Name();                                                               \
+    Diags.finish();                                                            \
     return status();                                                           \
   }
 #include "simplecc/Driver/Driver.def"
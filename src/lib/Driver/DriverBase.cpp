@@ -23,15 +23,17 @@
 #include "simplecc/Driver/DriverBase.h"
 #include "simplecc/Lex/Tokenize.h"
 #include "simplecc/CodeGen/CodeGen.h"
+#include "simplecc/IR/IR.h"
+#include "simplecc/IR/IRModule.h"
 #include "simplecc/Target/Target.h"
 #include "simplecc/Transform/Transform.h"
 
 using namespace simplecc;
 
-std::ostream *DriverBase::getStdOstream() {
+std::ostream *DriverBase::getStdOstream(std::ios::openmode Mode) {
   if (OutputFile == "-")
     return &std::cout;
-  StdOFStream.open(OutputFile);
+  StdOFStream.open(OutputFile, Mode | std::ios::out);
   if (StdOFStream.fail()) {
     EM.setErrorType("FileWriteError");
     EM.Error(OutputFile);
@@ -69,12 +71,27 @@ void DriverBase::doCodeGen() {
   CompileToByteCode(TheProgram.get(), AM.getSymbolTable(), TheModule);
 }
 
+/// Optimize TheModule through the SSA IR and verify the result.
+bool DriverBase::doOptimize() {
+  /// -O0 assembles the byte code as it is compiled.
+  if (OptOptions.OptLevel == 0 && !OptOptions.hasCustomPipeline())
+    return VerifyByteCode(TheModule);
+  IRModule M;
+  BuildIR(TheModule, M);
+  OptimizeIR(M, OptOptions);
+  if (VerifyIR(M))
+    return true;
+  LowerToByteCode(M, TheModule);
+  SimplifyByteCodeCFG(TheModule);
+  return VerifyByteCode(TheModule);
+}
+
 void DriverBase::doAssemble(std::ostream &OS) {
   AssembleMips(TheModule, OS);
 }
 
 void DriverBase::doTransform() {
-  TransformProgram(TheProgram.get(), AM.getSymbolTable());
+  TransformProgram(TheProgram.get(), AM.getSymbolTable(), OptOptions);
 }
 
 bool DriverBase::runTokenize() {
@@ -119,11 +136,21 @@ bool DriverBase::runCodeGen() {
   return false;
 }
 
+bool DriverBase::runOptimize() {
+  if (runCodeGen())
+    return true;
+  if (doOptimize()) {
+    EM.increaseErrorCount();
+    return true;
+  }
+  return false;
+}
+
 bool DriverBase::runAssemble() {
   auto OS = getStdOstream();
   if (!OS)
     return true;
-  if (runCodeGen())
+  if (runOptimize())
     return true;
   doAssemble(*OS);
   return false;
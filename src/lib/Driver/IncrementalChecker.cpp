@@ -0,0 +1,475 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "simplecc/Driver/IncrementalChecker.h"
+#include "simplecc/AST/ASTVerifier.h"
+#include "simplecc/AST/ChildrenVisitor.h"
+#include "simplecc/Analysis/AnalysisManager.h"
+#include "simplecc/Analysis/ArrayBoundChecker.h"
+#include "simplecc/Analysis/ImplicitCallTransformer.h"
+#include "simplecc/Analysis/SymbolTableBuilder.h"
+#include "simplecc/Analysis/SyntaxChecker.h"
+#include "simplecc/Analysis/TypeChecker.h"
+#include "simplecc/Lex/Tokenize.h"
+#include "simplecc/Parse/Parse.h"
+#include <algorithm> // min()
+
+using namespace simplecc;
+
+namespace {
+/// Capture the diagnostics reported during the lifetime of this object
+/// instead of printing them.
+class DiagnosticCapture {
+  std::vector<Diagnostic> Captured;
+  bool Done = false;
+
+public:
+  DiagnosticCapture() { DiagnosticsEngine::get().beginCapture(); }
+  ~DiagnosticCapture() { take(); }
+
+  /// Stop capturing and return what was captured.
+  std::vector<Diagnostic> take() {
+    if (!Done) {
+      Captured = DiagnosticsEngine::get().endCapture();
+      Done = true;
+    }
+    return std::move(Captured);
+  }
+};
+
+/// Report diagnostics captured earlier.
+void Replay(const std::vector<Diagnostic> &Diagnostics) {
+  for (const Diagnostic &D : Diagnostics)
+    DiagnosticsEngine::get().Report(D);
+}
+
+/// Return a location some lines below L, or above if LineDelta is negative.
+Location ShiftLine(Location L, int LineDelta) {
+  return Location(L.getLine() + LineDelta, L.getColumn());
+}
+
+/// Move every node of an AST by some lines.
+class LineShifter : ChildrenVisitor<LineShifter> {
+  int LineDelta;
+
+  void Shift(AST *A) {
+    A->setLocation(ShiftLine(A->getLocation(), LineDelta));
+    A->setEndLocation(ShiftLine(A->getEndLocation(), LineDelta));
+  }
+
+  void visitDecl(DeclAST *D) {
+    Shift(D);
+    ChildrenVisitor::visitDecl(D);
+  }
+  void visitStmt(StmtAST *S) {
+    Shift(S);
+    ChildrenVisitor::visitStmt(S);
+  }
+  void visitExpr(ExprAST *E) {
+    Shift(E);
+    ChildrenVisitor::visitExpr(E);
+  }
+
+public:
+  explicit LineShifter(int LineDelta) : LineDelta(LineDelta) {}
+  void Apply(DeclAST *D) { visitDecl(D); }
+
+private:
+  friend ChildrenVisitor;
+  friend VisitorBase;
+};
+} // namespace
+
+using UnitRange = std::pair<unsigned, unsigned>;
+
+/// Return if a token is an operator.
+static inline bool IsOperator(const TokenInfo &T, const char *Op) {
+  return T.getType() == Symbol::OP && T.getString() == Op;
+}
+
+/// Return if two tokens are identical, B being LineDelta lines below A.
+static bool IsSameToken(const TokenInfo &A, const TokenInfo &B,
+                        int LineDelta) {
+  return A.getType() == B.getType() && A.getString() == B.getString() &&
+         A.getLocation().getLine() + LineDelta == B.getLocation().getLine() &&
+         A.getLocation().getColumn() == B.getLocation().getColumn();
+}
+
+/// Return if location A comes after location B.
+static inline bool IsAfter(Location A, Location B) {
+  return A.getLine() > B.getLine() ||
+         (A.getLine() == B.getLine() && A.getColumn() > B.getColumn());
+}
+
+/// Cut the tokens into top-level units, each of which ends with a ';' or a '}'
+/// that closes the outermost '{'. Return false if the tokens cannot be a
+/// program, in which case the Parser will tell what is wrong.
+static bool SplitUnits(const std::vector<TokenInfo> &Tokens,
+                       std::vector<UnitRange> &Units) {
+  Units.clear();
+  unsigned Begin = 0;
+  int Depth = 0;
+  bool SeenDeclaration = false;
+  for (unsigned I = 0, E = Tokens.size(); I < E; ++I) {
+    const TokenInfo &T = Tokens[I];
+    if (T.getType() == Symbol::ENDMARKER)
+      return I + 1 == E && Depth == 0 && Begin == I;
+    if (I == Begin) {
+      /// program: const_decl* declaration* ENDMARKER
+      bool IsConstDecl = T.getString() == "const";
+      if (IsConstDecl && SeenDeclaration)
+        return false;
+      SeenDeclaration = !IsConstDecl;
+    }
+    if (IsOperator(T, "{")) {
+      ++Depth;
+    } else if (IsOperator(T, "}")) {
+      if (--Depth < 0)
+        return false;
+      if (Depth == 0) {
+        Units.emplace_back(Begin, I + 1);
+        Begin = I + 1;
+      }
+    } else if (IsOperator(T, ";") && Depth == 0) {
+      Units.emplace_back(Begin, I + 1);
+      Begin = I + 1;
+    }
+  }
+  return false;
+}
+
+/// Return if two function units have the same signature, i.e., the same tokens
+/// up to the opening '{' regardless of their locations.
+static bool IsSameSignature(const std::vector<TokenInfo> &A, unsigned BeginA,
+                            const std::vector<TokenInfo> &B, unsigned BeginB) {
+  for (;; ++BeginA, ++BeginB) {
+    const TokenInfo &TA = A[BeginA];
+    const TokenInfo &TB = B[BeginB];
+    if (TA.getType() != TB.getType() || TA.getString() != TB.getString())
+      return false;
+    if (IsOperator(TA, "{"))
+      return true;
+  }
+}
+
+bool IncrementalChecker::Unit::IsFuncDef(
+    const std::vector<TokenInfo> &Tokens) const {
+  return IsOperator(Tokens[TokenEnd - 1], "}");
+}
+
+const std::string &IncrementalChecker::Unit::getFuncName(
+    const std::vector<TokenInfo> &Tokens) const {
+  assert(IsFuncDef(Tokens));
+  /// declaration: type_name NAME ...
+  return Tokens[TokenBegin + 1].getString();
+}
+
+bool IncrementalChecker::Unit::References(
+    const std::vector<TokenInfo> &Tokens,
+    const std::unordered_set<std::string> &Names) const {
+  for (unsigned I = TokenBegin; I < TokenEnd; ++I)
+    if (Tokens[I].getType() == Symbol::NAME &&
+        Names.count(Tokens[I].getString()))
+      return true;
+  return false;
+}
+
+bool IncrementalChecker::Check(std::istream &IS, const std::string &Name) {
+  std::vector<TokenInfo> NewTokens;
+  Tokenize(IS, NewTokens);
+  std::vector<UnitRange> NewUnits;
+  bool Split = SplitUnits(NewTokens, NewUnits);
+
+  /// Another file is taken as an edit of the last one, as editors often
+  /// check a copy of the buffer saved under a new name.
+  if (Split && TheProgram && IncrementalParse(NewTokens, NewUnits)) {
+    Filename = Name;
+    TheProgram->setFilename(Name);
+    return RunAnalyses();
+  }
+
+  clear();
+  Filename = Name;
+  TheTokens = std::move(NewTokens);
+  if (!Split) {
+    /// Let the Parser report the error.
+    TheProgram = BuildAST(Filename, TheTokens);
+    if (!TheProgram)
+      return true;
+    /// Not expected, but we can still check it as a whole.
+    bool Failed = AnalysisManager().runAllAnalyses(TheProgram.get());
+    clear();
+    return Failed;
+  }
+
+  TheProgram = BuildAST(Filename, TheTokens);
+  if (!TheProgram)
+    return true;
+
+  /// Assign the DeclASTs to the units they come from.
+  auto &Decls = TheProgram->getDecls();
+  unsigned DeclIdx = 0;
+  for (const UnitRange &R : NewUnits) {
+    Unit U;
+    U.TokenBegin = R.first;
+    U.TokenEnd = R.second;
+    U.DeclBegin = DeclIdx;
+    Location Last = TheTokens[R.second - 1].getLocation();
+    while (DeclIdx < Decls.size() &&
+           !IsAfter(Decls[DeclIdx]->getLocation(), Last))
+      ++DeclIdx;
+    U.DeclEnd = DeclIdx;
+    Units.push_back(std::move(U));
+  }
+  assert(DeclIdx == Decls.size() && "DeclAST out of any unit");
+  return RunAnalyses();
+}
+
+bool IncrementalChecker::IncrementalParse(std::vector<TokenInfo> &NewTokens,
+                                          std::vector<UnitRange> &NewUnits) {
+  if (NewUnits.size() != Units.size())
+    return false;
+
+  /// Find the common prefix and suffix of the two token streams. Lines
+  /// inserted or deleted before the suffix move it as a whole, so it is
+  /// compared with the line offset of the last tokens.
+  unsigned OldSize = TheTokens.size();
+  unsigned NewSize = NewTokens.size();
+  unsigned Limit = std::min(OldSize, NewSize);
+  unsigned Prefix = 0;
+  while (Prefix < Limit &&
+         IsSameToken(TheTokens[Prefix], NewTokens[Prefix], 0))
+    ++Prefix;
+  /// Both streams end with an ENDMARKER, wherever the last line is.
+  unsigned Suffix = Prefix < Limit ? 1 : 0;
+  int LineDelta = 0;
+  if (Suffix < Limit - Prefix)
+    LineDelta = int(NewTokens[NewSize - 2].getLocation().getLine()) -
+                int(TheTokens[OldSize - 2].getLocation().getLine());
+  while (Suffix < Limit - Prefix &&
+         IsSameToken(TheTokens[OldSize - 1 - Suffix],
+                     NewTokens[NewSize - 1 - Suffix], LineDelta))
+    ++Suffix;
+
+  /// A unit is unchanged if it lies wholly in the prefix or the suffix.
+  /// Only functions whose signatures stay the same may change.
+  std::vector<unsigned> Changed;
+  std::vector<unsigned> Moved;
+  for (unsigned I = 0, E = Units.size(); I < E; ++I) {
+    const Unit &U = Units[I];
+    const UnitRange &R = NewUnits[I];
+    if (R.second <= Prefix && U.TokenBegin == R.first &&
+        U.TokenEnd == R.second)
+      continue;
+    if (R.first >= NewSize - Suffix &&
+        U.TokenBegin + NewSize == R.first + OldSize &&
+        U.TokenEnd + NewSize == R.second + OldSize) {
+      if (LineDelta)
+        Moved.push_back(I);
+      continue;
+    }
+    if (!U.IsFuncDef(TheTokens) ||
+        !IsSameSignature(TheTokens, U.TokenBegin, NewTokens, R.first))
+      return false;
+    Changed.push_back(I);
+  }
+
+  /// Parse the changed functions. Any error is reported by a full check.
+  std::vector<DeclAST *> NewFuncDefs;
+  for (unsigned I : Changed) {
+    const UnitRange &R = NewUnits[I];
+    std::vector<TokenInfo> Slice(NewTokens.begin() + R.first,
+                                 NewTokens.begin() + R.second);
+    std::vector<DeclAST *> Decls;
+    bool Failed;
+    {
+      DiagnosticCapture Discard;
+      Failed = BuildTopLevelDecl(Slice, Decls);
+    }
+    if (Failed || Decls.size() != 1 || !IsInstance<FuncDef>(Decls.front())) {
+      DeleteAST::apply(Decls);
+      DeleteAST::apply(NewFuncDefs);
+      return false;
+    }
+    NewFuncDefs.push_back(Decls.front());
+  }
+
+  /// Commit the new tokens and functions.
+  TheTokens = std::move(NewTokens);
+  for (unsigned I = 0, E = Units.size(); I < E; ++I) {
+    Units[I].TokenBegin = NewUnits[I].first;
+    Units[I].TokenEnd = NewUnits[I].second;
+  }
+  auto &Decls = TheProgram->getDecls();
+  for (unsigned I = 0, E = Changed.size(); I < E; ++I) {
+    Unit &U = Units[Changed[I]];
+    auto Old = static_cast<FuncDef *>(Decls[U.DeclBegin]);
+    auto New = static_cast<FuncDef *>(NewFuncDefs[I]);
+    Decls[U.DeclBegin] = New;
+    for (PhaseResult &Result : U.Results)
+      Result = PhaseResult();
+    if (TableBuilt) {
+      /// Old must leave the SymbolTable before it dies.
+      PhaseResult &Result = U.Results[NamePhase];
+      DiagnosticCapture Capture;
+      Result.Failed = SymbolTableBuilder().Rebuild(Old, New, TheTable);
+      Result.Diagnostics = Capture.take();
+      Result.Done = true;
+    }
+    DeleteAST::apply(Old);
+  }
+  for (unsigned I : Moved)
+    ShiftLines(Units[I], LineDelta);
+
+  /// ArrayBoundChecker uses the ranges of values functions return, so callers
+  /// of a changed function must be checked again, and so must their callers.
+  std::unordered_set<std::string> ChangedNames;
+  for (unsigned I : Changed)
+    ChangedNames.insert(Units[I].getFuncName(TheTokens));
+  for (bool Grown = true; Grown;) {
+    Grown = false;
+    for (Unit &U : Units) {
+      if (!U.Results[ArrayBoundPhase].Done || !U.IsFuncDef(TheTokens) ||
+          !U.References(TheTokens, ChangedNames))
+        continue;
+      U.Results[ArrayBoundPhase] = PhaseResult();
+      Grown |= ChangedNames.insert(U.getFuncName(TheTokens)).second;
+    }
+  }
+
+  /// Build the SymbolTable anew once more slots are retired than in use.
+  if (TableBuilt && TheTable.getNumRetiredLocals() > TheTable.getNumLocals()) {
+    TableBuilt = false;
+    for (Unit &U : Units)
+      U.Results[NamePhase] = PhaseResult();
+  }
+  NumReparsed = Changed.size();
+  return true;
+}
+
+void IncrementalChecker::RunPhase(PhaseKind Phase, Unit &U) {
+  PhaseResult &Result = U.Results[Phase];
+  DiagnosticCapture Capture;
+  for (unsigned I = U.DeclBegin; I < U.DeclEnd; ++I) {
+    DeclAST *D = TheProgram->getDecls()[I];
+    auto FD = subclass_cast<FuncDef>(D);
+    switch (Phase) {
+    case NamePhase:
+      assert(false && "NamePhase is run by RunAnalyses()");
+      break;
+    case TypePhase:
+      if (!FD)
+        break;
+      ImplicitCallTransformer().Transform(FD, TheTable);
+      Result.Failed |= TypeChecker().Check(FD, TheTable);
+      break;
+    case ArrayBoundPhase:
+      if (FD)
+        Result.Failed |= ArrayBoundChecker().Check(FD, TheTable);
+      break;
+    case VerifyPhase:Result.Failed |= ASTVerifier().Check(D);
+      break;
+    default:assert(false && "Unhandled PhaseKind");
+    }
+  }
+  Result.Diagnostics = Capture.take();
+  Result.Done = true;
+}
+
+void IncrementalChecker::ShiftLines(Unit &U, int LineDelta) {
+  LineShifter Shifter(LineDelta);
+  for (unsigned I = U.DeclBegin; I < U.DeclEnd; ++I)
+    Shifter.Apply(TheProgram->getDecls()[I]);
+  for (PhaseResult &Result : U.Results) {
+    for (Diagnostic &D : Result.Diagnostics) {
+      if (!D.hasRange())
+        continue;
+      SourceRange R = D.getRange();
+      D = Diagnostic(D.getType(),
+                     SourceRange(ShiftLine(R.getBegin(), LineDelta),
+                                 ShiftLine(R.getEnd(), LineDelta)),
+                     D.getMessage());
+    }
+  }
+}
+
+bool IncrementalChecker::RunAnalyses() {
+  /// SyntaxChecker looks at declarations only, so it is cheap to run it on the
+  /// whole program.
+  {
+    bool Failed;
+    std::vector<Diagnostic> Diagnostics;
+    {
+      DiagnosticCapture Capture;
+      Failed = SyntaxChecker().Check(TheProgram.get());
+      Diagnostics = Capture.take();
+    }
+    if (Failed) {
+      Replay(Diagnostics);
+      return true;
+    }
+  }
+
+  for (int Phase = NamePhase; Phase < NumPhases; ++Phase) {
+    if (Phase == NamePhase && !TableBuilt) {
+      SymbolTableBuilder Builder;
+      Builder.Begin(TheTable);
+      for (Unit &U : Units) {
+        PhaseResult &Result = U.Results[NamePhase];
+        DiagnosticCapture Capture;
+        for (unsigned I = U.DeclBegin; I < U.DeclEnd; ++I)
+          Result.Failed |= Builder.BuildDecl(TheProgram->getDecls()[I]);
+        Result.Diagnostics = Capture.take();
+        Result.Done = true;
+      }
+      TableBuilt = true;
+    }
+
+    bool Failed = false;
+    for (Unit &U : Units) {
+      if (!U.Results[Phase].Done)
+        RunPhase(static_cast<PhaseKind>(Phase), U);
+      Failed |= U.Results[Phase].Failed;
+    }
+    if (!Failed)
+      continue;
+    /// Report this phase in program order as a full check would.
+    for (const Unit &U : Units)
+      Replay(U.Results[Phase].Diagnostics);
+    if (Phase == VerifyPhase) {
+      DiagnosticsEngine::get().flush();
+      PrintErrs("ProgramAST should be well-formed after all analyses run!");
+    }
+    return true;
+  }
+  return false;
+}
+
+void IncrementalChecker::clear() {
+  Filename.clear();
+  TheTokens.clear();
+  Units.clear();
+  TheTable.clear();
+  TheProgram.reset();
+  TableBuilt = false;
+  NumReparsed = -1;
+}
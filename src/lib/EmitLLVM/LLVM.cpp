@@ -22,20 +22,170 @@
 
 #include "simplecc/LLVM/LLVM.h"
 #include "simplecc/LLVM/LLVMIRCompiler.h"
+#include "simplecc/LLVM/LLVMObjectCache.h"
+#include "simplecc/Support/ErrorManager.h"
+#include <cstdio>
+#include <llvm/ExecutionEngine/Orc/CompileUtils.h>
+#include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
+#include <llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/Passes/OptimizationLevel.h>
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/Support/TargetSelect.h>
 
 namespace simplecc {
 
-bool CompileToLLVMIR(ProgramAST *P, const SymbolTable &S, llvm::raw_ostream &OS) {
+/// Return the passes of a custom pipeline that are not AST passes, which are
+/// left to LLVM, as a pipeline string of PassBuilder.
+static std::string getLLVMPipeline(const std::vector<std::string> &Passes) {
+  std::string Pipeline;
+  for (const std::string &Pass : Passes) {
+#define HANDLE_AST_PASS(Name, Description)                                     \
+  if (Pass == Name)                                                            \
+    continue;
+#include "simplecc/Support/Passes.def"
+    if (!Pipeline.empty())
+      Pipeline += ',';
+    Pipeline += Pass;
+  }
+  return Pipeline;
+}
+
+/// Optimize M with the new pass manager of LLVM.
+/// Return true if the custom pipeline fails to parse.
+static bool RunLLVMPasses(llvm::Module &M, const OptimizationOptions &Options) {
+  static const llvm::OptimizationLevel Levels[] = {
+      llvm::OptimizationLevel::O0, llvm::OptimizationLevel::O1,
+      llvm::OptimizationLevel::O2, llvm::OptimizationLevel::O3};
+
+  llvm::PassBuilder PB;
+  llvm::LoopAnalysisManager LAM;
+  llvm::FunctionAnalysisManager FAM;
+  llvm::CGSCCAnalysisManager CGAM;
+  llvm::ModuleAnalysisManager MAM;
+  PB.registerModuleAnalyses(MAM);
+  PB.registerCGSCCAnalyses(CGAM);
+  PB.registerFunctionAnalyses(FAM);
+  PB.registerLoopAnalyses(LAM);
+  PB.crossRegisterProxies(LAM, FAM, CGAM, MAM);
+
+  llvm::ModulePassManager MPM;
+  if (Options.hasCustomPipeline()) {
+    std::string Pipeline = getLLVMPipeline(Options.Passes);
+    if (Pipeline.empty())
+      return false;
+    if (auto Err = PB.parsePassPipeline(MPM, Pipeline)) {
+      ErrorManager EM("PassPipelineError");
+      EM.Error(llvm::toString(std::move(Err)));
+      return true;
+    }
+  } else {
+    /// The default pipeline of O0 is not to be built.
+    if (Options.OptLevel == 0)
+      return false;
+    MPM = PB.buildPerModuleDefaultPipeline(Levels[Options.OptLevel]);
+  }
+  MPM.run(M, MAM);
+  return false;
+}
+
+bool CompileToLLVMIR(ProgramAST *P, const SymbolTable &S, llvm::raw_ostream &OS,
+                     const OptimizationOptions &Options) {
 
-  auto TheCompiler = llvm::make_unique<LLVMIRCompiler>(P, S);
+  auto TheCompiler = std::make_unique<LLVMIRCompiler>(P, S);
 
   /// Compile to llvm::Module, fail fast.
   if (TheCompiler->Compile())
     return true;
 
+  if (RunLLVMPasses(TheCompiler->getModule(), Options))
+    return true;
+
   /// Write out the human-readable bitcode.
   TheCompiler->getModule().print(OS, nullptr);
   return false;
 }
 
+/// Return the level of code generation of an optimization level.
+static llvm::CodeGenOpt::Level getCodeGenOptLevel(unsigned OptLevel) {
+  static const llvm::CodeGenOpt::Level Levels[] = {
+      llvm::CodeGenOpt::None, llvm::CodeGenOpt::Less,
+      llvm::CodeGenOpt::Default, llvm::CodeGenOpt::Aggressive};
+  return Levels[OptLevel];
+}
+
+bool RunWithLLVMJIT(ProgramAST *P, const SymbolTable &S,
+                    const OptimizationOptions &Options,
+                    const std::string &CacheDir, bool PrintCacheStats) {
+  ErrorManager EM("LLVMJITError");
+  /// Report the llvm::Error of E, if any. Return true if there is one.
+  auto Failed = [&EM](llvm::Error E) {
+    if (!E)
+      return false;
+    EM.Error(llvm::toString(std::move(E)));
+    return true;
+  };
+
+  llvm::InitializeNativeTarget();
+  llvm::InitializeNativeTargetAsmPrinter();
+
+  auto TheCompiler = std::make_unique<LLVMIRCompiler>(P, S);
+  if (TheCompiler->Compile())
+    return true;
+  llvm::Module &M = TheCompiler->getModule();
+
+  /// The passes see the data layout of the host.
+  auto JTMB = llvm::orc::JITTargetMachineBuilder::detectHost();
+  if (!JTMB)
+    return Failed(JTMB.takeError());
+  JTMB->setCodeGenOptLevel(getCodeGenOptLevel(Options.OptLevel));
+  auto DL = JTMB->getDefaultDataLayoutForTarget();
+  if (!DL)
+    return Failed(DL.takeError());
+  M.setDataLayout(*DL);
+  M.setTargetTriple(JTMB->getTargetTriple().str());
+  if (RunLLVMPasses(M, Options))
+    return true;
+
+  auto TM = JTMB->createTargetMachine();
+  if (!TM)
+    return Failed(TM.takeError());
+  auto J = llvm::orc::LLJITBuilder()
+               .setJITTargetMachineBuilder(std::move(*JTMB))
+               .create();
+  if (!J)
+    return Failed(J.takeError());
+
+  /// printf() and scanf() are those of this process.
+  auto Generator =
+      llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(
+          DL->getGlobalPrefix());
+  if (!Generator)
+    return Failed(Generator.takeError());
+  (*J)->getMainJITDylib().addGenerator(std::move(*Generator));
+
+  /// Compile the Module to an object, unless an earlier run left one in the
+  /// cache, and let the JIT link and load it.
+  LLVMObjectCache Cache(CacheDir);
+  M.setModuleIdentifier(LLVMObjectCache::getModuleKey(M, Options.OptLevel));
+  llvm::orc::SimpleCompiler Compiler(**TM, &Cache);
+  auto Object = Compiler(M);
+  if (!Object)
+    return Failed(Object.takeError());
+  if (PrintCacheStats)
+    llvm::errs() << "JIT cache: " << (Cache.getNumHits() ? "hit" : "miss")
+                 << "\n";
+  if (Failed((*J)->addObjectFile(std::move(*Object))))
+    return true;
+
+  auto Main = (*J)->lookup("main");
+  if (!Main)
+    return Failed(Main.takeError());
+  auto MainFn = reinterpret_cast<int (*)()>(
+      static_cast<uintptr_t>(Main->getAddress()));
+  MainFn();
+  std::fflush(stdout);
+  return false;
+}
+
 } // namespace simplecc
@@ -33,6 +33,14 @@ using llvm::StringRef;
 
 using namespace simplecc;
 
+/// Return the type of the variable Ptr points to, which is either an alloca
+/// or a global.
+static llvm::Type *getVariableType(Value *Ptr) {
+  if (auto A = llvm::dyn_cast<llvm::AllocaInst>(Ptr))
+    return A->getAllocatedType();
+  return llvm::cast<GlobalVariable>(Ptr)->getValueType();
+}
+
 LLVMIRCompiler::LLVMIRCompiler(ProgramAST *P, const SymbolTable &S)
     : TheTable(S), TheProgram(P), TheContext(),
       TheModule(P->getFilename(), TheContext), Builder(TheContext),
@@ -124,7 +132,7 @@ Value *LLVMIRCompiler::visitName(NameExpr *N) {
   }
   // This is a variable so **load** it.
   if (!llvm::isa<llvm::ConstantInt>(Val)) {
-    return Builder.CreateLoad(Val, N->getName());
+    return Builder.CreateLoad(getVariableType(Val), Val, N->getName());
   }
   return Val;
 }
@@ -279,7 +287,12 @@ Value *LLVMIRCompiler::visitCall(CallExpr *C) {
   for (ExprAST *E : C->getArgs()) {
     Args.push_back(visitExpr(E));
   }
-  return Builder.CreateCall(Callee, Args);
+  auto Call = Builder.CreateCall(llvm::cast<llvm::Function>(Callee), Args);
+  /// No C0 function can reach the frame of its caller, since arrays are never
+  /// passed, so every call can be a tail call. This lets TailCallElim turn
+  /// self recursion into a loop and the backend reuse the frame.
+  Call->setTailCall();
+  return Call;
 }
 
 void LLVMIRCompiler::visitReturn(ReturnStmt *Ret) {
@@ -287,6 +300,11 @@ void LLVMIRCompiler::visitReturn(ReturnStmt *Ret) {
     Builder.CreateRet(visitExpr(Ret->getValue()));
     return;
   }
+  /// A return; in main(), which returns int in IR, returns 0.
+  if (!Builder.getCurrentFunctionReturnType()->isVoidTy()) {
+    Builder.CreateRet(VM.getInt(0));
+    return;
+  }
   Builder.CreateRetVoid();
 }
 
@@ -306,12 +324,13 @@ Value *LLVMIRCompiler::visitSubscript(SubscriptExpr *SB) {
   /// first using a zero index in getelementptr and then the desired index.
   // Value *IdxList[2] = {VM.getInt(0), Index};
   const std::array<Value *, 2> IdxList{VM.getInt(0), Index};
-  Value *ElemPtr = Builder.CreateInBoundsGEP(Array, IdxList);
+  llvm::Type *ArrayType = getVariableType(Array);
+  Value *ElemPtr = Builder.CreateInBoundsGEP(ArrayType, Array, IdxList);
 
   switch (SB->getContext()) {
   case ExprContextKind::Load:
     /// If this is a Load, emit a load.
-    return Builder.CreateLoad(ElemPtr);
+    return Builder.CreateLoad(ArrayType->getArrayElementType(), ElemPtr);
   case ExprContextKind::Store:
     /// If this is a Store, just return the ptr to the element
     /// to be stored by an Assign.
@@ -382,9 +401,6 @@ void LLVMIRCompiler::visitFuncDef(FuncDef *FD) {
   LocalValues.clear();
   TheLocal = TheTable.getLocalTable(FD);
 
-  // TODO: only fixing return type is not enough. Fix any return;
-  // within main() to return 0;
-
   /// Create function, fixing return type of main() to int.
   /// We choose to alter the AST since otherwise the AST will
   /// disagree with IR.
@@ -444,14 +460,11 @@ void LLVMIRCompiler::visitFuncDef(FuncDef *FD) {
   }
 
   /// Populate LocalValues with global objects.
+  /// Local names shadow global ones, which emplace() respects. The local
+  /// table may still list the variables that dead store elimination deleted,
+  /// which no statement uses.
   LocalSymbolTable Local = TheTable.getLocalTable(FD);
-  for (auto &&Pair : Local) {
-    const SymbolEntry &E = Pair.second;
-    if (E.IsLocal()) {
-      assert(LocalValues.count(E.getName()) &&
-          "Local DeclAST must have been handled");
-      continue;
-    }
+  for (const SymbolEntry &E : Local.globals()) {
     auto GV = GlobalValues[E.getName()];
     assert(GV && "Global Value must exist");
     LocalValues.emplace(E.getName(), GV);
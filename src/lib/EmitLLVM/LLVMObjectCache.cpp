@@ -0,0 +1,96 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "simplecc/LLVM/LLVMObjectCache.h"
+#include <cstdlib>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MD5.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/raw_ostream.h>
+
+using namespace simplecc;
+
+/// $XDG_CACHE_HOME/simplecc, or ~/.cache/simplecc.
+std::string LLVMObjectCache::getDefaultDirectory() {
+  llvm::SmallString<128> Dir;
+  if (const char *CacheHome = std::getenv("XDG_CACHE_HOME"))
+    Dir = CacheHome;
+  else if (llvm::sys::path::home_directory(Dir))
+    llvm::sys::path::append(Dir, ".cache");
+  else
+    return "";
+  llvm::sys::path::append(Dir, "simplecc");
+  return Dir.str().str();
+}
+
+std::string LLVMObjectCache::getModuleKey(const llvm::Module &M,
+                                          unsigned OptLevel) {
+  std::string Text;
+  llvm::raw_string_ostream OS(Text);
+  M.print(OS, nullptr);
+  OS << "; O" << OptLevel << "\n";
+  OS.flush();
+
+  llvm::MD5 Hash;
+  Hash.update(Text);
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  return Result.digest().str().str();
+}
+
+std::string LLVMObjectCache::getObjectPath(const llvm::Module *M) const {
+  llvm::SmallString<128> Path(CacheDir);
+  llvm::sys::path::append(Path, M->getModuleIdentifier() + ".o");
+  return Path.str().str();
+}
+
+void LLVMObjectCache::notifyObjectCompiled(const llvm::Module *M,
+                                           llvm::MemoryBufferRef Obj) {
+  if (CacheDir.empty() || llvm::sys::fs::create_directories(CacheDir))
+    return;
+  /// Write a temporary file and rename it, so that no run ever reads half an
+  /// object. A cache that cannot be written is no error.
+  std::string Path = getObjectPath(M);
+  auto Temp = llvm::sys::fs::TempFile::create(Path + ".%%%%%%.tmp");
+  if (!Temp) {
+    llvm::consumeError(Temp.takeError());
+    return;
+  }
+  llvm::raw_fd_ostream OS(Temp->FD, /* shouldClose */ false);
+  OS << Obj.getBuffer();
+  OS.flush();
+  if (auto Err = Temp->keep(Path))
+    llvm::consumeError(std::move(Err));
+}
+
+std::unique_ptr<llvm::MemoryBuffer>
+LLVMObjectCache::getObject(const llvm::Module *M) {
+  if (CacheDir.empty())
+    return nullptr;
+  auto Buffer = llvm::MemoryBuffer::getFile(getObjectPath(M));
+  if (!Buffer)
+    return nullptr;
+  ++NumHits;
+  return std::move(*Buffer);
+}
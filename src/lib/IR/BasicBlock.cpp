@@ -0,0 +1,118 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "simplecc/IR/BasicBlock.h"
+#include <algorithm>
+
+using namespace simplecc;
+
+BasicBlock::~BasicBlock() {
+  /// The successors may be gone already, so leave their predecessors alone.
+  while (First) {
+    Instruction *I = First;
+    First = I->Next;
+    I->Parent = nullptr;
+    I->Prev = I->Next = nullptr;
+    delete I;
+  }
+  Last = nullptr;
+}
+
+unsigned BasicBlock::size() const {
+  unsigned N = 0;
+  for (Instruction *I = First; I; I = I->getNext()) {
+    ++N;
+  }
+  return N;
+}
+
+Instruction *BasicBlock::getFirstNonPhi() const {
+  Instruction *I = First;
+  while (I && I->isPhi()) {
+    I = I->getNext();
+  }
+  return I;
+}
+
+void BasicBlock::insert(Instruction *Pos, Instruction *I) {
+  assert(!I->Parent && "Instruction already inserted");
+  assert((!Pos || Pos->Parent == this) && "Pos not in this block");
+  I->Parent = this;
+  I->Next = Pos;
+  I->Prev = Pos ? Pos->Prev : Last;
+  (I->Prev ? I->Prev->Next : First) = I;
+  (Pos ? Pos->Prev : Last) = I;
+
+  if (I->isTerminator()) {
+    for (BasicBlock *Succ : I->Blocks) {
+      Succ->addPredecessor(this);
+    }
+  }
+}
+
+Instruction *BasicBlock::remove(Instruction *I) {
+  assert(I->Parent == this && "Instruction not in this block");
+  (I->Prev ? I->Prev->Next : First) = I->Next;
+  (I->Next ? I->Next->Prev : Last) = I->Prev;
+  I->Parent = nullptr;
+  I->Prev = I->Next = nullptr;
+
+  if (I->isTerminator()) {
+    for (BasicBlock *Succ : I->Blocks) {
+      Succ->removePredecessor(this);
+    }
+  }
+  return I;
+}
+
+void BasicBlock::erase(Instruction *I) { delete remove(I); }
+
+BasicBlock::BlockListTy BasicBlock::getSuccessors() const {
+  Instruction *Term = getTerminator();
+  return Term ? Term->Blocks : BlockListTy();
+}
+
+void BasicBlock::removePhiEntriesFor(BasicBlock *Pred) {
+  for (Instruction *I = First; I && I->isPhi(); I = I->getNext()) {
+    for (unsigned Idx = 0, E = I->getNumIncoming(); Idx < E; ++Idx) {
+      if (I->getIncomingBlock(Idx) == Pred) {
+        I->removeIncoming(Idx);
+        break;
+      }
+    }
+  }
+}
+
+void BasicBlock::replacePhiUsesWith(BasicBlock *From, BasicBlock *To) {
+  for (Instruction *I = First; I && I->isPhi(); I = I->getNext()) {
+    for (unsigned Idx = 0, E = I->getNumIncoming(); Idx < E; ++Idx) {
+      if (I->getIncomingBlock(Idx) == From)
+        I->setIncomingBlock(Idx, To);
+    }
+  }
+}
+
+void BasicBlock::removePredecessor(BasicBlock *B) {
+  auto Iter = std::find(Predecessors.begin(), Predecessors.end(), B);
+  assert(Iter != Predecessors.end() && "Not a predecessor");
+  Predecessors.erase(Iter);
+}
@@ -0,0 +1,66 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "simplecc/IR/BlockLayout.h"
+#include "simplecc/IR/IRFunction.h"
+#include "simplecc/Support/ExecutionProfile.h"
+#include <algorithm>
+
+using namespace simplecc;
+
+bool BlockLayout::isCold(const BasicBlock *BB) const {
+  bool Known = false;
+  for (auto I = BB->getFirstNonPhi(); I; I = I->getNext()) {
+    auto Iter = Lines->find(I->getLineno());
+    if (Iter == Lines->end())
+      continue;
+    if (Iter->second)
+      return false;
+    Known = true;
+  }
+  return Known;
+}
+
+bool BlockLayout::Transform(IRFunction &F) {
+  const ExecutionProfile::FunctionProfile *FP = Profile.getFunction(F.getName());
+  if (!FP)
+    return false;
+  Lines = &FP->getLineCounts();
+
+  IRFunction::BlockListTy Cold;
+  for (BasicBlock *BB : F) {
+    if (BB != F.getEntryBlock() && isCold(BB))
+      Cold.push_back(BB);
+  }
+  /// Nothing to do if the cold blocks are already the last ones.
+  if (Cold.empty() ||
+      std::equal(Cold.rbegin(), Cold.rend(), F.getBlockList().rbegin()))
+    return false;
+  BasicBlock *Last = F.getBlockList().back();
+  for (BasicBlock *BB : Cold) {
+    if (BB != Last)
+      F.moveBlockAfter(BB, Last);
+    Last = BB;
+  }
+  return true;
+}
@@ -0,0 +1,490 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "simplecc/IR/ByteCodeLowering.h"
+#include "simplecc/CodeGen/ByteCodeFunction.h"
+#include "simplecc/CodeGen/ByteCodeModule.h"
+#include "simplecc/IR/DominatorTree.h"
+#include "simplecc/IR/Liveness.h"
+#include "simplecc/Support/Casting.h"
+#include <algorithm>
+
+using namespace simplecc;
+
+static BinaryOpKind getCompareOp(Instruction::Predicate P) {
+  switch (P) {
+  case Instruction::EQ:
+    return BinaryOpKind::Eq;
+  case Instruction::NE:
+    return BinaryOpKind::NotEq;
+  case Instruction::LT:
+    return BinaryOpKind::Lt;
+  case Instruction::LE:
+    return BinaryOpKind::LtE;
+  case Instruction::GT:
+    return BinaryOpKind::Gt;
+  case Instruction::GE:
+    return BinaryOpKind::GtE;
+  }
+  assert(false && "Not a compare");
+  return BinaryOpKind::Eq;
+}
+
+static BinaryOpKind getBinaryOp(Instruction::Opcode Op) {
+  switch (Op) {
+  case Instruction::Add:
+    return BinaryOpKind::Add;
+  case Instruction::Sub:
+    return BinaryOpKind::Sub;
+  case Instruction::Mul:
+    return BinaryOpKind::Mult;
+  case Instruction::Div:
+    return BinaryOpKind::Div;
+  default:
+    break;
+  }
+  assert(false && "Not a binary operator");
+  return BinaryOpKind::Add;
+}
+
+static ByteCode::Opcode getImmediateOp(Instruction::Opcode Op) {
+  switch (Op) {
+  case Instruction::Shl:
+    return ByteCode::SHIFT_LEFT;
+  case Instruction::AShr:
+    return ByteCode::SHIFT_RIGHT;
+  case Instruction::LShr:
+    return ByteCode::SHIFT_RIGHT_LOGICAL;
+  case Instruction::MulHi:
+    return ByteCode::MULTIPLY_HIGH;
+  default:
+    break;
+  }
+  assert(false && "Not an operator with an immediate");
+  return ByteCode::SHIFT_LEFT;
+}
+
+void ByteCodeLowering::removeDeadCode(IRFunction &F) {
+  std::vector<Instruction *> Worklist;
+  for (BasicBlock *BB : F) {
+    for (Instruction &I : *BB) {
+      if (!I.hasSideEffects() && !I.mayTrap() && !I.hasUses())
+        Worklist.push_back(&I);
+    }
+  }
+  while (!Worklist.empty()) {
+    Instruction *I = Worklist.back();
+    Worklist.pop_back();
+    Instruction::OperandListTy Operands = I->getOperands();
+    I->eraseFromParent();
+    for (Value *Op : Operands) {
+      auto OpI = subclass_cast<Instruction>(Op);
+      if (OpI && !OpI->hasSideEffects() && !OpI->mayTrap() &&
+          !OpI->hasUses() &&
+          std::find(Worklist.begin(), Worklist.end(), OpI) == Worklist.end())
+        Worklist.push_back(OpI);
+    }
+  }
+}
+
+Instruction *ByteCodeLowering::stackifyOperands(Instruction *U) {
+  /// The operands are pushed in order, so the last one must come right
+  /// before U, the one before it right before the last one's tree, etc.
+  Instruction *InsertPt = U;
+  for (unsigned I = U->getNumOperands(); I-- > 0;) {
+    auto V = subclass_cast<Instruction>(U->getOperand(I));
+    if (!V || V->isPhi() || !V->hasOneUse() || V != InsertPt->getPrev())
+      continue;
+    Stackified.insert(V);
+    InsertPt = stackifyOperands(V);
+  }
+  return InsertPt;
+}
+
+void ByteCodeLowering::stackify(BasicBlock *BB) {
+  for (Instruction *U = BB->getLast(); U && !U->isPhi();
+       U = stackifyOperands(U)->getPrev()) {
+  }
+}
+
+void ByteCodeLowering::assignTemporaries(IRFunction &F) {
+  /// Put each phi and its operands in one class unless they interfere.
+  /// Values of a class share a location, so copies among them vanish.
+  DominatorTree DT(F);
+  Liveness LV(F);
+  std::unordered_map<const Value *, std::vector<Value *>> Classes;
+  std::unordered_map<const Value *, const Value *> Leaders;
+  auto getLeader = [&](Value *V) -> const Value * {
+    auto Iter = Leaders.find(V);
+    if (Iter != Leaders.end())
+      return Iter->second;
+    Leaders.emplace(V, V);
+    Classes[V].push_back(V);
+    return V;
+  };
+  auto Interfere = [&](const std::vector<Value *> &A,
+                       const std::vector<Value *> &B) {
+    for (Value *X : A) {
+      for (Value *Y : B) {
+        if (LV.interfere(X, Y, DT))
+          return true;
+      }
+    }
+    return false;
+  };
+
+  for (BasicBlock *BB : F) {
+    for (Instruction &Phi : *BB) {
+      if (!Phi.isPhi())
+        break;
+      for (Value *V : Phi.getOperands()) {
+        if (!IsInstance<Instruction>(V) && !IsInstance<Argument>(V))
+          continue;
+        const Value *PhiLeader = getLeader(&Phi);
+        const Value *Leader = getLeader(V);
+        if (PhiLeader == Leader ||
+            Interfere(Classes[PhiLeader], Classes[Leader]))
+          continue;
+        /// Merge the class of V into that of the phi.
+        for (Value *Member : Classes[Leader]) {
+          Leaders[Member] = PhiLeader;
+          Classes[PhiLeader].push_back(Member);
+        }
+        Classes.erase(Leader);
+      }
+    }
+  }
+
+  /// A class with an Argument lives in it.
+  const auto &Arguments = TheFunction->getFormalArguments();
+  assert(Arguments.size() == F.getNumArguments() && "Arguments mismatched");
+  for (unsigned I = 0, E = Arguments.size(); I < E; ++I) {
+    Argument *A = F.getArgument(I);
+    auto Iter = Leaders.find(A);
+    const std::string *Name = &Arguments[I].getName();
+    if (Iter == Leaders.end()) {
+      Names.emplace(A, Name);
+      continue;
+    }
+    for (Value *Member : Classes[Iter->second]) {
+      Names.emplace(Member, Name);
+    }
+  }
+
+  unsigned NextTemp = 0;
+  for (BasicBlock *BB : F) {
+    for (Instruction &I : *BB) {
+      if (!I.hasValue() || !I.hasUses() || Stackified.count(&I) ||
+          Names.count(&I))
+        continue;
+      const std::string *Name =
+          &TheFunction->addTemporary("%" + std::to_string(NextTemp++));
+      auto Iter = Leaders.find(&I);
+      if (Iter == Leaders.end()) {
+        Names.emplace(&I, Name);
+        continue;
+      }
+      for (Value *Member : Classes[Iter->second]) {
+        Names.emplace(Member, Name);
+      }
+    }
+  }
+
+  std::unordered_set<std::string> Used;
+  for (LocalArray *A : F.getLocalArrays()) {
+    std::string Name = "%" + A->getName();
+    for (unsigned K = 0; !Used.insert(Name).second; ++K)
+      Name = "%" + A->getName() + "." + std::to_string(K);
+    Names.emplace(A, &TheFunction->addTemporary(Name, A->getSize()));
+  }
+
+}
+
+void ByteCodeLowering::setLineno(const Instruction *I) {
+  Builder.setLineno(I->getLineno());
+  IRFunction *F = I->getSourceFunction();
+  Builder.setSourceFunction(F ? FunctionNames.at(F)->c_str() : nullptr);
+}
+
+void ByteCodeLowering::emitValue(Value *V) {
+  if (auto C = subclass_cast<Constant>(V)) {
+    Builder.CreateLoadConst(C->getValue());
+    return;
+  }
+  if (IsInstance<UndefValue>(V)) {
+    Builder.CreateLoadConst(0);
+    return;
+  }
+  if (IsInstance<GlobalVariable>(V)) {
+    Builder.CreateLoad(Scope::Global, getName(V));
+    return;
+  }
+  auto I = subclass_cast<Instruction>(V);
+  if (I && Stackified.count(I)) {
+    emitComputation(I);
+    return;
+  }
+  /// Arguments, LocalArrays and Instructions in temporaries.
+  Builder.CreateLoad(Scope::Local, getName(V));
+}
+
+void ByteCodeLowering::emitComputation(Instruction *I) {
+  setLineno(I);
+  for (Value *Op : I->getOperands()) {
+    /// Scalar globals are named by Load and Store.
+    if (I->getOpcode() != Instruction::Store ||
+        !IsInstance<GlobalVariable>(Op))
+      emitValue(Op);
+    /// The constant RHS of a shift or mulhi is encoded in the ByteCode.
+    if (Instruction::hasImmediateOperand(I->getOpcode()))
+      break;
+  }
+  setLineno(I);
+
+  switch (I->getOpcode()) {
+  case Instruction::Add:
+  case Instruction::Sub:
+  case Instruction::Mul:
+  case Instruction::Div:
+    Builder.CreateBinary(getBinaryOp(I->getOpcode()));
+    break;
+  case Instruction::Shl:
+  case Instruction::AShr:
+  case Instruction::LShr:
+  case Instruction::MulHi: {
+    auto Imm = subclass_cast<Constant>(I->getOperand(1));
+    Builder.CreateImmediate(getImmediateOp(I->getOpcode()), Imm->getValue());
+    break;
+  }
+  case Instruction::Neg:
+    Builder.CreateUnary(UnaryOpKind::USub);
+    break;
+  case Instruction::Load:
+    /// The GlobalVariable was pushed as an operand, i.e., loaded.
+    break;
+  case Instruction::Store:
+    Builder.CreateStore(Scope::Global, getName(I->getOperand(1)));
+    break;
+  case Instruction::LoadElem:
+    Builder.CreateSubscr(ExprContextKind::Load);
+    break;
+  case Instruction::StoreElem:
+    Builder.CreateSubscr(ExprContextKind::Store);
+    break;
+  case Instruction::Call:
+    Builder.CreateCallFunction(*FunctionNames.at(I->getCallee()),
+                               I->getNumOperands());
+    break;
+  case Instruction::ReadInt:
+    Builder.CreateRead(BasicTypeKind::Int);
+    break;
+  case Instruction::ReadChar:
+    Builder.CreateRead(BasicTypeKind::Character);
+    break;
+  case Instruction::PrintString:
+    Builder.CreateLoadString(I->getStringID());
+    Builder.CreatePrintString();
+    break;
+  case Instruction::PrintInt:
+    Builder.CreatePrint(BasicTypeKind::Int);
+    break;
+  case Instruction::PrintChar:
+    Builder.CreatePrint(BasicTypeKind::Character);
+    break;
+  case Instruction::PrintNewline:
+    Builder.CreatePrintNewline();
+    break;
+  default:
+    assert(false && "Unexpected opcode");
+  }
+}
+
+void ByteCodeLowering::emitInstruction(Instruction *I) {
+  emitComputation(I);
+  /// A call always pushes a value.
+  bool Pushed = I->hasValue() || I->getOpcode() == Instruction::Call;
+  if (!Pushed)
+    return;
+  if (I->hasValue() && I->hasUses())
+    Builder.CreateStore(Scope::Local, getName(I));
+  else
+    Builder.CreatePopTop();
+}
+
+bool ByteCodeLowering::needsCopies(BasicBlock *From, BasicBlock *To) const {
+  for (Instruction &Phi : *To) {
+    if (!Phi.isPhi())
+      break;
+    Value *V = Phi.getIncomingValueForBlock(From);
+    if (V != &Phi && !isCoalesced(V, &Phi))
+      return true;
+  }
+  return false;
+}
+
+void ByteCodeLowering::emitPhiCopies(BasicBlock *From, BasicBlock *To) {
+  std::vector<Instruction *> Phis;
+  for (Instruction &Phi : *To) {
+    if (!Phi.isPhi())
+      break;
+    Value *V = Phi.getIncomingValueForBlock(From);
+    if (V == &Phi || isCoalesced(V, &Phi))
+      continue;
+    emitValue(V);
+    Phis.push_back(&Phi);
+  }
+  for (auto Iter = Phis.rbegin(); Iter != Phis.rend(); ++Iter) {
+    Builder.CreateStore(Scope::Local, getName(*Iter));
+  }
+}
+
+void ByteCodeLowering::emitJump(BasicBlock *Dest, BasicBlock *Next) {
+  if (Dest != Next)
+    addFixup(Builder.CreateJumpForward(), Dest);
+}
+
+void ByteCodeLowering::emitTerminator(Instruction *I, BasicBlock *Next) {
+  BasicBlock *BB = I->getParent();
+  setLineno(I);
+  switch (I->getOpcode()) {
+  case Instruction::Ret:
+    if (I->getNumOperands()) {
+      emitValue(I->getOperand(0));
+      Builder.CreateReturnValue();
+    } else {
+      Builder.CreateReturnNone();
+    }
+    break;
+  case Instruction::Br:
+    emitPhiCopies(BB, I->getSuccessor(0));
+    emitJump(I->getSuccessor(0), Next);
+    break;
+  case Instruction::CondBr: {
+    /// Jump to TrueDest and fall through to FalseDest.
+    BasicBlock *TrueDest = I->getSuccessor(0);
+    BasicBlock *FalseDest = I->getSuccessor(1);
+    Instruction::Predicate P = I->getPredicate();
+    if (TrueDest == Next) {
+      std::swap(TrueDest, FalseDest);
+      P = Instruction::getInversePredicate(P);
+    }
+
+    Value *LHS = I->getOperand(0);
+    Value *RHS = I->getOperand(1);
+    auto Zero = subclass_cast<Constant>(RHS);
+    unsigned Jump;
+    emitValue(LHS);
+    setLineno(I);
+    if ((P == Instruction::EQ || P == Instruction::NE) && Zero &&
+        Zero->getValue() == 0) {
+      Jump = P == Instruction::NE ? Builder.CreateJumpIfTrue()
+                                  : Builder.CreateJumpIfFalse();
+    } else {
+      emitValue(RHS);
+      setLineno(I);
+      Jump = Builder.CreateCondJump(getCompareOp(P), /* IsNeg */ false);
+    }
+
+    if (needsCopies(BB, TrueDest))
+      Stubs.push_back(EdgeStub{BB, TrueDest, Jump});
+    else
+      addFixup(Jump, TrueDest);
+    emitPhiCopies(BB, FalseDest);
+    emitJump(FalseDest, Next);
+    break;
+  }
+  default:
+    assert(false && "Not a terminator");
+  }
+}
+
+void ByteCodeLowering::emitBlock(BasicBlock *BB, BasicBlock *Next) {
+  BlockOffsets.emplace(BB, Builder.getSize());
+  for (Instruction &I : *BB) {
+    if (I.isPhi() || Stackified.count(&I))
+      continue;
+    if (I.isTerminator())
+      emitTerminator(&I, Next);
+    else
+      emitInstruction(&I);
+  }
+}
+
+void ByteCodeLowering::lowerFunction(IRFunction &F, ByteCodeFunction &BF) {
+  TheFunction = &BF;
+  BF.getByteCodeList().clear();
+  BF.getLocalVariables().clear();
+  BF.clearTemporaries();
+  Builder.setInsertPoint(&BF);
+  Builder.setSourceFunction(nullptr);
+
+  removeDeadCode(F);
+  for (BasicBlock *BB : F) {
+    stackify(BB);
+  }
+  assignTemporaries(F);
+
+  const auto &Blocks = F.getBlockList();
+  for (unsigned I = 0, E = Blocks.size(); I < E; ++I) {
+    emitBlock(Blocks[I], I + 1 < E ? Blocks[I + 1] : nullptr);
+  }
+  /// Every block ends with a jump or return, so the stubs are never
+  /// fallen into.
+  for (const EdgeStub &S : Stubs) {
+    Builder.setJumpTargetAt(S.Jump, Builder.getSize());
+    setLineno(S.From->getTerminator());
+    emitPhiCopies(S.From, S.To);
+    addFixup(Builder.CreateJumpForward(), S.To);
+  }
+  for (const auto &Fixup : Fixups) {
+    Builder.setJumpTargetAt(Fixup.first, BlockOffsets.at(Fixup.second));
+  }
+
+  Stackified.clear();
+  BlockOffsets.clear();
+  Fixups.clear();
+  Stubs.clear();
+}
+
+void ByteCodeLowering::Lower(IRModule &M, ByteCodeModule &BM) {
+  std::unordered_map<std::string, ByteCodeFunction *> Functions;
+  for (ByteCodeFunction *BF : BM) {
+    Functions.emplace(BF->getName(), BF);
+  }
+  for (IRFunction *F : M) {
+    FunctionNames.emplace(F, &Functions.at(F->getName())->getName());
+  }
+  for (GlobalVariable *GV : M.getGlobals()) {
+    for (const SymbolEntry &E : BM.getGlobalVariables()) {
+      if (E.getName() == GV->getName()) {
+        Names.emplace(GV, &E.getName());
+        break;
+      }
+    }
+  }
+
+  for (IRFunction *F : M) {
+    lowerFunction(*F, *Functions.at(F->getName()));
+  }
+  Names.clear();
+  FunctionNames.clear();
+}
@@ -0,0 +1,196 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "simplecc/IR/DominatorTree.h"
+#include "simplecc/IR/IRFunction.h"
+#include <algorithm>
+#include <unordered_set>
+#include <utility>
+
+using namespace simplecc;
+
+void DominatorTree::recalculate(const IRFunction &F) {
+  TheFunction = &F;
+  computeRPO(F);
+  computeIDoms();
+  computeDFSNumbers();
+}
+
+void DominatorTree::computeRPO(const IRFunction &F) {
+  RPO.clear();
+  RPONumbers.clear();
+  if (F.empty())
+    return;
+
+  /// Iterative DFS that records the post order.
+  std::unordered_set<const BasicBlock *> Visited;
+  std::vector<std::pair<BasicBlock *, unsigned>> Stack;
+  BlockListTy PostOrder;
+  BasicBlock *Entry = F.getEntryBlock();
+  Stack.emplace_back(Entry, 0);
+  Visited.insert(Entry);
+  while (!Stack.empty()) {
+    BasicBlock *BB = Stack.back().first;
+    Instruction *Term = BB->getTerminator();
+    unsigned NumSuccs = Term ? Term->getNumSuccessors() : 0;
+    unsigned &Next = Stack.back().second;
+    if (Next == NumSuccs) {
+      PostOrder.push_back(BB);
+      Stack.pop_back();
+      continue;
+    }
+    BasicBlock *Succ = Term->getSuccessor(Next++);
+    if (Visited.insert(Succ).second)
+      Stack.emplace_back(Succ, 0);
+  }
+
+  RPO.assign(PostOrder.rbegin(), PostOrder.rend());
+  for (unsigned I = 0, E = RPO.size(); I < E; ++I) {
+    RPONumbers.emplace(RPO[I], I);
+  }
+}
+
+void DominatorTree::computeIDoms() {
+  constexpr unsigned Undefined = ~0U;
+  Nodes.assign(RPO.size(), Node{Undefined, {}, 0, 0});
+  if (RPO.empty())
+    return;
+  Nodes[0].IDom = 0;
+
+  /// Walk up the tree from both fingers until they meet.
+  auto Intersect = [this](unsigned A, unsigned B) {
+    while (A != B) {
+      while (A > B)
+        A = Nodes[A].IDom;
+      while (B > A)
+        B = Nodes[B].IDom;
+    }
+    return A;
+  };
+
+  bool Changed = true;
+  while (Changed) {
+    Changed = false;
+    for (unsigned I = 1, E = RPO.size(); I < E; ++I) {
+      unsigned NewIDom = Undefined;
+      for (const BasicBlock *Pred : RPO[I]->getPredecessors()) {
+        auto Iter = RPONumbers.find(Pred);
+        if (Iter == RPONumbers.end())
+          continue;
+        unsigned P = Iter->second;
+        if (Nodes[P].IDom == Undefined)
+          continue;
+        NewIDom = NewIDom == Undefined ? P : Intersect(P, NewIDom);
+      }
+      if (NewIDom != Nodes[I].IDom) {
+        Nodes[I].IDom = NewIDom;
+        Changed = true;
+      }
+    }
+  }
+
+  for (unsigned I = 1, E = RPO.size(); I < E; ++I) {
+    Nodes[Nodes[I].IDom].Children.push_back(RPO[I]);
+  }
+}
+
+void DominatorTree::computeDFSNumbers() {
+  if (RPO.empty())
+    return;
+  unsigned Counter = 0;
+  std::vector<std::pair<unsigned, unsigned>> Stack;
+  Stack.emplace_back(0, 0);
+  Nodes[0].DFSIn = Counter++;
+  while (!Stack.empty()) {
+    unsigned N = Stack.back().first;
+    unsigned &Next = Stack.back().second;
+    if (Next == Nodes[N].Children.size()) {
+      Nodes[N].DFSOut = Counter++;
+      Stack.pop_back();
+      continue;
+    }
+    unsigned Child = RPONumbers.at(Nodes[N].Children[Next++]);
+    Nodes[Child].DFSIn = Counter++;
+    Stack.emplace_back(Child, 0);
+  }
+}
+
+BasicBlock *DominatorTree::getIDom(const BasicBlock *BB) const {
+  auto Iter = RPONumbers.find(BB);
+  if (Iter == RPONumbers.end() || Iter->second == 0)
+    return nullptr;
+  return RPO[Nodes[Iter->second].IDom];
+}
+
+const DominatorTree::BlockListTy &
+DominatorTree::getChildren(const BasicBlock *BB) const {
+  return Nodes[RPONumbers.at(BB)].Children;
+}
+
+bool DominatorTree::dominates(const BasicBlock *A,
+                              const BasicBlock *B) const {
+  auto IterB = RPONumbers.find(B);
+  if (IterB == RPONumbers.end())
+    return true;
+  auto IterA = RPONumbers.find(A);
+  if (IterA == RPONumbers.end())
+    return false;
+  const Node &NA = Nodes[IterA->second];
+  const Node &NB = Nodes[IterB->second];
+  return NA.DFSIn <= NB.DFSIn && NB.DFSOut <= NA.DFSOut;
+}
+
+bool DominatorTree::dominates(const Instruction *Def,
+                              const Instruction *User) const {
+  const BasicBlock *DefBB = Def->getParent();
+  const BasicBlock *UserBB = User->getParent();
+  if (DefBB != UserBB)
+    return dominates(DefBB, UserBB);
+  /// Within a block, Def must come first.
+  for (const Instruction *I = Def->getNext(); I; I = I->getNext()) {
+    if (I == User)
+      return true;
+  }
+  return false;
+}
+
+void DominatorTree::Format(std::ostream &O) const {
+  if (RPO.empty())
+    return;
+  std::unordered_map<const BasicBlock *, unsigned> Layout;
+  for (const BasicBlock *BB : *TheFunction) {
+    Layout.emplace(BB, Layout.size());
+  }
+  /// Preorder walk with indentation by depth.
+  std::vector<std::pair<const BasicBlock *, unsigned>> Stack;
+  Stack.emplace_back(RPO[0], 0);
+  while (!Stack.empty()) {
+    const BasicBlock *BB = Stack.back().first;
+    unsigned Depth = Stack.back().second;
+    Stack.pop_back();
+    O << std::string(2 * Depth, ' ') << "%bb" << Layout.at(BB) << "\n";
+    const BlockListTy &Children = getChildren(BB);
+    for (auto Iter = Children.rbegin(); Iter != Children.rend(); ++Iter) {
+      Stack.emplace_back(*Iter, Depth + 1);
+    }
+  }
+}
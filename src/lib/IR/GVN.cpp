@@ -0,0 +1,171 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "simplecc/IR/GVN.h"
+#include "simplecc/IR/DominatorTree.h"
+#include "simplecc/IR/IRModule.h"
+#include "simplecc/IR/ModRefInfo.h"
+#include "simplecc/Support/Casting.h"
+#include <algorithm>
+
+using namespace simplecc;
+
+GVN::Expression GVN::getExpression(const Instruction *I) {
+  switch (I->getOpcode()) {
+  case Instruction::Neg:
+    return Expression{I->getOpcode(), I->getOperand(0), nullptr};
+  case Instruction::Load:
+    return Expression{Instruction::Load, I->getOperand(0), nullptr};
+  case Instruction::Store:
+    return Expression{Instruction::Load, I->getOperand(1), nullptr};
+  case Instruction::LoadElem:
+    return Expression{Instruction::LoadElem, I->getOperand(0),
+                      I->getOperand(1)};
+  case Instruction::StoreElem:
+    return Expression{Instruction::LoadElem, I->getOperand(1),
+                      I->getOperand(2)};
+  default:
+    assert(I->isBinaryOp() && "Instruction has no expression");
+    Value *LHS = I->getOperand(0);
+    Value *RHS = I->getOperand(1);
+    /// Any fixed order of the operands will do.
+    if (Instruction::isCommutative(I->getOpcode()) &&
+        std::less<Value *>()(RHS, LHS))
+      std::swap(LHS, RHS);
+    return Expression{I->getOpcode(), LHS, RHS};
+  }
+}
+
+Value *GVN::foldConstant(const Instruction *I) {
+  auto LHS = subclass_cast<const Constant>(I->getOperand(0));
+  if (!LHS)
+    return nullptr;
+  IRModule *M = I->getFunction()->getParent();
+  int Result;
+  if (I->getOpcode() == Instruction::Neg) {
+    Instruction::EvaluateBinary(Instruction::Sub, 0, LHS->getValue(), Result);
+    return M->getConstant(Result);
+  }
+  auto RHS = subclass_cast<const Constant>(I->getOperand(1));
+  if (!RHS || !Instruction::EvaluateBinary(I->getOpcode(), LHS->getValue(),
+                                           RHS->getValue(), Result))
+    return nullptr;
+  return M->getConstant(Result);
+}
+
+unsigned GVN::getVersion(Value *Location) const {
+  /// Every write takes a larger version than before, so the latest of the
+  /// writes that may reach Location tells whether it has changed.
+  unsigned Version = Epoch;
+  if (const unsigned *V = LocationVersions.lookup(Location))
+    Version = std::max(Version, *V);
+  return Version;
+}
+
+void GVN::clobber(Value *Location, const Expression &Key, Value *Val) {
+  LocationVersions.insert(Location, ++LastVersion);
+  AvailableMemory.insert(Key, MemoryValue{Val, getVersion(Location)});
+}
+
+bool GVN::processMemoryRead(Instruction *I, Value *Location) {
+  Expression Key = getExpression(I);
+  unsigned Version = getVersion(Location);
+  const MemoryValue *MV = AvailableMemory.lookup(Key);
+  if (MV && MV->Version == Version) {
+    I->replaceAllUsesWith(MV->Val);
+    I->eraseFromParent();
+    return true;
+  }
+  AvailableMemory.insert(Key, MemoryValue{I, Version});
+  return false;
+}
+
+bool GVN::processInstruction(Instruction *I) {
+  switch (I->getOpcode()) {
+  case Instruction::Add:
+  case Instruction::Sub:
+  case Instruction::Mul:
+  case Instruction::Div:
+  case Instruction::Shl:
+  case Instruction::AShr:
+  case Instruction::LShr:
+  case Instruction::MulHi:
+  case Instruction::Neg: {
+    if (Value *C = foldConstant(I)) {
+      I->replaceAllUsesWith(C);
+      I->eraseFromParent();
+      return true;
+    }
+    Expression Key = getExpression(I);
+    if (Value *const *V = AvailableValues.lookup(Key)) {
+      I->replaceAllUsesWith(*V);
+      I->eraseFromParent();
+      return true;
+    }
+    AvailableValues.insert(Key, I);
+    return false;
+  }
+  case Instruction::Load:
+  case Instruction::LoadElem:
+    return processMemoryRead(I, I->getOperand(0));
+  case Instruction::Store:
+  case Instruction::StoreElem:
+    clobber(I->getOperand(1), getExpression(I), I->getOperand(0));
+    return false;
+  case Instruction::Call:
+    for (Value *GV : MRI.getModifiedGlobals(I->getCallee())) {
+      LocationVersions.insert(GV, ++LastVersion);
+    }
+    return false;
+  default:
+    return false;
+  }
+}
+
+void GVN::processBlock(BasicBlock *BB, const DominatorTree &DT) {
+  AvailableValues.pushScope();
+  AvailableMemory.pushScope();
+  LocationVersions.pushScope();
+  unsigned SavedEpoch = Epoch;
+
+  if (BB->getPredecessors().size() > 1)
+    Epoch = ++LastVersion;
+  for (Instruction *I = BB->getFirst(); I;) {
+    Instruction *Next = I->getNext();
+    Changed |= processInstruction(I);
+    I = Next;
+  }
+  for (BasicBlock *Child : DT.getChildren(BB))
+    processBlock(Child, DT);
+
+  Epoch = SavedEpoch;
+  LocationVersions.popScope();
+  AvailableMemory.popScope();
+  AvailableValues.popScope();
+}
+
+bool GVN::Transform(IRFunction &F) {
+  DominatorTree DT(F);
+  Changed = false;
+  processBlock(F.getEntryBlock(), DT);
+  return Changed;
+}
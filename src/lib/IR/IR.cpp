@@ -0,0 +1,131 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "simplecc/IR/IR.h"
+#include "simplecc/IR/BlockLayout.h"
+#include "simplecc/IR/ByteCodeLowering.h"
+#include "simplecc/IR/GVN.h"
+#include "simplecc/IR/IRVerifier.h"
+#include "simplecc/IR/Inliner.h"
+#include "simplecc/IR/LICM.h"
+#include "simplecc/IR/LoopUnroll.h"
+#include "simplecc/IR/ModRefInfo.h"
+#include "simplecc/IR/SCCP.h"
+#include "simplecc/IR/SSABuilder.h"
+#include "simplecc/IR/SimplifyCFG.h"
+#include "simplecc/IR/StrengthReduction.h"
+#include "simplecc/IR/TailCallElim.h"
+
+namespace simplecc {
+void BuildIR(const ByteCodeModule &BM, IRModule &M) {
+  SSABuilder().Build(BM, M);
+}
+
+/// Move the blocks the profile, if any, found cold to the end of the
+/// functions.
+static void LayoutBlocks(IRModule &M, const OptimizationOptions &Options) {
+  if (!Options.Profile)
+    return;
+  for (IRFunction *F : M)
+    BlockLayout(*Options.Profile).Transform(*F);
+}
+
+/// Run the passes of a custom pipeline in order, each on the whole module.
+static void RunPassList(IRModule &M, const OptimizationOptions &Options) {
+  ModRefInfo MRI(M);
+  for (const std::string &Pass : Options.Passes) {
+    if (Pass == "inline") {
+      Inliner(Options.InlineThreshold, Options.Profile.get()).Transform(M);
+      /// The callers now write what their inlined callees wrote.
+      MRI.recalculate(M);
+      continue;
+    }
+    for (IRFunction *F : M) {
+      if (Pass == "sccp")
+        SCCP().Transform(*F);
+      else if (Pass == "simplifycfg")
+        SimplifyCFG().Transform(*F);
+      else if (Pass == "tailcallelim")
+        TailCallElim().Transform(*F);
+      else if (Pass == "licm")
+        LICM(MRI).Transform(*F);
+      else if (Pass == "strength-reduce")
+        StrengthReduction().Transform(*F);
+      else if (Pass == "unroll")
+        LoopUnroll(Options.UnrollFactor).Transform(*F);
+      else if (Pass == "gvn")
+        GVN(MRI).Transform(*F);
+    }
+  }
+  LayoutBlocks(M, Options);
+}
+
+void OptimizeIR(IRModule &M, const OptimizationOptions &Options) {
+  if (Options.hasCustomPipeline()) {
+    RunPassList(M, Options);
+    return;
+  }
+  if (Options.OptLevel == 0)
+    return;
+  if (Options.OptLevel == 1) {
+    ModRefInfo MRI(M);
+    for (IRFunction *F : M) {
+      SCCP().Transform(*F);
+      SimplifyCFG().Transform(*F);
+      GVN(MRI).Transform(*F);
+    }
+    LayoutBlocks(M, Options);
+    return;
+  }
+
+  /// Simplify the callees before their size is measured. A function that
+  /// calls itself only as a tail call can be inlined once it is a loop.
+  for (IRFunction *F : M) {
+    SCCP().Transform(*F);
+    SimplifyCFG().Transform(*F);
+    if (TailCallElim().Transform(*F))
+      SimplifyCFG().Transform(*F);
+  }
+  Inliner(Options.InlineThreshold, Options.Profile.get()).Transform(M);
+
+  ModRefInfo MRI(M);
+  for (IRFunction *F : M) {
+    SCCP().Transform(*F);
+    SimplifyCFG().Transform(*F);
+    if (LICM(MRI).Transform(*F))
+      SimplifyCFG().Transform(*F);
+    StrengthReduction().Transform(*F);
+    if (LoopUnroll(Options.UnrollFactor).Transform(*F)) {
+      SCCP().Transform(*F);
+      SimplifyCFG().Transform(*F);
+    }
+    GVN(MRI).Transform(*F);
+  }
+  LayoutBlocks(M, Options);
+}
+
+bool VerifyIR(const IRModule &M) { return IRVerifier().Check(M); }
+
+void LowerToByteCode(IRModule &M, ByteCodeModule &BM) {
+  ByteCodeLowering().Lower(M, BM);
+}
+} // namespace simplecc
@@ -0,0 +1,118 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "simplecc/IR/IRFunction.h"
+#include "simplecc/IR/IRModule.h"
+#include <algorithm>
+#include <unordered_set>
+
+using namespace simplecc;
+
+IRFunction *IRFunction::Create(IRModule *M, std::string Name,
+                               BasicTypeKind ReturnType) {
+  auto F = new IRFunction(M, std::move(Name), ReturnType);
+  /// Owned by Module
+  if (M) {
+    M->getFunctionList().push_back(F);
+  }
+  return F;
+}
+
+IRFunction::~IRFunction() {
+  /// Values may be used across blocks, so drop all uses before deleting.
+  for (BasicBlock *BB : Blocks) {
+    for (Instruction &I : *BB) {
+      I.dropAllReferences();
+    }
+  }
+  for (BasicBlock *BB : Blocks) {
+    delete BB;
+  }
+  for (Argument *A : Arguments) {
+    delete A;
+  }
+  for (LocalArray *A : LocalArrays) {
+    delete A;
+  }
+}
+
+Argument *IRFunction::addArgument(std::string ArgName) {
+  auto A = new Argument(std::move(ArgName), Arguments.size());
+  Arguments.push_back(A);
+  return A;
+}
+
+LocalArray *IRFunction::addLocalArray(std::string ArrayName,
+                                      BasicTypeKind Type, unsigned Size) {
+  auto A = new LocalArray(std::move(ArrayName), Type, Size);
+  LocalArrays.push_back(A);
+  return A;
+}
+
+BasicBlock *IRFunction::createBlock(BasicBlock *InsertBefore) {
+  auto BB = new BasicBlock(this);
+  auto Pos = InsertBefore
+                 ? std::find(Blocks.begin(), Blocks.end(), InsertBefore)
+                 : Blocks.end();
+  Blocks.insert(Pos, BB);
+  return BB;
+}
+
+void IRFunction::moveBlockAfter(BasicBlock *B, BasicBlock *Pos) {
+  assert(B != Pos && "Moving a block after itself");
+  Blocks.erase(std::find(Blocks.begin(), Blocks.end(), B));
+  Blocks.insert(std::find(Blocks.begin(), Blocks.end(), Pos) + 1, B);
+}
+
+void IRFunction::eraseBlocks(const BlockListTy &Dead) {
+  if (Dead.empty())
+    return;
+  std::unordered_set<BasicBlock *> DeadSet(Dead.begin(), Dead.end());
+
+  /// Cut the edges out of the dead blocks first.
+  for (BasicBlock *BB : Dead) {
+    Instruction *Term = BB->getTerminator();
+    if (!Term)
+      continue;
+    for (BasicBlock *Succ : BB->getSuccessors()) {
+      if (!DeadSet.count(Succ))
+        Succ->removePhiEntriesFor(BB);
+    }
+    BB->remove(Term);
+    Term->dropAllReferences();
+    delete Term;
+  }
+  for (BasicBlock *BB : Dead) {
+    assert(BB->getPredecessors().empty() && "A live block branches here");
+    for (Instruction &I : *BB) {
+      I.dropAllReferences();
+    }
+  }
+  for (BasicBlock *BB : Dead) {
+    delete BB;
+  }
+  Blocks.erase(std::remove_if(Blocks.begin(), Blocks.end(),
+                              [&DeadSet](BasicBlock *BB) {
+                                return DeadSet.count(BB) != 0;
+                              }),
+               Blocks.end());
+}
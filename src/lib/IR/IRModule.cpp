@@ -0,0 +1,72 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "simplecc/IR/IRModule.h"
+
+using namespace simplecc;
+
+IRFunction *IRModule::getFunction(const std::string &Name) const {
+  for (IRFunction *F : Functions) {
+    if (F->getName() == Name)
+      return F;
+  }
+  return nullptr;
+}
+
+GlobalVariable *IRModule::addGlobal(std::string Name, BasicTypeKind Type,
+                                    unsigned Size) {
+  auto GV = new GlobalVariable(std::move(Name), Type, Size);
+  Globals.push_back(GV);
+  return GV;
+}
+
+GlobalVariable *IRModule::getGlobal(const std::string &Name) const {
+  for (GlobalVariable *GV : Globals) {
+    if (GV->getName() == Name)
+      return GV;
+  }
+  return nullptr;
+}
+
+Constant *IRModule::getConstant(int Val) {
+  Constant *&C = Constants[Val];
+  if (!C)
+    C = new Constant(Val);
+  return C;
+}
+
+void IRModule::clear() {
+  /// Functions go first since they use the other values.
+  for (IRFunction *F : Functions) {
+    delete F;
+  }
+  Functions.clear();
+  for (GlobalVariable *GV : Globals) {
+    delete GV;
+  }
+  Globals.clear();
+  for (auto &Item : Constants) {
+    delete Item.second;
+  }
+  Constants.clear();
+  StringLiterals.clear();
+}
@@ -0,0 +1,234 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "simplecc/IR/IRModule.h"
+#include "simplecc/Support/Casting.h"
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+
+using namespace simplecc;
+
+namespace {
+/// Print the IR in its textual form. The values and blocks of a function are
+/// numbered in layout order, so that the numbers are dense however the IR was
+/// transformed.
+class IRPrinter {
+  std::ostream &O;
+  std::unordered_map<const Value *, unsigned> ValueSlots;
+  std::unordered_map<const BasicBlock *, unsigned> BlockSlots;
+
+public:
+  IRPrinter(std::ostream &O, const IRFunction *F) : O(O) {
+    if (!F)
+      return;
+    for (const BasicBlock *BB : *F) {
+      BlockSlots.emplace(BB, BlockSlots.size());
+      for (const Instruction &I : *BB) {
+        if (I.hasValue())
+          ValueSlots.emplace(&I, ValueSlots.size());
+      }
+    }
+  }
+
+  void printType(BasicTypeKind Type, unsigned Size) {
+    if (Size)
+      O << "[" << Size << " x " << CStringFromBasicTypeKind(Type) << "]";
+    else
+      O << CStringFromBasicTypeKind(Type);
+  }
+
+  void printOperand(const Value *V) {
+    switch (V->getKind()) {
+    case Value::ConstantKind:
+      O << static_cast<const Constant *>(V)->getValue();
+      break;
+    case Value::UndefValueKind:
+      O << "undef";
+      break;
+    case Value::ArgumentKind:
+      O << "%" << static_cast<const Argument *>(V)->getName();
+      break;
+    case Value::GlobalVariableKind:
+      O << "@" << static_cast<const GlobalVariable *>(V)->getName();
+      break;
+    case Value::LocalArrayKind:
+      O << "%" << static_cast<const LocalArray *>(V)->getName();
+      break;
+    case Value::InstructionKind: {
+      auto Iter = ValueSlots.find(V);
+      if (Iter == ValueSlots.end())
+        O << "%<badref>";
+      else
+        O << "%" << Iter->second;
+      break;
+    }
+    }
+  }
+
+  void printBlockRef(const BasicBlock *BB) {
+    auto Iter = BlockSlots.find(BB);
+    if (Iter == BlockSlots.end())
+      O << "%<badblock>";
+    else
+      O << "%bb" << Iter->second;
+  }
+
+  void printOperands(const Instruction &I) {
+    for (unsigned Idx = 0, E = I.getNumOperands(); Idx < E; ++Idx) {
+      if (Idx)
+        O << ", ";
+      printOperand(I.getOperand(Idx));
+    }
+  }
+
+  void printInstruction(const Instruction &I) {
+    if (I.hasValue()) {
+      printOperand(&I);
+      O << " = ";
+    }
+    O << I.getOpcodeName();
+
+    switch (I.getOpcode()) {
+    case Instruction::Call:
+      O << " @" << I.getCallee()->getName() << "(";
+      printOperands(I);
+      O << ")";
+      break;
+    case Instruction::PrintString:
+      O << " @.str." << I.getStringID();
+      break;
+    case Instruction::Phi:
+      for (unsigned Idx = 0, E = I.getNumIncoming(); Idx < E; ++Idx) {
+        O << (Idx ? ", [ " : " [ ");
+        printOperand(I.getIncomingValue(Idx));
+        O << ", ";
+        printBlockRef(I.getIncomingBlock(Idx));
+        O << " ]";
+      }
+      break;
+    case Instruction::CondBr:
+      O << " " << Instruction::getPredicateName(I.getPredicate()) << " ";
+      printOperands(I);
+      O << ", ";
+      printBlockRef(I.getSuccessor(0));
+      O << ", ";
+      printBlockRef(I.getSuccessor(1));
+      break;
+    case Instruction::Br:
+      O << " ";
+      printBlockRef(I.getSuccessor(0));
+      break;
+    default:
+      if (I.getNumOperands()) {
+        O << " ";
+        printOperands(I);
+      }
+      break;
+    }
+  }
+
+  void printBlock(const BasicBlock &BB) {
+    printBlockRef(&BB);
+    O << ":";
+    if (BB.getNumPredecessors()) {
+      O << "  ; preds =";
+      for (const BasicBlock *Pred : BB.getPredecessors()) {
+        O << " ";
+        printBlockRef(Pred);
+      }
+    }
+    O << "\n";
+    for (const Instruction &I : BB) {
+      O << "  ";
+      printInstruction(I);
+      O << "\n";
+    }
+  }
+
+  void printFunction(const IRFunction &F) {
+    O << "define " << CStringFromBasicTypeKind(F.getReturnType()) << " @"
+      << F.getName() << "(";
+    for (const Argument *A : F.getArguments()) {
+      if (A->getArgNo())
+        O << ", ";
+      printOperand(A);
+    }
+    O << ") {\n";
+    for (const LocalArray *A : F.getLocalArrays()) {
+      O << "  ";
+      printOperand(A);
+      O << " = local ";
+      printType(A->getType(), A->getSize());
+      O << "\n";
+    }
+    for (const BasicBlock *BB : F) {
+      printBlock(*BB);
+    }
+    O << "}\n";
+  }
+};
+} // namespace
+
+void Value::Format(std::ostream &O) const {
+  const IRFunction *F = nullptr;
+  if (IsInstance<Instruction>(this))
+    F = static_cast<const Instruction *>(this)->getFunction();
+  IRPrinter(O, F).printOperand(this);
+}
+
+void Instruction::Format(std::ostream &O) const {
+  IRPrinter(O, getFunction()).printInstruction(*this);
+}
+
+void BasicBlock::Format(std::ostream &O) const {
+  IRPrinter(O, getParent()).printBlock(*this);
+}
+
+void IRFunction::Format(std::ostream &O) const {
+  IRPrinter(O, this).printFunction(*this);
+}
+
+void IRModule::Format(std::ostream &O) const {
+  IRPrinter P(O, nullptr);
+  for (const GlobalVariable *GV : Globals) {
+    P.printOperand(GV);
+    O << " = global ";
+    P.printType(GV->getType(), GV->getSize());
+    O << "\n";
+  }
+
+  /// Print the string literals in the order of their IDs.
+  std::vector<std::pair<unsigned, const std::string *>> Strings;
+  for (const auto &Item : StringLiterals) {
+    Strings.emplace_back(Item.second, &Item.first);
+  }
+  std::sort(Strings.begin(), Strings.end());
+  for (const auto &Item : Strings) {
+    /// The literals keep their quotes.
+    O << "@.str." << Item.first << " = " << *Item.second << "\n";
+  }
+
+  for (const IRFunction *F : Functions) {
+    O << "\n" << *F;
+  }
+}
@@ -0,0 +1,234 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "simplecc/IR/IRVerifier.h"
+#include "simplecc/IR/IRModule.h"
+#include "simplecc/Support/Casting.h"
+#include <algorithm>
+
+using namespace simplecc;
+
+void IRVerifier::AssertThat(bool Predicate, const BasicBlock *BB,
+                            const char *ErrMsg) {
+  if (Predicate)
+    return;
+  unsigned Idx = std::find(TheFunction->begin(), TheFunction->end(), BB) -
+                 TheFunction->begin();
+  EM.Error("in function", Quote(TheFunction->getName()) + ",",
+           "%bb" + std::to_string(Idx) + ":", ErrMsg);
+}
+
+void IRVerifier::verifyBlock(const BasicBlock &BB) {
+  AssertThat(!BB.empty(), &BB, "block is empty");
+  AssertThat(BB.getTerminator() != nullptr, &BB, "block has no terminator");
+
+  bool SeenNonPhi = false;
+  for (const Instruction &I : BB) {
+    AssertThat(I.getParent() == &BB, &BB, "wrong parent of instruction");
+    AssertThat(!I.isTerminator() || &I == BB.getLast(), &BB,
+               "terminator in the middle of block");
+    AssertThat(!I.isPhi() || !SeenNonPhi, &BB, "phi after non-phi");
+    SeenNonPhi |= !I.isPhi();
+    if (I.isTerminator()) {
+      for (const BasicBlock *Succ : BB.getSuccessors()) {
+        AssertThat(Succ->getParent() == TheFunction, &BB,
+                   "successor not in this function");
+      }
+    }
+    if (I.isPhi())
+      verifyPhi(I);
+    verifyOperands(I);
+    verifyOpcode(I);
+  }
+
+  /// The predecessors must be exactly the blocks that branch here.
+  BasicBlock::BlockListTy Expected;
+  for (const BasicBlock *Other : *TheFunction) {
+    for (BasicBlock *Succ : Other->getSuccessors()) {
+      if (Succ == &BB)
+        Expected.push_back(const_cast<BasicBlock *>(Other));
+    }
+  }
+  BasicBlock::BlockListTy Actual = BB.getPredecessors();
+  std::sort(Expected.begin(), Expected.end());
+  std::sort(Actual.begin(), Actual.end());
+  AssertThat(Expected == Actual, &BB, "predecessors do not match the CFG");
+}
+
+void IRVerifier::verifyPhi(const Instruction &I) {
+  const BasicBlock *BB = I.getParent();
+  BasicBlock::BlockListTy Incoming;
+  for (unsigned Idx = 0, E = I.getNumIncoming(); Idx < E; ++Idx) {
+    Incoming.push_back(I.getIncomingBlock(Idx));
+    /// Several edges from a block must carry the same value.
+    AssertThat(I.getIncomingValueForBlock(I.getIncomingBlock(Idx)) ==
+                   I.getIncomingValue(Idx),
+               BB, "phi has different values for the same block");
+  }
+  BasicBlock::BlockListTy Preds = BB->getPredecessors();
+  std::sort(Incoming.begin(), Incoming.end());
+  std::sort(Preds.begin(), Preds.end());
+  AssertThat(Incoming == Preds, BB,
+             "incoming blocks of phi do not match the predecessors");
+}
+
+void IRVerifier::verifyOperands(const Instruction &I) {
+  const BasicBlock *BB = I.getParent();
+  for (unsigned Idx = 0, E = I.getNumOperands(); Idx < E; ++Idx) {
+    const Value *V = I.getOperand(Idx);
+    const auto &Users = V->getUsers();
+    AssertThat(std::count(Users.begin(), Users.end(), &I) ==
+                   std::count(I.getOperands().begin(), I.getOperands().end(),
+                              V),
+               BB, "def-use chain is out of sync");
+
+    switch (V->getKind()) {
+    case Value::ArgumentKind: {
+      const auto &Args = TheFunction->getArguments();
+      AssertThat(std::find(Args.begin(), Args.end(), V) != Args.end(), BB,
+                 "argument of another function");
+      break;
+    }
+    case Value::LocalArrayKind: {
+      const auto &Arrays = TheFunction->getLocalArrays();
+      AssertThat(std::find(Arrays.begin(), Arrays.end(), V) != Arrays.end(),
+                 BB, "local array of another function");
+      break;
+    }
+    case Value::InstructionKind: {
+      auto Def = static_cast<const Instruction *>(V);
+      if (!Def->getParent() || Def->getFunction() != TheFunction) {
+        AssertThat(false, BB, "operand not in this function");
+        break;
+      }
+      AssertThat(Def->hasValue(), BB, "operand defines no value");
+      /// A phi uses its operand at the end of the incoming block.
+      bool Dominates =
+          I.isPhi() ? DT.dominates(Def->getParent(), I.getIncomingBlock(Idx))
+                    : DT.dominates(Def, &I);
+      AssertThat(Dominates, BB, "definition does not dominate its use");
+      break;
+    }
+    default:
+      break;
+    }
+  }
+
+  for (const Instruction *User : I.getUsers()) {
+    AssertThat(User->getParent() != nullptr, BB,
+               "user of instruction is not in any block");
+  }
+}
+
+void IRVerifier::verifyOpcode(const Instruction &I) {
+  const BasicBlock *BB = I.getParent();
+  unsigned NumOps = I.getNumOperands();
+  auto IsArray = [](const Value *V) {
+    if (auto GV = subclass_cast<GlobalVariable>(const_cast<Value *>(V)))
+      return GV->isArray();
+    return IsInstance<LocalArray>(V);
+  };
+  auto IsScalar = [&IsArray](const Value *V) {
+    return !IsArray(V) && !IsInstance<GlobalVariable>(V);
+  };
+
+  if (Instruction::hasImmediateOperand(I.getOpcode()))
+    AssertThat(IsInstance<Constant>(I.getOperand(1)), BB,
+               "shift or mulhi must take a constant RHS");
+
+  switch (I.getOpcode()) {
+  case Instruction::Load:
+    AssertThat(NumOps == 1 && IsInstance<GlobalVariable>(I.getOperand(0)) &&
+                   !IsArray(I.getOperand(0)),
+               BB, "load must take a scalar global");
+    break;
+  case Instruction::Store:
+    AssertThat(NumOps == 2 && IsScalar(I.getOperand(0)) &&
+                   IsInstance<GlobalVariable>(I.getOperand(1)) &&
+                   !IsArray(I.getOperand(1)),
+               BB, "store must take a value and a scalar global");
+    break;
+  case Instruction::LoadElem:
+    AssertThat(NumOps == 2 && IsArray(I.getOperand(0)) &&
+                   IsScalar(I.getOperand(1)),
+               BB, "load_elem must take an array and an index");
+    break;
+  case Instruction::StoreElem:
+    AssertThat(NumOps == 3 && IsScalar(I.getOperand(0)) &&
+                   IsArray(I.getOperand(1)) && IsScalar(I.getOperand(2)),
+               BB, "store_elem must take a value, an array and an index");
+    break;
+  case Instruction::Call:
+    AssertThat(I.getCallee()->getParent() == TheFunction->getParent() &&
+                   NumOps == I.getCallee()->getNumArguments(),
+               BB, "call does not match the callee");
+    break;
+  case Instruction::CondBr:
+    AssertThat(NumOps == 2 && I.getNumSuccessors() == 2, BB,
+               "br_if must take two operands and two successors");
+    break;
+  case Instruction::Ret:
+    AssertThat(NumOps == 0 ||
+                   TheFunction->getReturnType() != BasicTypeKind::Void,
+               BB, "void function returns a value");
+    break;
+  default:
+    break;
+  }
+
+  if (I.isBinaryOp() || I.getOpcode() == Instruction::Neg ||
+      I.getOpcode() == Instruction::PrintInt ||
+      I.getOpcode() == Instruction::PrintChar ||
+      I.getOpcode() == Instruction::CondBr ||
+      I.getOpcode() == Instruction::Call || I.getOpcode() == Instruction::Ret ||
+      I.isPhi()) {
+    for (const Value *V : I.getOperands()) {
+      AssertThat(IsScalar(V), BB, "operand must be a scalar");
+    }
+  }
+}
+
+bool IRVerifier::Check(const IRFunction &F) {
+  EM.setErrorType("InternalError");
+  int Prev = EM.getErrorCount();
+  TheFunction = &F;
+  if (F.empty()) {
+    EM.Error("in function", Quote(F.getName()) + ":", "no blocks");
+    return true;
+  }
+  DT.recalculate(F);
+  AssertThat(F.getEntryBlock()->getPredecessors().empty(), F.getEntryBlock(),
+             "entry block has predecessors");
+  for (const BasicBlock *BB : F) {
+    AssertThat(BB->getParent() == &F, BB, "wrong parent of block");
+    verifyBlock(*BB);
+  }
+  return !EM.IsOk(Prev);
+}
+
+bool IRVerifier::Check(const IRModule &M) {
+  bool Failed = false;
+  for (const IRFunction *F : M) {
+    Failed |= Check(*F);
+  }
+  return Failed;
+}
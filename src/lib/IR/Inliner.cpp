@@ -0,0 +1,246 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "simplecc/IR/Inliner.h"
+#include "simplecc/CodeGen/CallGraph.h"
+#include "simplecc/IR/DominatorTree.h"
+#include "simplecc/IR/IRModule.h"
+#include "simplecc/IR/LoopInfo.h"
+#include "simplecc/Support/Casting.h"
+#include "simplecc/Support/ExecutionProfile.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace simplecc;
+
+/// What a call takes besides the arguments: the call and the return.
+static constexpr int CallCost = 2;
+/// What the callee may fold away when an argument is a constant.
+static constexpr int ConstantArgBonus = 3;
+/// A call is hot if it ran at least 1/HotCallRatio as often as the hottest
+/// call, and its threshold is then multiplied by HotCallBonus.
+static constexpr uint64_t HotCallRatio = 16;
+static constexpr int HotCallBonus = 4;
+
+/// Return Name, with a suffix if F already has a local array of that name.
+static std::string getUniqueArrayName(const IRFunction &F,
+                                      const std::string &Name) {
+  auto Exists = [&F](const std::string &N) {
+    for (const LocalArray *A : F.getLocalArrays()) {
+      if (A->getName() == N)
+        return true;
+    }
+    return false;
+  };
+  std::string Unique = Name;
+  for (unsigned I = 1; Exists(Unique); ++I) {
+    Unique = Name + "." + std::to_string(I);
+  }
+  return Unique;
+}
+
+unsigned Inliner::getFunctionSize(const IRFunction &F) {
+  unsigned Size = 0;
+  for (const BasicBlock *BB : F) {
+    for (const Instruction &I : *BB) {
+      if (!I.isPhi())
+        ++Size;
+    }
+  }
+  return Size;
+}
+
+int Inliner::getInlineCost(const Instruction *Call) const {
+  int Cost = Sizes.at(Call->getCallee()) - CallCost;
+  /// Each argument is pushed before the call and moved into the frame.
+  for (const Value *Arg : Call->getOperands()) {
+    Cost -= IsInstance<Constant>(Arg) ? ConstantArgBonus : 1;
+  }
+  return Cost;
+}
+
+int Inliner::getProfileLimit(const IRFunction &F, const Instruction *Call,
+                             int Limit) const {
+  const ExecutionProfile::FunctionProfile *FP =
+      Profile->getFunction(F.getName());
+  if (!FP)
+    return Limit;
+  uint64_t Count;
+  if (!FP->findCallCount(Call->getLineno(), Call->getCallee()->getName(),
+                         Count)) {
+    /// The call was inlined in the profiled code, which ran its line.
+    if (!FP->hasLine(Call->getLineno()))
+      return Limit;
+    Count = FP->getLineCount(Call->getLineno());
+  }
+  if (Count == 0)
+    return 0;
+  if (Count * HotCallRatio >= MaxCallCount)
+    return Limit * HotCallBonus;
+  return Limit;
+}
+
+void Inliner::inlineCall(Instruction *Call) {
+  BasicBlock *BB = Call->getParent();
+  IRFunction *Caller = BB->getParent();
+  IRFunction *Callee = Call->getCallee();
+
+  /// Split BB after Call.
+  BasicBlock *After = Caller->createBlock();
+  Caller->moveBlockAfter(After, BB);
+  while (Instruction *I = Call->getNext()) {
+    After->push_back(BB->remove(I));
+  }
+  for (BasicBlock *Succ : After->getSuccessors()) {
+    Succ->replacePhiUsesWith(BB, After);
+  }
+
+  std::unordered_map<const Value *, Value *> ValueMap;
+  for (unsigned I = 0, E = Callee->getNumArguments(); I < E; ++I) {
+    ValueMap.emplace(Callee->getArgument(I), Call->getOperand(I));
+  }
+  for (LocalArray *A : Callee->getLocalArrays()) {
+    std::string Name = getUniqueArrayName(*Caller, Callee->getName() + "." +
+                                                       A->getName());
+    ValueMap.emplace(A, Caller->addLocalArray(std::move(Name), A->getType(),
+                                              A->getSize()));
+  }
+  std::unordered_map<const BasicBlock *, BasicBlock *> BlockMap;
+  for (BasicBlock *CB : *Callee) {
+    BlockMap.emplace(CB, Caller->createBlock(After));
+  }
+
+  /// Copy every instruction before mapping the operands, as a phi may use a
+  /// value defined later. A return becomes a branch to After.
+  std::vector<std::pair<Instruction *, BasicBlock *>> Clones;
+  std::vector<std::pair<Value *, BasicBlock *>> Returns;
+  for (BasicBlock *CB : *Callee) {
+    BasicBlock *NewBB = BlockMap.at(CB);
+    for (Instruction &I : *CB) {
+      Instruction *Clone;
+      if (I.getOpcode() == Instruction::Ret) {
+        Clone = Instruction::CreateBr(After);
+        Clone->copyLineno(&I);
+        if (I.getNumOperands())
+          Returns.emplace_back(I.getOperand(0), NewBB);
+      } else {
+        Clone = I.clone();
+        ValueMap.emplace(&I, Clone);
+      }
+      /// The line stays in the source of Callee, or of the function Callee
+      /// inlined it from.
+      if (!Clone->getSourceFunction())
+        Clone->setSourceFunction(Callee);
+      Clones.emplace_back(Clone, NewBB);
+    }
+  }
+  auto MapValue = [&ValueMap](Value *V) {
+    auto Iter = ValueMap.find(V);
+    return Iter == ValueMap.end() ? V : Iter->second;
+  };
+  for (auto &Pair : Clones) {
+    Instruction *Clone = Pair.first;
+    for (unsigned I = 0, E = Clone->getNumOperands(); I < E; ++I) {
+      Clone->setOperand(I, MapValue(Clone->getOperand(I)));
+    }
+    if (Clone->isPhi()) {
+      for (unsigned I = 0, E = Clone->getNumIncoming(); I < E; ++I) {
+        Clone->setIncomingBlock(I, BlockMap.at(Clone->getIncomingBlock(I)));
+      }
+    } else if (Clone->isTerminator() && Clone->getSuccessor(0) != After) {
+      for (unsigned I = 0, E = Clone->getNumSuccessors(); I < E; ++I) {
+        Clone->setSuccessor(I, BlockMap.at(Clone->getSuccessor(I)));
+      }
+    }
+    Pair.second->push_back(Clone);
+  }
+
+  /// The returned values replace the value of Call.
+  if (Call->getNumUses()) {
+    Value *Result;
+    if (Returns.size() == 1) {
+      Result = MapValue(Returns.front().first);
+    } else {
+      Instruction *Phi = Instruction::CreatePhi();
+      for (auto &Pair : Returns) {
+        Phi->addIncoming(MapValue(Pair.first), Pair.second);
+      }
+      After->insert(After->getFirst(), Phi);
+      Result = Phi;
+    }
+    Call->replaceAllUsesWith(Result);
+  }
+  Instruction *Br = Instruction::CreateBr(BlockMap.at(Callee->getEntryBlock()));
+  Br->copyLineno(Call);
+  BB->erase(Call);
+  BB->push_back(Br);
+}
+
+bool Inliner::Transform(IRModule &M) {
+  if (Profile)
+    MaxCallCount = Profile->getMaxCallCount();
+  CallGraph CG;
+  for (const IRFunction *F : M) {
+    CG.addFunction(F->getName());
+    Sizes.emplace(F, getFunctionSize(*F));
+  }
+  for (const IRFunction *F : M) {
+    unsigned Caller = CG.getIndex(F->getName());
+    for (const BasicBlock *BB : *F) {
+      for (const Instruction &I : *BB) {
+        if (I.getOpcode() == Instruction::Call)
+          CG.addCall(Caller, I.getCallee()->getName());
+      }
+    }
+  }
+  CG.Finalize();
+
+  bool Changed = false;
+  for (unsigned Index : CG.getBottomUpOrder()) {
+    IRFunction *F = M.getFunction(CG.getName(Index));
+    /// Decide on all the calls before the CFG changes.
+    DominatorTree DT(*F);
+    LoopInfo LI(DT);
+    std::vector<Instruction *> Calls;
+    for (BasicBlock *BB : *F) {
+      for (Instruction &I : *BB) {
+        if (I.getOpcode() != Instruction::Call)
+          continue;
+        const IRFunction *Callee = I.getCallee();
+        if (CG.isRecursive(CG.getIndex(Callee->getName())))
+          continue;
+        int Limit = static_cast<int>(Threshold) * (LI.getLoopFor(BB) ? 2 : 1);
+        if (Profile)
+          Limit = getProfileLimit(*F, &I, Limit);
+        if (getInlineCost(&I) <= Limit)
+          Calls.push_back(&I);
+      }
+    }
+    for (Instruction *Call : Calls) {
+      Sizes[F] += Sizes.at(Call->getCallee()) - 1;
+      inlineCall(Call);
+      Changed = true;
+    }
+  }
+  return Changed;
+}
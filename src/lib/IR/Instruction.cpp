@@ -0,0 +1,411 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "simplecc/IR/Instruction.h"
+#include "simplecc/IR/BasicBlock.h"
+#include "simplecc/IR/IRFunction.h"
+#include "simplecc/Support/Casting.h"
+#include <algorithm>
+#include <climits>
+
+using namespace simplecc;
+
+Value::~Value() { assert(Users.empty() && "Deleting a Value still in use"); }
+
+void Value::removeUser(Instruction *I) {
+  /// The most recent user is usually the one to go.
+  auto Iter = std::find(Users.rbegin(), Users.rend(), I);
+  assert(Iter != Users.rend() && "Not a user of this Value");
+  Users.erase(std::next(Iter).base());
+}
+
+void Value::replaceAllUsesWith(Value *V) {
+  assert(V != this && "Replacing a Value with itself");
+  while (!Users.empty()) {
+    Users.back()->replaceUsesOfWith(this, V);
+  }
+}
+
+Instruction::~Instruction() {
+  assert(!Parent && "Deleting an Instruction still in a BasicBlock");
+  dropAllReferences();
+}
+
+Instruction *Instruction::CreateBinary(Opcode Op, Value *LHS, Value *RHS) {
+  assert(isBinaryOp(Op) && "Not a binary operator");
+  auto I = new Instruction(Op);
+  I->addOperand(LHS);
+  I->addOperand(RHS);
+  return I;
+}
+
+Instruction *Instruction::CreateNeg(Value *V) {
+  auto I = new Instruction(Neg);
+  I->addOperand(V);
+  return I;
+}
+
+Instruction *Instruction::CreateLoad(GlobalVariable *GV) {
+  assert(!GV->isArray() && "Load of an array");
+  auto I = new Instruction(Load);
+  I->addOperand(GV);
+  return I;
+}
+
+Instruction *Instruction::CreateStore(Value *V, GlobalVariable *GV) {
+  assert(!GV->isArray() && "Store to an array");
+  auto I = new Instruction(Store);
+  I->addOperand(V);
+  I->addOperand(GV);
+  return I;
+}
+
+Instruction *Instruction::CreateLoadElem(Value *Base, Value *Index) {
+  auto I = new Instruction(LoadElem);
+  I->addOperand(Base);
+  I->addOperand(Index);
+  return I;
+}
+
+Instruction *Instruction::CreateStoreElem(Value *V, Value *Base,
+                                          Value *Index) {
+  auto I = new Instruction(StoreElem);
+  I->addOperand(V);
+  I->addOperand(Base);
+  I->addOperand(Index);
+  return I;
+}
+
+Instruction *Instruction::CreateCall(IRFunction *Callee,
+                                     const OperandListTy &Args) {
+  assert(Callee && Callee->getNumArguments() == Args.size() &&
+         "Wrong number of arguments");
+  auto I = new Instruction(Call);
+  I->Callee = Callee;
+  for (Value *Arg : Args) {
+    I->addOperand(Arg);
+  }
+  return I;
+}
+
+Instruction *Instruction::CreateRead(Opcode Op) {
+  assert((Op == ReadInt || Op == ReadChar) && "Not a read");
+  return new Instruction(Op);
+}
+
+Instruction *Instruction::CreatePrintString(unsigned StringID) {
+  auto I = new Instruction(PrintString);
+  I->StringID = StringID;
+  return I;
+}
+
+Instruction *Instruction::CreatePrint(Opcode Op, Value *V) {
+  assert((Op == PrintInt || Op == PrintChar) && "Not a print of a value");
+  auto I = new Instruction(Op);
+  I->addOperand(V);
+  return I;
+}
+
+Instruction *Instruction::CreatePrintNewline() {
+  return new Instruction(PrintNewline);
+}
+
+Instruction *Instruction::CreatePhi() { return new Instruction(Phi); }
+
+Instruction *Instruction::CreateBr(BasicBlock *Dest) {
+  auto I = new Instruction(Br);
+  I->Blocks.push_back(Dest);
+  return I;
+}
+
+Instruction *Instruction::CreateCondBr(Predicate P, Value *LHS, Value *RHS,
+                                       BasicBlock *TrueDest,
+                                       BasicBlock *FalseDest) {
+  auto I = new Instruction(CondBr);
+  I->Pred = P;
+  I->addOperand(LHS);
+  I->addOperand(RHS);
+  I->Blocks.push_back(TrueDest);
+  I->Blocks.push_back(FalseDest);
+  return I;
+}
+
+Instruction *Instruction::CreateRet(Value *V) {
+  auto I = new Instruction(Ret);
+  if (V)
+    I->addOperand(V);
+  return I;
+}
+
+Instruction *Instruction::clone() const {
+  auto I = new Instruction(Op);
+  for (Value *V : Operands) {
+    I->addOperand(V);
+  }
+  I->Blocks = Blocks;
+  I->Callee = Callee;
+  I->Pred = Pred;
+  I->StringID = StringID;
+  I->Lineno = Lineno;
+  I->SourceFunction = SourceFunction;
+  return I;
+}
+
+const char *Instruction::getOpcodeName(Opcode Op) {
+  switch (Op) {
+#define HANDLE_INSTRUCTION(Opc, Name)                                          \
+  case Opc:                                                                    \
+    return Name;
+#include "simplecc/IR/Instruction.def"
+  }
+  assert(false && "Invalid Opcode");
+  return nullptr;
+}
+
+bool Instruction::hasValue() const {
+  switch (Op) {
+  case Call:
+    return Callee->getReturnType() != BasicTypeKind::Void;
+  case Neg:
+  case Load:
+  case LoadElem:
+  case ReadInt:
+  case ReadChar:
+  case Phi:
+    return true;
+  default:
+    return isBinaryOp();
+  }
+}
+
+bool Instruction::mayReadMemory() const {
+  return Op == Load || Op == LoadElem || Op == Call;
+}
+
+bool Instruction::mayWriteMemory() const {
+  return Op == Store || Op == StoreElem || Op == Call;
+}
+
+bool Instruction::hasSideEffects() const {
+  switch (Op) {
+  case Store:
+  case StoreElem:
+  case Call:
+  case ReadInt:
+  case ReadChar:
+  case PrintString:
+  case PrintInt:
+  case PrintChar:
+  case PrintNewline:
+    return true;
+  default:
+    return isTerminator();
+  }
+}
+
+bool Instruction::mayTrap() const {
+  switch (Op) {
+  case Div: {
+    const Constant *C = subclass_cast<const Constant>(getOperand(1));
+    return !C || C->getValue() == 0;
+  }
+  case LoadElem:
+    return true;
+  default:
+    return false;
+  }
+}
+
+IRFunction *Instruction::getFunction() const {
+  return Parent ? Parent->getParent() : nullptr;
+}
+
+void Instruction::eraseFromParent() {
+  assert(Parent && "Not in a BasicBlock");
+  Parent->erase(this);
+}
+
+void Instruction::moveBefore(Instruction *Pos) {
+  assert(Pos->getParent() && "Moving before an Instruction not inserted");
+  if (Parent)
+    Parent->remove(this);
+  Pos->getParent()->insert(Pos, this);
+}
+
+void Instruction::addOperand(Value *V) {
+  assert(V && "Null operand");
+  Operands.push_back(V);
+  V->addUser(this);
+}
+
+void Instruction::setOperand(unsigned I, Value *V) {
+  assert(V && "Null operand");
+  Operands[I]->removeUser(this);
+  Operands[I] = V;
+  V->addUser(this);
+}
+
+void Instruction::replaceUsesOfWith(Value *From, Value *To) {
+  for (unsigned I = 0, E = Operands.size(); I < E; ++I) {
+    if (Operands[I] == From)
+      setOperand(I, To);
+  }
+}
+
+void Instruction::dropAllReferences() {
+  for (Value *V : Operands) {
+    V->removeUser(this);
+  }
+  Operands.clear();
+}
+
+unsigned Instruction::getNumSuccessors() const {
+  assert(isTerminator() && "Not a terminator");
+  return Blocks.size();
+}
+
+void Instruction::setSuccessor(unsigned I, BasicBlock *B) {
+  assert(isTerminator() && "Not a terminator");
+  if (Parent) {
+    Blocks[I]->removePredecessor(Parent);
+    B->addPredecessor(Parent);
+  }
+  Blocks[I] = B;
+}
+
+void Instruction::addIncoming(Value *V, BasicBlock *B) {
+  assert(isPhi() && "Not a Phi");
+  addOperand(V);
+  Blocks.push_back(B);
+}
+
+void Instruction::removeIncoming(unsigned I) {
+  assert(isPhi() && "Not a Phi");
+  Operands[I]->removeUser(this);
+  Operands.erase(Operands.begin() + I);
+  Blocks.erase(Blocks.begin() + I);
+}
+
+Value *Instruction::getIncomingValueForBlock(const BasicBlock *B) const {
+  assert(isPhi() && "Not a Phi");
+  for (unsigned I = 0, E = Blocks.size(); I < E; ++I) {
+    if (Blocks[I] == B)
+      return Operands[I];
+  }
+  assert(false && "Not an incoming block");
+  return nullptr;
+}
+
+Value *Instruction::getUniqueIncomingValue() const {
+  assert(isPhi() && "Not a Phi");
+  Value *Unique = nullptr;
+  for (Value *V : Operands) {
+    if (V == this || V == Unique)
+      continue;
+    if (Unique)
+      return nullptr;
+    Unique = V;
+  }
+  return Unique;
+}
+
+Instruction::Predicate Instruction::getInversePredicate(Predicate P) {
+  switch (P) {
+  case EQ:return NE;
+  case NE:return EQ;
+  case LT:return GE;
+  case LE:return GT;
+  case GT:return LE;
+  case GE:return LT;
+  }
+  assert(false && "Invalid Predicate");
+  return P;
+}
+
+Instruction::Predicate Instruction::getSwappedPredicate(Predicate P) {
+  switch (P) {
+  case EQ:
+  case NE:return P;
+  case LT:return GT;
+  case LE:return GE;
+  case GT:return LT;
+  case GE:return LE;
+  }
+  assert(false && "Invalid Predicate");
+  return P;
+}
+
+const char *Instruction::getPredicateName(Predicate P) {
+  static const char *Names[] = {"eq", "ne", "lt", "le", "gt", "ge"};
+  return Names[P];
+}
+
+bool Instruction::EvaluatePredicate(Predicate P, int LHS, int RHS) {
+  switch (P) {
+  case EQ:return LHS == RHS;
+  case NE:return LHS != RHS;
+  case LT:return LHS < RHS;
+  case LE:return LHS <= RHS;
+  case GT:return LHS > RHS;
+  case GE:return LHS >= RHS;
+  }
+  assert(false && "Invalid Predicate");
+  return false;
+}
+
+bool Instruction::EvaluateBinary(Opcode Op, int LHS, int RHS, int &Result) {
+  /// Wrap around on overflow like the target does.
+  auto Wrap = [](long long V) {
+    return static_cast<int>(static_cast<unsigned>(V));
+  };
+  switch (Op) {
+  case Add:
+    Result = Wrap(static_cast<long long>(LHS) + RHS);
+    return true;
+  case Sub:
+    Result = Wrap(static_cast<long long>(LHS) - RHS);
+    return true;
+  case Mul:
+    Result = Wrap(static_cast<long long>(LHS) * RHS);
+    return true;
+  case Div:
+    if (RHS == 0 || (LHS == INT_MIN && RHS == -1))
+      return false;
+    Result = LHS / RHS;
+    return true;
+  case Shl:
+    Result = static_cast<int>(static_cast<unsigned>(LHS) << (RHS & 31));
+    return true;
+  case AShr:
+    Result = static_cast<int>(static_cast<long long>(LHS) >> (RHS & 31));
+    return true;
+  case LShr:
+    Result = static_cast<int>(static_cast<unsigned>(LHS) >> (RHS & 31));
+    return true;
+  case MulHi:
+    Result = static_cast<int>((static_cast<long long>(LHS) * RHS) >> 32);
+    return true;
+  default:
+    assert(false && "Not a binary operator");
+    return false;
+  }
+}
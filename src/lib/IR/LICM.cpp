@@ -0,0 +1,212 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "simplecc/IR/LICM.h"
+#include "simplecc/IR/DominatorTree.h"
+#include "simplecc/IR/IRFunction.h"
+#include "simplecc/IR/ModRefInfo.h"
+#include "simplecc/Support/Casting.h"
+
+using namespace simplecc;
+
+void LICM::insertPreheader(IRFunction &F, Loop *L) {
+  BasicBlock *Header = L->getHeader();
+  Loop::BlockListTy Outside;
+  for (BasicBlock *Pred : Header->getPredecessors()) {
+    if (!L->contains(Pred))
+      Outside.push_back(Pred);
+  }
+  /// The header is the entry block.
+  if (Outside.empty())
+    return;
+
+  BasicBlock *Preheader = F.createBlock(Header);
+  if (Outside.size() == 1) {
+    Header->replacePhiUsesWith(Outside.front(), Preheader);
+  } else {
+    /// The values from outside are merged in the preheader.
+    for (Instruction *Phi = Header->getFirst(); Phi && Phi->isPhi();
+         Phi = Phi->getNext()) {
+      Instruction *NewPhi = Instruction::CreatePhi();
+      for (BasicBlock *Pred : Outside) {
+        NewPhi->addIncoming(Phi->getIncomingValueForBlock(Pred), Pred);
+      }
+      for (unsigned I = Phi->getNumIncoming(); I-- > 0;) {
+        if (!L->contains(Phi->getIncomingBlock(I)))
+          Phi->removeIncoming(I);
+      }
+      Value *V = NewPhi->getUniqueIncomingValue();
+      if (V) {
+        delete NewPhi;
+      } else {
+        Preheader->push_back(NewPhi);
+        V = NewPhi;
+      }
+      Phi->addIncoming(V, Preheader);
+    }
+  }
+
+  Instruction *Br = Instruction::CreateBr(Header);
+  Br->copyLineno(Header->getFirstNonPhi());
+  Preheader->push_back(Br);
+  for (BasicBlock *Pred : Outside) {
+    Instruction *Term = Pred->getTerminator();
+    for (unsigned I = 0, E = Term->getNumSuccessors(); I < E; ++I) {
+      if (Term->getSuccessor(I) == Header)
+        Term->setSuccessor(I, Preheader);
+    }
+  }
+}
+
+bool LICM::insertPreheaders(IRFunction &F, const LoopInfo &LI) {
+  bool Changed = false;
+  for (Loop *L : LI.getLoopsInPostorder()) {
+    if (L->getLoopPreheader())
+      continue;
+    insertPreheader(F, L);
+    Changed = true;
+  }
+  return Changed;
+}
+
+bool LICM::isLoopInvariant(const Loop *L, const Value *V) const {
+  const Instruction *I = subclass_cast<const Instruction>(V);
+  return !I || !L->contains(I->getParent());
+}
+
+bool LICM::canHoist(const Instruction *I, const Loop *L) const {
+  switch (I->getOpcode()) {
+  case Instruction::Add:
+  case Instruction::Sub:
+  case Instruction::Mul:
+  case Instruction::Div:
+  case Instruction::Shl:
+  case Instruction::AShr:
+  case Instruction::LShr:
+  case Instruction::MulHi:
+  case Instruction::Neg:
+    break;
+  case Instruction::Load:
+  case Instruction::LoadElem:
+    if (ModifiedLocations.count(I->getOperand(0)))
+      return false;
+    break;
+  default:
+    return false;
+  }
+  for (const Value *V : I->getOperands()) {
+    if (!isLoopInvariant(L, V))
+      return false;
+  }
+  return true;
+}
+
+bool LICM::isSafeToSpeculate(const Instruction *I) {
+  switch (I->getOpcode()) {
+  case Instruction::Div: {
+    const Constant *C = subclass_cast<const Constant>(I->getOperand(1));
+    return C && C->getValue() != 0 && C->getValue() != -1;
+  }
+  case Instruction::LoadElem: {
+    const Constant *C = subclass_cast<const Constant>(I->getOperand(1));
+    if (!C || C->getValue() < 0)
+      return false;
+    const Value *Base = I->getOperand(0);
+    unsigned Size = IsInstance<GlobalVariable>(Base)
+                        ? static_cast<const GlobalVariable *>(Base)->getSize()
+                        : static_cast<const LocalArray *>(Base)->getSize();
+    return static_cast<unsigned>(C->getValue()) < Size;
+  }
+  default:
+    return true;
+  }
+}
+
+bool LICM::hoistLoop(Loop *L, const DominatorTree &DT) {
+  BasicBlock *Preheader = L->getLoopPreheader();
+  if (!Preheader)
+    return false;
+
+  ModifiedLocations.clear();
+  for (const BasicBlock *BB : L->getBlocks()) {
+    for (const Instruction &I : *BB) {
+      switch (I.getOpcode()) {
+      case Instruction::Store:
+      case Instruction::StoreElem:
+        ModifiedLocations.insert(I.getOperand(1));
+        break;
+      case Instruction::Call:
+        for (const Value *GV : MRI.getModifiedGlobals(I.getCallee())) {
+          ModifiedLocations.insert(GV);
+        }
+        break;
+      default:
+        break;
+      }
+    }
+  }
+
+  /// A block runs in every iteration that leaves the loop if it dominates all
+  /// the ways out. A loop that never leaves has no such block.
+  Loop::BlockListTy Exiting = L->getExitingBlocks();
+  auto IsGuaranteedToExecute = [&](const BasicBlock *BB) {
+    if (Exiting.empty())
+      return false;
+    for (const BasicBlock *E : Exiting) {
+      if (!DT.dominates(BB, E))
+        return false;
+    }
+    return true;
+  };
+
+  /// In reverse post order the operands in the loop are visited before their
+  /// users, so a chain of invariant computations moves at once.
+  bool Changed = false;
+  for (BasicBlock *BB : L->getBlocks()) {
+    for (Instruction *I = BB->getFirstNonPhi(); I && !I->isTerminator();) {
+      Instruction *Next = I->getNext();
+      if (canHoist(I, L) &&
+          (isSafeToSpeculate(I) || IsGuaranteedToExecute(BB))) {
+        I->moveBefore(Preheader->getTerminator());
+        Changed = true;
+      }
+      I = Next;
+    }
+  }
+  return Changed;
+}
+
+bool LICM::Transform(IRFunction &F) {
+  DominatorTree DT(F);
+  LoopInfo LI(DT);
+  if (LI.empty())
+    return false;
+  bool Changed = insertPreheaders(F, LI);
+  if (Changed) {
+    DT.recalculate(F);
+    LI.recalculate(DT);
+  }
+  for (Loop *L : LI.getLoopsInPostorder()) {
+    Changed |= hoistLoop(L, DT);
+  }
+  return Changed;
+}
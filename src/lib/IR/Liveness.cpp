@@ -0,0 +1,126 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "simplecc/IR/Liveness.h"
+#include "simplecc/IR/DominatorTree.h"
+#include "simplecc/IR/IRFunction.h"
+#include "simplecc/Support/Casting.h"
+#include <vector>
+
+using namespace simplecc;
+
+/// Return whether V has a location, i.e., it is not a Constant, a global or
+/// an array.
+static bool isTracked(const Value *V) {
+  return IsInstance<Instruction>(V) || IsInstance<Argument>(V);
+}
+
+void Liveness::recalculate(const IRFunction &F) {
+  LiveIn.clear();
+  LiveOut.clear();
+
+  /// Upward exposed uses and phi uses by the edges out of each block.
+  std::unordered_map<const BasicBlock *, ValueSetTy> Uses;
+  std::unordered_map<const BasicBlock *, ValueSetTy> PhiUses;
+  for (const BasicBlock *BB : F) {
+    ValueSetTy &BBUses = Uses[BB];
+    for (const Instruction &I : *BB) {
+      if (I.isPhi()) {
+        for (unsigned Idx = 0, E = I.getNumIncoming(); Idx < E; ++Idx) {
+          if (isTracked(I.getIncomingValue(Idx)))
+            PhiUses[I.getIncomingBlock(Idx)].insert(I.getIncomingValue(Idx));
+        }
+        continue;
+      }
+      for (const Value *Op : I.getOperands()) {
+        auto OpI = subclass_cast<const Instruction>(Op);
+        /// A definition in the same block comes before its uses.
+        if (isTracked(Op) && (!OpI || OpI->getParent() != BB))
+          BBUses.insert(Op);
+      }
+    }
+    LiveIn[BB];
+    LiveOut[BB];
+  }
+
+  /// Iterate in post order until nothing changes.
+  DominatorTree DT(F);
+  std::vector<BasicBlock *> PostOrder(DT.getReversePostOrder().rbegin(),
+                                      DT.getReversePostOrder().rend());
+  bool Changed;
+  do {
+    Changed = false;
+    for (BasicBlock *BB : PostOrder) {
+      ValueSetTy Out = PhiUses[BB];
+      for (BasicBlock *Succ : BB->getSuccessors()) {
+        const ValueSetTy &SuccIn = LiveIn[Succ];
+        Out.insert(SuccIn.begin(), SuccIn.end());
+      }
+      ValueSetTy In = Uses[BB];
+      for (const Value *V : Out) {
+        auto I = subclass_cast<const Instruction>(V);
+        if (!I || I->getParent() != BB)
+          In.insert(V);
+      }
+      if (In.size() != LiveIn[BB].size() || Out.size() != LiveOut[BB].size())
+        Changed = true;
+      LiveIn[BB] = std::move(In);
+      LiveOut[BB] = std::move(Out);
+    }
+  } while (Changed);
+}
+
+bool Liveness::isLiveAfter(const Value *V, const Instruction *I) const {
+  const BasicBlock *BB = I->getParent();
+  if (LiveOut.at(BB).count(V))
+    return true;
+  const Instruction *Pos = I->getNext();
+  while (Pos && Pos->isPhi()) {
+    Pos = Pos->getNext();
+  }
+  for (; Pos; Pos = Pos->getNext()) {
+    for (const Value *Op : Pos->getOperands()) {
+      if (Op == V)
+        return true;
+    }
+  }
+  return false;
+}
+
+bool Liveness::interfere(const Value *A, const Value *B,
+                         const DominatorTree &DT) const {
+  /// Arguments are all defined on entry.
+  if (IsInstance<Argument>(A) && IsInstance<Argument>(B))
+    return true;
+  auto AI = subclass_cast<const Instruction>(A);
+  auto BI = subclass_cast<const Instruction>(B);
+  if (!AI)
+    return isLiveAfter(A, BI);
+  if (!BI)
+    return isLiveAfter(B, AI);
+  /// Phis come first in a block, so this also orders the phis of a block.
+  if (DT.dominates(AI, BI))
+    return isLiveAfter(A, BI);
+  if (DT.dominates(BI, AI))
+    return isLiveAfter(B, AI);
+  return false;
+}
@@ -0,0 +1,185 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "simplecc/IR/LoopInfo.h"
+#include "simplecc/IR/DominatorTree.h"
+#include "simplecc/IR/IRFunction.h"
+#include <algorithm>
+
+using namespace simplecc;
+
+unsigned Loop::getLoopDepth() const {
+  unsigned Depth = 1;
+  for (const Loop *L = ParentLoop; L; L = L->ParentLoop)
+    ++Depth;
+  return Depth;
+}
+
+bool Loop::contains(const Loop *L) const {
+  for (; L; L = L->ParentLoop) {
+    if (L == this)
+      return true;
+  }
+  return false;
+}
+
+Loop::BlockListTy Loop::getLatches() const {
+  BlockListTy Latches;
+  for (BasicBlock *Pred : Header->getPredecessors()) {
+    if (contains(Pred))
+      Latches.push_back(Pred);
+  }
+  return Latches;
+}
+
+Loop::BlockListTy Loop::getExitingBlocks() const {
+  BlockListTy Exiting;
+  for (BasicBlock *BB : Blocks) {
+    for (BasicBlock *Succ : BB->getSuccessors()) {
+      if (!contains(Succ)) {
+        Exiting.push_back(BB);
+        break;
+      }
+    }
+  }
+  return Exiting;
+}
+
+Loop::BlockListTy Loop::getExitBlocks() const {
+  BlockListTy Exits;
+  for (BasicBlock *BB : Blocks) {
+    for (BasicBlock *Succ : BB->getSuccessors()) {
+      if (!contains(Succ) &&
+          std::find(Exits.begin(), Exits.end(), Succ) == Exits.end())
+        Exits.push_back(Succ);
+    }
+  }
+  return Exits;
+}
+
+BasicBlock *Loop::getLoopPreheader() const {
+  BasicBlock *Preheader = nullptr;
+  for (BasicBlock *Pred : Header->getPredecessors()) {
+    if (contains(Pred))
+      continue;
+    if (Preheader)
+      return nullptr;
+    Preheader = Pred;
+  }
+  if (!Preheader || Preheader->getSuccessors().size() != 1)
+    return nullptr;
+  return Preheader;
+}
+
+void Loop::Format(std::ostream &O) const {
+  std::unordered_map<const BasicBlock *, unsigned> Layout;
+  for (const BasicBlock *BB : *Header->getParent()) {
+    Layout.emplace(BB, Layout.size());
+  }
+  O << std::string(2 * (getLoopDepth() - 1), ' ') << "loop at depth "
+    << getLoopDepth() << ":";
+  for (const BasicBlock *BB : Blocks) {
+    O << " %bb" << Layout.at(BB);
+  }
+  O << "\n";
+  for (const Loop *Sub : SubLoops) {
+    O << *Sub;
+  }
+}
+
+void LoopInfo::clear() {
+  for (Loop *L : Loops) {
+    delete L;
+  }
+  Loops.clear();
+  TopLevelLoops.clear();
+  BlockMap.clear();
+}
+
+void LoopInfo::recalculate(const DominatorTree &DT) {
+  clear();
+  const auto &RPO = DT.getReversePostOrder();
+
+  /// A header comes before the blocks it dominates in reverse post order, so
+  /// the loops are found outer ones first.
+  for (BasicBlock *Header : RPO) {
+    Loop::BlockListTy Worklist;
+    for (BasicBlock *Pred : Header->getPredecessors()) {
+      if (DT.isReachable(Pred) && DT.dominates(Header, Pred))
+        Worklist.push_back(Pred);
+    }
+    if (Worklist.empty())
+      continue;
+
+    /// The loop is what reaches a latch backwards without passing the header.
+    Loop *L = new Loop(Header);
+    L->BlockSet.insert(Header);
+    while (!Worklist.empty()) {
+      BasicBlock *BB = Worklist.back();
+      Worklist.pop_back();
+      if (!L->BlockSet.insert(BB).second)
+        continue;
+      for (BasicBlock *Pred : BB->getPredecessors()) {
+        if (DT.isReachable(Pred))
+          Worklist.push_back(Pred);
+      }
+    }
+    for (BasicBlock *BB : RPO) {
+      if (L->contains(BB))
+        L->Blocks.push_back(BB);
+    }
+
+    /// The innermost loop found so far that contains the header is the
+    /// parent, since the loops nest.
+    auto Iter = BlockMap.find(Header);
+    if (Iter != BlockMap.end()) {
+      L->ParentLoop = Iter->second;
+      Iter->second->SubLoops.push_back(L);
+    } else {
+      TopLevelLoops.push_back(L);
+    }
+    for (BasicBlock *BB : L->Blocks) {
+      BlockMap[BB] = L;
+    }
+    Loops.push_back(L);
+  }
+}
+
+Loop *LoopInfo::getLoopFor(const BasicBlock *BB) const {
+  auto Iter = BlockMap.find(BB);
+  return Iter == BlockMap.end() ? nullptr : Iter->second;
+}
+
+unsigned LoopInfo::getLoopDepth(const BasicBlock *BB) const {
+  const Loop *L = getLoopFor(BB);
+  return L ? L->getLoopDepth() : 0;
+}
+
+LoopInfo::LoopListTy LoopInfo::getLoopsInPostorder() const {
+  return LoopListTy(Loops.rbegin(), Loops.rend());
+}
+
+void LoopInfo::Format(std::ostream &O) const {
+  for (const Loop *L : TopLevelLoops) {
+    O << *L;
+  }
+}
@@ -0,0 +1,362 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "simplecc/IR/LoopUnroll.h"
+#include "simplecc/IR/DominatorTree.h"
+#include "simplecc/IR/IRModule.h"
+#include "simplecc/IR/LoopInfo.h"
+#include "simplecc/Support/Casting.h"
+#include <climits>
+
+using namespace simplecc;
+
+/// Unroll a loop fully if the instructions of all its iterations are at most
+/// this many, and partially if the instructions of Factor of them are.
+static constexpr unsigned FullUnrollThreshold = 128;
+static constexpr unsigned PartialUnrollThreshold = 128;
+
+bool LoopUnroll::analyzeLoop(Loop *L, Candidate &C) {
+  if (!L->getSubLoops().empty())
+    return false;
+  C.Header = L->getHeader();
+  C.Preheader = L->getLoopPreheader();
+  Loop::BlockListTy Latches = L->getLatches();
+  Loop::BlockListTy Exiting = L->getExitingBlocks();
+  if (!C.Preheader || Latches.size() != 1 || Exiting.size() != 1 ||
+      Exiting.front() != Latches.front())
+    return false;
+  C.Latch = Latches.front();
+
+  Instruction *Term = C.Latch->getTerminator();
+  if (Term->getOpcode() != Instruction::CondBr)
+    return false;
+  bool ContinueIfTrue = Term->getSuccessor(0) == C.Header;
+  C.Exit = Term->getSuccessor(ContinueIfTrue ? 1 : 0);
+
+  /// Find the induction variable on either side of the condition.
+  C.IndVar = nullptr;
+  for (unsigned I = 0; I < 2 && !C.IndVar; ++I) {
+    auto Tested = subclass_cast<Instruction>(Term->getOperand(I));
+    auto Bound = subclass_cast<Instruction>(Term->getOperand(1 - I));
+    if (!Tested || (Bound && L->contains(Bound->getParent())))
+      continue;
+    for (Instruction *Phi = C.Header->getFirst(); Phi && Phi->isPhi();
+         Phi = Phi->getNext()) {
+      auto Next = subclass_cast<Instruction>(
+          Phi->getIncomingValueForBlock(C.Latch));
+      if (Tested != Phi && Tested != Next)
+        continue;
+      if (!Next)
+        continue;
+      Value *Step = nullptr;
+      bool IsAdd = Next->getOpcode() == Instruction::Add;
+      if ((IsAdd || Next->getOpcode() == Instruction::Sub) &&
+          Next->getOperand(0) == Phi)
+        Step = Next->getOperand(1);
+      else if (IsAdd && Next->getOperand(1) == Phi)
+        Step = Next->getOperand(0);
+      auto StepC = Step ? subclass_cast<Constant>(Step) : nullptr;
+      if (!StepC || StepC->getValue() == 0 || StepC->getValue() == INT_MIN)
+        continue;
+      C.Step = IsAdd ? StepC->getValue() : -StepC->getValue();
+      C.IndVar = Phi;
+      C.TestsNext = Tested == Next;
+      C.Bound = Term->getOperand(1 - I);
+      C.Pred = I == 0 ? Term->getPredicate()
+                      : Instruction::getSwappedPredicate(Term->getPredicate());
+      if (!ContinueIfTrue)
+        C.Pred = Instruction::getInversePredicate(C.Pred);
+      break;
+    }
+  }
+  if (!C.IndVar)
+    return false;
+
+  C.Size = 0;
+  for (const BasicBlock *BB : L->getBlocks()) {
+    for (const Instruction &I : *BB) {
+      if (!I.isPhi())
+        ++C.Size;
+    }
+  }
+  return true;
+}
+
+unsigned LoopUnroll::getTripCount(const Candidate &C) {
+  auto Init = subclass_cast<Constant>(
+      C.IndVar->getIncomingValueForBlock(C.Preheader));
+  auto Bound = subclass_cast<Constant>(C.Bound);
+  if (!Init || !Bound)
+    return 0;
+  int Val = Init->getValue();
+  for (unsigned TripCount = 1; TripCount * C.Size <= FullUnrollThreshold;
+       ++TripCount) {
+    int Next;
+    Instruction::EvaluateBinary(Instruction::Add, Val, C.Step, Next);
+    if (!Instruction::EvaluatePredicate(C.Pred, C.TestsNext ? Next : Val,
+                                        Bound->getValue()))
+      return TripCount;
+    Val = Next;
+  }
+  return 0;
+}
+
+void LoopUnroll::cloneLoop(IRFunction &F, Loop *L, BasicBlock *InsertBefore,
+                           ValueMapTy &VM, BlockMapTy &BM) {
+  for (BasicBlock *BB : L->getBlocks()) {
+    BM.emplace(BB, F.createBlock(InsertBefore));
+  }
+  /// Copy every instruction before mapping the operands, as a phi may use a
+  /// value defined later.
+  std::vector<std::pair<Instruction *, BasicBlock *>> Clones;
+  for (BasicBlock *BB : L->getBlocks()) {
+    for (Instruction &I : *BB) {
+      if (I.isPhi() && BB == L->getHeader())
+        continue;
+      Instruction *Clone = I.clone();
+      VM.emplace(&I, Clone);
+      Clones.emplace_back(Clone, BM.at(BB));
+    }
+  }
+  for (auto &Pair : Clones) {
+    Instruction *Clone = Pair.first;
+    for (unsigned I = 0, E = Clone->getNumOperands(); I < E; ++I) {
+      auto Iter = VM.find(Clone->getOperand(I));
+      if (Iter != VM.end())
+        Clone->setOperand(I, Iter->second);
+    }
+    if (Clone->isPhi()) {
+      for (unsigned I = 0, E = Clone->getNumIncoming(); I < E; ++I) {
+        Clone->setIncomingBlock(I, BM.at(Clone->getIncomingBlock(I)));
+      }
+    }
+    Pair.second->push_back(Clone);
+    if (Clone->isTerminator()) {
+      for (unsigned I = 0, E = Clone->getNumSuccessors(); I < E; ++I) {
+        auto Iter = BM.find(Clone->getSuccessor(I));
+        if (Iter != BM.end())
+          Clone->setSuccessor(I, Iter->second);
+      }
+    }
+  }
+}
+
+void LoopUnroll::insertChunkTest(const Candidate &C, Value *Start,
+                                 BasicBlock *BB, BasicBlock *TrueDest,
+                                 BasicBlock *FalseDest) {
+  /// The test after the last but one iteration of the chunk is the last one
+  /// that must hold, and the ones before it hold if it does.
+  const Instruction *Term = C.Latch->getTerminator();
+  int Offset;
+  Instruction::EvaluateBinary(Instruction::Mul, C.Step,
+                              C.TestsNext ? Factor - 1 : Factor - 2, Offset);
+  Value *Tested = Start;
+  if (Offset) {
+    IRModule *M = BB->getParent()->getParent();
+    Instruction *Add =
+        Instruction::CreateBinary(Instruction::Add, Start, M->getConstant(Offset));
+    Add->copyLineno(Term);
+    BB->push_back(Add);
+    Tested = Add;
+  }
+  Instruction *Br =
+      Instruction::CreateCondBr(C.Pred, Tested, C.Bound, TrueDest, FalseDest);
+  Br->copyLineno(Term);
+  BB->push_back(Br);
+}
+
+void LoopUnroll::unrollFully(IRFunction &F, Loop *L, const Candidate &C,
+                             unsigned TripCount) {
+  /// The loop itself becomes the last iteration, so the values used after it
+  /// stay as they are.
+  std::vector<Instruction *> Phis;
+  std::vector<Value *> Values;
+  for (Instruction *Phi = C.Header->getFirst(); Phi && Phi->isPhi();
+       Phi = Phi->getNext()) {
+    Phis.push_back(Phi);
+    Values.push_back(Phi->getIncomingValueForBlock(C.Preheader));
+  }
+
+  BasicBlock *PrevLatch = C.Preheader;
+  for (unsigned Iter = 1; Iter < TripCount; ++Iter) {
+    ValueMapTy VM;
+    BlockMapTy BM;
+    for (unsigned I = 0, E = Phis.size(); I < E; ++I) {
+      VM.emplace(Phis[I], Values[I]);
+    }
+    cloneLoop(F, L, C.Header, VM, BM);
+    for (unsigned I = 0, E = Phis.size(); I < E; ++I) {
+      Value *V = Phis[I]->getIncomingValueForBlock(C.Latch);
+      auto Iter = VM.find(V);
+      Values[I] = Iter == VM.end() ? V : Iter->second;
+    }
+    PrevLatch->getTerminator()->setSuccessor(0, BM.at(C.Header));
+    PrevLatch = BM.at(C.Latch);
+    Instruction *Term = PrevLatch->getTerminator();
+    Instruction *Br = Instruction::CreateBr(C.Header);
+    Br->copyLineno(Term);
+    PrevLatch->erase(Term);
+    PrevLatch->push_back(Br);
+  }
+
+  for (unsigned I = 0, E = Phis.size(); I < E; ++I) {
+    Phis[I]->replaceAllUsesWith(Values[I]);
+  }
+  for (Instruction *Phi : Phis) {
+    Phi->eraseFromParent();
+  }
+  Instruction *Term = C.Latch->getTerminator();
+  Instruction *Br = Instruction::CreateBr(C.Exit);
+  Br->copyLineno(Term);
+  C.Latch->erase(Term);
+  C.Latch->push_back(Br);
+}
+
+bool LoopUnroll::unrollPartially(IRFunction &F, Loop *L, const Candidate &C) {
+  /// The chunk test needs the condition to stay false once it is false.
+  bool Increasing = C.Pred == Instruction::LT || C.Pred == Instruction::LE;
+  bool Decreasing = C.Pred == Instruction::GT || C.Pred == Instruction::GE;
+  if (!(Increasing && C.Step > 0) && !(Decreasing && C.Step < 0))
+    return false;
+  /// The values used after the loop are merged in the exit.
+  if (C.Exit->getNumPredecessors() != 1)
+    return false;
+
+  /// The header of the first copy merges the values from the preheader and
+  /// from the last copy, like the original header.
+  BasicBlock *Dispatch = F.createBlock(C.Header);
+  std::vector<Instruction *> Phis;
+  ValueMapTy VM;
+  for (Instruction *Phi = C.Header->getFirst(); Phi && Phi->isPhi();
+       Phi = Phi->getNext()) {
+    Phis.push_back(Phi);
+    VM.emplace(Phi, Instruction::CreatePhi());
+  }
+  std::vector<Instruction *> NewPhis;
+  for (Instruction *Phi : Phis) {
+    NewPhis.push_back(static_cast<Instruction *>(VM.at(Phi)));
+  }
+
+  BasicBlock *FirstHeader = nullptr;
+  BasicBlock *LastHeader = nullptr;
+  BasicBlock *PrevLatch = nullptr;
+  for (unsigned Iter = 0; Iter < Factor; ++Iter) {
+    BlockMapTy BM;
+    if (Iter) {
+      ValueMapTy NextVM;
+      for (Instruction *Phi : Phis) {
+        Value *V = Phi->getIncomingValueForBlock(C.Latch);
+        auto It = VM.find(V);
+        NextVM.emplace(Phi, It == VM.end() ? V : It->second);
+      }
+      VM.swap(NextVM);
+    }
+    cloneLoop(F, L, Dispatch, VM, BM);
+    if (PrevLatch) {
+      Instruction *Term = PrevLatch->getTerminator();
+      Instruction *Br = Instruction::CreateBr(BM.at(C.Header));
+      Br->copyLineno(Term);
+      PrevLatch->erase(Term);
+      PrevLatch->push_back(Br);
+    } else {
+      FirstHeader = BM.at(C.Header);
+    }
+    LastHeader = BM.at(C.Header);
+    PrevLatch = BM.at(C.Latch);
+  }
+  for (unsigned I = 0, E = Phis.size(); I < E; ++I) {
+    FirstHeader->insert(FirstHeader->getFirst(), NewPhis[I]);
+  }
+
+  /// The last copy goes to Dispatch where the loop would go on.
+  Instruction *LastTerm = PrevLatch->getTerminator();
+  LastTerm->setSuccessor(LastTerm->getSuccessor(0) == LastHeader ? 0 : 1,
+                         Dispatch);
+  auto MapValue = [&VM](Value *V) {
+    auto Iter = VM.find(V);
+    return Iter == VM.end() ? V : Iter->second;
+  };
+
+  /// Enter the copy from the preheader if it can run a whole chunk.
+  Instruction *PreheaderTerm = C.Preheader->getTerminator();
+  C.Preheader->erase(PreheaderTerm);
+  insertChunkTest(C, C.IndVar->getIncomingValueForBlock(C.Preheader),
+                  C.Preheader, FirstHeader, C.Header);
+  Value *NextIndVar = MapValue(C.IndVar->getIncomingValueForBlock(C.Latch));
+  insertChunkTest(C, NextIndVar, Dispatch, FirstHeader, C.Header);
+
+  for (unsigned I = 0, E = Phis.size(); I < E; ++I) {
+    Value *Init = Phis[I]->getIncomingValueForBlock(C.Preheader);
+    Value *Next = MapValue(Phis[I]->getIncomingValueForBlock(C.Latch));
+    NewPhis[I]->addIncoming(Init, C.Preheader);
+    NewPhis[I]->addIncoming(Next, Dispatch);
+    Phis[I]->addIncoming(Next, Dispatch);
+  }
+
+  /// The exit is entered from the last copy as well.
+  for (Instruction *Phi = C.Exit->getFirst(); Phi && Phi->isPhi();
+       Phi = Phi->getNext()) {
+    Phi->addIncoming(MapValue(Phi->getIncomingValueForBlock(C.Latch)),
+                     PrevLatch);
+  }
+  for (BasicBlock *BB : L->getBlocks()) {
+    for (Instruction &I : *BB) {
+      std::vector<Instruction *> Outside;
+      for (Instruction *U : I.getUsers()) {
+        if (!L->contains(U->getParent()) &&
+            !(U->isPhi() && U->getParent() == C.Exit))
+          Outside.push_back(U);
+      }
+      if (Outside.empty())
+        continue;
+      Instruction *Phi = Instruction::CreatePhi();
+      Phi->addIncoming(&I, C.Latch);
+      Phi->addIncoming(MapValue(&I), PrevLatch);
+      C.Exit->insert(C.Exit->getFirst(), Phi);
+      for (Instruction *U : Outside) {
+        U->replaceUsesOfWith(&I, Phi);
+      }
+    }
+  }
+  return true;
+}
+
+bool LoopUnroll::Transform(IRFunction &F) {
+  if (Factor < 2)
+    return false;
+  DominatorTree DT(F);
+  LoopInfo LI(DT);
+  bool Changed = false;
+  for (Loop *L : LI.getLoopsInPostorder()) {
+    Candidate C;
+    if (!analyzeLoop(L, C))
+      continue;
+    if (unsigned TripCount = getTripCount(C)) {
+      unrollFully(F, L, C, TripCount);
+      Changed = true;
+    } else if (Factor * C.Size <= PartialUnrollThreshold) {
+      Changed |= unrollPartially(F, L, C);
+    }
+  }
+  return Changed;
+}
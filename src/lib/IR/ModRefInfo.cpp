@@ -0,0 +1,67 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "simplecc/IR/ModRefInfo.h"
+#include "simplecc/IR/IRModule.h"
+#include "simplecc/Support/Casting.h"
+#include <vector>
+
+using namespace simplecc;
+
+void ModRefInfo::recalculate(const IRModule &M) {
+  ModifiedGlobals.clear();
+  std::unordered_map<const IRFunction *, std::vector<const IRFunction *>>
+      Callees;
+  for (const IRFunction *F : M) {
+    LocationSetTy &Mod = ModifiedGlobals[F];
+    for (const BasicBlock *BB : *F) {
+      for (const Instruction &I : *BB) {
+        switch (I.getOpcode()) {
+        case Instruction::Store:
+        case Instruction::StoreElem:
+          if (IsInstance<GlobalVariable>(I.getOperand(1)))
+            Mod.insert(I.getOperand(1));
+          break;
+        case Instruction::Call:
+          Callees[F].push_back(I.getCallee());
+          break;
+        default:
+          break;
+        }
+      }
+    }
+  }
+
+  /// Propagate from the callees to the callers until nothing changes.
+  bool Changed = true;
+  while (Changed) {
+    Changed = false;
+    for (const auto &Pair : Callees) {
+      LocationSetTy &Mod = ModifiedGlobals[Pair.first];
+      for (const IRFunction *Callee : Pair.second) {
+        for (Value *GV : ModifiedGlobals[Callee]) {
+          Changed |= Mod.insert(GV).second;
+        }
+      }
+    }
+  }
+}
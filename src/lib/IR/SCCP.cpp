@@ -0,0 +1,260 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "simplecc/IR/SCCP.h"
+#include "simplecc/IR/IRModule.h"
+#include "simplecc/Support/Casting.h"
+
+using namespace simplecc;
+
+SCCP::LatticeValue SCCP::getValue(Value *V) const {
+  LatticeValue LV;
+  if (auto C = subclass_cast<Constant>(V)) {
+    LV.Kind = LatticeValue::Const;
+    LV.Val = C->getValue();
+    return LV;
+  }
+  if (IsInstance<UndefValue>(V)) {
+    LV.Kind = LatticeValue::Const;
+    return LV;
+  }
+  if (auto I = subclass_cast<Instruction>(V)) {
+    auto Iter = Values.find(I);
+    return Iter == Values.end() ? LV : Iter->second;
+  }
+  /// Arguments, globals and arrays.
+  LV.Kind = LatticeValue::Overdefined;
+  return LV;
+}
+
+void SCCP::mergeInValue(Instruction *I, LatticeValue LV) {
+  LatticeValue &Old = Values[I];
+  if (Old.isOverdefined() || LV.isUnknown())
+    return;
+  if (Old.isConstant() && LV.isConstant() && Old.Val == LV.Val)
+    return;
+  if (Old.isUnknown())
+    Old = LV;
+  else
+    Old.Kind = LatticeValue::Overdefined;
+  for (Instruction *U : I->getUsers()) {
+    InstWorklist.push_back(U);
+  }
+}
+
+void SCCP::markOverdefined(Instruction *I) {
+  LatticeValue LV;
+  LV.Kind = LatticeValue::Overdefined;
+  mergeInValue(I, LV);
+}
+
+void SCCP::markBlockExecutable(BasicBlock *BB) {
+  if (ExecutableBlocks.insert(BB).second)
+    BlockWorklist.push_back(BB);
+}
+
+void SCCP::markEdgeExecutable(BasicBlock *From, BasicBlock *To) {
+  if (!ExecutableEdges.insert(std::make_pair(From, To)).second)
+    return;
+  if (!ExecutableBlocks.count(To)) {
+    markBlockExecutable(To);
+    return;
+  }
+  /// A new edge into a visited block only changes its phis.
+  for (Instruction &I : *To) {
+    if (!I.isPhi())
+      break;
+    visitPhi(&I);
+  }
+}
+
+void SCCP::visitPhi(Instruction *I) {
+  LatticeValue Result;
+  for (unsigned Idx = 0, E = I->getNumIncoming(); Idx < E; ++Idx) {
+    if (!isEdgeExecutable(I->getIncomingBlock(Idx), I->getParent()))
+      continue;
+    LatticeValue LV = getValue(I->getIncomingValue(Idx));
+    if (LV.isUnknown())
+      continue;
+    if (LV.isOverdefined() || (Result.isConstant() && Result.Val != LV.Val)) {
+      markOverdefined(I);
+      return;
+    }
+    Result = LV;
+  }
+  mergeInValue(I, Result);
+}
+
+void SCCP::visitBinary(Instruction *I) {
+  LatticeValue LHS = getValue(I->getOperand(0));
+  LatticeValue RHS = getValue(I->getOperand(1));
+  if (LHS.isOverdefined() || RHS.isOverdefined()) {
+    markOverdefined(I);
+    return;
+  }
+  if (LHS.isUnknown() || RHS.isUnknown())
+    return;
+  LatticeValue Result;
+  if (!Instruction::EvaluateBinary(I->getOpcode(), LHS.Val, RHS.Val,
+                                   Result.Val)) {
+    markOverdefined(I);
+    return;
+  }
+  Result.Kind = LatticeValue::Const;
+  mergeInValue(I, Result);
+}
+
+void SCCP::visitNeg(Instruction *I) {
+  LatticeValue V = getValue(I->getOperand(0));
+  if (!V.isConstant()) {
+    if (V.isOverdefined())
+      markOverdefined(I);
+    return;
+  }
+  LatticeValue Result;
+  Result.Kind = LatticeValue::Const;
+  Instruction::EvaluateBinary(Instruction::Sub, 0, V.Val, Result.Val);
+  mergeInValue(I, Result);
+}
+
+void SCCP::visitCondBr(Instruction *I) {
+  LatticeValue LHS = getValue(I->getOperand(0));
+  LatticeValue RHS = getValue(I->getOperand(1));
+  BasicBlock *BB = I->getParent();
+  if (LHS.isConstant() && RHS.isConstant()) {
+    bool Taken =
+        Instruction::EvaluatePredicate(I->getPredicate(), LHS.Val, RHS.Val);
+    markEdgeExecutable(BB, I->getSuccessor(Taken ? 0 : 1));
+    return;
+  }
+  if (LHS.isOverdefined() || RHS.isOverdefined()) {
+    markEdgeExecutable(BB, I->getSuccessor(0));
+    markEdgeExecutable(BB, I->getSuccessor(1));
+  }
+}
+
+void SCCP::visitInstruction(Instruction *I) {
+  if (!ExecutableBlocks.count(I->getParent()))
+    return;
+  switch (I->getOpcode()) {
+  case Instruction::Phi:
+    visitPhi(I);
+    break;
+  case Instruction::Add:
+  case Instruction::Sub:
+  case Instruction::Mul:
+  case Instruction::Div:
+  case Instruction::Shl:
+  case Instruction::AShr:
+  case Instruction::LShr:
+  case Instruction::MulHi:
+    visitBinary(I);
+    break;
+  case Instruction::Neg:
+    visitNeg(I);
+    break;
+  case Instruction::CondBr:
+    visitCondBr(I);
+    break;
+  case Instruction::Br:
+    markEdgeExecutable(I->getParent(), I->getSuccessor(0));
+    break;
+  default:
+    if (I->hasValue())
+      markOverdefined(I);
+    break;
+  }
+}
+
+void SCCP::solve() {
+  while (!BlockWorklist.empty() || !InstWorklist.empty()) {
+    while (!InstWorklist.empty()) {
+      Instruction *I = InstWorklist.back();
+      InstWorklist.pop_back();
+      visitInstruction(I);
+    }
+    while (!BlockWorklist.empty()) {
+      BasicBlock *BB = BlockWorklist.back();
+      BlockWorklist.pop_back();
+      for (Instruction &I : *BB) {
+        visitInstruction(&I);
+      }
+    }
+  }
+}
+
+bool SCCP::rewrite(IRFunction &F) {
+  bool Changed = false;
+  IRFunction::BlockListTy Dead;
+  for (BasicBlock *BB : F) {
+    if (!ExecutableBlocks.count(BB)) {
+      Dead.push_back(BB);
+      continue;
+    }
+    for (Instruction *I = BB->getFirst(); I;) {
+      Instruction *Next = I->getNext();
+      auto Iter = Values.find(I);
+      /// A Div is constant only if its divisor is a non-zero constant, so no
+      /// constant instruction can trap.
+      if (Iter != Values.end() && Iter->second.isConstant() &&
+          !I->hasSideEffects()) {
+        I->replaceAllUsesWith(TheModule->getConstant(Iter->second.Val));
+        I->eraseFromParent();
+        Changed = true;
+      }
+      I = Next;
+    }
+
+    /// Fold a branch with only one executable edge.
+    Instruction *Term = BB->getTerminator();
+    if (Term->getOpcode() != Instruction::CondBr)
+      continue;
+    bool TrueEdge = isEdgeExecutable(BB, Term->getSuccessor(0));
+    bool FalseEdge = isEdgeExecutable(BB, Term->getSuccessor(1));
+    if (TrueEdge == FalseEdge)
+      continue;
+    BasicBlock *Taken = Term->getSuccessor(TrueEdge ? 0 : 1);
+    BasicBlock *NotTaken = Term->getSuccessor(TrueEdge ? 1 : 0);
+    NotTaken->removePhiEntriesFor(BB);
+    Instruction *Br = Instruction::CreateBr(Taken);
+    Br->copyLineno(Term);
+    BB->erase(Term);
+    BB->push_back(Br);
+    Changed = true;
+  }
+  if (!Dead.empty()) {
+    F.eraseBlocks(Dead);
+    Changed = true;
+  }
+  return Changed;
+}
+
+bool SCCP::Transform(IRFunction &F) {
+  TheModule = F.getParent();
+  markBlockExecutable(F.getEntryBlock());
+  solve();
+  bool Changed = rewrite(F);
+  Values.clear();
+  ExecutableBlocks.clear();
+  ExecutableEdges.clear();
+  return Changed;
+}
@@ -0,0 +1,383 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "simplecc/IR/SSABuilder.h"
+#include "simplecc/CodeGen/ByteCodeCFG.h"
+#include "simplecc/CodeGen/ByteCodeFunction.h"
+#include "simplecc/CodeGen/ByteCodeModule.h"
+#include "simplecc/Support/Casting.h"
+#include <algorithm>
+
+using namespace simplecc;
+
+Instruction *SSABuilder::insert(Instruction *I) {
+  I->setLineno(CurrentLineno);
+  CurrentBlock->push_back(I);
+  return I;
+}
+
+void SSABuilder::visitLoadLocal(const ByteCode &C) {
+  SymbolEntry E = TheLocalTable[C.getStrOperand()];
+  if (E.IsArray()) {
+    push(Arrays.at(E.getSlot()));
+    return;
+  }
+  push(readVariable(E.getSlot(), CurrentBlock));
+}
+
+void SSABuilder::visitStoreLocal(const ByteCode &C) {
+  SymbolEntry E = TheLocalTable[C.getStrOperand()];
+  writeVariable(E.getSlot(), CurrentBlock, pop());
+}
+
+void SSABuilder::visitLoadGlobal(const ByteCode &C) {
+  GlobalVariable *GV = TheModule->getGlobal(C.getStrOperand());
+  assert(GV && "Undefined global");
+  if (GV->isArray()) {
+    push(GV);
+    return;
+  }
+  push(insert(Instruction::CreateLoad(GV)));
+}
+
+void SSABuilder::visitStoreGlobal(const ByteCode &C) {
+  GlobalVariable *GV = TheModule->getGlobal(C.getStrOperand());
+  assert(GV && "Undefined global");
+  insert(Instruction::CreateStore(pop(), GV));
+}
+
+void SSABuilder::visitBinary(Instruction::Opcode Op) {
+  Value *RHS = pop();
+  Value *LHS = pop();
+  push(insert(Instruction::CreateBinary(Op, LHS, RHS)));
+}
+
+void SSABuilder::visitImmediate(Instruction::Opcode Op, const ByteCode &C) {
+  Value *LHS = pop();
+  Value *RHS = TheModule->getConstant(C.getIntOperand());
+  push(insert(Instruction::CreateBinary(Op, LHS, RHS)));
+}
+
+void SSABuilder::visitBinarySubscr(const ByteCode &) {
+  Value *Index = pop();
+  Value *Base = pop();
+  push(insert(Instruction::CreateLoadElem(Base, Index)));
+}
+
+void SSABuilder::visitStoreSubscr(const ByteCode &) {
+  Value *Index = pop();
+  Value *Base = pop();
+  Value *V = pop();
+  insert(Instruction::CreateStoreElem(V, Base, Index));
+}
+
+void SSABuilder::visitUnaryNegative(const ByteCode &) {
+  push(insert(Instruction::CreateNeg(pop())));
+}
+
+void SSABuilder::visitRead(Instruction::Opcode Op) {
+  push(insert(Instruction::CreateRead(Op)));
+}
+
+void SSABuilder::visitPrintString(const ByteCode &) {
+  /// LOAD_STRING pushed the ID as a Constant.
+  auto ID = subclass_cast<Constant>(pop());
+  assert(ID && "PRINT_STRING must follow LOAD_STRING");
+  insert(Instruction::CreatePrintString(ID->getValue()));
+}
+
+void SSABuilder::visitPrint(Instruction::Opcode Op) {
+  insert(Instruction::CreatePrint(Op, pop()));
+}
+
+void SSABuilder::visitPrintNewline(const ByteCode &) {
+  insert(Instruction::CreatePrintNewline());
+}
+
+void SSABuilder::visitJumpForward(const ByteCode &C) {
+  insert(Instruction::CreateBr(getBlockAt(C.getJumpTarget())));
+}
+
+void SSABuilder::insertCondBr(const ByteCode &C, Instruction::Predicate P,
+                              Value *LHS, Value *RHS) {
+  insert(Instruction::CreateCondBr(P, LHS, RHS, getBlockAt(C.getJumpTarget()),
+                                   getBlockAt(NextOffset)));
+}
+
+void SSABuilder::visitUnaryJumpIf(const ByteCode &C,
+                                  Instruction::Predicate P) {
+  Value *V = pop();
+  insertCondBr(C, P, V, TheModule->getConstant(0));
+}
+
+void SSABuilder::visitJumpIf(const ByteCode &C, Instruction::Predicate P) {
+  Value *RHS = pop();
+  Value *LHS = pop();
+  insertCondBr(C, P, LHS, RHS);
+}
+
+void SSABuilder::visitCallFunction(const ByteCode &C) {
+  unsigned Argc = C.getIntOperand();
+  assert(Stack.size() >= Argc && "Too few arguments on the stack");
+  Instruction::OperandListTy Args(Stack.end() - Argc, Stack.end());
+  Stack.resize(Stack.size() - Argc);
+  IRFunction *Callee = TheModule->getFunction(C.getStrOperand());
+  assert(Callee && "Undefined function");
+  /// A call always pushes a value, which is popped if the callee is void.
+  push(insert(Instruction::CreateCall(Callee, Args)));
+}
+
+void SSABuilder::visitReturnValue(const ByteCode &) {
+  insert(Instruction::CreateRet(pop()));
+}
+
+void SSABuilder::visitReturnNone(const ByteCode &) {
+  insert(Instruction::CreateRet());
+}
+
+void SSABuilder::visitLoadConst(const ByteCode &C) {
+  push(TheModule->getConstant(C.getIntOperand()));
+}
+
+void SSABuilder::visitLoadString(const ByteCode &C) {
+  push(TheModule->getConstant(C.getIntOperand()));
+}
+
+void SSABuilder::visitPopTop(const ByteCode &) { pop(); }
+
+void SSABuilder::writeVariable(unsigned Slot, BasicBlock *BB, Value *V) {
+  auto &Defs = CurrentDef[BB];
+  if (Defs.empty())
+    Defs.assign(TheLocalTable.size(), nullptr);
+  Defs[Slot] = V;
+}
+
+Value *SSABuilder::resolve(Value *V) const {
+  for (auto Iter = RemovedPhis.find(V); Iter != RemovedPhis.end();
+       Iter = RemovedPhis.find(V)) {
+    V = Iter->second;
+  }
+  return V;
+}
+
+Value *SSABuilder::readVariable(unsigned Slot, BasicBlock *BB) {
+  auto Iter = CurrentDef.find(BB);
+  if (Iter != CurrentDef.end() && Iter->second[Slot])
+    return resolve(Iter->second[Slot]);
+  return readVariableRecursive(Slot, BB);
+}
+
+Value *SSABuilder::readVariableRecursive(unsigned Slot, BasicBlock *BB) {
+  Value *V;
+  if (!isSealed(BB)) {
+    /// Not all predecessors are known yet. Complete the phi on sealing.
+    Instruction *Phi = Instruction::CreatePhi();
+    BB->insert(BB->getFirstNonPhi(), Phi);
+    IncompletePhis[BB].emplace_back(Slot, Phi);
+    V = Phi;
+  } else if (BB->getNumPredecessors() == 0) {
+    /// The entry: a formal argument or an uninitialized local.
+    V = Slot < TheFunction->getNumArguments()
+            ? static_cast<Value *>(TheFunction->getArgument(Slot))
+            : TheModule->getUndef();
+  } else if (BB->getNumPredecessors() == 1) {
+    V = readVariable(Slot, BB->getSinglePredecessor());
+  } else {
+    /// Break cycles with an operandless phi.
+    Instruction *Phi = Instruction::CreatePhi();
+    BB->insert(BB->getFirstNonPhi(), Phi);
+    writeVariable(Slot, BB, Phi);
+    V = addPhiOperands(Slot, Phi);
+  }
+  writeVariable(Slot, BB, V);
+  return V;
+}
+
+Value *SSABuilder::addPhiOperands(unsigned Slot, Instruction *Phi) {
+  BasicBlock::BlockListTy Preds = Phi->getParent()->getPredecessors();
+  for (BasicBlock *Pred : Preds) {
+    Phi->addIncoming(readVariable(Slot, Pred), Pred);
+  }
+  return tryRemoveTrivialPhi(Phi);
+}
+
+Value *SSABuilder::tryRemoveTrivialPhi(Instruction *Phi) {
+  Value *Same = nullptr;
+  for (Value *Op : Phi->getOperands()) {
+    if (Op == Same || Op == Phi)
+      continue;
+    /// The phi merges at least two values.
+    if (Same)
+      return Phi;
+    Same = Op;
+  }
+  /// The phi is unreachable or in the entry block.
+  if (!Same)
+    Same = TheModule->getUndef();
+
+  std::vector<Instruction *> Users;
+  for (Instruction *U : Phi->getUsers()) {
+    if (U != Phi && U->isPhi() &&
+        std::find(Users.begin(), Users.end(), U) == Users.end())
+      Users.push_back(U);
+  }
+  Phi->replaceAllUsesWith(Same);
+  Phi->getParent()->remove(Phi);
+  Phi->dropAllReferences();
+  RemovedPhis.emplace(Phi, Same);
+
+  /// Removing this phi may make its users trivial.
+  for (Instruction *U : Users) {
+    if (U->getParent())
+      tryRemoveTrivialPhi(U);
+  }
+  return resolve(Same);
+}
+
+void SSABuilder::sealBlock(BasicBlock *BB) {
+  auto Iter = IncompletePhis.find(BB);
+  if (Iter != IncompletePhis.end()) {
+    auto Phis = std::move(Iter->second);
+    IncompletePhis.erase(Iter);
+    for (auto &Item : Phis) {
+      addPhiOperands(Item.first, Item.second);
+    }
+  }
+  Sealed.insert(BB);
+}
+
+void SSABuilder::createBlocks(const ByteCodeFunction &F) {
+  /// Create blocks only for the reachable ones, in ByteCode order.
+  ByteCodeCFG CFG(F);
+  for (unsigned B = 0, E = CFG.size(); B < E; ++B) {
+    if (CFG.isReachable(B))
+      Blocks.emplace(CFG.getBlock(B).Begin, TheFunction->createBlock());
+  }
+  for (unsigned B = 0, E = CFG.size(); B < E; ++B) {
+    if (!CFG.isReachable(B))
+      continue;
+    for (unsigned Succ : CFG.getBlock(B).Successors) {
+      ++NumPredecessors[getBlockAt(CFG.getBlock(Succ).Begin)];
+    }
+    /// A conditional jump to the next block is still two edges in the IR.
+    const ByteCode &Last = CFG.getTerminator(B);
+    if (Last.IsJump() && Last.getOpcode() != ByteCode::JUMP_FORWARD &&
+        Last.getJumpTarget() == CFG.getBlock(B).End)
+      ++NumPredecessors[getBlockAt(Last.getJumpTarget())];
+  }
+}
+
+void SSABuilder::buildFunction(const ByteCodeFunction &F, IRFunction *IRF) {
+  TheFunction = IRF;
+  TheLocalTable = F.getLocalTable();
+  createBlocks(F);
+  for (const SymbolEntry &E : F.getLocalVariables()) {
+    if (E.IsArray()) {
+      Arrays.emplace(E.getSlot(),
+                     IRF->addLocalArray(E.getName(),
+                                        E.AsArray().getElementType(),
+                                        E.AsArray().getSize()));
+    }
+  }
+
+  /// The entry block cannot be a loop header, so give the loop a preheader.
+  BasicBlock *First = getBlockAt(0);
+  if (NumPredecessors[First]) {
+    BasicBlock *Entry = IRF->createBlock(First);
+    Entry->push_back(Instruction::CreateBr(First));
+    Sealed.insert(Entry);
+    ++NumFilledPredecessors[First];
+    ++NumPredecessors[First];
+  } else {
+    Sealed.insert(First);
+  }
+
+  std::vector<std::pair<unsigned, BasicBlock *>> Order(Blocks.begin(),
+                                                        Blocks.end());
+  std::sort(Order.begin(), Order.end());
+  for (unsigned I = 0, E = Order.size(); I < E; ++I) {
+    unsigned Start = Order[I].first;
+    unsigned End = I + 1 < E ? Order[I + 1].first : F.size();
+    CurrentBlock = Order[I].second;
+    if (!isSealed(CurrentBlock) &&
+        NumFilledPredecessors[CurrentBlock] == NumPredecessors[CurrentBlock])
+      sealBlock(CurrentBlock);
+
+    for (unsigned Off = Start; Off < End && !CurrentBlock->getTerminator();
+         ++Off) {
+      const ByteCode &C = F.getByteCodeAt(Off);
+      CurrentLineno = C.getSourceLineno();
+      NextOffset = Off + 1;
+      visit(C);
+    }
+    assert(Stack.empty() && "Values left on the stack across blocks");
+    /// Fall through to the next block.
+    if (!CurrentBlock->getTerminator())
+      insert(Instruction::CreateBr(getBlockAt(End)));
+
+    for (BasicBlock *Succ : CurrentBlock->getSuccessors()) {
+      if (++NumFilledPredecessors[Succ] == NumPredecessors[Succ] &&
+          !isSealed(Succ))
+        sealBlock(Succ);
+    }
+  }
+  assert(IncompletePhis.empty() && "Blocks left unsealed");
+
+  for (auto &Item : RemovedPhis) {
+    delete static_cast<Instruction *>(Item.first);
+  }
+  RemovedPhis.clear();
+  CurrentDef.clear();
+  Sealed.clear();
+  Blocks.clear();
+  NumPredecessors.clear();
+  NumFilledPredecessors.clear();
+  Arrays.clear();
+  CurrentBlock = nullptr;
+}
+
+void SSABuilder::Build(const ByteCodeModule &BM, IRModule &M) {
+  TheModule = &M;
+  M.getStringLiteralTable() = BM.getStringLiteralTable();
+  for (const SymbolEntry &E : BM.getGlobalVariables()) {
+    if (E.IsArray())
+      M.addGlobal(E.getName(), E.AsArray().getElementType(),
+                  E.AsArray().getSize());
+    else
+      M.addGlobal(E.getName(), E.AsVariable().getType(), 0);
+  }
+
+  /// Create all the functions first so that calls can refer to them.
+  std::vector<IRFunction *> Functions;
+  for (const ByteCodeFunction *F : BM) {
+    SymbolEntry E = F->getLocalTable()[F->getName()];
+    IRFunction *IRF = IRFunction::Create(&M, F->getName(),
+                                         E.AsFunction().getReturnType());
+    for (const SymbolEntry &Arg : F->getFormalArguments()) {
+      IRF->addArgument(Arg.getName());
+    }
+    Functions.push_back(IRF);
+  }
+  for (unsigned I = 0, E = Functions.size(); I < E; ++I) {
+    buildFunction(*BM.getFunctionList()[I], Functions[I]);
+  }
+}
@@ -0,0 +1,148 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "simplecc/IR/SimplifyCFG.h"
+#include "simplecc/IR/IRFunction.h"
+#include <unordered_set>
+
+using namespace simplecc;
+
+bool SimplifyCFG::removeUnreachableBlocks(IRFunction &F) {
+  std::unordered_set<BasicBlock *> Reachable;
+  std::vector<BasicBlock *> Worklist{F.getEntryBlock()};
+  Reachable.insert(F.getEntryBlock());
+  while (!Worklist.empty()) {
+    BasicBlock *BB = Worklist.back();
+    Worklist.pop_back();
+    for (BasicBlock *Succ : BB->getSuccessors()) {
+      if (Reachable.insert(Succ).second)
+        Worklist.push_back(Succ);
+    }
+  }
+
+  IRFunction::BlockListTy Dead;
+  for (BasicBlock *BB : F) {
+    if (!Reachable.count(BB))
+      Dead.push_back(BB);
+  }
+  F.eraseBlocks(Dead);
+  return !Dead.empty();
+}
+
+bool SimplifyCFG::foldTrivialPhis(BasicBlock *BB) {
+  bool Changed = false;
+  for (Instruction *I = BB->getFirst(); I && I->isPhi();) {
+    Instruction *Next = I->getNext();
+    if (Value *V = I->getUniqueIncomingValue()) {
+      I->replaceAllUsesWith(V);
+      I->eraseFromParent();
+      Changed = true;
+    }
+    I = Next;
+  }
+  return Changed;
+}
+
+bool SimplifyCFG::foldRedundantCondBr(BasicBlock *BB) {
+  Instruction *Term = BB->getTerminator();
+  if (Term->getOpcode() != Instruction::CondBr ||
+      Term->getSuccessor(0) != Term->getSuccessor(1))
+    return false;
+  /// The two entries of each phi carry the same value, so drop one.
+  BasicBlock *Succ = Term->getSuccessor(0);
+  Succ->removePhiEntriesFor(BB);
+  Instruction *Br = Instruction::CreateBr(Succ);
+  Br->copyLineno(Term);
+  BB->erase(Term);
+  BB->push_back(Br);
+  return true;
+}
+
+bool SimplifyCFG::mergeIntoPredecessor(BasicBlock *BB) {
+  BasicBlock *Pred = BB->getSinglePredecessor();
+  if (!Pred || Pred == BB || BB == BB->getParent()->getEntryBlock())
+    return false;
+  Instruction *PredTerm = Pred->getTerminator();
+  if (PredTerm->getOpcode() != Instruction::Br)
+    return false;
+
+  /// With a single predecessor, every phi is trivial.
+  while (!BB->empty() && BB->getFirst()->isPhi()) {
+    Instruction *Phi = BB->getFirst();
+    Phi->replaceAllUsesWith(Phi->getIncomingValue(0));
+    Phi->eraseFromParent();
+  }
+  Pred->erase(PredTerm);
+  while (!BB->empty()) {
+    Pred->push_back(BB->remove(BB->getFirst()));
+  }
+  for (BasicBlock *Succ : Pred->getSuccessors()) {
+    Succ->replacePhiUsesWith(BB, Pred);
+  }
+  BB->getParent()->eraseBlocks({BB});
+  return true;
+}
+
+bool SimplifyCFG::forwardEmptyBlock(BasicBlock *BB) {
+  Instruction *Term = BB->getFirst();
+  if (Term->getOpcode() != Instruction::Br ||
+      BB == BB->getParent()->getEntryBlock())
+    return false;
+  BasicBlock *Succ = Term->getSuccessor(0);
+  if (Succ == BB || (!Succ->empty() && Succ->getFirst()->isPhi()))
+    return false;
+
+  BasicBlock::BlockListTy Preds = BB->getPredecessors();
+  for (BasicBlock *Pred : Preds) {
+    Instruction *PredTerm = Pred->getTerminator();
+    for (unsigned I = 0, E = PredTerm->getNumSuccessors(); I < E; ++I) {
+      if (PredTerm->getSuccessor(I) == BB)
+        PredTerm->setSuccessor(I, Succ);
+    }
+  }
+  return !Preds.empty();
+}
+
+bool SimplifyCFG::Transform(IRFunction &F) {
+  bool Changed = false;
+  bool LocalChanged;
+  do {
+    LocalChanged = removeUnreachableBlocks(F);
+    /// Blocks may be deleted while iterating, so walk a copy.
+    IRFunction::BlockListTy Blocks = F.getBlockList();
+    std::unordered_set<BasicBlock *> Erased;
+    for (BasicBlock *BB : Blocks) {
+      if (Erased.count(BB))
+        continue;
+      LocalChanged |= foldTrivialPhis(BB);
+      LocalChanged |= foldRedundantCondBr(BB);
+      if (mergeIntoPredecessor(BB)) {
+        Erased.insert(BB);
+        LocalChanged = true;
+        continue;
+      }
+      LocalChanged |= forwardEmptyBlock(BB);
+    }
+    Changed |= LocalChanged;
+  } while (LocalChanged);
+  return Changed;
+}
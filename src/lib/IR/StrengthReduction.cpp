@@ -0,0 +1,305 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "simplecc/IR/StrengthReduction.h"
+#include "simplecc/IR/DominatorTree.h"
+#include "simplecc/IR/IRModule.h"
+#include "simplecc/IR/LoopInfo.h"
+#include "simplecc/Support/Casting.h"
+#include <climits>
+#include <unordered_map>
+
+using namespace simplecc;
+
+/// Return k if U is 2**k, or -1 if it is not a power of two.
+static int getLog2(unsigned U) {
+  if (U == 0 || (U & (U - 1)))
+    return -1;
+  int K = 0;
+  while (U >>= 1)
+    ++K;
+  return K;
+}
+
+/// The magic number M and the shift s of a signed divisor D, so that the
+/// quotient is the high word of N * M shifted right by s, plus corrections.
+/// This is the algorithm of Figure 10-1 in Hacker's Delight, which requires
+/// 2 <= |D| and D != INT_MIN.
+static void getMagicNumber(int D, int &M, int &S) {
+  const unsigned Two31 = 0x80000000u;
+  unsigned AbsD = D < 0 ? -static_cast<unsigned>(D) : D;
+  unsigned T = Two31 + (static_cast<unsigned>(D) >> 31);
+  unsigned ANC = T - 1 - T % AbsD;
+  unsigned Q1 = Two31 / ANC, R1 = Two31 - Q1 * ANC;
+  unsigned Q2 = Two31 / AbsD, R2 = Two31 - Q2 * AbsD;
+  unsigned Delta;
+  int P = 31;
+  do {
+    ++P;
+    Q1 *= 2;
+    R1 *= 2;
+    if (R1 >= ANC) {
+      ++Q1;
+      R1 -= ANC;
+    }
+    Q2 *= 2;
+    R2 *= 2;
+    if (R2 >= AbsD) {
+      ++Q2;
+      R2 -= AbsD;
+    }
+    Delta = AbsD - R2;
+  } while (Q1 < Delta || (Q1 == Delta && R1 == 0));
+  M = static_cast<int>(Q2 + 1);
+  if (D < 0)
+    M = -M;
+  S = P - 32;
+}
+
+/// Return whether a product by C is cheap enough without a new induction
+/// variable.
+static bool isCheapMultiplier(int C) {
+  unsigned U = C;
+  return C == 0 || C == -1 || getLog2(U) >= 0 || getLog2(-U) >= 0;
+}
+
+Instruction *StrengthReduction::insertBinary(Instruction::Opcode Op,
+                                             Value *LHS, Value *RHS,
+                                             Instruction *Pos) {
+  Instruction *I = Instruction::CreateBinary(Op, LHS, RHS);
+  I->copyLineno(Pos);
+  Pos->getParent()->insert(Pos, I);
+  return I;
+}
+
+Instruction *StrengthReduction::insertNeg(Value *V, Instruction *Pos) {
+  Instruction *I = Instruction::CreateNeg(V);
+  I->copyLineno(Pos);
+  Pos->getParent()->insert(Pos, I);
+  return I;
+}
+
+bool StrengthReduction::reduceInductionVariables(Loop *L) {
+  BasicBlock *Preheader = L->getLoopPreheader();
+  Loop::BlockListTy Latches = L->getLatches();
+  if (!Preheader || Latches.size() != 1)
+    return false;
+  BasicBlock *Header = L->getHeader();
+  BasicBlock *Latch = Latches.front();
+  IRModule *M = Header->getParent()->getParent();
+
+  bool Changed = false;
+  for (Instruction *P = Header->getFirst(); P && P->isPhi(); P = P->getNext()) {
+    if (P->getNumIncoming() != 2)
+      continue;
+    /// P must be updated as P + Step or P - Step in the loop.
+    auto Next = subclass_cast<Instruction>(P->getIncomingValueForBlock(Latch));
+    if (!Next || !L->contains(Next->getParent()))
+      continue;
+    Value *Step = nullptr;
+    if (Next->getOpcode() == Instruction::Add && Next->getOperand(0) == P)
+      Step = Next->getOperand(1);
+    else if (Next->getOpcode() == Instruction::Add && Next->getOperand(1) == P)
+      Step = Next->getOperand(0);
+    else if (Next->getOpcode() == Instruction::Sub && Next->getOperand(0) == P)
+      Step = Next->getOperand(1);
+    auto StepC = Step ? subclass_cast<Constant>(Step) : nullptr;
+    if (!StepC)
+      continue;
+
+    /// Collect the products of P and of Next first, as replacing them
+    /// changes the users.
+    std::vector<std::pair<Instruction *, Constant *>> Products;
+    auto CollectProducts = [&](Value *V) {
+      for (Instruction *U : V->getUsers()) {
+        if (U->getOpcode() != Instruction::Mul || !L->contains(U->getParent()))
+          continue;
+        auto C = subclass_cast<Constant>(
+            U->getOperand(0) == V ? U->getOperand(1) : U->getOperand(0));
+        if (C && !isCheapMultiplier(C->getValue()))
+          Products.emplace_back(U, C);
+      }
+    };
+    CollectProducts(P);
+    CollectProducts(Next);
+
+    /// Q is P * C and QNext is Next * C.
+    std::unordered_map<int, std::pair<Instruction *, Instruction *>> Reduced;
+    Value *Init = P->getIncomingValueForBlock(Preheader);
+    for (const auto &Product : Products) {
+      Instruction *Mul = Product.first;
+      int C = Product.second->getValue();
+      auto Iter = Reduced.find(C);
+      if (Iter == Reduced.end()) {
+        int Result;
+        Value *Start;
+        if (auto InitC = subclass_cast<Constant>(Init)) {
+          Instruction::EvaluateBinary(Instruction::Mul, InitC->getValue(), C,
+                                      Result);
+          Start = M->getConstant(Result);
+        } else {
+          Start = insertBinary(Instruction::Mul, Init, Product.second,
+                               Preheader->getTerminator());
+        }
+        Instruction::EvaluateBinary(Instruction::Mul, StepC->getValue(), C,
+                                    Result);
+
+        Instruction *Q = Instruction::CreatePhi();
+        Header->insert(Header->getFirst(), Q);
+        Instruction *QNext = Instruction::CreateBinary(Next->getOpcode(), Q,
+                                                       M->getConstant(Result));
+        QNext->copyLineno(Next);
+        Next->getParent()->insert(Next->getNext(), QNext);
+        Q->addIncoming(Start, Preheader);
+        Q->addIncoming(QNext, Latch);
+        Iter = Reduced.emplace(C, std::make_pair(Q, QNext)).first;
+      }
+      /// QNext follows Next, so it dominates every user of Next.
+      bool OfP = Mul->getOperand(0) == P || Mul->getOperand(1) == P;
+      Mul->replaceAllUsesWith(OfP ? Iter->second.first : Iter->second.second);
+      Mul->eraseFromParent();
+      Changed = true;
+    }
+  }
+  return Changed;
+}
+
+Value *StrengthReduction::reduceMul(Instruction *I, Value *X, int C) {
+  IRModule *M = I->getFunction()->getParent();
+  if (C == 0)
+    return M->getConstant(0);
+  if (C == 1)
+    return X;
+  if (C == -1)
+    return insertNeg(X, I);
+
+  /// 2**K also covers INT_MIN, whose product wraps as the shift does.
+  unsigned U = C;
+  int K = getLog2(U);
+  if (K >= 0)
+    return insertBinary(Instruction::Shl, X, M->getConstant(K), I);
+  if (C < 0) {
+    K = getLog2(-U);
+    if (K < 0)
+      return nullptr;
+    return insertNeg(insertBinary(Instruction::Shl, X, M->getConstant(K), I),
+                     I);
+  }
+  /// 2**K + 1 and 2**K - 1.
+  K = getLog2(U - 1);
+  if (K >= 0) {
+    Value *Shl = insertBinary(Instruction::Shl, X, M->getConstant(K), I);
+    return insertBinary(Instruction::Add, Shl, X, I);
+  }
+  K = getLog2(U + 1);
+  if (K >= 0) {
+    Value *Shl = insertBinary(Instruction::Shl, X, M->getConstant(K), I);
+    return insertBinary(Instruction::Sub, Shl, X, I);
+  }
+  return nullptr;
+}
+
+Value *StrengthReduction::reduceDiv(Instruction *I, Value *X, int D) {
+  IRModule *M = I->getFunction()->getParent();
+  if (D == 0 || D == INT_MIN)
+    return nullptr;
+  if (D == 1)
+    return X;
+  if (D == -1)
+    return insertNeg(X, I);
+
+  unsigned AbsD = D < 0 ? -static_cast<unsigned>(D) : D;
+  int K = getLog2(AbsD);
+  Value *Q;
+  if (K >= 0) {
+    /// Add 2**K - 1 to a negative dividend so that the shift rounds toward
+    /// zero. The bias is the sign shifted right logically by 32 - K.
+    Value *Sign = X;
+    if (K > 1)
+      Sign = insertBinary(Instruction::AShr, X, M->getConstant(K - 1), I);
+    Value *Bias =
+        insertBinary(Instruction::LShr, Sign, M->getConstant(32 - K), I);
+    Value *Sum = insertBinary(Instruction::Add, X, Bias, I);
+    Q = insertBinary(Instruction::AShr, Sum, M->getConstant(K), I);
+    return D < 0 ? insertNeg(Q, I) : Q;
+  }
+
+  int Magic, Shift;
+  getMagicNumber(D, Magic, Shift);
+  Q = insertBinary(Instruction::MulHi, X, M->getConstant(Magic), I);
+  if (D > 0 && Magic < 0)
+    Q = insertBinary(Instruction::Add, Q, X, I);
+  else if (D < 0 && Magic > 0)
+    Q = insertBinary(Instruction::Sub, Q, X, I);
+  if (Shift > 0)
+    Q = insertBinary(Instruction::AShr, Q, M->getConstant(Shift), I);
+  /// Add one to a negative quotient to round it toward zero.
+  Value *Sign = insertBinary(Instruction::LShr, Q, M->getConstant(31), I);
+  return insertBinary(Instruction::Add, Q, Sign, I);
+}
+
+bool StrengthReduction::reduceInstruction(Instruction *I) {
+  Value *V = nullptr;
+  switch (I->getOpcode()) {
+  case Instruction::Mul: {
+    auto LHS = subclass_cast<Constant>(I->getOperand(0));
+    auto RHS = subclass_cast<Constant>(I->getOperand(1));
+    /// A product of constants is left to SCCP.
+    if (LHS && !RHS)
+      V = reduceMul(I, I->getOperand(1), LHS->getValue());
+    else if (RHS && !LHS)
+      V = reduceMul(I, I->getOperand(0), RHS->getValue());
+    break;
+  }
+  case Instruction::Div: {
+    auto RHS = subclass_cast<Constant>(I->getOperand(1));
+    if (RHS && !IsInstance<Constant>(I->getOperand(0)))
+      V = reduceDiv(I, I->getOperand(0), RHS->getValue());
+    break;
+  }
+  default:
+    break;
+  }
+  if (!V)
+    return false;
+  I->replaceAllUsesWith(V);
+  I->eraseFromParent();
+  return true;
+}
+
+bool StrengthReduction::Transform(IRFunction &F) {
+  bool Changed = false;
+  DominatorTree DT(F);
+  LoopInfo LI(DT);
+  for (Loop *L : LI.getLoopsInPostorder()) {
+    Changed |= reduceInductionVariables(L);
+  }
+  for (BasicBlock *BB : F) {
+    for (Instruction *I = BB->getFirst(); I;) {
+      Instruction *Next = I->getNext();
+      Changed |= reduceInstruction(I);
+      I = Next;
+    }
+  }
+  return Changed;
+}
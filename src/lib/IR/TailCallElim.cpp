@@ -0,0 +1,163 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "simplecc/IR/TailCallElim.h"
+#include "simplecc/IR/IRFunction.h"
+#include "simplecc/IR/IRModule.h"
+#include <vector>
+
+using namespace simplecc;
+
+bool TailCallElim::findTailCall(BasicBlock *BB, TailCall &TC) {
+  Instruction *Ret = BB->getTerminator();
+  if (Ret->getOpcode() != Instruction::Ret)
+    return false;
+  Instruction *Prev = Ret->getPrev();
+  if (!Prev)
+    return false;
+  Value *RetVal = Ret->getNumOperands() ? Ret->getOperand(0) : nullptr;
+  IRFunction *F = BB->getParent();
+
+  /// ret (call @f(...))
+  if (Prev->getOpcode() == Instruction::Call && Prev->getCallee() == F) {
+    if (RetVal && RetVal != Prev)
+      return false;
+    TC.Call = Prev;
+    TC.Accumulate = nullptr;
+    return true;
+  }
+
+  /// ret (X op call @f(...)), where X comes before the call.
+  if (Prev->getOpcode() != Instruction::Add &&
+      Prev->getOpcode() != Instruction::Mul)
+    return false;
+  Instruction *Call = Prev->getPrev();
+  if (RetVal != Prev || !Call || Call->getOpcode() != Instruction::Call ||
+      Call->getCallee() != F || !Call->hasOneUse())
+    return false;
+  if (Prev->getOperand(0) != Call && Prev->getOperand(1) != Call)
+    return false;
+  TC.Call = Call;
+  TC.Accumulate = Prev;
+  return getAccumulatedValue(TC) != Call;
+}
+
+Value *TailCallElim::getAccumulatedValue(const TailCall &TC) {
+  Instruction *Acc = TC.Accumulate;
+  return Acc->getOperand(Acc->getOperand(0) == TC.Call ? 1 : 0);
+}
+
+bool TailCallElim::Transform(IRFunction &F) {
+  std::vector<TailCall> TailCalls;
+  Instruction::Opcode AccOp = Instruction::Add;
+  bool HasAccumulator = false;
+  for (BasicBlock *BB : F) {
+    TailCall TC;
+    if (!findTailCall(BB, TC))
+      continue;
+    if (TC.Accumulate) {
+      if (HasAccumulator && TC.Accumulate->getOpcode() != AccOp)
+        continue;
+      AccOp = TC.Accumulate->getOpcode();
+      HasAccumulator = true;
+    }
+    TailCalls.push_back(TC);
+  }
+  if (TailCalls.empty())
+    return false;
+
+  /// The old entry becomes the header of the loop.
+  BasicBlock *Header = F.getEntryBlock();
+  const Instruction *First = Header->getFirst();
+  BasicBlock *Entry = F.createBlock(Header);
+  Instruction *Br = Instruction::CreateBr(Header);
+  Br->copyLineno(First);
+  Entry->push_back(Br);
+
+  std::vector<Instruction *> ArgPhis;
+  for (Argument *Arg : F.getArguments()) {
+    Instruction *Phi = Instruction::CreatePhi();
+    Phi->copyLineno(First);
+    Header->insert(Header->getFirstNonPhi(), Phi);
+    Arg->replaceAllUsesWith(Phi);
+    Phi->addIncoming(Arg, Entry);
+    ArgPhis.push_back(Phi);
+  }
+
+  Instruction *AccPhi = nullptr;
+  if (HasAccumulator) {
+    AccPhi = Instruction::CreatePhi();
+    AccPhi->copyLineno(First);
+    Header->insert(Header->getFirstNonPhi(), AccPhi);
+    IRModule *M = F.getParent();
+    AccPhi->addIncoming(M->getConstant(AccOp == Instruction::Add ? 0 : 1),
+                        Entry);
+  }
+
+  for (const TailCall &TC : TailCalls) {
+    Instruction *Call = TC.Call;
+    BasicBlock *BB = Call->getParent();
+    for (unsigned I = 0, E = ArgPhis.size(); I < E; ++I) {
+      ArgPhis[I]->addIncoming(Call->getOperand(I), BB);
+    }
+    if (AccPhi) {
+      Value *NewAcc = AccPhi;
+      if (TC.Accumulate) {
+        Instruction *Combine = Instruction::CreateBinary(
+            AccOp, AccPhi, getAccumulatedValue(TC));
+        Combine->copyLineno(Call);
+        BB->insert(Call, Combine);
+        NewAcc = Combine;
+      }
+      AccPhi->addIncoming(NewAcc, BB);
+    }
+    Instruction *Back = Instruction::CreateBr(Header);
+    Back->copyLineno(Call);
+    BB->erase(BB->getTerminator());
+    if (TC.Accumulate)
+      BB->erase(TC.Accumulate);
+    BB->erase(Call);
+    BB->push_back(Back);
+  }
+
+  /// Each remaining return yields what it returns combined with what the
+  /// calls it replaces would have done to it.
+  if (AccPhi) {
+    Value *Identity = AccPhi->getIncomingValue(0);
+    for (BasicBlock *BB : F) {
+      Instruction *Ret = BB->getTerminator();
+      if (Ret->getOpcode() != Instruction::Ret)
+        continue;
+      if (Ret->getOperand(0) == Identity) {
+        Ret->setOperand(0, AccPhi);
+        continue;
+      }
+      Instruction *Combine =
+          Instruction::CreateBinary(AccOp, AccPhi, Ret->getOperand(0));
+      Combine->copyLineno(Ret);
+      BB->insert(Ret, Combine);
+      Ret->setOperand(0, Combine);
+    }
+  }
+  return true;
+}
@@ -27,6 +27,20 @@
 
 using namespace simplecc;
 
+/// Return the location past the last token of N.
+static Location getEndLocation(const Node *N) {
+  while (N->getNumChildren())
+    N = N->getLastChild();
+  Location L = N->getLocation();
+  return Location(L.getLine(), L.getColumn() + N->getValue().size());
+}
+
+/// Make A end where the source text of N does.
+template <typename T> static T *setEnd(T *A, const Node *N) {
+  A->setEndLocation(getEndLocation(N));
+  return A;
+}
+
 ProgramAST *ASTBuilder::visit_program(std::string Filename, Node *N) {
   assert(N->getType() == Symbol::program);
   std::vector<DeclAST *> Decls;
@@ -63,16 +77,18 @@ DeclAST *ASTBuilder::visit_const_item(Node *N, BasicTypeKind Ty) {
     Val = makeCharExpr(constant);
   } else {
     assert(constant->getType() == Symbol::integer);
-    Val = new NumExpr(visit_integer(constant), constant->getLocation());
+    Val = setEnd(new NumExpr(visit_integer(constant), constant->getLocation()),
+                 constant);
   }
-  return new ConstDecl(Ty, name->getValue(), Val, name->getLocation());
+  return setEnd(new ConstDecl(Ty, name->getValue(), Val, name->getLocation()),
+                constant);
 }
 
 int ASTBuilder::visit_integer(Node *N) {
   std::ostringstream OS;
   std::transform(N->begin(), N->end(), std::ostream_iterator<std::string>(OS),
                  [](Node *C) { return C->getValue(); });
-  return evaluate_integer(OS.str(), N->getLocation());
+  return evaluate_integer(OS.str(), N);
 }
 
 void ASTBuilder::visit_declaration(Node *N, std::vector<DeclAST *> &Decls) {
@@ -83,8 +99,10 @@ void ASTBuilder::visit_declaration(Node *N, std::vector<DeclAST *> &Decls) {
     std::vector<StmtAST *> FnStmts;
     auto Ty = visit_type_name(TypeName);
     visit_compound_stmt(N->getLastChild(), FnDecls, FnStmts);
-    Decls.push_back(new FuncDef(Ty, {}, std::move(FnDecls), std::move(FnStmts),
-                                "main", TypeName->getLocation()));
+    Decls.push_back(
+        setEnd(new FuncDef(Ty, {}, std::move(FnDecls), std::move(FnStmts),
+                           "main", TypeName->getLocation()),
+               name));
     return;
   }
 
@@ -103,18 +121,21 @@ std::vector<ExprAST *> ASTBuilder::visit_arglist(Node *N) {
   return std::move(Args);
 }
 
-ExprAST *ASTBuilder::visit_atom_trailer(Node *N, const std::string &Name,
+ExprAST *ASTBuilder::visit_atom_trailer(Node *N, Node *Name,
                                         ExprContextKind Context) {
   auto first = N->getFirstChild();
   if (first->getType() == Symbol::arglist) {
     // no empty arglist
     std::vector<ExprAST *> Args = visit_arglist(first);
-    return new CallExpr(Name, Args, N->getLocation());
+    return setEnd(
+        new CallExpr(Name->getValue(), Args, Name->getLocation()), N);
   }
 
   assert(first->getValue() == "[");
   auto index = visit_expr(N->getChild(1));
-  return new SubscriptExpr(Name, index, Context, N->getLocation());
+  return setEnd(new SubscriptExpr(Name->getValue(), index, Context,
+                                  Name->getLocation()),
+                N);
 }
 
 ExprAST *ASTBuilder::visit_atom(Node *N, ExprContextKind Context) {
@@ -122,11 +143,13 @@ ExprAST *ASTBuilder::visit_atom(Node *N, ExprContextKind Context) {
   if (first->getType() == Symbol::NAME) {
     if (N->getNumChildren() == 1) {
       // single name
-      return new NameExpr(first->getValue(), Context, first->getLocation());
+      return setEnd(
+          new NameExpr(first->getValue(), Context, first->getLocation()),
+          first);
     }
     // name with trailer: visit_trailer
     auto trailer = N->getChild(1);
-    return visit_atom_trailer(trailer, first->getValue(), Context);
+    return visit_atom_trailer(trailer, first, Context);
   }
 
   if (first->getType() == Symbol::NUMBER) {
@@ -139,7 +162,7 @@ ExprAST *ASTBuilder::visit_atom(Node *N, ExprContextKind Context) {
 
   assert(first->getValue() == "(");
   auto value = visit_expr(N->getChild(1));
-  return new ParenExpr(value, first->getLocation());
+  return setEnd(new ParenExpr(value, first->getLocation()), N);
 }
 
 StmtAST *ASTBuilder::visit_write_stmt(Node *N) {
@@ -150,10 +173,10 @@ StmtAST *ASTBuilder::visit_write_stmt(Node *N) {
     if (C->getType() == Symbol::expr)
       E = visit_expr(C);
     else if (C->getType() == Symbol::STRING)
-      S = new StrExpr(C->getValue(), C->getLocation());
+      S = setEnd(new StrExpr(C->getValue(), C->getLocation()), C);
     // ignore other things
   }
-  return new WriteStmt(S, E, N->getLocation());
+  return setEnd(new WriteStmt(S, E, N->getLocation()), N);
 }
 
 void ASTBuilder::visit_decl_trailer(Node *N, Node *TypeName, Node *Name,
@@ -163,22 +186,25 @@ void ASTBuilder::visit_decl_trailer(Node *N, Node *TypeName, Node *Name,
   auto Ty = visit_type_name(TypeName);
 
   if (first->getValue() == ";") {
-    Decls.push_back(
-        new VarDecl(Ty, Name->getValue(), false, 0, TypeName->getLocation()));
+    Decls.push_back(setEnd(
+        new VarDecl(Ty, Name->getValue(), false, 0, TypeName->getLocation()),
+        Name));
     return;
   }
 
   if (first->getType() == Symbol::paralist ||
       first->getType() == Symbol::compound_stmt) {
-    Decls.push_back(
-        visit_funcdef(Ty, Name->getValue(), N, TypeName->getLocation()));
+    Decls.push_back(setEnd(
+        visit_funcdef(Ty, Name->getValue(), N, TypeName->getLocation()),
+        Name));
     return;
   }
 
   bool IsArray = first->getType() == Symbol::subscript2;
   int ArraySize = IsArray ? visit_subscript2(first) : 0;
-  Decls.push_back(
-      new VarDecl(Ty, Name->getValue(), IsArray, ArraySize, N->getLocation()));
+  Decls.push_back(setEnd(
+      new VarDecl(Ty, Name->getValue(), IsArray, ArraySize, N->getLocation()),
+      IsArray ? first : Name));
 
   for (auto C : N->getChildren()) {
     if (C->getType() != Symbol::var_item)
@@ -189,10 +215,10 @@ void ASTBuilder::visit_decl_trailer(Node *N, Node *TypeName, Node *Name,
 
 StmtAST *ASTBuilder::visit_return_stmt(Node *N) {
   if (N->getNumChildren() == 1)
-    return new ReturnStmt(nullptr, N->getLocation());
+    return setEnd(new ReturnStmt(nullptr, N->getLocation()), N);
 
   auto expr = visit_expr(N->getChild(2));
-  return new ReturnStmt(expr, N->getLocation());
+  return setEnd(new ReturnStmt(expr, N->getLocation()), N);
 }
 
 void ASTBuilder::visit_stmt(Node *N, std::vector<StmtAST *> &Stmts) {
@@ -203,8 +229,10 @@ void ASTBuilder::visit_stmt(Node *N, std::vector<StmtAST *> &Stmts) {
 
   if (first->getType() == Symbol::NAME) {
     if (N->getNumChildren() == 2) {
-      auto call = new CallExpr(first->getValue(), {}, first->getLocation());
-      return Stmts.push_back(new ExprStmt(call, N->getLocation()));
+      auto call = setEnd(
+          new CallExpr(first->getValue(), {}, first->getLocation()), first);
+      return Stmts.push_back(
+          setEnd(new ExprStmt(call, N->getLocation()), first));
     }
     return Stmts.push_back(visit_stmt_trailer(N->getChild(1), first));
   }
@@ -247,7 +275,9 @@ StmtAST *ASTBuilder::visit_if_stmt(Node *N) {
   visit_stmt(stmt, body);
   if (N->getNumChildren() > 5)
     visit_stmt(N->getLastChild(), orelse);
-  return new IfStmt(test, std::move(body), std::move(orelse), N->getLocation());
+  return setEnd(
+      new IfStmt(test, std::move(body), std::move(orelse), N->getLocation()),
+      N);
 }
 
 ExprAST *ASTBuilder::visit_binop(Node *N, ExprContextKind Context) {
@@ -258,7 +288,9 @@ ExprAST *ASTBuilder::visit_binop(Node *N, ExprContextKind Context) {
     auto NextOp = N->getChild(i * 2 + 1);
     auto op = OperatorKindFromString(NextOp->getValue());
     auto tmp = visit_expr(N->getChild(i * 2 + 2), Context);
-    auto tmp_result = new BinOpExpr(result, op, tmp, NextOp->getLocation());
+    auto tmp_result =
+        setEnd(new BinOpExpr(result, op, tmp, NextOp->getLocation()),
+               N->getChild(i * 2 + 2));
     result = tmp_result;
   }
   return result;
@@ -282,17 +314,22 @@ DeclAST *ASTBuilder::visit_funcdef(BasicTypeKind RetTy, std::string Name,
 
 ExprAST *ASTBuilder::visit_condition(Node *N) {
   bool has_cmpop = N->getNumChildren() == 3;
-  return new BoolOpExpr(visit_expr(N), has_cmpop, N->getLocation());
+  return setEnd(new BoolOpExpr(visit_expr(N), has_cmpop, N->getLocation()),
+                N);
 }
 
 StmtAST *ASTBuilder::visit_for_stmt(Node *N) {
   // initial: stmt
   auto Nn = N->getChild(2);
   auto expr = N->getChild(4);
-  auto Initial = new AssignStmt(
-      /* target */ new NameExpr(Nn->getValue(), ExprContextKind::Store,
-                                Nn->getLocation()),
-      /* value */ visit_expr(expr), /* loc */ Nn->getLocation());
+  auto Initial = setEnd(
+      new AssignStmt(
+          /* target */ setEnd(new NameExpr(Nn->getValue(),
+                                           ExprContextKind::Store,
+                                           Nn->getLocation()),
+                              Nn),
+          /* value */ visit_expr(expr), /* loc */ Nn->getLocation()),
+      expr);
 
   // condition: expr
   auto Cond = visit_condition(N->getChild(6));
@@ -303,23 +340,30 @@ StmtAST *ASTBuilder::visit_for_stmt(Node *N) {
   auto op = N->getChild(11);
   auto num = N->getChild(12);
   assert(num->getType() == Symbol::NUMBER);
-  auto L = new NameExpr(name2->getValue(), ExprContextKind::Load,
-                        name2->getLocation());
+  auto L = setEnd(new NameExpr(name2->getValue(), ExprContextKind::Load,
+                               name2->getLocation()),
+                  name2);
   auto R = makeNumExpr(num);
-  auto BO = new BinOpExpr(
-      /* left */ L,
-      /* op */ OperatorKindFromString(op->getValue()),
-      /* right */ R, name2->getLocation());
-  auto Step = new AssignStmt(
-      /* target */ new NameExpr(target->getValue(), ExprContextKind::Store,
-                                target->getLocation()),
-      /* value */ BO,
-      /* loc */ target->getLocation());
+  auto BO = setEnd(new BinOpExpr(
+                       /* left */ L,
+                       /* op */ OperatorKindFromString(op->getValue()),
+                       /* right */ R, name2->getLocation()),
+                   num);
+  auto Step = setEnd(
+      new AssignStmt(
+          /* target */ setEnd(new NameExpr(target->getValue(),
+                                           ExprContextKind::Store,
+                                           target->getLocation()),
+                              target),
+          /* value */ BO,
+          /* loc */ target->getLocation()),
+      num);
 
   // body: stmt*
   std::vector<StmtAST *> Body;
   visit_stmt(N->getLastChild(), Body);
-  return new ForStmt(Initial, Cond, Step, std::move(Body), N->getLocation());
+  return setEnd(
+      new ForStmt(Initial, Cond, Step, std::move(Body), N->getLocation()), N);
 }
 
 void ASTBuilder::visit_paralist(Node *N, std::vector<ArgDecl *> &ParamList) {
@@ -329,10 +373,11 @@ void ASTBuilder::visit_paralist(Node *N, std::vector<ArgDecl *> &ParamList) {
     auto TypeName = N->getChild(1 + i * 3);
     auto Name = N->getChild(2 + i * 3);
 
-    ParamList.push_back(new ArgDecl(
-        /* type */ visit_type_name(TypeName),
-        /* name */ Name->getValue(),
-        /* loc */ TypeName->getLocation()));
+    ParamList.push_back(setEnd(new ArgDecl(
+                                   /* type */ visit_type_name(TypeName),
+                                   /* name */ Name->getValue(),
+                                   /* loc */ TypeName->getLocation()),
+                               Name));
   }
 }
 
@@ -344,30 +389,33 @@ ExprAST *ASTBuilder::visit_factor(Node *N, ExprContextKind Context) {
   auto first = N->getFirstChild();
   auto op = UnaryopKindFromString(first->getValue());
   auto operand = visit_factor(N->getChild(1), Context);
-  return new UnaryOpExpr(op, operand, first->getLocation());
+  return setEnd(new UnaryOpExpr(op, operand, first->getLocation()), N);
 }
 
 StmtAST *ASTBuilder::visit_stmt_trailer(Node *N, Node *Name) {
   auto first = N->getFirstChild();
   if (first->getType() == Symbol::arglist) {
     std::vector<ExprAST *> Args = visit_arglist(first);
-    auto C =
-        new CallExpr(Name->getValue(), std::move(Args), Name->getLocation());
-    return new ExprStmt(C, Name->getLocation());
+    auto C = setEnd(
+        new CallExpr(Name->getValue(), std::move(Args), Name->getLocation()), N);
+    return setEnd(new ExprStmt(C, Name->getLocation()), N);
 
   } else if (first->getValue() == "[") {
     auto Idx = visit_expr(N->getChild(1));
     auto Val = visit_expr(N->getLastChild());
-    auto SB = new SubscriptExpr(Name->getValue(), Idx, ExprContextKind::Store,
-                                N->getLocation());
-    return new AssignStmt(SB, Val, Name->getLocation());
+    auto SB = setEnd(new SubscriptExpr(Name->getValue(), Idx,
+                                       ExprContextKind::Store,
+                                       Name->getLocation()),
+                     N->getChild(2));
+    return setEnd(new AssignStmt(SB, Val, Name->getLocation()), N);
 
   } else {
     assert(first->getValue() == "=");
     auto Val = visit_expr(N->getLastChild());
-    auto Target = new NameExpr(Name->getValue(), ExprContextKind::Store,
-                               Name->getLocation());
-    return new AssignStmt(Target, Val, Name->getLocation());
+    auto Target = setEnd(new NameExpr(Name->getValue(), ExprContextKind::Store,
+                                      Name->getLocation()),
+                         Name);
+    return setEnd(new AssignStmt(Target, Val, Name->getLocation()), N);
   }
 }
 
@@ -391,11 +439,13 @@ StmtAST *ASTBuilder::visit_read_stmt(Node *N) {
   std::vector<NameExpr *> Names;
   std::for_each(std::next(N->begin()), N->end(), [&Names](Node *Child) {
     if (Child->getType() == Symbol::NAME) {
-      Names.push_back(new NameExpr(Child->getValue(), ExprContextKind::Store,
-                                   Child->getLocation()));
+      Names.push_back(setEnd(new NameExpr(Child->getValue(),
+                                          ExprContextKind::Store,
+                                          Child->getLocation()),
+                             Child));
     }
   });
-  return new ReadStmt(std::move(Names), N->getLocation());
+  return setEnd(new ReadStmt(std::move(Names), N->getLocation()), N);
 }
 
 ExprAST *ASTBuilder::visit_expr(Node *N, ExprContextKind Context) {
@@ -423,17 +473,18 @@ DeclAST *ASTBuilder::visit_var_item(Node *N, BasicTypeKind Ty) {
   auto name = N->getFirstChild();
   bool IsArray = N->getNumChildren() > 1;
   int Size = IsArray ? visit_subscript2(N->getChild(1)) : 0;
-  return new VarDecl(Ty,
-      /* name */ name->getValue(),
-      /* IsArray */ IsArray,
-      /* size */ Size, name->getLocation());
+  return setEnd(new VarDecl(Ty,
+                            /* name */ name->getValue(),
+                            /* IsArray */ IsArray,
+                            /* size */ Size, name->getLocation()),
+                N);
 }
 
 StmtAST *ASTBuilder::visit_while_stmt(Node *N) {
   auto Cond = visit_condition(N->getChild(2));
   std::vector<StmtAST *> Body;
   visit_stmt(N->getLastChild(), Body);
-  return new WhileStmt(Cond, std::move(Body), N->getLocation());
+  return setEnd(new WhileStmt(Cond, std::move(Body), N->getLocation()), N);
 }
 
 BasicTypeKind ASTBuilder::visit_type_name(Node *N) {
@@ -442,25 +493,27 @@ BasicTypeKind ASTBuilder::visit_type_name(Node *N) {
 
 int ASTBuilder::visit_subscript2(Node *N) {
   auto Child = N->getChild(1);
-  return evaluate_integer(Child->getValue(), Child->getLocation());
+  return evaluate_integer(Child->getValue(), Child);
 }
 
 CharExpr *ASTBuilder::makeCharExpr(Node *N) {
   assert(N->getType() == Symbol::CHAR);
-  return new CharExpr(static_cast<int>(N->getValue()[1]), N->getLocation());
+  return setEnd(
+      new CharExpr(static_cast<int>(N->getValue()[1]), N->getLocation()), N);
 }
 
 NumExpr *ASTBuilder::makeNumExpr(Node *N) {
   assert(N->getType() == Symbol::NUMBER);
-  auto loc = N->getLocation();
-  return new NumExpr(evaluate_integer(N->getValue(), loc), loc);
+  return setEnd(
+      new NumExpr(evaluate_integer(N->getValue(), N), N->getLocation()), N);
 }
 
-int ASTBuilder::evaluate_integer(const std::string &Str, Location L) {
+int ASTBuilder::evaluate_integer(const std::string &Str, const Node *N) {
   try {
     return std::stoi(Str);
   } catch (std::out_of_range &E) {
-    EM.Error(L, "integer out of range:", Str);
+    EM.Error(SourceRange(N->getLocation(), getEndLocation(N)),
+             "integer out of range:", Str);
     return 0;
   }
 }
@@ -472,3 +525,19 @@ ASTBuilder::Build(const std::string &Filename, const Node *N) {
     return std::move(Ptr);
   return nullptr;
 }
+
+bool ASTBuilder::BuildTopLevelDecl(const Node *N, std::vector<DeclAST *> &Decls) {
+  auto Size = Decls.size();
+  auto NonConstN = const_cast<Node *>(N);
+  if (N->getType() == Symbol::const_decl) {
+    visit_const_decl(NonConstN, Decls);
+  } else {
+    assert(N->getType() == Symbol::declaration);
+    visit_declaration(NonConstN, Decls);
+  }
+  if (EM.IsOk())
+    return false;
+  DeleteAST::apply(Decls.begin() + Size, Decls.end());
+  Decls.resize(Size);
+  return true;
+}
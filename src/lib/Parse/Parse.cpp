@@ -38,4 +38,17 @@ BuildAST(const std::string &Filename, const std::vector<TokenInfo> &TheTokens) {
   return ASTBuilder().Build(Filename, CST.get());
 }
 
+bool BuildTopLevelDecl(const std::vector<TokenInfo> &TheTokens,
+                       std::vector<DeclAST *> &Decls) {
+  if (TheTokens.empty())
+    return true;
+  bool IsConstDecl = TheTokens.front().getString() == "const";
+  Parser P(&CompilerGrammar,
+           IsConstDecl ? Symbol::const_decl : Symbol::declaration);
+  auto CST = P.ParseTokens(TheTokens);
+  if (!CST)
+    return true;
+  return ASTBuilder().BuildTopLevelDecl(CST.get(), Decls);
+}
+
 } // namespace simplecc
\ No newline at end of file
@@ -27,10 +27,15 @@
 
 using namespace simplecc;
 
-Parser::Parser(const Grammar *G) : TheStack(), TheGrammar(G), EM("SyntaxError") {
-  auto Start = G->start;
-  Node *Root = new Node(static_cast<Symbol>(Start), "", Location(0, 0));
-  TheStack.push(StackEntry(G->dfas[Start - NT_OFFSET], 0, Root));
+Parser::Parser(const Grammar *G)
+    : Parser(G, static_cast<Symbol>(G->start)) {}
+
+Parser::Parser(const Grammar *G, Symbol Start)
+    : TheStack(), TheGrammar(G), EM("SyntaxError") {
+  assert(TokenInfo::IsNonTerminal(Start) && "Start must be a non-terminal");
+  Node *Root = new Node(Start, "", Location(0, 0));
+  TheStack.push(
+      StackEntry(G->dfas[static_cast<int>(Start) - NT_OFFSET], 0, Root));
 }
 
 bool Parser::IsAcceptOnlyState(const DFAState *State) {
@@ -102,14 +107,14 @@ void Parser::Pop() {
 int Parser::AddToken(const TokenInfo &T) {
   // fail fast if it is an error token.
   if (T.getType() == Symbol::ERRORTOKEN) {
-    EM.Error(T.getLocation(), "error token", T.getString());
+    EM.Error(T.getRange(), "error token", T.getString());
     return -1;
   }
 
   // classify the token into label value.
   auto Label = Classify(T.getType(), T.getString());
   if (Label < 0) {
-    EM.Error(T.getLocation(), "unexpected token", T.getString());
+    EM.Error(T.getRange(), "unexpected token", T.getString());
     return -1;
   }
 
@@ -153,11 +158,11 @@ int Parser::AddToken(const TokenInfo &T) {
       if (TheState->is_final) {
         Pop();
         if (TheStack.empty()) {
-          EM.Error(T.getLocation(), "too much input");
+          EM.Error(T.getRange(), "too much input");
           return -1;
         }
       } else {
-        EM.Error(T.getLocation(), "unexpected", T.getLine());
+        EM.Error(T.getRange(), "unexpected", T.getLine());
         return -1;
       }
     }
@@ -181,7 +186,7 @@ std::unique_ptr<Node> Parser::ParseTokens(const std::vector<TokenInfo> &Tokens)
   }
   // if not return from the loop above, we are screw by extraordinary input.
   const auto &LastToken = Tokens.back();
-  EM.Error(LastToken.getLocation(), "incomplete input");
+  EM.Error(LastToken.getRange(), "incomplete input");
   return nullptr;
 }
 
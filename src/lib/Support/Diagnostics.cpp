@@ -0,0 +1,179 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "simplecc/Support/Diagnostics.h"
+#include <cassert>
+#include <sstream>
+
+using namespace simplecc;
+
+constexpr unsigned DiagnosticsEngine::MaxBuffered;
+
+/// Write a string as a JSON string literal.
+static void WriteJSONString(std::ostream &O, const std::string &Str) {
+  O << '"';
+  for (char C : Str) {
+    switch (C) {
+    case '"':
+      O << "\\\"";
+      break;
+    case '\\':
+      O << "\\\\";
+      break;
+    case '\n':
+      O << "\\n";
+      break;
+    case '\t':
+      O << "\\t";
+      break;
+    default:
+      if (static_cast<unsigned char>(C) < 0x20) {
+        static const char Hex[] = "0123456789abcdef";
+        O << "\\u00" << Hex[(C >> 4) & 0xf] << Hex[C & 0xf];
+      } else {
+        O << C;
+      }
+    }
+  }
+  O << '"';
+}
+
+/// Write a Location as a JSON object.
+static void WriteJSONLocation(std::ostream &O, Location L) {
+  O << "{\"line\": " << L.getLine() << ", \"column\": " << L.getColumn()
+    << "}";
+}
+
+void Diagnostic::Format(std::ostream &O) const {
+  O << Type;
+  if (HasRange) {
+    O << " at ";
+    Range.getBegin().FormatCompact(O);
+    O << " ";
+  } else {
+    O << ": ";
+  }
+  O << Message;
+}
+
+void Diagnostic::FormatJSON(std::ostream &O) const {
+  O << "{\"type\": ";
+  WriteJSONString(O, Type);
+  if (HasRange) {
+    O << ", \"range\": {\"begin\": ";
+    WriteJSONLocation(O, Range.getBegin());
+    O << ", \"end\": ";
+    WriteJSONLocation(O, Range.getEnd());
+    O << "}";
+  }
+  O << ", \"message\": ";
+  WriteJSONString(O, Message);
+  O << "}";
+}
+
+DiagnosticsEngine &DiagnosticsEngine::get() {
+  static DiagnosticsEngine TheEngine;
+  return TheEngine;
+}
+
+DiagnosticsEngine::~DiagnosticsEngine() { flush(); }
+
+void DiagnosticsEngine::setErrorLimit(unsigned N) {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  ErrorLimit = N;
+  if (!ErrorLimit)
+    LimitReached = false;
+}
+
+void DiagnosticsEngine::setFormat(FormatKind F) {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  flushText();
+  Format = F;
+}
+
+void DiagnosticsEngine::Report(Diagnostic D) {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  if (Capturing) {
+    Captured.push_back(std::move(D));
+    return;
+  }
+  if (LimitReached)
+    return;
+  /// The first diagnostic past the limit is replaced by a note.
+  if (ErrorLimit && NumReported >= ErrorLimit) {
+    LimitReached = true;
+    Buffer.emplace_back("Error", "too many errors emitted, stopping now");
+    return;
+  }
+  Buffer.push_back(std::move(D));
+  ++NumReported;
+  if (Format == TextFormat && Buffer.size() >= MaxBuffered)
+    flushText();
+}
+
+void DiagnosticsEngine::flushText() {
+  if (Format != TextFormat || Buffer.empty())
+    return;
+  std::ostringstream OS;
+  for (const Diagnostic &D : Buffer)
+    OS << D << "\n";
+  std::cerr << OS.str();
+  Buffer.clear();
+}
+
+void DiagnosticsEngine::beginCapture() {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  assert(!Capturing && "Captures do not nest");
+  Capturing = true;
+}
+
+std::vector<Diagnostic> DiagnosticsEngine::endCapture() {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  assert(Capturing && "Not capturing");
+  Capturing = false;
+  std::vector<Diagnostic> Result;
+  Result.swap(Captured);
+  return Result;
+}
+
+void DiagnosticsEngine::flush() {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  flushText();
+}
+
+void DiagnosticsEngine::finish() {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  if (Format == JSONFormat) {
+    std::ostringstream OS;
+    OS << "[";
+    for (unsigned I = 0, E = Buffer.size(); I < E; ++I) {
+      OS << (I ? ",\n " : "");
+      Buffer[I].FormatJSON(OS);
+    }
+    OS << "]\n";
+    std::cerr << OS.str();
+    Buffer.clear();
+  }
+  flushText();
+  NumReported = 0;
+  LimitReached = false;
+}
@@ -0,0 +1,222 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "simplecc/Support/ExecutionProfile.h"
+#include "simplecc/Support/ErrorManager.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <utility>
+
+using namespace simplecc;
+
+constexpr const char *ExecutionProfile::Magic;
+constexpr unsigned ExecutionProfile::Version;
+
+uint64_t ExecutionProfile::FunctionProfile::getTotalCount() const {
+  uint64_t Total = 0;
+  for (const InstructionCount &I : Instructions)
+    Total += I.Count;
+  return Total;
+}
+
+uint64_t
+ExecutionProfile::FunctionProfile::getLineCount(unsigned Lineno) const {
+  auto Iter = Lines.find(Lineno);
+  return Iter == Lines.end() ? 0 : Iter->second;
+}
+
+bool ExecutionProfile::FunctionProfile::findCallCount(
+    unsigned Lineno, const std::string &Callee, uint64_t &Count) const {
+  bool Found = false;
+  Count = 0;
+  /// Several calls to Callee on a line count as one.
+  for (const CallCount &C : Calls) {
+    if (C.Lineno == Lineno && C.Callee == Callee) {
+      Count += C.Count;
+      Found = true;
+    }
+  }
+  return Found;
+}
+
+void ExecutionProfile::FunctionProfile::addInstruction(unsigned Offset,
+                                                       unsigned Lineno,
+                                                       uint64_t Count) {
+  Instructions.push_back(InstructionCount{Offset, Lineno, Count});
+  uint64_t &LineCount = Lines[Lineno];
+  LineCount = std::max(LineCount, Count);
+}
+
+ExecutionProfile::FunctionProfile &
+ExecutionProfile::addFunction(std::string Name, uint64_t EntryCount) {
+  FunctionIndices[Name] = static_cast<unsigned>(Functions.size());
+  Functions.emplace_back(std::move(Name), EntryCount);
+  return Functions.back();
+}
+
+const ExecutionProfile::FunctionProfile *
+ExecutionProfile::getFunction(const std::string &Name) const {
+  auto Iter = FunctionIndices.find(Name);
+  return Iter == FunctionIndices.end() ? nullptr : &Functions[Iter->second];
+}
+
+uint64_t ExecutionProfile::getMaxCallCount() const {
+  uint64_t Max = 0;
+  for (const FunctionProfile &F : Functions)
+    for (const CallCount &C : F.getCalls())
+      Max = std::max(Max, C.Count);
+  return Max;
+}
+
+void ExecutionProfile::Write(std::ostream &O) const {
+  O << Magic << " " << Version << "\n";
+  for (const FunctionProfile &F : Functions) {
+    O << "function " << F.getName() << " " << F.getEntryCount() << "\n";
+    for (const InstructionCount &I : F.getInstructions())
+      O << "bc " << I.Offset << " " << I.Lineno << " " << I.Count << "\n";
+    for (const BlockCount &B : F.getBlocks())
+      O << "block " << B.Begin << " " << B.End << " " << B.Count << "\n";
+    for (const CallCount &C : F.getCalls())
+      O << "call " << C.Offset << " " << C.Lineno << " " << C.Callee << " "
+        << C.Count << "\n";
+    O << "end\n";
+  }
+}
+
+bool ExecutionProfile::Read(const std::string &Filename) {
+  ErrorManager EM("ProfileError");
+  Functions.clear();
+  FunctionIndices.clear();
+
+  std::ifstream File(Filename);
+  if (!File) {
+    EM.setErrorType("FileReadError");
+    EM.Error(Quote(Filename));
+    return true;
+  }
+  std::string Line;
+  std::string Word;
+  unsigned FileVersion;
+  if (!std::getline(File, Line) ||
+      !(std::istringstream(Line) >> Word >> FileVersion) || Word != Magic) {
+    EM.Error(Quote(Filename), "is not a profile");
+    return true;
+  }
+  if (FileVersion != Version) {
+    EM.Error(Quote(Filename), "has version", FileVersion, "but version",
+             Version, "is supported");
+    return true;
+  }
+
+  FunctionProfile *F = nullptr;
+  for (unsigned RecordLine = 2; std::getline(File, Line); ++RecordLine) {
+    std::istringstream Record(Line);
+    if (!(Record >> Word))
+      continue;
+    bool Valid;
+    if (Word == "function") {
+      std::string Name;
+      uint64_t EntryCount;
+      Valid = !F && Record >> Name >> EntryCount && !getFunction(Name);
+      if (Valid)
+        F = &addFunction(Name, EntryCount);
+    } else if (Word == "end") {
+      Valid = F != nullptr;
+      F = nullptr;
+    } else if (Word == "bc") {
+      unsigned Offset, Lineno;
+      uint64_t Count;
+      Valid = F && Record >> Offset >> Lineno >> Count;
+      if (Valid)
+        F->addInstruction(Offset, Lineno, Count);
+    } else if (Word == "block") {
+      unsigned Begin, End;
+      uint64_t Count;
+      Valid = F && Record >> Begin >> End >> Count && Begin < End;
+      if (Valid)
+        F->addBlock(Begin, End, Count);
+    } else if (Word == "call") {
+      unsigned Offset, Lineno;
+      std::string Callee;
+      uint64_t Count;
+      Valid = F && Record >> Offset >> Lineno >> Callee >> Count;
+      if (Valid)
+        F->addCall(Offset, Lineno, Callee, Count);
+    } else {
+      Valid = false;
+    }
+    if (!Valid || Record >> Word) {
+      EM.Error(Quote(Filename), "has a bad record at line", RecordLine);
+      return true;
+    }
+  }
+  if (F) {
+    EM.Error(Quote(Filename), "ends in function", Quote(F->getName()));
+    return true;
+  }
+  return false;
+}
+
+/// Return the percentage of Part in Whole.
+static double Percent(uint64_t Part, uint64_t Whole) {
+  return Whole ? 100.0 * Part / Whole : 0.0;
+}
+
+void ExecutionProfile::Print(std::ostream &O) const {
+  uint64_t Total = 0;
+  for (const FunctionProfile &F : Functions)
+    Total += F.getTotalCount();
+  O << "Total: " << Total << " byte codes run\n";
+
+  /// The functions that ran the most come first.
+  std::vector<const FunctionProfile *> Order;
+  for (const FunctionProfile &F : Functions)
+    Order.push_back(&F);
+  std::stable_sort(Order.begin(), Order.end(),
+                   [](const FunctionProfile *L, const FunctionProfile *R) {
+                     return L->getTotalCount() > R->getTotalCount();
+                   });
+
+  auto OldFlags = O.flags();
+  O << std::fixed << std::setprecision(2);
+  for (const FunctionProfile *F : Order) {
+    O << "\nfunction " << F->getName() << ": " << F->getEntryCount()
+      << " calls, " << F->getTotalCount() << " byte codes run ("
+      << Percent(F->getTotalCount(), Total) << "%)\n";
+    for (const auto &Line : F->getLineCounts())
+      O << "  line " << Line.first << ": " << Line.second << "\n";
+    for (const BlockCount &B : F->getBlocks())
+      O << "  block [" << B.Begin << ", " << B.End << "): " << B.Count << "\n";
+    /// The calls of a line to the same callee are added up, as
+    /// findCallCount() does.
+    std::map<std::pair<unsigned, std::string>, uint64_t> Calls;
+    for (const CallCount &C : F->getCalls())
+      Calls[std::make_pair(C.Lineno, C.Callee)] += C.Count;
+    for (const auto &Call : Calls)
+      O << "  call " << Call.first.second << " at line " << Call.first.first
+        << ": " << Call.second << "\n";
+  }
+  O.flags(OldFlags);
+}
@@ -0,0 +1,62 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "simplecc/Support/OptimizationOptions.h"
+
+namespace simplecc {
+OptimizationOptions OptimizationOptions::getDefault(unsigned OptLevel) {
+  OptimizationOptions Options;
+  Options.OptLevel = OptLevel;
+  /// -O3 trades code size for fewer calls and branches.
+  if (OptLevel >= 3) {
+    Options.InlineThreshold = 100;
+    Options.UnrollFactor = 8;
+  }
+  return Options;
+}
+
+bool IsKnownPass(const std::string &Name) {
+#define HANDLE_AST_PASS(PassName, Description)                                 \
+  if (Name == PassName)                                                        \
+    return true;
+#define HANDLE_IR_PASS(PassName, Description)                                  \
+  if (Name == PassName)                                                        \
+    return true;
+#include "simplecc/Support/Passes.def"
+  return false;
+}
+
+std::vector<std::string> ParsePassList(const std::string &List) {
+  std::vector<std::string> Passes;
+  std::string::size_type Begin = 0;
+  while (Begin <= List.size()) {
+    auto End = List.find(',', Begin);
+    if (End == std::string::npos)
+      End = List.size();
+    if (End != Begin)
+      Passes.push_back(List.substr(Begin, End - Begin));
+    Begin = End + 1;
+  }
+  return Passes;
+}
+} // namespace simplecc
@@ -127,6 +127,20 @@ void ByteCodeToMipsTranslator::visitUnaryNegative(const ByteCode &C) {
   WriteLine("sw, $t0, 4($sp)");
 }
 
+void ByteCodeToMipsTranslator::visitShift(const char *Op, const ByteCode &C) {
+  WriteLine("lw $t0, 4($sp)");
+  WriteLine(Op, "$t0, $t0,", C.getIntOperand());
+  WriteLine("sw $t0, 4($sp)");
+}
+
+void ByteCodeToMipsTranslator::visitMultiplyHigh(const ByteCode &C) {
+  WriteLine("lw $t0, 4($sp)");
+  WriteLine("li $t1,", C.getIntOperand());
+  WriteLine("mult $t0, $t1");
+  WriteLine("mfhi $t0");
+  WriteLine("sw $t0, 4($sp)");
+}
+
 void ByteCodeToMipsTranslator::visitCallFunction(const ByteCode &C) {
   GlobalLabel Fn(C.getStrOperand(), /* NeedColon */ false);
   WriteLine("jal", Fn);
@@ -230,6 +244,126 @@ void ByteCodeToMipsTranslator::visitBinaryJumpIf(const char *Op,
   WriteLine(Op, "$t1, $t0,", Label);
 }
 
+void ByteCodeToMipsTranslator::WriteAddImmediate(int K) {
+  /// The immediate of addiu has 16 bits.
+  if (K >= -32768 && K <= 32767) {
+    WriteLine("addiu $t0, $t0,", K);
+    return;
+  }
+  WriteLine("li $t1,", K);
+  WriteLine("addu $t0, $t0, $t1");
+}
+
+void ByteCodeToMipsTranslator::visitIncLocal(const SuperInstruction &SI) {
+  auto Offset = TheContext.getLocalOffset(SI.Local);
+  WriteLine("lw $t0,", Offset, "($fp)");
+  WriteAddImmediate(SI.Constant);
+  WriteLine("sw $t0,", Offset, "($fp)");
+}
+
+void ByteCodeToMipsTranslator::visitLoadLocalAddConst(
+    const SuperInstruction &SI) {
+  WriteLine("lw $t0,", TheContext.getLocalOffset(SI.Local), "($fp)");
+  WriteAddImmediate(SI.Constant);
+  PUSH("$t0");
+}
+
+void ByteCodeToMipsTranslator::visitMoveLocal(const SuperInstruction &SI) {
+  WriteLine("lw $t0,", TheContext.getLocalOffset(SI.Source), "($fp)");
+  WriteLine("sw $t0,", TheContext.getLocalOffset(SI.Local), "($fp)");
+}
+
+void ByteCodeToMipsTranslator::visitStoreLocalConst(
+    const SuperInstruction &SI) {
+  WriteLine("li $t0,", SI.Constant);
+  WriteLine("sw $t0,", TheContext.getLocalOffset(SI.Local), "($fp)");
+}
+
+void ByteCodeToMipsTranslator::visitAddConst(const SuperInstruction &SI) {
+  WriteLine("lw $t0, 4($sp)");
+  WriteAddImmediate(SI.Constant);
+  WriteLine("sw $t0, 4($sp)");
+}
+
+void ByteCodeToMipsTranslator::visitAddLocal(const SuperInstruction &SI) {
+  WriteLine("lw $t0, 4($sp)");
+  WriteLine("lw $t1,", TheContext.getLocalOffset(SI.Local), "($fp)");
+  WriteLine("addu $t0, $t0, $t1");
+  WriteLine("sw $t0, 4($sp)");
+}
+
+void ByteCodeToMipsTranslator::visitSubLocal(const SuperInstruction &SI) {
+  WriteLine("lw $t0, 4($sp)");
+  WriteLine("lw $t1,", TheContext.getLocalOffset(SI.Local), "($fp)");
+  WriteLine("subu $t0, $t0, $t1");
+  WriteLine("sw $t0, 4($sp)");
+}
+
+/// Return the branch that jumps if Jump does.
+static const char *getBranchName(ByteCode::Opcode Jump) {
+  switch (Jump) {
+  case ByteCode::JUMP_IF_EQUAL:
+    return "beq";
+  case ByteCode::JUMP_IF_NOT_EQUAL:
+    return "bne";
+  case ByteCode::JUMP_IF_GREATER:
+    return "bgt";
+  case ByteCode::JUMP_IF_GREATER_EQUAL:
+    return "bge";
+  case ByteCode::JUMP_IF_LESS:
+    return "blt";
+  case ByteCode::JUMP_IF_LESS_EQUAL:
+    return "ble";
+  default:
+    assert(false && "Not a compare");
+    return nullptr;
+  }
+}
+
+void ByteCodeToMipsTranslator::visitCompareLocalConst(
+    const SuperInstruction &SI) {
+  WriteLine("lw $t1,", TheContext.getLocalOffset(SI.Local), "($fp)");
+  WriteLine("li $t0,", SI.Constant);
+  JumpTargetLabel Label(TheContext.getFuncName(), SI.Target,
+                        /* NeedColon */ false);
+  WriteLine(getBranchName(SuperInstruction::getJump(SI.getOpcode())),
+            "$t1, $t0,", Label);
+}
+
+void ByteCodeToMipsTranslator::visitCompareLocals(const SuperInstruction &SI) {
+  WriteLine("lw $t1,", TheContext.getLocalOffset(SI.Local), "($fp)");
+  WriteLine("lw $t0,", TheContext.getLocalOffset(SI.Source), "($fp)");
+  JumpTargetLabel Label(TheContext.getFuncName(), SI.Target,
+                        /* NeedColon */ false);
+  WriteLine(getBranchName(SuperInstruction::getJump(SI.getOpcode())),
+            "$t1, $t0,", Label);
+}
+
+void ByteCodeToMipsTranslator::Write(const ByteCode &C,
+                                     const SuperInstruction &SI) {
+  unsigned Off = C.getByteCodeOffset();
+  if (TheContext.IsJumpTarget(Off)) {
+    WriteLine(JumpTargetLabel(TheContext.getFuncName(), Off, /* NeedColon */ true));
+  }
+  WriteLine("#", SI.getOpcodeName());
+  switch (SI.getOpcode()) {
+#define HANDLE_SUPER_INSTRUCTION(Opcode, camelName)                            \
+  case SuperInstruction::Opcode:                                               \
+    visit##camelName(SI);                                                      \
+    break;
+#define HANDLE_COMPARE_LOCAL_CONST(Opcode, camelName, Jump)                    \
+  case SuperInstruction::Opcode:                                               \
+    visitCompareLocalConst(SI);                                                \
+    break;
+#define HANDLE_COMPARE_LOCALS(Opcode, camelName, Jump)                         \
+  case SuperInstruction::Opcode:                                               \
+    visitCompareLocals(SI);                                                    \
+    break;
+#include "simplecc/CodeGen/SuperInstruction.def"
+  }
+  WriteLine();
+}
+
 /// ByteCodeToMipsTranslator::Wrap OpcodeDispatcher::dispatch() to provide label
 /// generation.
 void ByteCodeToMipsTranslator::Write(const ByteCode &C) {
@@ -27,58 +27,70 @@
 
 using namespace simplecc;
 
-/// Initialize the **local offset** dictionary for a function.
-/// The LocalOffsets is where local variables live on the stack.
+/// Initialize the **local offset** table for a function.
+/// The LocalOffsets is where local variables live on the stack,
+/// indexed by local slot. Temporaries are laid out after them.
 void LocalContext::InitializeLocalOffsets() {
   // offset points to the first vacant byte after storing
   // $ra and $fp. $ra is at 0($fp), $fp is at -4($fp)
-  LocalOffsets.clear();
+  LocalSymbolTable Table = TheFunction->getLocalTable();
+  LocalOffsets.assign(Table.size(), 0);
   signed Off = -BytesFromEntries(2);
 
-  /// Allocate space for formal arguments.
-  for (const SymbolEntry &Arg : TheFunction->getFormalArguments()) {
-    LocalOffsets.emplace(Arg.getName(), Off);
-    Off -= BytesFromEntries(1);
-  }
-
-  /// Allocate space for non-arg local variables.
-  for (const SymbolEntry &Var : TheFunction->getLocalVariables()) {
-    if (Var.IsArray()) {
-      Off -= BytesFromEntries(Var.AsArray().getSize());
-      LocalOffsets.emplace(Var.getName(), Off + BytesFromEntries(1));
-      continue;
+  /// Arguments come first, then the local objects and the temporaries.
+  auto Layout = [&](const SymbolEntry &E) {
+    if (E.IsArray()) {
+      Off -= BytesFromEntries(E.AsArray().getSize());
+      LocalOffsets[E.getSlot()] = Off + BytesFromEntries(1);
+      return;
     }
     /// Variable:
-    assert(Var.IsVariable() && "Local objects must be Variable or Array");
-    LocalOffsets.emplace(Var.getName(), Off);
+    assert(E.IsVariable() && "Local objects must be Variable or Array");
+    LocalOffsets[E.getSlot()] = Off;
     Off -= BytesFromEntries(1);
-  }
-}
+  };
+  for (const SymbolEntry &E : TheFunction->getFormalArguments())
+    Layout(E);
+  for (const SymbolEntry &E : TheFunction->getLocalVariables())
+    Layout(E);
 
-/// Initialize the **jump targets** set, which tells us whether an offset
-/// in the ByteCode stream is a target of some jump command.
-void LocalContext::InitializeJumpTargets() {
-  JumpTargets.clear();
-  for (const ByteCode &C : *TheFunction) {
-    if (C.IsJump()) {
-      JumpTargets.insert(C.getJumpTarget());
+  TemporaryOffsets.clear();
+  for (const auto &T : TheFunction->getTemporaries()) {
+    if (T.IsArray()) {
+      Off -= BytesFromEntries(T.Size);
+      signed Base = Off + BytesFromEntries(1);
+      TemporaryOffsets.emplace(T.Name, std::make_pair(Base, true));
+      continue;
     }
+    TemporaryOffsets.emplace(T.Name, std::make_pair(Off, false));
+    Off -= BytesFromEntries(1);
   }
+  LocalObjectsInBytes = -BytesFromEntries(2) - Off;
 }
 
 // Return the offset of local name related to frame pointer
 signed int LocalContext::getLocalOffset(const char *Name) const {
-  assert(LocalOffsets.count(Name) && "Undefined Name");
-  return LocalOffsets.find(Name)->second;
+  auto Iter = TemporaryOffsets.find(Name);
+  if (Iter != TemporaryOffsets.end())
+    return Iter->second.first;
+  SymbolEntry E = TheFunction->getLocalTable()[Name];
+  assert(E.IsLocal() && !E.IsConstant() && "Undefined Name");
+  return LocalOffsets[E.getSlot()];
 }
 
 // Return whether a name is a variable
 bool LocalContext::IsVariable(const char *Name) const {
+  auto Iter = TemporaryOffsets.find(Name);
+  if (Iter != TemporaryOffsets.end())
+    return !Iter->second.second;
   return TheFunction->getLocalTable()[Name].IsVariable();
 }
 
 // Return whether a name is an array
 bool LocalContext::IsArray(const char *Name) const {
+  auto Iter = TemporaryOffsets.find(Name);
+  if (Iter != TemporaryOffsets.end())
+    return Iter->second.second;
   return TheFunction->getLocalTable()[Name].IsArray();
 }
 
@@ -86,9 +98,9 @@ const std::string &LocalContext::getFuncName() const {
   return TheFunction->getName();
 }
 
-/// Initialize both LocalOffsets and JumpTargets.
+/// Initialize both LocalOffsets and the CFG.
 void LocalContext::Initialize(const ByteCodeFunction &F) {
   TheFunction = &F;
   InitializeLocalOffsets();
-  InitializeJumpTargets();
+  CFG.recalculate(F);
 }
\ No newline at end of file
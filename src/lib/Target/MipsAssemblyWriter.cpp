@@ -24,9 +24,9 @@
 #include "simplecc/Analysis/Types.h" // SymbolEntry
 #include "simplecc/CodeGen/ByteCodeFunction.h"
 #include "simplecc/CodeGen/ByteCodeModule.h"
+#include "simplecc/CodeGen/SuperInstruction.h"
 #include "simplecc/Target/ByteCodeToMipsTranslator.h"
 
-#include <numeric> // accumulate()
 
 using namespace simplecc;
 
@@ -58,13 +58,16 @@ void MipsAssemblyWriter::WriteData(Printer &W, const ByteCodeModule &Module) {
 // variables, arrays and formal arguments.
 int MipsAssemblyWriter::getLocalObjectsInBytes(
     const ByteCodeFunction &TheFunction) const {
-  int Entries = std::accumulate(
-      TheFunction.local_begin(), TheFunction.local_end(),
-      TheFunction.getFormalArgumentCount(),
-      [](unsigned Entries, const SymbolEntry &E) {
-        return Entries + (E.IsArray() ? E.AsArray().getSize() : 1);
-      });
-  return BytesFromEntries(Entries);
+  /// The frame layout has been computed over the local slots.
+  assert(TheContext.getFuncName() == TheFunction.getName() &&
+         "LocalContext must be initialized for this function");
+  return TheContext.getLocalObjectsInBytes();
+}
+
+bool MipsAssemblyWriter::isLeaf(const ByteCodeFunction &TheFunction) const {
+  int Idx = TheCallGraph.getIndex(TheFunction.getName());
+  assert(Idx >= 0 && "Function not in the CallGraph");
+  return TheCallGraph.isLeaf(Idx);
 }
 
 void MipsAssemblyWriter::WriteFunction(Printer &W,
@@ -72,9 +75,19 @@ void MipsAssemblyWriter::WriteFunction(Printer &W,
   TheContext.Initialize(TheFunction);
   ByteCodeToMipsTranslator TheTranslator(W.getOuts(), TheContext);
 
+  SuperInstructionSelector Selector;
+  Selector.Select(TheFunction);
+
   WritePrologue(W, TheFunction);
-  for (const ByteCode &C : TheFunction) {
+  for (unsigned I = 0; I < TheFunction.size();) {
+    const ByteCode &C = TheFunction.getByteCodeAt(I);
+    if (const SuperInstruction *SI = Selector.getSuperInstructionAt(I)) {
+      TheTranslator.Write(C, *SI);
+      I += SI->getLength();
+      continue;
+    }
     TheTranslator.Write(C);
+    ++I;
   }
   WriteEpilogue(W, TheFunction);
 }
@@ -88,9 +101,13 @@ void MipsAssemblyWriter::WriteText(Printer &W, const ByteCodeModule &Module) {
   W.WriteLine();
   W.WriteLine("# User defined functions");
 
+  unsigned Idx = 0;
   for (const ByteCodeFunction *Fn : Module) {
-    WriteFunction(W, *Fn);
-    W.WriteLine();
+    /// Nothing can call an unreachable function.
+    if (TheCallGraph.isReachable(Idx++)) {
+      WriteFunction(W, *Fn);
+      W.WriteLine();
+    }
   }
   W.WriteLine("# End of text segment");
 }
@@ -99,7 +116,9 @@ void MipsAssemblyWriter::WritePrologue(Printer &W,
                                        const ByteCodeFunction &TheFunction) {
   W.WriteLine(GlobalLabel(TheFunction.getName(), /* NeedColon */ true));
   W.WriteLine("# Prologue");
-  W.WriteLine("sw $ra, 0($sp)");
+  /// A leaf function never changes $ra. Its slot stays to keep the layout.
+  if (!isLeaf(TheFunction))
+    W.WriteLine("sw $ra, 0($sp)");
   W.WriteLine("sw $fp, -4($sp)");
   W.WriteLine("move $fp, $sp");
   W.WriteLine("addiu $sp, $sp,", -BytesFromEntries(2));
@@ -136,13 +155,15 @@ void MipsAssemblyWriter::WriteEpilogue(Printer &W,
                                        const ByteCodeFunction &TheFunction) {
   W.WriteLine("# Epilogue");
   W.WriteLine(ReturnLabel(TheFunction.getName(), /* NeedColon */ true));
-  W.WriteLine("lw $ra, 0($fp)");
+  if (!isLeaf(TheFunction))
+    W.WriteLine("lw $ra, 0($fp)");
   W.WriteLine("move $sp, $fp");
   W.WriteLine("lw $fp, -4($fp)");
   W.WriteLine("jr $ra");
 }
 
 void MipsAssemblyWriter::Write(const ByteCodeModule &M, std::ostream &O) {
+  TheCallGraph.Build(M);
   Printer ThePrinter(O);
   WriteData(ThePrinter, M);
   ThePrinter.WriteLine();
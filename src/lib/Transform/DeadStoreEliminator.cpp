@@ -0,0 +1,251 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "simplecc/Transform/DeadStoreEliminator.h"
+#include "simplecc/AST/ChildrenVisitor.h"
+#include <algorithm>
+
+using namespace simplecc;
+
+namespace {
+/// Collect the names an AST refers to, whether it calls a function and
+/// whether it may stop with a runtime error.
+class NameCollector : ChildrenVisitor<NameCollector> {
+  friend VisitorBase;
+  friend ChildrenVisitor;
+  void visitName(NameExpr *N) { Names.insert(N->getName()); }
+  void visitCall(CallExpr *C) {
+    HasCall = true;
+    ChildrenVisitor::visitCall(C);
+  }
+  void visitBinOp(BinOpExpr *B) {
+    /// Only a constant divisor is known not to be 0.
+    if (B->getOp() == BinaryOpKind::Div &&
+        (!B->getRight()->isConstant() || B->getRight()->isZeroVal()))
+      MayTrap = true;
+    ChildrenVisitor::visitBinOp(B);
+  }
+  void visitSubscript(SubscriptExpr *SB) {
+    MayTrap = true;
+    ChildrenVisitor::visitSubscript(SB);
+  }
+
+public:
+  explicit NameCollector(std::unordered_set<std::string> &Names)
+      : Names(Names) {}
+  void Collect(ExprAST *E) { visitExpr(E); }
+  void Collect(StmtAST *S) { visitStmt(S); }
+  bool hasCall() const { return HasCall; }
+  bool mayTrap() const { return MayTrap; }
+
+private:
+  std::unordered_set<std::string> &Names;
+  bool HasCall = false;
+  bool MayTrap = false;
+};
+} // namespace
+
+void DeadStoreEliminator::addUses(ExprAST *E, LiveSetType &Live) const {
+  std::unordered_set<std::string> Names;
+  NameCollector(Names).Collect(E);
+  for (const std::string &Name : Names) {
+    if (Locals.count(Name))
+      Live.insert(Name);
+  }
+}
+
+bool DeadStoreEliminator::isDeadStore(StmtAST *S,
+                                      const LiveSetType &Live) const {
+  auto A = subclass_cast<AssignStmt>(S);
+  if (!A)
+    return false;
+  auto Target = subclass_cast<NameExpr>(A->getTarget());
+  if (!Target || !Locals.count(Target->getName()) ||
+      Live.count(Target->getName()))
+    return false;
+  std::unordered_set<std::string> Names;
+  NameCollector Collector(Names);
+  Collector.Collect(A->getValue());
+  return !Collector.hasCall() && !Collector.mayTrap();
+}
+
+DeadStoreEliminator::LiveSetType
+DeadStoreEliminator::visitStmt(StmtAST *S, LiveSetType Live, bool Delete) {
+  switch (S->getKind()) {
+  case StmtAST::AssignStmtKind: {
+    auto A = static_cast<AssignStmt *>(S);
+    if (auto Target = subclass_cast<NameExpr>(A->getTarget())) {
+      /// The value of a variable that is not live is read by no one.
+      if (Locals.count(Target->getName()) && !Live.erase(Target->getName()) &&
+          isDeadStore(S, Live))
+        return Live;
+    } else {
+      addUses(A->getTarget(), Live);
+    }
+    addUses(A->getValue(), Live);
+    return Live;
+  }
+  case StmtAST::ReadStmtKind:
+    for (NameExpr *N : static_cast<ReadStmt *>(S)->getNames()) {
+      Live.erase(N->getName());
+    }
+    return Live;
+  case StmtAST::WriteStmtKind: {
+    auto W = static_cast<WriteStmt *>(S);
+    if (W->getValue())
+      addUses(W->getValue(), Live);
+    return Live;
+  }
+  case StmtAST::ExprStmtKind:
+    addUses(static_cast<ExprStmt *>(S)->getValue(), Live);
+    return Live;
+  case StmtAST::ReturnStmtKind: {
+    /// Nothing local lives after a return.
+    auto R = static_cast<ReturnStmt *>(S);
+    Live.clear();
+    if (R->getValue())
+      addUses(R->getValue(), Live);
+    return Live;
+  }
+  case StmtAST::IfStmtKind: {
+    auto I = static_cast<IfStmt *>(S);
+    LiveSetType Then = visitStmtList(I->getThen(), Live, Delete);
+    LiveSetType Else = visitStmtList(I->getElse(), std::move(Live), Delete);
+    Then.insert(Else.begin(), Else.end());
+    addUses(I->getCondition(), Then);
+    return Then;
+  }
+  case StmtAST::WhileStmtKind:
+    return visitWhile(static_cast<WhileStmt *>(S), Live, Delete);
+  case StmtAST::ForStmtKind:
+    return visitFor(static_cast<ForStmt *>(S), Live, Delete);
+  }
+  assert(false && "Unhandled StmtAST subclasses");
+  return Live;
+}
+
+void DeadStoreEliminator::visitKeptAssign(StmtAST *S, LiveSetType &Live) {
+  auto A = static_cast<AssignStmt *>(S);
+  if (auto Target = subclass_cast<NameExpr>(A->getTarget()))
+    Live.erase(Target->getName());
+  else
+    addUses(A->getTarget(), Live);
+  addUses(A->getValue(), Live);
+}
+
+DeadStoreEliminator::LiveSetType
+DeadStoreEliminator::visitWhile(WhileStmt *W, const LiveSetType &Live,
+                                bool Delete) {
+  /// Before the condition, what is live after the loop or before the body.
+  LiveSetType Head;
+  for (;;) {
+    LiveSetType Next = Live;
+    LiveSetType Body = visitStmtList(W->getBody(), Head, false);
+    Next.insert(Body.begin(), Body.end());
+    addUses(W->getCondition(), Next);
+    if (Next == Head)
+      break;
+    Head = std::move(Next);
+  }
+  if (Delete)
+    visitStmtList(W->getBody(), Head, true);
+  return Head;
+}
+
+DeadStoreEliminator::LiveSetType
+DeadStoreEliminator::visitFor(ForStmt *F, const LiveSetType &Live,
+                              bool Delete) {
+  /// The body runs first, then the step and the condition, which goes back to
+  /// the body or leaves the loop.
+  LiveSetType BodyIn;
+  LiveSetType StepIn;
+  for (;;) {
+    StepIn = Live;
+    StepIn.insert(BodyIn.begin(), BodyIn.end());
+    addUses(F->getCondition(), StepIn);
+    visitKeptAssign(F->getStep(), StepIn);
+    LiveSetType Next = visitStmtList(F->getBody(), StepIn, false);
+    if (Next == BodyIn)
+      break;
+    BodyIn = std::move(Next);
+  }
+  if (Delete)
+    visitStmtList(F->getBody(), StepIn, true);
+  LiveSetType In = std::move(BodyIn);
+  visitKeptAssign(F->getInitial(), In);
+  return In;
+}
+
+DeadStoreEliminator::LiveSetType
+DeadStoreEliminator::visitStmtList(StmtListType &StmtList, LiveSetType Live,
+                                   bool Delete) {
+  for (auto Iter = StmtList.rbegin(); Iter != StmtList.rend();) {
+    if (Delete && isDeadStore(*Iter, Live)) {
+      DeleteAST::apply(*Iter);
+      /// Erase through the base iterator, which points one past *Iter.
+      Iter = StmtListType::reverse_iterator(StmtList.erase(std::next(Iter).base()));
+      continue;
+    }
+    Live = visitStmt(*Iter, std::move(Live), Delete);
+    ++Iter;
+  }
+  return Live;
+}
+
+void DeadStoreEliminator::removeUnusedVarDecls(FuncDef *FD) {
+  std::unordered_set<std::string> Used;
+  NameCollector Collector(Used);
+  for (StmtAST *S : FD->getStmts()) {
+    Collector.Collect(S);
+  }
+  auto &Decls = FD->getDecls();
+  auto End = std::remove_if(Decls.begin(), Decls.end(), [&](DeclAST *D) {
+    auto VD = subclass_cast<VarDecl>(D);
+    if (!VD || VD->isArray() || Used.count(VD->getName()))
+      return false;
+    DeleteAST::apply(VD);
+    return true;
+  });
+  Decls.erase(End, Decls.end());
+}
+
+void DeadStoreEliminator::visitFuncDef(FuncDef *FD) {
+  Locals.clear();
+  for (ArgDecl *A : FD->getArgs()) {
+    Locals.insert(A->getName());
+  }
+  for (DeclAST *D : FD->getDecls()) {
+    auto VD = subclass_cast<VarDecl>(D);
+    if (VD && !VD->isArray())
+      Locals.insert(VD->getName());
+  }
+  visitStmtList(FD->getStmts(), LiveSetType(), true);
+  removeUnusedVarDecls(FD);
+}
+
+void DeadStoreEliminator::Transform(ProgramAST *P) {
+  for (DeclAST *D : P->getDecls()) {
+    if (auto FD = subclass_cast<FuncDef>(D))
+      visitFuncDef(FD);
+  }
+}
@@ -22,12 +22,28 @@
 
 #include "simplecc/Transform/Transform.h"
 #include "simplecc/Transform/DeadCodeEliminator.h"
+#include "simplecc/Transform/DeadStoreEliminator.h"
 #include "simplecc/Transform/TrivialConstantFolder.h"
 
 namespace simplecc {
-void TransformProgram(ProgramAST *P, SymbolTable &S) {
+void TransformProgram(ProgramAST *P, SymbolTable &S,
+                      const OptimizationOptions &Options) {
+  if (Options.hasCustomPipeline()) {
+    for (const std::string &Pass : Options.Passes) {
+      if (Pass == "fold")
+        TrivialConstantFolder().Transform(P, S);
+      else if (Pass == "dce")
+        DeadCodeEliminator().Transform(P);
+      else if (Pass == "dse")
+        DeadStoreEliminator().Transform(P);
+    }
+    return;
+  }
+  if (Options.OptLevel == 0)
+    return;
   TrivialConstantFolder().Transform(P, S);
   DeadCodeEliminator().Transform(P);
+  DeadStoreEliminator().Transform(P);
 }
 
 } // namespace simplecc
\ No newline at end of file
@@ -21,7 +21,9 @@
 // SOFTWARE.
 
 #include "simplecc/Transform/TrivialConstantFolder.h"
+#include "simplecc/Analysis/TypeEvaluator.h"
 #include <functional>
+#include <memory>
 
 using namespace simplecc;
 
@@ -86,9 +88,9 @@ ExprAST *TrivialConstantFolder::FoldBinOpExpr(BinOpExpr *B) {
   case BinaryOpKind::Add:
     // 0 + X == X + 0 == X
     if (L->isZeroVal())
-      return (std::move(*B).getRight().release());
+      return KeepInt(std::move(*B).getRight().release(), B->getLocation());
     if (R->isZeroVal())
-      return (std::move(*B).getLeft().release());
+      return KeepInt(std::move(*B).getLeft().release(), B->getLocation());
     return B;
   case BinaryOpKind::Sub:
     // 0 - X == -X
@@ -104,15 +106,15 @@ ExprAST *TrivialConstantFolder::FoldBinOpExpr(BinOpExpr *B) {
       return new NumExpr(0, B->getLocation());
     // 1 * X == X * 1 == X
     if (L->isOneVal())
-      return std::move(*B).getRight().release();
+      return KeepInt(std::move(*B).getRight().release(), B->getLocation());
     if (R->isOneVal())
-      return std::move(*B).getLeft().release();
+      return KeepInt(std::move(*B).getLeft().release(), B->getLocation());
     return B;
   case BinaryOpKind::Div:
     // 0 / X == 0, but X may be zero, which will cause a ZeroDivisor. Lose
     // opportunity. X / 1 == X
     if (R->isOneVal())
-      return std::move(*B).getLeft().release();
+      return KeepInt(std::move(*B).getLeft().release(), B->getLocation());
     return B;
   default:return B;
   }
@@ -121,7 +123,7 @@ ExprAST *TrivialConstantFolder::FoldBinOpExpr(BinOpExpr *B) {
 ExprAST *TrivialConstantFolder::FoldUnaryOpExpr(UnaryOpExpr *U) {
   // Case-1: Ignore UAdd, +X => X
   if (U->getOp() == UnaryOpKind::UAdd) {
-    return std::move(*U).getOperand().release();
+    return KeepInt(std::move(*U).getOperand().release(), U->getLocation());
   }
   // Case-2: Compute negate of constant like -1, -2.
   assert(U->getOp() == UnaryOpKind::USub);
@@ -134,14 +136,14 @@ ExprAST *TrivialConstantFolder::FoldUnaryOpExpr(UnaryOpExpr *U) {
   if (IsInstance<UnaryOpExpr>(Operand) &&
       static_cast<UnaryOpExpr *>(Operand)->getOp() == UnaryOpKind::USub) {
     auto UO = static_cast<UnaryOpExpr *>(Operand);
-    return std::move(*UO).getOperand().release();
+    return KeepInt(std::move(*UO).getOperand().release(), U->getLocation());
   }
   return U;
 }
 
 ExprAST *TrivialConstantFolder::FoldParenExpr(ParenExpr *P) {
-  // Extract wrapped value, (X) => X
-  return (std::move(*P).getValue().release());
+  // Extract wrapped value, (X) => X, unless X is a char.
+  return KeepInt(std::move(*P).getValue().release(), P->getLocation());
 }
 
 ExprAST *TrivialConstantFolder::FoldNameExpr(NameExpr *N) {
@@ -157,6 +159,16 @@ ExprAST *TrivialConstantFolder::FoldNameExpr(NameExpr *N) {
   }
 }
 
+ExprAST *TrivialConstantFolder::KeepInt(ExprAST *E, Location Loc) {
+  if (TypeEvaluator::getExprType(E, getLocalTable()) !=
+      BasicTypeKind::Character)
+    return E;
+  std::unique_ptr<ExprAST> Char(E);
+  if (Char->isConstant())
+    return new NumExpr(Char->getConstantValue(), Loc);
+  return new ParenExpr(Char.release(), Loc);
+}
+
 ExprAST *TrivialConstantFolder::FoldExprAST(ExprAST *E) {
   switch (E->getKind()) {
 #define HANDLE_CONST_FOLD(Class)                                               \
@@ -0,0 +1,509 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "simplecc/VM/Interpreter.h"
+#include "simplecc/CodeGen/ByteCodeCFG.h"
+#include "simplecc/CodeGen/ByteCodeFunction.h"
+#include "simplecc/CodeGen/ByteCodeModule.h"
+#include "simplecc/CodeGen/CodeGen.h"
+#include "simplecc/Support/ExecutionProfile.h"
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+using namespace simplecc;
+
+/// Use threaded dispatch if labels can be taken as values.
+#if defined(__GNUC__)
+#define SIMPLECC_VM_THREADED_DISPATCH 1
+#else
+#define SIMPLECC_VM_THREADED_DISPATCH 0
+#endif
+
+constexpr unsigned Interpreter::MemorySize;
+constexpr unsigned Interpreter::MaxCallDepth;
+
+/// Arithmetic wraps around as it does on the target.
+static inline int WrapAdd(int L, int R) {
+  return static_cast<int>(static_cast<unsigned>(L) + static_cast<unsigned>(R));
+}
+static inline int WrapSub(int L, int R) {
+  return static_cast<int>(static_cast<unsigned>(L) - static_cast<unsigned>(R));
+}
+static inline int WrapMul(int L, int R) {
+  return static_cast<int>(static_cast<unsigned>(L) * static_cast<unsigned>(R));
+}
+
+/// The conditions of the jumps that compare two values.
+static inline bool CompareJUMP_IF_EQUAL(int L, int R) { return L == R; }
+static inline bool CompareJUMP_IF_NOT_EQUAL(int L, int R) { return L != R; }
+static inline bool CompareJUMP_IF_GREATER(int L, int R) { return L > R; }
+static inline bool CompareJUMP_IF_GREATER_EQUAL(int L, int R) { return L >= R; }
+static inline bool CompareJUMP_IF_LESS(int L, int R) { return L < R; }
+static inline bool CompareJUMP_IF_LESS_EQUAL(int L, int R) { return L <= R; }
+
+int Interpreter::ReadInteger(std::istream &IS) {
+  int Val;
+  if (IS >> Val)
+    return Val;
+  IS.clear();
+  return 0;
+}
+
+int Interpreter::ReadCharacter(std::istream &IS) {
+  char Val;
+  if (IS >> Val)
+    return Val;
+  IS.clear();
+  return 0;
+}
+
+void Interpreter::Error(const EncodedFunction &F, unsigned Offset,
+                        const char *Msg) {
+  /// Name the function the line is in, which inlined code does not run in.
+  int Source = F.getSourceFunction(Offset);
+  EM.Error(Location(F.getSourceLineno(Offset), 0), Msg, "in function",
+           Source < 0 ? F.getName() : TheModule->getFunctionName(Source));
+}
+
+template <bool Profiling>
+bool Interpreter::Execute(unsigned Main, std::istream &IS, std::ostream &OS) {
+  /// What a call saves to return.
+  struct Frame {
+    const EncodedFunction *Fn;
+    const uint8_t *ReturnPC;
+    int *FP;
+    uint64_t *Hits;
+  };
+  std::vector<int> Memory(MemorySize);
+  std::vector<Frame> CallStack;
+  int *const Base = Memory.data();
+  int *const Limit = Base + MemorySize;
+  const std::vector<std::string> &Strings = TheModule->getStringLiterals();
+
+  const EncodedFunction *Fn = &TheModule->getFunction(Main);
+  const uint8_t *Code = Fn->getCode().data();
+  const uint8_t *PC = Code;
+  /// The start of the instruction being run.
+  const uint8_t *I = PC;
+  /// The counts of the instructions of Fn.
+  uint64_t *Hits = Profiling ? Counts[Main].data() : nullptr;
+  int *FP = Base + TheModule->getGlobalsSize();
+  int *SP = FP + Fn->getFrameSize();
+  if (SP + Fn->getMaxStackDepth() > Limit) {
+    Error(*Fn, 0, "stack overflow");
+    return true;
+  }
+
+#define VM_UNSIGNED() EncodedFunction::DecodeUnsigned(PC)
+#define VM_SIGNED() EncodedFunction::DecodeSigned(PC)
+#define VM_ERROR(Msg)                                                          \
+  do {                                                                         \
+    Error(*Fn, static_cast<unsigned>(I - Code), Msg);                          \
+    return true;                                                               \
+  } while (0)
+
+#if SIMPLECC_VM_THREADED_DISPATCH
+  static const void *const DispatchTable[] = {
+#define HANDLE_OPCODE(Opcode, Name) &&Handle_##Opcode,
+#include "simplecc/CodeGen/Opcode.def"
+      &&Handle_LOAD_LOCAL_ADDRESS,
+#define HANDLE_SUPER_INSTRUCTION(Opcode, Name) &&Handle_##Opcode,
+#include "simplecc/CodeGen/SuperInstruction.def"
+  };
+  static_assert(sizeof(DispatchTable) / sizeof(DispatchTable[0]) ==
+                    EncodedFunction::NUM_OPCODES,
+                "DispatchTable must cover every Opcode");
+#define VM_CASE(Opcode) Handle_##Opcode:
+#define VM_NEXT()                                                              \
+  do {                                                                         \
+    I = PC;                                                                    \
+    if (Profiling)                                                             \
+      ++Hits[I - Code];                                                        \
+    goto *DispatchTable[*PC++];                                                \
+  } while (0)
+  VM_NEXT();
+#else
+#define VM_CASE(Opcode) case EncodedFunction::Opcode:
+#define VM_NEXT() goto Dispatch
+Dispatch:
+  I = PC;
+  if (Profiling)
+    ++Hits[I - Code];
+  switch (*PC++) {
+#endif
+
+  VM_CASE(LOAD_LOCAL) {
+    *SP++ = FP[VM_UNSIGNED()];
+    VM_NEXT();
+  }
+  VM_CASE(LOAD_LOCAL_ADDRESS) {
+    *SP++ = static_cast<int>(FP - Base) + static_cast<int>(VM_UNSIGNED());
+    VM_NEXT();
+  }
+  VM_CASE(LOAD_GLOBAL) {
+    *SP++ = Base[VM_UNSIGNED()];
+    VM_NEXT();
+  }
+  VM_CASE(STORE_LOCAL) {
+    FP[VM_UNSIGNED()] = *--SP;
+    VM_NEXT();
+  }
+  VM_CASE(STORE_GLOBAL) {
+    Base[VM_UNSIGNED()] = *--SP;
+    VM_NEXT();
+  }
+  VM_CASE(LOAD_CONST) {
+    *SP++ = VM_SIGNED();
+    VM_NEXT();
+  }
+  VM_CASE(LOAD_STRING) {
+    *SP++ = static_cast<int>(VM_UNSIGNED());
+    VM_NEXT();
+  }
+  VM_CASE(POP_TOP) {
+    --SP;
+    VM_NEXT();
+  }
+
+  VM_CASE(BINARY_ADD) {
+    --SP;
+    SP[-1] = WrapAdd(SP[-1], SP[0]);
+    VM_NEXT();
+  }
+  VM_CASE(BINARY_SUB) {
+    --SP;
+    SP[-1] = WrapSub(SP[-1], SP[0]);
+    VM_NEXT();
+  }
+  VM_CASE(BINARY_MULTIPLY) {
+    --SP;
+    SP[-1] = WrapMul(SP[-1], SP[0]);
+    VM_NEXT();
+  }
+  VM_CASE(BINARY_DIVIDE) {
+    --SP;
+    if (SP[0] == 0)
+      VM_ERROR("division by zero");
+    /// INT_MIN / -1 overflows to INT_MIN.
+    SP[-1] = SP[0] == -1 ? WrapSub(0, SP[-1]) : SP[-1] / SP[0];
+    VM_NEXT();
+  }
+  VM_CASE(BINARY_SUBSCR) {
+    --SP;
+    auto Address = static_cast<unsigned>(WrapAdd(SP[-1], SP[0]));
+    if (Address >= MemorySize)
+      VM_ERROR("array index out of range");
+    SP[-1] = Base[Address];
+    VM_NEXT();
+  }
+  VM_CASE(STORE_SUBSCR) {
+    /// The value, the base and the index.
+    SP -= 3;
+    auto Address = static_cast<unsigned>(WrapAdd(SP[1], SP[2]));
+    if (Address >= MemorySize)
+      VM_ERROR("array index out of range");
+    Base[Address] = SP[0];
+    VM_NEXT();
+  }
+
+  VM_CASE(UNARY_POSITIVE) { VM_NEXT(); }
+  VM_CASE(UNARY_NEGATIVE) {
+    SP[-1] = WrapSub(0, SP[-1]);
+    VM_NEXT();
+  }
+
+  VM_CASE(SHIFT_LEFT) {
+    auto Val = static_cast<unsigned>(SP[-1]);
+    SP[-1] = static_cast<int>(Val << (VM_UNSIGNED() & 31));
+    VM_NEXT();
+  }
+  VM_CASE(SHIFT_RIGHT) {
+    SP[-1] >>= VM_UNSIGNED() & 31;
+    VM_NEXT();
+  }
+  VM_CASE(SHIFT_RIGHT_LOGICAL) {
+    auto Val = static_cast<unsigned>(SP[-1]);
+    SP[-1] = static_cast<int>(Val >> (VM_UNSIGNED() & 31));
+    VM_NEXT();
+  }
+  VM_CASE(MULTIPLY_HIGH) {
+    int64_t Product = static_cast<int64_t>(SP[-1]) * VM_SIGNED();
+    SP[-1] = static_cast<int>(Product >> 32);
+    VM_NEXT();
+  }
+
+  VM_CASE(READ_INTEGER) {
+    *SP++ = ReadInteger(IS);
+    VM_NEXT();
+  }
+  VM_CASE(READ_CHARACTER) {
+    *SP++ = ReadCharacter(IS);
+    VM_NEXT();
+  }
+
+  VM_CASE(PRINT_STRING) {
+    OS << Strings[*--SP];
+    VM_NEXT();
+  }
+  VM_CASE(PRINT_CHARACTER) {
+    OS.put(static_cast<char>(*--SP));
+    VM_NEXT();
+  }
+  VM_CASE(PRINT_INTEGER) {
+    OS << *--SP;
+    VM_NEXT();
+  }
+  VM_CASE(PRINT_NEWLINE) {
+    OS.put('\n');
+    VM_NEXT();
+  }
+
+  VM_CASE(JUMP_FORWARD) {
+    PC = Code + VM_UNSIGNED();
+    VM_NEXT();
+  }
+  VM_CASE(JUMP_IF_TRUE) {
+    unsigned Target = VM_UNSIGNED();
+    if (*--SP)
+      PC = Code + Target;
+    VM_NEXT();
+  }
+  VM_CASE(JUMP_IF_FALSE) {
+    unsigned Target = VM_UNSIGNED();
+    if (!*--SP)
+      PC = Code + Target;
+    VM_NEXT();
+  }
+
+  /// Compare TOS1 with TOS.
+#define HANDLE_COMPARE(Opcode)                                                 \
+  VM_CASE(Opcode) {                                                            \
+    unsigned Target = VM_UNSIGNED();                                           \
+    SP -= 2;                                                                   \
+    if (Compare##Opcode(SP[0], SP[1]))                                         \
+      PC = Code + Target;                                                      \
+    VM_NEXT();                                                                 \
+  }
+  HANDLE_COMPARE(JUMP_IF_EQUAL)
+  HANDLE_COMPARE(JUMP_IF_NOT_EQUAL)
+  HANDLE_COMPARE(JUMP_IF_GREATER)
+  HANDLE_COMPARE(JUMP_IF_GREATER_EQUAL)
+  HANDLE_COMPARE(JUMP_IF_LESS)
+  HANDLE_COMPARE(JUMP_IF_LESS_EQUAL)
+#undef HANDLE_COMPARE
+
+  VM_CASE(CALL_FUNCTION) {
+    unsigned Index = VM_UNSIGNED();
+    const EncodedFunction *Callee = &TheModule->getFunction(Index);
+    /// The arguments on the stack become the first slots of the frame.
+    int *CalleeFP = SP - Callee->getArgumentCount();
+    int *CalleeSP = CalleeFP + Callee->getFrameSize();
+    if (CallStack.size() == MaxCallDepth ||
+        CalleeSP + Callee->getMaxStackDepth() > Limit)
+      VM_ERROR("stack overflow");
+    CallStack.push_back(Frame{Fn, PC, FP, Hits});
+    if (Profiling)
+      Hits = Counts[Index].data();
+    Fn = Callee;
+    Code = PC = Callee->getCode().data();
+    FP = CalleeFP;
+    SP = CalleeSP;
+    VM_NEXT();
+  }
+
+  VM_CASE(RETURN_VALUE)
+  VM_CASE(RETURN_NONE) {
+    int Val = *I == EncodedFunction::RETURN_VALUE ? SP[-1] : 0;
+    if (CallStack.empty())
+      return false;
+    const Frame &Caller = CallStack.back();
+    /// Pop the frame and push the value the callee returns.
+    SP = FP;
+    *SP++ = Val;
+    Fn = Caller.Fn;
+    Code = Fn->getCode().data();
+    PC = Caller.ReturnPC;
+    FP = Caller.FP;
+    Hits = Caller.Hits;
+    CallStack.pop_back();
+    VM_NEXT();
+  }
+
+  /// The SuperInstruction's.
+  VM_CASE(INC_LOCAL) {
+    int *Local = FP + VM_UNSIGNED();
+    *Local = WrapAdd(*Local, VM_SIGNED());
+    VM_NEXT();
+  }
+  VM_CASE(LOAD_LOCAL_ADD_CONST) {
+    int Val = FP[VM_UNSIGNED()];
+    *SP++ = WrapAdd(Val, VM_SIGNED());
+    VM_NEXT();
+  }
+  VM_CASE(MOVE_LOCAL) {
+    int *Local = FP + VM_UNSIGNED();
+    *Local = FP[VM_UNSIGNED()];
+    VM_NEXT();
+  }
+  VM_CASE(STORE_LOCAL_CONST) {
+    int *Local = FP + VM_UNSIGNED();
+    *Local = VM_SIGNED();
+    VM_NEXT();
+  }
+  VM_CASE(ADD_CONST) {
+    SP[-1] = WrapAdd(SP[-1], VM_SIGNED());
+    VM_NEXT();
+  }
+  VM_CASE(ADD_LOCAL) {
+    SP[-1] = WrapAdd(SP[-1], FP[VM_UNSIGNED()]);
+    VM_NEXT();
+  }
+  VM_CASE(SUB_LOCAL) {
+    SP[-1] = WrapSub(SP[-1], FP[VM_UNSIGNED()]);
+    VM_NEXT();
+  }
+
+#define HANDLE_COMPARE_LOCAL_CONST(Opcode, Name, Jump)                         \
+  VM_CASE(Opcode) {                                                            \
+    int Val = FP[VM_UNSIGNED()];                                               \
+    int Const = VM_SIGNED();                                                   \
+    unsigned Target = VM_UNSIGNED();                                           \
+    if (Compare##Jump(Val, Const))                                             \
+      PC = Code + Target;                                                      \
+    VM_NEXT();                                                                 \
+  }
+#define HANDLE_COMPARE_LOCALS(Opcode, Name, Jump)                              \
+  VM_CASE(Opcode) {                                                            \
+    int Val = FP[VM_UNSIGNED()];                                               \
+    int Other = FP[VM_UNSIGNED()];                                             \
+    unsigned Target = VM_UNSIGNED();                                           \
+    if (Compare##Jump(Val, Other))                                             \
+      PC = Code + Target;                                                      \
+    VM_NEXT();                                                                 \
+  }
+#include "simplecc/CodeGen/SuperInstruction.def"
+
+#if !SIMPLECC_VM_THREADED_DISPATCH
+  default:
+    break;
+  }
+  assert(false && "Unhandled Opcode");
+  return true;
+#endif
+#undef VM_CASE
+#undef VM_NEXT
+#undef VM_ERROR
+#undef VM_SIGNED
+#undef VM_UNSIGNED
+}
+
+bool Interpreter::Run(const EncodedModule &M, std::istream &IS,
+                      std::ostream &OS) {
+  EM.clear();
+  TheModule = &M;
+  int Main = M.getFunctionIndex("main");
+  assert(Main >= 0 && "main() must exist");
+  bool Failed = Execute<false>(static_cast<unsigned>(Main), IS, OS);
+  OS.flush();
+  TheModule = nullptr;
+  return Failed;
+}
+
+bool Interpreter::Run(const ByteCodeModule &M, std::istream &IS,
+                      std::ostream &OS) {
+  EncodedModule Encoded;
+  EncodeByteCode(M, Encoded);
+  return Run(Encoded, IS, OS);
+}
+
+/// Return the offset of each instruction of F in order.
+static std::vector<unsigned> getInstructionOffsets(const EncodedFunction &F) {
+  std::vector<unsigned> Offsets;
+  const uint8_t *Begin = F.getCode().data();
+  const uint8_t *PC = Begin;
+  const uint8_t *End = Begin + F.getCode().size();
+  while (PC != End) {
+    Offsets.push_back(static_cast<unsigned>(PC - Begin));
+    auto Op = static_cast<EncodedFunction::Opcode>(*PC++);
+    for (auto Kind = EncodedFunction::getImmediateKinds(Op);
+         *Kind != EncodedFunction::NoImmediate; ++Kind)
+      EncodedFunction::DecodeUnsigned(PC);
+  }
+  return Offsets;
+}
+
+bool Interpreter::Profile(const ByteCodeModule &M, std::istream &IS,
+                          std::ostream &OS, ExecutionProfile &P) {
+  EncodedModule Encoded;
+  EncodeByteCode(M, Encoded, /* SuperInstructions */ false);
+  EM.clear();
+  TheModule = &Encoded;
+  Counts.clear();
+  for (unsigned F = 0; F < Encoded.size(); F++)
+    Counts.emplace_back(Encoded.getFunction(F).getCode().size());
+  int Main = Encoded.getFunctionIndex("main");
+  assert(Main >= 0 && "main() must exist");
+  bool Failed = Execute<true>(static_cast<unsigned>(Main), IS, OS);
+  OS.flush();
+  TheModule = nullptr;
+
+  /// Each ByteCode is one instruction, so the k-th instruction is the k-th
+  /// ByteCode. A function is entered once per call to it, and main once.
+  std::vector<std::vector<uint64_t>> ByteCodeCounts(Encoded.size());
+  std::unordered_map<std::string, uint64_t> EntryCounts{{"main", 1}};
+  for (const ByteCodeFunction *F : M) {
+    unsigned Index = Encoded.getFunctionIndex(F->getName());
+    std::vector<unsigned> Offsets =
+        getInstructionOffsets(Encoded.getFunction(Index));
+    assert(Offsets.size() == F->size() && "ByteCode must not be fused");
+    std::vector<uint64_t> &BCCounts = ByteCodeCounts[Index];
+    for (unsigned Offset : Offsets)
+      BCCounts.push_back(Counts[Index][Offset]);
+    for (unsigned I = 0; I < F->size(); I++) {
+      const ByteCode &C = F->getByteCodeAt(I);
+      if (C.getOpcode() == ByteCode::CALL_FUNCTION)
+        EntryCounts[C.getStrOperand()] += BCCounts[I];
+    }
+  }
+  Counts.clear();
+
+  P = ExecutionProfile();
+  for (const ByteCodeFunction *F : M) {
+    const std::vector<uint64_t> &BCCounts =
+        ByteCodeCounts[Encoded.getFunctionIndex(F->getName())];
+    auto &FP = P.addFunction(F->getName(), EntryCounts[F->getName()]);
+    for (unsigned I = 0; I < F->size(); I++) {
+      const ByteCode &C = F->getByteCodeAt(I);
+      FP.addInstruction(I, C.getSourceLineno(), BCCounts[I]);
+      if (C.getOpcode() == ByteCode::CALL_FUNCTION)
+        FP.addCall(I, C.getSourceLineno(), C.getStrOperand(), BCCounts[I]);
+    }
+    ByteCodeCFG CFG(*F);
+    for (unsigned B = 0; B < CFG.size(); B++) {
+      const ByteCodeCFG::Block &Block = CFG.getBlock(B);
+      FP.addBlock(Block.Begin, Block.End, BCCounts[Block.Begin]);
+    }
+  }
+  return Failed;
+}
@@ -0,0 +1,346 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "simplecc/VM/RegisterInterpreter.h"
+#include "simplecc/CodeGen/CodeGen.h"
+#include "simplecc/VM/Interpreter.h"
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+using namespace simplecc;
+
+/// Use threaded dispatch if labels can be taken as values.
+#if defined(__GNUC__)
+#define SIMPLECC_VM_THREADED_DISPATCH 1
+#else
+#define SIMPLECC_VM_THREADED_DISPATCH 0
+#endif
+
+/// Arithmetic wraps around as it does on the target.
+static inline int WrapAdd(int L, int R) {
+  return static_cast<int>(static_cast<unsigned>(L) + static_cast<unsigned>(R));
+}
+static inline int WrapSub(int L, int R) {
+  return static_cast<int>(static_cast<unsigned>(L) - static_cast<unsigned>(R));
+}
+static inline int WrapMul(int L, int R) {
+  return static_cast<int>(static_cast<unsigned>(L) * static_cast<unsigned>(R));
+}
+/// INT_MIN / -1 overflows to INT_MIN.
+static inline int WrapDiv(int L, int R) {
+  return R == -1 ? WrapSub(0, L) : L / R;
+}
+
+void RegisterInterpreter::Error(const RegisterInstruction &I,
+                                const char *Msg) {
+  EM.Error(Location(I.Lineno, 0), Msg, "in function",
+           TheModule->getFunction(I.Function).getName());
+}
+
+bool RegisterInterpreter::Execute(unsigned Main, std::istream &IS,
+                                  std::ostream &OS) {
+  constexpr unsigned MemorySize = Interpreter::MemorySize;
+  /// What a call saves to return.
+  struct Frame {
+    const RegisterFunction *Fn;
+    const RegisterInstruction *ReturnPC;
+    int *FP;
+  };
+  std::vector<int> Memory(MemorySize);
+  std::vector<Frame> CallStack;
+  int *const Base = Memory.data();
+  int *const Limit = Base + MemorySize;
+  const std::vector<std::string> &Strings = TheModule->getStringLiterals();
+
+  const RegisterFunction *Fn = &TheModule->getFunction(Main);
+  const RegisterInstruction *Code = Fn->getInstructions().data();
+  const RegisterInstruction *PC = Code;
+  /// The instruction being run.
+  const RegisterInstruction *I = PC;
+  int *FP = Base + TheModule->getGlobalsSize();
+  if (FP + Fn->getRegisterCount() > Limit) {
+    Error(*PC, "stack overflow");
+    return true;
+  }
+
+#define VM_A I->A
+#define VM_B I->B
+#define VM_C I->C
+#define VM_ERROR(Msg)                                                          \
+  do {                                                                         \
+    Error(*I, Msg);                                                            \
+    return true;                                                               \
+  } while (0)
+
+#if SIMPLECC_VM_THREADED_DISPATCH
+  static const void *const DispatchTable[] = {
+#define HANDLE_REGISTER_OPCODE(Opcode, Operands) &&Handle_##Opcode,
+#include "simplecc/CodeGen/RegisterOpcode.def"
+  };
+  static_assert(sizeof(DispatchTable) / sizeof(DispatchTable[0]) ==
+                    RegisterInstruction::NUM_OPCODES,
+                "DispatchTable must cover every Opcode");
+#define VM_CASE(Opcode) Handle_##Opcode:
+#define VM_NEXT()                                                              \
+  do {                                                                         \
+    I = PC++;                                                                  \
+    goto *DispatchTable[I->Op];                                                \
+  } while (0)
+  VM_NEXT();
+#else
+#define VM_CASE(Opcode) case RegisterInstruction::Opcode:
+#define VM_NEXT() goto Dispatch
+Dispatch:
+  I = PC++;
+  switch (I->Op) {
+#endif
+
+  VM_CASE(MOVE) {
+    FP[VM_A] = FP[VM_B];
+    VM_NEXT();
+  }
+  VM_CASE(LOAD_IMM) {
+    FP[VM_A] = VM_B;
+    VM_NEXT();
+  }
+  VM_CASE(LOAD_ADDRESS) {
+    FP[VM_A] = static_cast<int>(FP - Base) + VM_B;
+    VM_NEXT();
+  }
+  VM_CASE(LOAD_GLOBAL) {
+    FP[VM_A] = Base[VM_B];
+    VM_NEXT();
+  }
+  VM_CASE(STORE_GLOBAL) {
+    Base[VM_A] = FP[VM_B];
+    VM_NEXT();
+  }
+
+  VM_CASE(ADD) {
+    FP[VM_A] = WrapAdd(FP[VM_B], FP[VM_C]);
+    VM_NEXT();
+  }
+  VM_CASE(ADD_IMM) {
+    FP[VM_A] = WrapAdd(FP[VM_B], VM_C);
+    VM_NEXT();
+  }
+  VM_CASE(SUB) {
+    FP[VM_A] = WrapSub(FP[VM_B], FP[VM_C]);
+    VM_NEXT();
+  }
+  VM_CASE(SUB_IMM) {
+    FP[VM_A] = WrapSub(FP[VM_B], VM_C);
+    VM_NEXT();
+  }
+  VM_CASE(MUL) {
+    FP[VM_A] = WrapMul(FP[VM_B], FP[VM_C]);
+    VM_NEXT();
+  }
+  VM_CASE(MUL_IMM) {
+    FP[VM_A] = WrapMul(FP[VM_B], VM_C);
+    VM_NEXT();
+  }
+  VM_CASE(DIV) {
+    if (FP[VM_C] == 0)
+      VM_ERROR("division by zero");
+    FP[VM_A] = WrapDiv(FP[VM_B], FP[VM_C]);
+    VM_NEXT();
+  }
+  VM_CASE(DIV_IMM) {
+    if (VM_C == 0)
+      VM_ERROR("division by zero");
+    FP[VM_A] = WrapDiv(FP[VM_B], VM_C);
+    VM_NEXT();
+  }
+  VM_CASE(NEG) {
+    FP[VM_A] = WrapSub(0, FP[VM_B]);
+    VM_NEXT();
+  }
+  VM_CASE(SHIFT_LEFT) {
+    auto Val = static_cast<unsigned>(FP[VM_B]);
+    FP[VM_A] = static_cast<int>(Val << (VM_C & 31));
+    VM_NEXT();
+  }
+  VM_CASE(SHIFT_RIGHT) {
+    FP[VM_A] = FP[VM_B] >> (VM_C & 31);
+    VM_NEXT();
+  }
+  VM_CASE(SHIFT_RIGHT_LOGICAL) {
+    auto Val = static_cast<unsigned>(FP[VM_B]);
+    FP[VM_A] = static_cast<int>(Val >> (VM_C & 31));
+    VM_NEXT();
+  }
+  VM_CASE(MULTIPLY_HIGH) {
+    int64_t Product = static_cast<int64_t>(FP[VM_B]) * VM_C;
+    FP[VM_A] = static_cast<int>(Product >> 32);
+    VM_NEXT();
+  }
+
+  /// The address of an element is checked as Interpreter does. A load takes
+  /// the base and the index.
+#define HANDLE_LOAD_ELEMENT(Opcode, BaseAddress)                               \
+  VM_CASE(Opcode) {                                                            \
+    auto Address = static_cast<unsigned>(WrapAdd(BaseAddress, FP[VM_C]));      \
+    if (Address >= MemorySize)                                                 \
+      VM_ERROR("array index out of range");                                    \
+    FP[VM_A] = Base[Address];                                                  \
+    VM_NEXT();                                                                 \
+  }
+  HANDLE_LOAD_ELEMENT(LOAD_ELEM, FP[VM_B])
+  HANDLE_LOAD_ELEMENT(LOAD_ELEM_LOCAL, static_cast<int>(FP - Base) + VM_B)
+  HANDLE_LOAD_ELEMENT(LOAD_ELEM_GLOBAL, VM_B)
+#undef HANDLE_LOAD_ELEMENT
+  /// A store takes the base, the index and the value.
+#define HANDLE_STORE_ELEMENT(Opcode, BaseAddress)                              \
+  VM_CASE(Opcode) {                                                            \
+    auto Address = static_cast<unsigned>(WrapAdd(BaseAddress, FP[VM_B]));      \
+    if (Address >= MemorySize)                                                 \
+      VM_ERROR("array index out of range");                                    \
+    Base[Address] = FP[VM_C];                                                  \
+    VM_NEXT();                                                                 \
+  }
+  HANDLE_STORE_ELEMENT(STORE_ELEM, FP[VM_A])
+  HANDLE_STORE_ELEMENT(STORE_ELEM_LOCAL, static_cast<int>(FP - Base) + VM_A)
+  HANDLE_STORE_ELEMENT(STORE_ELEM_GLOBAL, VM_A)
+#undef HANDLE_STORE_ELEMENT
+
+  VM_CASE(READ_INTEGER) {
+    FP[VM_A] = Interpreter::ReadInteger(IS);
+    VM_NEXT();
+  }
+  VM_CASE(READ_CHARACTER) {
+    FP[VM_A] = Interpreter::ReadCharacter(IS);
+    VM_NEXT();
+  }
+  VM_CASE(PRINT_STRING) {
+    OS << Strings[VM_A];
+    VM_NEXT();
+  }
+  VM_CASE(PRINT_CHARACTER) {
+    OS.put(static_cast<char>(FP[VM_A]));
+    VM_NEXT();
+  }
+  VM_CASE(PRINT_INTEGER) {
+    OS << FP[VM_A];
+    VM_NEXT();
+  }
+  VM_CASE(PRINT_NEWLINE) {
+    OS.put('\n');
+    VM_NEXT();
+  }
+
+  VM_CASE(JUMP) {
+    PC = Code + VM_A;
+    VM_NEXT();
+  }
+  VM_CASE(JUMP_IF_TRUE) {
+    if (FP[VM_A])
+      PC = Code + VM_B;
+    VM_NEXT();
+  }
+  VM_CASE(JUMP_IF_FALSE) {
+    if (!FP[VM_A])
+      PC = Code + VM_B;
+    VM_NEXT();
+  }
+#define HANDLE_COMPARE(Opcode, Op)                                             \
+  VM_CASE(Opcode) {                                                            \
+    if (FP[VM_A] Op FP[VM_B])                                                  \
+      PC = Code + VM_C;                                                        \
+    VM_NEXT();                                                                 \
+  }                                                                            \
+  VM_CASE(Opcode##_IMM) {                                                      \
+    if (FP[VM_A] Op VM_B)                                                      \
+      PC = Code + VM_C;                                                        \
+    VM_NEXT();                                                                 \
+  }
+  HANDLE_COMPARE(JUMP_IF_EQUAL, ==)
+  HANDLE_COMPARE(JUMP_IF_NOT_EQUAL, !=)
+  HANDLE_COMPARE(JUMP_IF_GREATER, >)
+  HANDLE_COMPARE(JUMP_IF_GREATER_EQUAL, >=)
+  HANDLE_COMPARE(JUMP_IF_LESS, <)
+  HANDLE_COMPARE(JUMP_IF_LESS_EQUAL, <=)
+#undef HANDLE_COMPARE
+
+  VM_CASE(CALL) {
+    const RegisterFunction *Callee = &TheModule->getFunction(VM_B);
+    /// The arguments are the first registers of the frame of the callee.
+    int *CalleeFP = FP + VM_A;
+    if (CallStack.size() == Interpreter::MaxCallDepth ||
+        CalleeFP + Callee->getRegisterCount() > Limit)
+      VM_ERROR("stack overflow");
+    CallStack.push_back(Frame{Fn, PC, FP});
+    Fn = Callee;
+    Code = PC = Callee->getInstructions().data();
+    FP = CalleeFP;
+    VM_NEXT();
+  }
+  VM_CASE(RETURN_VALUE)
+  VM_CASE(RETURN_NONE) {
+    int Val = I->Op == RegisterInstruction::RETURN_VALUE ? FP[VM_A] : 0;
+    if (CallStack.empty())
+      return false;
+    const Frame &Caller = CallStack.back();
+    FP[0] = Val;
+    Fn = Caller.Fn;
+    Code = Fn->getInstructions().data();
+    PC = Caller.ReturnPC;
+    FP = Caller.FP;
+    CallStack.pop_back();
+    VM_NEXT();
+  }
+
+#if !SIMPLECC_VM_THREADED_DISPATCH
+  default:
+    break;
+  }
+  assert(false && "Unhandled Opcode");
+  return true;
+#endif
+#undef VM_CASE
+#undef VM_NEXT
+#undef VM_ERROR
+#undef VM_A
+#undef VM_B
+#undef VM_C
+}
+
+bool RegisterInterpreter::Run(const RegisterModule &RM, std::istream &IS,
+                              std::ostream &OS) {
+  EM.clear();
+  TheModule = &RM;
+  int Main = RM.getFunctionIndex("main");
+  assert(Main >= 0 && "main() must exist");
+  bool Failed = Execute(static_cast<unsigned>(Main), IS, OS);
+  OS.flush();
+  TheModule = nullptr;
+  return Failed;
+}
+
+bool RegisterInterpreter::Run(const ByteCodeModule &M, std::istream &IS,
+                              std::ostream &OS) {
+  RegisterModule Translated;
+  TranslateToRegisterByteCode(M, Translated);
+  return Run(Translated, IS, OS);
+}
@@ -0,0 +1,806 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "simplecc/VM/TemplateJIT.h"
+#include "simplecc/CodeGen/CodeGen.h"
+#include "simplecc/VM/Interpreter.h"
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+/// The code is x86-64 with the System V calling convention.
+#if defined(__x86_64__) && (defined(__unix__) || defined(__APPLE__))
+#define SIMPLECC_HAS_TEMPLATE_JIT 1
+#include <sys/mman.h>
+#else
+#define SIMPLECC_HAS_TEMPLATE_JIT 0
+#endif
+
+using namespace simplecc;
+
+/// What the compiled code reads and writes of the run, at fixed offsets from
+/// the register Ctx.
+struct TemplateJIT::Context {
+  /// The memory and its end.
+  int *Base;
+  int *Limit;
+  /// The first word after the globals.
+  int *SP;
+  /// The native stack pointer on entry, to leave on a runtime error.
+  uintptr_t EntryStack;
+  /// The native stack pointer below which a call is too deep.
+  uintptr_t StackLimit;
+  TemplateJIT *JIT;
+  std::istream *IS;
+  std::ostream *OS;
+  const std::vector<std::string> *Strings;
+};
+
+/// The entry of the compiled code: Ctx and the entry of main.
+using EntryFunction = int (*)(TemplateJIT::Context *, const uint8_t *);
+
+bool TemplateJIT::isSupported() { return SIMPLECC_HAS_TEMPLATE_JIT; }
+
+void TemplateJIT::ErrorHelper(Context *C, const EncodedFunction *F,
+                              unsigned Offset, const char *Msg) {
+  C->JIT->Error(*F, Offset, Msg);
+}
+
+void TemplateJIT::Error(const EncodedFunction &F, unsigned Offset,
+                        const char *Msg) {
+  /// Name the function the line is in, which inlined code does not run in.
+  int Source = F.getSourceFunction(Offset);
+  EM.Error(Location(F.getSourceLineno(Offset), 0), Msg, "in function",
+           Source < 0 ? F.getName() : TheModule->getFunctionName(Source));
+}
+
+#if SIMPLECC_HAS_TEMPLATE_JIT
+/// The helpers the compiled code calls.
+static int ReadIntegerHelper(TemplateJIT::Context *C) {
+  return Interpreter::ReadInteger(*C->IS);
+}
+static int ReadCharacterHelper(TemplateJIT::Context *C) {
+  return Interpreter::ReadCharacter(*C->IS);
+}
+static void PrintStringHelper(TemplateJIT::Context *C, int ID) {
+  *C->OS << (*C->Strings)[ID];
+}
+static void PrintCharacterHelper(TemplateJIT::Context *C, int Val) {
+  C->OS->put(static_cast<char>(Val));
+}
+static void PrintIntegerHelper(TemplateJIT::Context *C, int Val) {
+  *C->OS << Val;
+}
+static void PrintNewlineHelper(TemplateJIT::Context *C) { C->OS->put('\n'); }
+
+namespace {
+/// The registers by their numbers in the encoding.
+enum Register : unsigned {
+  RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI,
+  R8, R9, R10, R11, R12, R13, R14, R15,
+};
+
+/// The registers the compiled code keeps its state in. They are all saved
+/// by the callee, so the helpers leave them alone.
+/// The address of the memory.
+constexpr Register Base = RBX;
+/// The frame of the current function.
+constexpr Register FP = R12;
+/// The word after the top of the operand stack in memory.
+constexpr Register SP = R13;
+/// The top of the operand stack.
+constexpr Register TOS = R14;
+/// The end of the memory.
+constexpr Register Limit = R15;
+/// The Context of the run.
+constexpr Register Ctx = RBP;
+
+/// The conditions of Jcc.
+enum Condition : uint8_t {
+  CC_B = 0x2,
+  CC_AE = 0x3,
+  CC_E = 0x4,
+  CC_NE = 0x5,
+  CC_BE = 0x6,
+  CC_A = 0x7,
+  CC_L = 0xC,
+  CC_GE = 0xD,
+  CC_LE = 0xE,
+  CC_G = 0xF,
+};
+
+/// The extensions of the opcode in ModRM.reg of the group instructions.
+enum GroupDigit : unsigned {
+  ADD = 0, SUB = 5, CMP = 7,
+  NEG = 3, IDIV = 7, CALL = 2,
+  SHL = 4, SHR = 5, SAR = 7,
+};
+
+/// A memory operand [Base + Index * 4 + Disp].
+struct Address {
+  Register Base;
+  int Disp;
+  bool HasIndex;
+  Register Index;
+
+  Address(Register Base, int Disp = 0)
+      : Base(Base), Disp(Disp), HasIndex(false), Index(RAX) {}
+  Address(Register Base, Register Index, int Disp = 0)
+      : Base(Base), Disp(Disp), HasIndex(true), Index(Index) {
+    assert(Index != RSP && "RSP cannot be an index");
+  }
+};
+
+/// @brief X86Emitter appends x86-64 instructions to a buffer. Only the
+/// forms the templates need are supported, all on 32-bit operands unless
+/// the name says otherwise.
+class X86Emitter {
+public:
+  explicit X86Emitter(std::vector<uint8_t> &Buffer) : Buffer(Buffer) {}
+
+  size_t size() const { return Buffer.size(); }
+
+  void emitByte(uint8_t Byte) { Buffer.push_back(Byte); }
+  void emitInt32(int32_t Val) {
+    auto U = static_cast<uint32_t>(Val);
+    for (unsigned I = 0; I < 4; ++I)
+      emitByte(static_cast<uint8_t>(U >> (8 * I)));
+  }
+  void emitInt64(uint64_t Val) {
+    for (unsigned I = 0; I < 8; ++I)
+      emitByte(static_cast<uint8_t>(Val >> (8 * I)));
+  }
+
+  /// Make the rel32 at Pos go to Target.
+  void patchRel32(size_t Pos, size_t Target) {
+    auto Rel = static_cast<uint32_t>(static_cast<int64_t>(Target) -
+                                     static_cast<int64_t>(Pos + 4));
+    for (unsigned I = 0; I < 4; ++I)
+      Buffer[Pos + I] = static_cast<uint8_t>(Rel >> (8 * I));
+  }
+
+  /// Opcode with a register in ModRM.reg and memory in ModRM.rm.
+  void emitMem(uint8_t Opcode, unsigned Reg, const Address &A,
+               bool Wide = false, bool TwoByte = false) {
+    emitRex(Wide, Reg, A.HasIndex ? static_cast<unsigned>(A.Index) : 0u, A.Base);
+    if (TwoByte)
+      emitByte(0x0F);
+    emitByte(Opcode);
+    unsigned Mod;
+    if (A.Disp == 0 && (A.Base & 7) != RBP)
+      Mod = 0;
+    else if (A.Disp >= -128 && A.Disp < 128)
+      Mod = 1;
+    else
+      Mod = 2;
+    if (A.HasIndex) {
+      emitByte(static_cast<uint8_t>(Mod << 6 | (Reg & 7) << 3 | RSP));
+      emitByte(static_cast<uint8_t>(2 << 6 | (A.Index & 7) << 3 |
+                                    (A.Base & 7)));
+    } else {
+      emitByte(static_cast<uint8_t>(Mod << 6 | (Reg & 7) << 3 | (A.Base & 7)));
+      if ((A.Base & 7) == RSP)
+        emitByte(0x24);
+    }
+    if (Mod == 1)
+      emitByte(static_cast<uint8_t>(A.Disp));
+    else if (Mod == 2)
+      emitInt32(A.Disp);
+  }
+
+  /// Opcode with registers in both ModRM.reg and ModRM.rm.
+  void emitReg(uint8_t Opcode, unsigned Reg, unsigned RM, bool Wide = false,
+               bool TwoByte = false) {
+    emitRex(Wide, Reg, 0, RM);
+    if (TwoByte)
+      emitByte(0x0F);
+    emitByte(Opcode);
+    emitByte(static_cast<uint8_t>(3 << 6 | (Reg & 7) << 3 | (RM & 7)));
+  }
+
+  void movLoad(Register Dst, const Address &A) { emitMem(0x8B, Dst, A); }
+  void movStore(const Address &A, Register Src) { emitMem(0x89, Src, A); }
+  void movLoad64(Register Dst, const Address &A) {
+    emitMem(0x8B, Dst, A, true);
+  }
+  void movStore64(const Address &A, Register Src) {
+    emitMem(0x89, Src, A, true);
+  }
+  void movStoreImm(const Address &A, int Val) {
+    emitMem(0xC7, 0, A);
+    emitInt32(Val);
+  }
+  void movReg(Register Dst, Register Src) { emitReg(0x89, Src, Dst); }
+  void movReg64(Register Dst, Register Src) { emitReg(0x89, Src, Dst, true); }
+  void movImm(Register Dst, int Val) {
+    if (Val == 0) {
+      /// xor Dst, Dst.
+      emitReg(0x31, Dst, Dst);
+      return;
+    }
+    emitRex(false, 0, 0, Dst);
+    emitByte(static_cast<uint8_t>(0xB8 + (Dst & 7)));
+    emitInt32(Val);
+  }
+  void movImm64(Register Dst, uint64_t Val) {
+    emitRex(true, 0, 0, Dst);
+    emitByte(static_cast<uint8_t>(0xB8 + (Dst & 7)));
+    emitInt64(Val);
+  }
+  void lea64(Register Dst, const Address &A) { emitMem(0x8D, Dst, A, true); }
+
+  /// Dst op= [A], for ADD, SUB and CMP.
+  void aluLoad(GroupDigit Op, Register Dst, const Address &A) {
+    emitMem(getLoadOpcode(Op), Dst, A);
+  }
+  /// Dst op= Src, for ADD, SUB and CMP.
+  void aluReg(GroupDigit Op, Register Dst, Register Src, bool Wide = false) {
+    emitReg(getLoadOpcode(Op), Dst, Src, Wide);
+  }
+  /// Dst op= Val, for ADD, SUB and CMP.
+  void aluImm(GroupDigit Op, Register Dst, int Val, bool Wide = false) {
+    bool Short = Val >= -128 && Val < 128;
+    emitReg(Short ? 0x83 : 0x81, Op, Dst, Wide);
+    emitImmediate(Val, Short);
+  }
+  /// [A] op= Val, for ADD, SUB and CMP.
+  void aluStoreImm(GroupDigit Op, const Address &A, int Val) {
+    bool Short = Val >= -128 && Val < 128;
+    emitMem(Short ? 0x83 : 0x81, Op, A);
+    emitImmediate(Val, Short);
+  }
+  void test(Register L, Register R) { emitReg(0x85, R, L); }
+  void imulLoad(Register Dst, const Address &A) {
+    emitMem(0xAF, Dst, A, false, true);
+  }
+  /// Dst = Src * Val on 64 bits.
+  void imulImm64(Register Dst, Register Src, int Val) {
+    emitReg(0x69, Dst, Src, true);
+    emitInt32(Val);
+  }
+  /// NEG and IDIV.
+  void unary(GroupDigit Op, Register R) { emitReg(0xF7, Op, R); }
+  void cdq() { emitByte(0x99); }
+  void shift(GroupDigit Op, Register R, unsigned Amount, bool Wide = false) {
+    emitReg(0xC1, Op, R, Wide);
+    emitByte(static_cast<uint8_t>(Amount & (Wide ? 63 : 31)));
+  }
+  /// Dst = sign extended Src.
+  void movsxd(Register Dst, Register Src) { emitReg(0x63, Dst, Src, true); }
+
+  void push(Register R) {
+    emitRex(false, 0, 0, R);
+    emitByte(static_cast<uint8_t>(0x50 + (R & 7)));
+  }
+  void pop(Register R) {
+    emitRex(false, 0, 0, R);
+    emitByte(static_cast<uint8_t>(0x58 + (R & 7)));
+  }
+  void ret() { emitByte(0xC3); }
+  void callReg(Register R) { emitReg(0xFF, CALL, R); }
+  /// Call the C++ function Fn.
+  void callAbsolute(const void *Fn) {
+    movImm64(RAX, reinterpret_cast<uintptr_t>(Fn));
+    callReg(RAX);
+  }
+
+  /// These return the offset of the rel32 to patch.
+  size_t call() { return emitRel32(0xE8); }
+  size_t jmp() { return emitRel32(0xE9); }
+  size_t jcc(Condition CC) {
+    emitByte(0x0F);
+    return emitRel32(static_cast<uint8_t>(0x80 | CC));
+  }
+
+private:
+  void emitRex(bool Wide, unsigned Reg, unsigned Index, unsigned Base) {
+    uint8_t Rex = static_cast<uint8_t>(0x40 | Wide << 3 | (Reg >> 3) << 2 |
+                                       (Index >> 3) << 1 | (Base >> 3));
+    if (Rex != 0x40)
+      emitByte(Rex);
+  }
+
+  void emitImmediate(int Val, bool Short) {
+    if (Short)
+      emitByte(static_cast<uint8_t>(Val));
+    else
+      emitInt32(Val);
+  }
+
+  size_t emitRel32(uint8_t Opcode) {
+    emitByte(Opcode);
+    size_t Pos = size();
+    emitInt32(0);
+    return Pos;
+  }
+
+  static uint8_t getLoadOpcode(GroupDigit Op) {
+    switch (Op) {
+    case ADD:
+      return 0x03;
+    case SUB:
+      return 0x2B;
+    case CMP:
+      return 0x3B;
+    default:
+      assert(false && "Not an ALU operation");
+      return 0;
+    }
+  }
+
+  std::vector<uint8_t> &Buffer;
+};
+
+/// Return the condition on which the compare-and-jump Op jumps.
+Condition getCondition(EncodedFunction::Opcode Op) {
+  switch (Op) {
+  case EncodedFunction::JUMP_IF_EQUAL:
+    return CC_E;
+  case EncodedFunction::JUMP_IF_NOT_EQUAL:
+    return CC_NE;
+  case EncodedFunction::JUMP_IF_GREATER:
+    return CC_G;
+  case EncodedFunction::JUMP_IF_GREATER_EQUAL:
+    return CC_GE;
+  case EncodedFunction::JUMP_IF_LESS:
+    return CC_L;
+  case EncodedFunction::JUMP_IF_LESS_EQUAL:
+    return CC_LE;
+  default:
+    assert(false && "Not a compare-and-jump");
+    return CC_E;
+  }
+}
+
+/// The address of a word of the frame or the memory.
+Address Slot(Register R, int Index) { return Address(R, 4 * Index); }
+} // namespace
+
+/// The code that enters the compiled code with Ctx in RDI and the entry of
+/// main in RSI, and returns 0, or 1 on a runtime error.
+void TemplateJIT::compileEntry(std::vector<uint8_t> &Buffer) {
+  X86Emitter E(Buffer);
+  static const Register Saved[] = {RBP, RBX, R12, R13, R14, R15};
+  for (Register R : Saved)
+    E.push(R);
+  /// Keep the native stack aligned to 16 bytes at each call.
+  E.aluImm(SUB, RSP, 8, true);
+  E.movReg64(Ctx, RDI);
+  E.movLoad64(Base, Address(Ctx, offsetof(Context, Base)));
+  E.movLoad64(Limit, Address(Ctx, offsetof(Context, Limit)));
+  E.movLoad64(SP, Address(Ctx, offsetof(Context, SP)));
+  E.movStore64(Address(Ctx, offsetof(Context, EntryStack)), RSP);
+  /// Each call takes 16 bytes of the native stack: the return address and FP.
+  E.lea64(RAX, Address(RSP, -16 * static_cast<int>(
+                                      Interpreter::MaxCallDepth + 1)));
+  E.movStore64(Address(Ctx, offsetof(Context, StackLimit)), RAX);
+  E.callReg(RSI);
+  E.movImm(RAX, 0);
+  size_t Exit = E.size();
+  E.aluImm(ADD, RSP, 8, true);
+  for (unsigned I = 6; I-- > 0;)
+    E.pop(Saved[I]);
+  E.ret();
+
+  /// A runtime error unwinds all the compiled frames at once.
+  ErrorExit = E.size();
+  E.movLoad64(RSP, Address(Ctx, offsetof(Context, EntryStack)));
+  E.movImm(RAX, 1);
+  E.patchRel32(E.jmp(), Exit);
+}
+
+/// The templates. The operand stack is kept as TOS in a register, the
+/// rest in memory below SP. Pushing spills TOS to memory first and popping
+/// reloads it. When the stack is empty, TOS holds a dead value, which may be
+/// spilled all the same: the stack never needs more words than its depth.
+///
+/// A function is called with SP right after its arguments and TOS spilled.
+/// It saves FP on the native stack, and returns its value in TOS with SP at
+/// its frame, which pops the arguments and pushes the value in one go.
+void TemplateJIT::compileFunction(unsigned FnIndex,
+                                  std::vector<uint8_t> &Buffer) {
+  using Opcode = EncodedFunction::Opcode;
+  const EncodedFunction &F = TheModule->getFunction(FnIndex);
+  const std::vector<uint8_t> &Bytes = F.getCode();
+  X86Emitter E(Buffer);
+
+  /// Where each instruction starts in Buffer.
+  std::vector<size_t> Labels(Bytes.size(), 0);
+  /// The jumps to patch and the offset in F they go to.
+  std::vector<std::pair<size_t, unsigned>> Jumps;
+  /// The jumps to the error stubs, the instruction and the message.
+  struct ErrorSite {
+    size_t Jump;
+    unsigned Offset;
+    const char *Msg;
+  };
+  std::vector<ErrorSite> Errors;
+
+  auto Spill = [&]() {
+    E.movStore(Address(SP), TOS);
+    E.lea64(SP, Address(SP, 4));
+  };
+  auto Pop = [&](int N) {
+    E.movLoad(TOS, Slot(SP, -N));
+    E.lea64(SP, Slot(SP, -N));
+  };
+  auto CallHelper = [&](const void *Fn) {
+    E.movReg64(RDI, Ctx);
+    E.callAbsolute(Fn);
+  };
+
+  FunctionEntries[FnIndex] = E.size();
+  E.push(FP);
+  E.lea64(FP, Slot(SP, -static_cast<int>(F.getArgumentCount())));
+  E.lea64(SP, Slot(FP, static_cast<int>(F.getFrameSize())));
+
+  const uint8_t *Start = Bytes.data();
+  const uint8_t *End = Start + Bytes.size();
+  for (const uint8_t *PC = Start; PC != End;) {
+    auto Offset = static_cast<unsigned>(PC - Start);
+    Labels[Offset] = E.size();
+    auto Op = static_cast<Opcode>(*PC++);
+    int Imm[EncodedFunction::MaxImmediates] = {0};
+    const EncodedFunction::ImmediateKind *Kinds =
+        EncodedFunction::getImmediateKinds(Op);
+    for (unsigned I = 0; Kinds[I] != EncodedFunction::NoImmediate; ++I)
+      Imm[I] = Kinds[I] == EncodedFunction::SignedImmediate
+                   ? EncodedFunction::DecodeSigned(PC)
+                   : static_cast<int>(EncodedFunction::DecodeUnsigned(PC));
+    auto JumpTo = [&](size_t Jump, int Target) {
+      Jumps.emplace_back(Jump, static_cast<unsigned>(Target));
+    };
+    auto ErrorIf = [&](Condition CC, const char *Msg) {
+      Errors.push_back(ErrorSite{E.jcc(CC), Offset, Msg});
+    };
+
+    switch (Op) {
+    case EncodedFunction::LOAD_LOCAL:
+      Spill();
+      E.movLoad(TOS, Slot(FP, Imm[0]));
+      break;
+    case EncodedFunction::LOAD_LOCAL_ADDRESS:
+      Spill();
+      E.lea64(RAX, Slot(FP, Imm[0]));
+      E.aluReg(SUB, RAX, Base, true);
+      E.shift(SHR, RAX, 2, true);
+      E.movReg(TOS, RAX);
+      break;
+    case EncodedFunction::LOAD_GLOBAL:
+      Spill();
+      E.movLoad(TOS, Slot(Base, Imm[0]));
+      break;
+    case EncodedFunction::STORE_LOCAL:
+      E.movStore(Slot(FP, Imm[0]), TOS);
+      Pop(1);
+      break;
+    case EncodedFunction::STORE_GLOBAL:
+      E.movStore(Slot(Base, Imm[0]), TOS);
+      Pop(1);
+      break;
+    case EncodedFunction::LOAD_CONST:
+    case EncodedFunction::LOAD_STRING:
+      Spill();
+      E.movImm(TOS, Imm[0]);
+      break;
+    case EncodedFunction::POP_TOP:
+      Pop(1);
+      break;
+
+    case EncodedFunction::BINARY_ADD:
+      E.aluLoad(ADD, TOS, Slot(SP, -1));
+      E.lea64(SP, Slot(SP, -1));
+      break;
+    case EncodedFunction::BINARY_SUB:
+      E.movLoad(RAX, Slot(SP, -1));
+      E.aluReg(SUB, RAX, TOS);
+      E.movReg(TOS, RAX);
+      E.lea64(SP, Slot(SP, -1));
+      break;
+    case EncodedFunction::BINARY_MULTIPLY:
+      E.imulLoad(TOS, Slot(SP, -1));
+      E.lea64(SP, Slot(SP, -1));
+      break;
+    case EncodedFunction::BINARY_DIVIDE: {
+      E.test(TOS, TOS);
+      ErrorIf(CC_E, "division by zero");
+      /// INT_MIN / -1 overflows to INT_MIN, where idiv would trap.
+      E.aluImm(CMP, TOS, -1);
+      size_t ByMinusOne = E.jcc(CC_E);
+      E.movLoad(RAX, Slot(SP, -1));
+      E.cdq();
+      E.unary(IDIV, TOS);
+      E.movReg(TOS, RAX);
+      size_t Done = E.jmp();
+      E.patchRel32(ByMinusOne, E.size());
+      E.movLoad(TOS, Slot(SP, -1));
+      E.unary(NEG, TOS);
+      E.patchRel32(Done, E.size());
+      E.lea64(SP, Slot(SP, -1));
+      break;
+    }
+    case EncodedFunction::BINARY_SUBSCR:
+      /// The address wraps around on 32 bits and is zero-extended.
+      E.movLoad(RAX, Slot(SP, -1));
+      E.aluReg(ADD, RAX, TOS);
+      E.aluImm(CMP, RAX, static_cast<int>(Interpreter::MemorySize));
+      ErrorIf(CC_AE, "array index out of range");
+      E.movLoad(TOS, Address(Base, RAX));
+      E.lea64(SP, Slot(SP, -1));
+      break;
+    case EncodedFunction::STORE_SUBSCR:
+      /// The value, the base and the index.
+      E.movLoad(RAX, Slot(SP, -1));
+      E.aluReg(ADD, RAX, TOS);
+      E.aluImm(CMP, RAX, static_cast<int>(Interpreter::MemorySize));
+      ErrorIf(CC_AE, "array index out of range");
+      E.movLoad(RCX, Slot(SP, -2));
+      E.movStore(Address(Base, RAX), RCX);
+      Pop(3);
+      break;
+
+    case EncodedFunction::UNARY_POSITIVE:
+      break;
+    case EncodedFunction::UNARY_NEGATIVE:
+      E.unary(NEG, TOS);
+      break;
+
+    case EncodedFunction::SHIFT_LEFT:
+      E.shift(SHL, TOS, static_cast<unsigned>(Imm[0]));
+      break;
+    case EncodedFunction::SHIFT_RIGHT:
+      E.shift(SAR, TOS, static_cast<unsigned>(Imm[0]));
+      break;
+    case EncodedFunction::SHIFT_RIGHT_LOGICAL:
+      E.shift(SHR, TOS, static_cast<unsigned>(Imm[0]));
+      break;
+    case EncodedFunction::MULTIPLY_HIGH:
+      E.movsxd(RAX, TOS);
+      E.imulImm64(RAX, RAX, Imm[0]);
+      E.shift(SAR, RAX, 32, true);
+      E.movReg(TOS, RAX);
+      break;
+
+    case EncodedFunction::READ_INTEGER:
+    case EncodedFunction::READ_CHARACTER:
+      Spill();
+      CallHelper(Op == EncodedFunction::READ_INTEGER
+                     ? reinterpret_cast<const void *>(&ReadIntegerHelper)
+                     : reinterpret_cast<const void *>(&ReadCharacterHelper));
+      E.movReg(TOS, RAX);
+      break;
+    case EncodedFunction::PRINT_STRING:
+    case EncodedFunction::PRINT_CHARACTER:
+    case EncodedFunction::PRINT_INTEGER: {
+      const void *Helper =
+          Op == EncodedFunction::PRINT_STRING
+              ? reinterpret_cast<const void *>(&PrintStringHelper)
+              : Op == EncodedFunction::PRINT_CHARACTER
+                    ? reinterpret_cast<const void *>(&PrintCharacterHelper)
+                    : reinterpret_cast<const void *>(&PrintIntegerHelper);
+      E.movReg(RSI, TOS);
+      CallHelper(Helper);
+      Pop(1);
+      break;
+    }
+    case EncodedFunction::PRINT_NEWLINE:
+      CallHelper(reinterpret_cast<const void *>(&PrintNewlineHelper));
+      break;
+
+    case EncodedFunction::JUMP_FORWARD:
+      JumpTo(E.jmp(), Imm[0]);
+      break;
+    case EncodedFunction::JUMP_IF_TRUE:
+    case EncodedFunction::JUMP_IF_FALSE:
+      /// Neither a load nor a lea changes the flags.
+      E.test(TOS, TOS);
+      Pop(1);
+      JumpTo(E.jcc(Op == EncodedFunction::JUMP_IF_TRUE ? CC_NE : CC_E),
+             Imm[0]);
+      break;
+    case EncodedFunction::JUMP_IF_EQUAL:
+    case EncodedFunction::JUMP_IF_NOT_EQUAL:
+    case EncodedFunction::JUMP_IF_GREATER:
+    case EncodedFunction::JUMP_IF_GREATER_EQUAL:
+    case EncodedFunction::JUMP_IF_LESS:
+    case EncodedFunction::JUMP_IF_LESS_EQUAL:
+      /// Compare TOS1 with TOS.
+      E.movLoad(RAX, Slot(SP, -1));
+      E.aluReg(CMP, RAX, TOS);
+      Pop(2);
+      JumpTo(E.jcc(getCondition(Op)), Imm[0]);
+      break;
+
+    case EncodedFunction::CALL_FUNCTION: {
+      const EncodedFunction &Callee =
+          TheModule->getFunction(static_cast<unsigned>(Imm[0]));
+      Spill();
+      /// The memory the callee may use, as the Interpreter checks it.
+      int Words = static_cast<int>(Callee.getFrameSize()) -
+                  static_cast<int>(Callee.getArgumentCount()) +
+                  static_cast<int>(Callee.getMaxStackDepth());
+      E.lea64(RAX, Slot(SP, Words));
+      E.aluReg(CMP, RAX, Limit, true);
+      ErrorIf(CC_A, "stack overflow");
+      E.emitMem(0x3B, RSP, Address(Ctx, offsetof(Context, StackLimit)), true);
+      ErrorIf(CC_BE, "stack overflow");
+      /// The entries are patched once all the functions are compiled.
+      Calls.emplace_back(E.call(), static_cast<unsigned>(Imm[0]));
+      break;
+    }
+    case EncodedFunction::RETURN_VALUE:
+    case EncodedFunction::RETURN_NONE:
+      if (Op == EncodedFunction::RETURN_NONE)
+        E.movImm(TOS, 0);
+      E.movReg64(SP, FP);
+      E.pop(FP);
+      E.ret();
+      break;
+
+    /// The SuperInstruction's.
+    case EncodedFunction::INC_LOCAL:
+      E.aluStoreImm(ADD, Slot(FP, Imm[0]), Imm[1]);
+      break;
+    case EncodedFunction::LOAD_LOCAL_ADD_CONST:
+      Spill();
+      E.movLoad(TOS, Slot(FP, Imm[0]));
+      E.aluImm(ADD, TOS, Imm[1]);
+      break;
+    case EncodedFunction::MOVE_LOCAL:
+      E.movLoad(RAX, Slot(FP, Imm[1]));
+      E.movStore(Slot(FP, Imm[0]), RAX);
+      break;
+    case EncodedFunction::STORE_LOCAL_CONST:
+      E.movStoreImm(Slot(FP, Imm[0]), Imm[1]);
+      break;
+    case EncodedFunction::ADD_CONST:
+      E.aluImm(ADD, TOS, Imm[0]);
+      break;
+    case EncodedFunction::ADD_LOCAL:
+      E.aluLoad(ADD, TOS, Slot(FP, Imm[0]));
+      break;
+    case EncodedFunction::SUB_LOCAL:
+      E.aluLoad(SUB, TOS, Slot(FP, Imm[0]));
+      break;
+#define HANDLE_COMPARE_LOCAL_CONST(Opcode, Name, Jump)                         \
+  case EncodedFunction::Opcode:                                                \
+    E.aluStoreImm(CMP, Slot(FP, Imm[0]), Imm[1]);                              \
+    JumpTo(E.jcc(getCondition(EncodedFunction::Jump)), Imm[2]);                \
+    break;
+#define HANDLE_COMPARE_LOCALS(Opcode, Name, Jump)                              \
+  case EncodedFunction::Opcode:                                                \
+    E.movLoad(RAX, Slot(FP, Imm[0]));                                          \
+    E.aluLoad(CMP, RAX, Slot(FP, Imm[1]));                                     \
+    JumpTo(E.jcc(getCondition(EncodedFunction::Jump)), Imm[2]);                \
+    break;
+#include "simplecc/CodeGen/SuperInstruction.def"
+
+    default:
+      assert(false && "Unhandled Opcode");
+      break;
+    }
+  }
+
+  for (const auto &J : Jumps)
+    E.patchRel32(J.first, Labels[J.second]);
+
+  /// The error stubs are out of the way of the code that runs.
+  for (const ErrorSite &Site : Errors) {
+    E.patchRel32(Site.Jump, E.size());
+    E.movReg64(RDI, Ctx);
+    E.movImm64(RSI, reinterpret_cast<uintptr_t>(&F));
+    E.movImm(RDX, static_cast<int>(Site.Offset));
+    E.movImm64(RCX, reinterpret_cast<uintptr_t>(Site.Msg));
+    E.callAbsolute(reinterpret_cast<const void *>(&ErrorHelper));
+    E.patchRel32(E.jmp(), ErrorExit);
+  }
+}
+
+bool TemplateJIT::Compile() {
+  std::vector<uint8_t> Buffer;
+  compileEntry(Buffer);
+  FunctionEntries.assign(TheModule->size(), 0);
+  Calls.clear();
+  for (unsigned F = 0, N = static_cast<unsigned>(TheModule->size()); F < N;
+       ++F)
+    compileFunction(F, Buffer);
+  X86Emitter E(Buffer);
+  for (const auto &C : Calls)
+    E.patchRel32(C.first, FunctionEntries[C.second]);
+
+  /// The memory is never writable and executable at once.
+  void *Mem = mmap(nullptr, Buffer.size(), PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (Mem == MAP_FAILED)
+    return false;
+  std::memcpy(Mem, Buffer.data(), Buffer.size());
+  if (mprotect(Mem, Buffer.size(), PROT_READ | PROT_EXEC) != 0) {
+    munmap(Mem, Buffer.size());
+    return false;
+  }
+  Code = static_cast<uint8_t *>(Mem);
+  CodeSize = Buffer.size();
+  return true;
+}
+
+void TemplateJIT::releaseCode() {
+  if (Code)
+    munmap(Code, CodeSize);
+  Code = nullptr;
+  CodeSize = 0;
+}
+#else
+void TemplateJIT::compileEntry(std::vector<uint8_t> &) {}
+void TemplateJIT::compileFunction(unsigned, std::vector<uint8_t> &) {}
+bool TemplateJIT::Compile() { return false; }
+void TemplateJIT::releaseCode() {}
+#endif // SIMPLECC_HAS_TEMPLATE_JIT
+
+TemplateJIT::~TemplateJIT() { releaseCode(); }
+
+bool TemplateJIT::Run(const EncodedModule &M, std::istream &IS,
+                      std::ostream &OS) {
+  releaseCode();
+  EM.clear();
+  TheModule = &M;
+  int Main = M.getFunctionIndex("main");
+  assert(Main >= 0 && "main() must exist");
+  if (!Compile()) {
+    TheModule = nullptr;
+    return Interpreter().Run(M, IS, OS);
+  }
+
+  /// One word before the memory lets the empty operand stack of a frame at
+  /// its start reload a dead TOS.
+  std::vector<int> Memory(Interpreter::MemorySize + 1);
+  Context C;
+  C.Base = Memory.data() + 1;
+  C.Limit = C.Base + Interpreter::MemorySize;
+  C.SP = C.Base + M.getGlobalsSize();
+  C.EntryStack = C.StackLimit = 0;
+  C.JIT = this;
+  C.IS = &IS;
+  C.OS = &OS;
+  C.Strings = &M.getStringLiterals();
+
+  const EncodedFunction &MainFn = M.getFunction(static_cast<unsigned>(Main));
+  bool Failed;
+  if (C.SP + MainFn.getFrameSize() + MainFn.getMaxStackDepth() > C.Limit) {
+    Error(MainFn, 0, "stack overflow");
+    Failed = true;
+  } else {
+    auto Entry = reinterpret_cast<EntryFunction>(Code);
+    Failed = Entry(&C, Code + FunctionEntries[Main]) != 0;
+  }
+  OS.flush();
+  TheModule = nullptr;
+  return Failed;
+}
+
+bool TemplateJIT::Run(const ByteCodeModule &M, std::istream &IS,
+                      std::ostream &OS) {
+  EncodedModule Encoded;
+  EncodeByteCode(M, Encoded);
+  return Run(Encoded, IS, OS);
+}
@@ -0,0 +1,53 @@
+// MIT License
+// 
+// Copyright (c) 2018 Cong Feng.
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "simplecc/VM/VM.h"
+#include "simplecc/VM/Interpreter.h"
+#include "simplecc/VM/RegisterInterpreter.h"
+#include "simplecc/VM/TemplateJIT.h"
+
+namespace simplecc {
+bool RunByteCode(const ByteCodeModule &M, std::istream &IS, std::ostream &OS) {
+  return Interpreter().Run(M, IS, OS);
+}
+
+bool RunEncodedModule(const EncodedModule &M, std::istream &IS,
+                      std::ostream &OS) {
+  return Interpreter().Run(M, IS, OS);
+}
+
+bool RunByteCodeJIT(const ByteCodeModule &M, std::istream &IS,
+                    std::ostream &OS) {
+  return TemplateJIT().Run(M, IS, OS);
+}
+
+bool RunRegisterByteCode(const ByteCodeModule &M, std::istream &IS,
+                         std::ostream &OS) {
+  return RegisterInterpreter().Run(M, IS, OS);
+}
+
+bool ProfileByteCode(const ByteCodeModule &M, std::istream &IS,
+                     std::ostream &OS, ExecutionProfile &P) {
+  return Interpreter().Profile(M, IS, OS, P);
+}
+} // namespace simplecc
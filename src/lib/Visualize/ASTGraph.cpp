@@ -35,7 +35,7 @@ ASTNode *ASTGraph::getNodeOrCreate(AST *Ptr) {
   auto iter = Nodes.find(Ptr);
   if (iter != Nodes.end())
     return iter->second.get();
-  auto Result = Nodes.emplace(Ptr, llvm::make_unique<ASTNode>(Ptr, this));
+  auto Result = Nodes.emplace(Ptr, std::make_unique<ASTNode>(Ptr, this));
   assert(Result.second && "Emplace must succeed");
   return Result.first->second.get();
 }